@@ -20,8 +20,13 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <cassert>
-#include <cstring>        /* memcpy() */
+#include <cerrno>
+#include <cstring>        /* memcpy(), memmove() */
 #include <iostream>
 #include <string>
 
@@ -33,9 +38,11 @@
 #include <sys/poll.h>     /* POSIX: poll() */
 #include <sys/socket.h>   /* BSD: getpeername() */
 #include <sys/types.h>    /* OSX: u_int32_t (INADDR_ANY) */
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>    /* Linux: epoll_*() */
+#endif
 
 #include <kvu_dbc.h>
-#include <kvu_fd_io.h>
 #include <kvu_numtostr.h>
 #include <kvu_utils.h>
 
@@ -51,8 +58,15 @@
  */
 // #define NETECI_DEBUG_ENABLED
 
-#define ECA_NETECI_START_BUFFER_SIZE    128
+#define ECA_NETECI_START_BUFFER_SIZE    4096
 #define ECA_NETECI_MAX_BUFFER_SIZE      65536
+#define ECA_NETECI_MAX_OUTPUT_SIZE      262144
+#define ECA_NETECI_MAX_COMMANDS_PER_PASS 16
+#define ECA_NETECI_MAX_EVENTS           64
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 
 /**
  * Macro definitions
@@ -73,9 +87,11 @@ using namespace std;
 ECA_NETECI_SERVER::ECA_NETECI_SERVER(ECASOUND_RUN_STATE* state)
   : state_repp(state),
     srvfd_rep(-1),
+    epollfd_rep(-1),
     server_listening_rep(false),
     unix_sockets_rep(false),
-    cleanup_request_rep(false)
+    cleanup_request_rep(false),
+    commands_pending_rep(false)
 {
 }
 
@@ -181,7 +197,7 @@ void ECA_NETECI_SERVER::open_server_socket(void)
     res = bind(srvfd_rep, (struct sockaddr*)&addr_in_rep, sizeof(addr_in_rep));
   
   if (res == 0) {
-    res = listen(srvfd_rep, 5);
+    res = listen(srvfd_rep, 64);
     if (res == 0) {
       int res = fcntl(srvfd_rep, F_SETFL, O_NONBLOCK);
       if (res == -1) 
@@ -189,6 +205,22 @@ void ECA_NETECI_SERVER::open_server_socket(void)
       
       NETECI_DEBUG(std::cout << "server socket created." << endl);
       server_listening_rep = true;
+
+#ifdef HAVE_SYS_EPOLL_H
+      epollfd_rep = epoll_create(ECA_NETECI_MAX_EVENTS);
+      if (epollfd_rep >= 0) {
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	/* note: null pointer identifies the server socket */
+	ev.data.ptr = 0;
+	if (epoll_ctl(epollfd_rep, EPOLL_CTL_ADD, srvfd_rep, &ev) != 0) {
+	  close(epollfd_rep);
+	  epollfd_rep = -1;
+	}
+      }
+      if (epollfd_rep < 0)
+	std::cerr << "epoll setup failed, using poll()." << endl;
+#endif
     }
     else 
       std::cerr << "listen() failed." << endl;
@@ -216,6 +248,10 @@ void ECA_NETECI_SERVER::close_server_socket(void)
   DBC_REQUIRE(server_listening_rep == true);
 
   NETECI_DEBUG(cerr << "closing socket " << kvu_numtostr(srvfd_rep) << "." << endl);
+  if (epollfd_rep >= 0) {
+    close(epollfd_rep);
+    epollfd_rep = -1;
+  }
   close(srvfd_rep);
   srvfd_rep = -1;
   server_listening_rep = false;
@@ -234,12 +270,14 @@ void ECA_NETECI_SERVER::listen_for_events(void)
    *   ecasound_state
    */
   
-  /* - enter poll
+  /* - wait for socket events
    * - if new connections, accept them and add the new client to
    *   client list
-   * - if incoming bytes, grab ecasound_state lock, send command,
-   *   store retval, release lock, send the reply to client
-   * - return to poll
+   * - if incoming bytes, read all available data to the
+   *   client's input buffer
+   * - execute complete commands from each client in turn, 
+   *   appending replies to the client's output buffer
+   * - send buffered replies without blocking
    */
   while(state_repp->exit_requested() != true) {
     // NETECI_DEBUG(cerr << "checking for events" << endl);
@@ -253,7 +291,8 @@ void ECA_NETECI_SERVER::listen_for_events(void)
 
 /**
  * Checks for new connections and messages from 
- * clients.
+ * clients, executes received commands and sends
+ * replies.
  * 
  * @param timeout upper-limit in ms for how long 
  *        function waits for events; if -1, 
@@ -262,235 +301,396 @@ void ECA_NETECI_SERVER::listen_for_events(void)
  */
 void ECA_NETECI_SERVER::check_for_events(int timeout)
 {
-  int nfds = clients_rep.size() + 1;
-  struct pollfd* ufds = new struct pollfd [nfds];
+  /* note: don't sleep if some client still has 
+   *       commands waiting for execution */
+  if (commands_pending_rep == true)
+    timeout = 0;
 
-  ufds[0].fd = srvfd_rep;
-  ufds[0].events = POLLIN;
-  ufds[0].revents = 0;
-  
+  wait_for_events(timeout);
+
+  /* note: execute a limited number of commands from 
+   *       each client per pass, so that a client sending
+   *       a long pipeline can't starve the others */
+  commands_pending_rep = false;
   std::list<struct ecasound_neteci_server_client*>::iterator p = clients_rep.begin();
-  for(int n = 1; n < nfds; n++) {
-    ufds[n].fd = (*p)->fd;
-    ufds[n].events = POLLIN;
-    ufds[n].revents = 0;
+  while(p != clients_rep.end()) {
+    if ((*p)->fd != -1) {
+      if (handle_client_commands(*p) == true)
+	commands_pending_rep = true;
+      if ((*p)->fd != -1 && (*p)->out_pos < (*p)->outbuf.size())
+	flush_client_output(*p);
+      if ((*p)->fd != -1)
+	update_client_events(*p);
+    }
     ++p;
   }
-  DBC_CHECK(nfds == 1 || p == clients_rep.end());
 
-  int ret = poll(ufds, nfds, timeout);
-  if (ret > 0) {
-    if (ufds[0].revents & POLLIN) {
-      /* 1. new incoming connection */
-      handle_connection(srvfd_rep);
+  if (cleanup_request_rep == true) {
+    clean_removed_clients();
+  }
+}
+
+/**
+ * Waits for socket events and handles them. New 
+ * connections are accepted, incoming data is read
+ * to client input buffers and pending output is 
+ * sent to clients whose sockets have become writable.
+ *
+ * No memory is allocated if the set of clients 
+ * has not grown.
+ */
+void ECA_NETECI_SERVER::wait_for_events(int timeout)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (epollfd_rep >= 0) {
+    struct epoll_event events[ECA_NETECI_MAX_EVENTS];
+
+    int ret = epoll_wait(epollfd_rep, events, ECA_NETECI_MAX_EVENTS, timeout);
+    for(int n = 0; n < ret; n++) {
+      struct ecasound_neteci_server_client* client = 
+	reinterpret_cast<struct ecasound_neteci_server_client*>(events[n].data.ptr);
+
+      if (client == 0) {
+	/* 1. new incoming connection */
+	handle_connection(srvfd_rep);
+	continue;
+      }
+
+      if (client->fd == -1)
+	continue;
+
+      if (events[n].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+	/* 2. client has sent data, or connection has been closed */
+	handle_client_input(client);
+      }
+      if (client->fd != -1 && (events[n].events & EPOLLOUT)) {
+	/* 3. client is ready to receive more replies */
+	flush_client_output(client);
+      }
     }
+    return;
+  }
+#endif
+
+  /* note: poll() fallback; pollfds_rep keeps its 
+   *       capacity between calls */
+  pollfds_rep.resize(clients_rep.size() + 1);
+  pollfds_rep[0].fd = srvfd_rep;
+  pollfds_rep[0].events = POLLIN;
+  pollfds_rep[0].revents = 0;
+  
+  std::list<struct ecasound_neteci_server_client*>::iterator p = clients_rep.begin();
+  for(size_t n = 1; n < pollfds_rep.size(); n++, ++p) {
+    pollfds_rep[n].fd = (*p)->fd;
+    pollfds_rep[n].events = (*p)->event_mask;
+    pollfds_rep[n].revents = 0;
+  }
+
+  int ret = poll(&pollfds_rep[0], pollfds_rep.size(), timeout);
+  if (ret > 0) {
     p = clients_rep.begin();
-    for(int n = 1; n < nfds; n++) {
-      if (ufds[n].revents & POLLIN) {
-	/* 2. client has sent a message */
-	handle_client_messages(*p);
+    for(size_t n = 1; n < pollfds_rep.size(); n++, ++p) {
+      if ((*p)->fd == -1)
+	continue;
+      if (pollfds_rep[n].revents & (POLLIN | POLLHUP | POLLERR)) {
+	handle_client_input(*p);
       }
-      else if (ufds[n].revents == POLLERR ||
-	       ufds[n].revents == POLLHUP ||
-	       ufds[n].revents == POLLNVAL) {
-	/* 3. error, remove client */
+      else if (pollfds_rep[n].revents & POLLNVAL) {
 	remove_client(*p);
       }
-      if (p != clients_rep.end()) ++p;
+      if ((*p)->fd != -1 && (pollfds_rep[n].revents & POLLOUT)) {
+	flush_client_output(*p);
+      }
     }
-  }
 
-  if (cleanup_request_rep == true) {
-    clean_removed_clients();
+    /* note: new clients are appended to the list, so this 
+     *       is done only after iterating the old clients */
+    if (pollfds_rep[0].revents & POLLIN) {
+      handle_connection(srvfd_rep);
+    }
   }
-
-  delete[] ufds;
 }
 
+/**
+ * Accepts all pending connections on server socket 'fd'.
+ */
 void ECA_NETECI_SERVER::handle_connection(int fd)
 {
-  socklen_t bytes = 0;
-  string peername;
-  int connfd = 0;
+  while(true) {
+    socklen_t bytes = 0;
+    string peername;
+    int connfd = -1;
 
-  if (unix_sockets_rep == true) {
-    bytes = static_cast<socklen_t>(sizeof(addr_un_rep));
-    connfd = accept(fd, reinterpret_cast<struct sockaddr*>(&addr_un_rep), &bytes);
-    peername = "UNIX:" + socketpath_rep;
-  }
-  else {
-    bytes = static_cast<socklen_t>(sizeof(addr_in_rep));
-    connfd = accept(fd, reinterpret_cast<struct sockaddr*>(&addr_in_rep), &bytes);
-
-    if (connfd > 0) {
-      struct sockaddr_in peeraddr;
-      socklen_t peernamelen;
-      // struct in_addr peerip;
-      peername = "TCP/IP:";
-      int res = getpeername(connfd, 
-			    reinterpret_cast<struct sockaddr*>(&peeraddr), 
-			    reinterpret_cast<socklen_t*>(&peernamelen));
-      if (res == 0)
-	peername += string(inet_ntoa(peeraddr.sin_addr));
-      else
-	peername += string(inet_ntoa(addr_in_rep.sin_addr));
+    if (unix_sockets_rep == true) {
+      bytes = static_cast<socklen_t>(sizeof(addr_un_rep));
+      connfd = accept(fd, reinterpret_cast<struct sockaddr*>(&addr_un_rep), &bytes);
+      peername = "UNIX:" + socketpath_rep;
+    }
+    else {
+      bytes = static_cast<socklen_t>(sizeof(addr_in_rep));
+      connfd = accept(fd, reinterpret_cast<struct sockaddr*>(&addr_in_rep), &bytes);
+
+      if (connfd >= 0) {
+	struct sockaddr_in peeraddr;
+	socklen_t peernamelen = static_cast<socklen_t>(sizeof(peeraddr));
+	peername = "TCP/IP:";
+	int res = getpeername(connfd, 
+			      reinterpret_cast<struct sockaddr*>(&peeraddr), 
+			      &peernamelen);
+	if (res == 0)
+	  peername += string(inet_ntoa(peeraddr.sin_addr));
+	else
+	  peername += string(inet_ntoa(addr_in_rep.sin_addr));
+      }
     }
-  }
 
-  ECA_LOG_MSG(ECA_LOGGER::info,
-	      "New connection from " + 
-	      peername + ".");
+    if (connfd < 0) {
+      /* note: EAGAIN, no more pending connections */
+      break;
+    }
+
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"New connection from " + 
+		peername + ".");
 
+    int res = fcntl(connfd, F_SETFL, O_NONBLOCK);
+    if (res == -1) 
+      std::cerr << "fcntl() failed." << endl;
 
-  if (connfd >= 0) {
     NETECI_DEBUG(cerr << "incoming connection accepted" << endl);
     struct ecasound_neteci_server_client* client = new struct ecasound_neteci_server_client; /* add a new client */
     client->fd = connfd; 
-    client->buffer_length = ECA_NETECI_START_BUFFER_SIZE;
-    client->buffer = new char [client->buffer_length];
-    client->buffer_current_ptr = 0;
+    client->in_size = ECA_NETECI_START_BUFFER_SIZE;
+    client->inbuf = new char [client->in_size];
+    client->in_begin = client->in_end = client->in_scan = 0;
+    client->out_pos = 0;
+    client->event_mask = POLLIN;
+    client->quit_requested = false;
     client->peername = peername;
     clients_rep.push_back(client);
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (epollfd_rep >= 0) {
+      struct epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.ptr = client;
+      if (epoll_ctl(epollfd_rep, EPOLL_CTL_ADD, connfd, &ev) != 0) {
+	std::cerr << "epoll_ctl() failed, removing client." << endl;
+	remove_client(client);
+      }
+    }
+#endif
   }
 }
 
 /**
- * Handle incoming messages for client 'client'.
+ * Reads all available data from 'client' to its
+ * input buffer. The buffer is grown up to 
+ * ECA_NETECI_MAX_BUFFER_SIZE bytes when needed.
  */
-void ECA_NETECI_SERVER::handle_client_messages(struct ecasound_neteci_server_client* client)
+void ECA_NETECI_SERVER::handle_client_input(struct ecasound_neteci_server_client* client)
 {
-  char* buf[128];
-  int connfd = client->fd;
-
-  NETECI_DEBUG(cerr << "handle_client_messages for fd " 
-	       << connfd << endl);
-
-  ssize_t c = kvu_fd_read(connfd, buf, 128, 5000);
-  if (c > 0) {
-    parse_raw_incoming_data(reinterpret_cast<char*>(buf), c, client);
-    while(parsed_cmd_queue_rep.size() > 0) {
-      const string& nextcmd = parsed_cmd_queue_rep.front();
-      if (nextcmd == "quit" || nextcmd == "q") {
-	NETECI_DEBUG(cerr << "client initiated quit, removing client-fd " << connfd << "." << endl);
-	remove_client(client);
+  NETECI_DEBUG(cerr << "handle_client_input for fd " 
+	       << client->fd << endl);
+
+  while(client->fd != -1) {
+    if (client->in_end == client->in_size) {
+      if (client->in_begin > 0) {
+	/* note: areas may overlap */
+	int pending = client->in_end - client->in_begin;
+	memmove(client->inbuf, client->inbuf + client->in_begin, pending);
+	client->in_scan -= client->in_begin;
+	client->in_end = pending;
+	client->in_begin = 0;
+      }
+      else if (client->in_size * 2 <= ECA_NETECI_MAX_BUFFER_SIZE) {
+	int new_size = client->in_size * 2;
+	NETECI_DEBUG(cerr << "client buffer full, increasing buffer size from "
+		     << client->in_size << " to " << new_size << " bytes." << endl);
+	char* new_buffer = new char [new_size];
+	memcpy(new_buffer, client->inbuf, client->in_end);
+	delete[] client->inbuf;
+	client->inbuf = new_buffer;
+	client->in_size = new_size;
+      }
+      else if (client->in_scan == client->in_end) {
+	/* note: buffer holds an incomplete command that 
+	 *       doesn't fit in the buffer */
+	cerr << "client buffer overflow, unable to increase buffer size. flushing..." << endl;
+	client->in_begin = client->in_end = client->in_scan = 0;
       }
       else {
-	handle_eci_command(nextcmd, client);
+	/* note: buffer full of pipelined commands; read 
+	 *       more once they have been executed */
+	break;
       }
-      parsed_cmd_queue_rep.pop_front();
     }
-    /* ... */
-  }
-  else {
-    /* read() <= 0 */
-    NETECI_DEBUG(cerr << "read error, removing client-fd " << connfd << "." << endl);
-    remove_client(client);
+
+    int space = client->in_size - client->in_end;
+    ssize_t c = read(client->fd, client->inbuf + client->in_end, space);
+    if (c > 0) {
+      client->in_end += c;
+      if (c < space)
+	break;
+    }
+    else if (c < 0 && errno == EINTR) {
+      continue;
+    }
+    else if (c < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    else {
+      /* read() == 0 or error */
+      NETECI_DEBUG(cerr << "read error, removing client-fd " << client->fd << "." << endl);
+      remove_client(client);
+    }
   }
 }
 
-void ECA_NETECI_SERVER::parse_raw_incoming_data(const char* buffer,
-						ssize_t bytes,
-						struct ecasound_neteci_server_client* client)
+/**
+ * Executes complete commands from input buffer of 'client',
+ * at most ECA_NETECI_MAX_COMMANDS_PER_PASS commands per call.
+ * Execution is paused if the client is not reading its
+ * replies.
+ *
+ * @return true if client may have more complete commands
+ *         waiting for execution
+ */
+bool ECA_NETECI_SERVER::handle_client_commands(struct ecasound_neteci_server_client* client)
 {
-  DBC_REQUIRE(buffer != 0);
-  DBC_REQUIRE(bytes >= 0);
-  DBC_REQUIRE(client != 0);
-  DBC_DECLARE(int old_client_ptr = client->buffer_current_ptr);
-  DBC_DECLARE(unsigned int old_cmd_queue_size = parsed_cmd_queue_rep.size());
-
-  NETECI_DEBUG(cerr << "parse incoming data; "
-	       << bytes << " bytes. Buffer length is " 
-	       << client->buffer_length << endl);
-  
-  for(int n = 0; n < bytes; n++) {
-    DBC_CHECK(client->buffer_current_ptr <= client->buffer_length);
-    if (client->buffer_current_ptr == client->buffer_length) {
-      int new_buffer_length = client->buffer_length * 2;
-      char *new_buffer = new char [new_buffer_length];
+  int executed = 0;
 
-      if (new_buffer_length > ECA_NETECI_MAX_BUFFER_SIZE) {
-	cerr << "client buffer overflow, unable to increase buffer size. flushing..." << endl;
-	client->buffer_current_ptr = 0;
-      }
-      else {
-	NETECI_DEBUG(cerr << "client buffer overflow, increasing buffer size from "
-		     << client->buffer_length << " to " << new_buffer_length << " bytes." << endl);
-	
-	for(int i = 0; i < client->buffer_length; i++) new_buffer[i] = client->buffer[i];
-	
-	delete[] client->buffer;
-	client->buffer = new_buffer;
-	client->buffer_length = new_buffer_length;
-      }
+  while(client->fd != -1 &&
+	client->quit_requested != true &&
+	executed < ECA_NETECI_MAX_COMMANDS_PER_PASS &&
+	client->outbuf.size() - client->out_pos < ECA_NETECI_MAX_OUTPUT_SIZE) {
+
+    /* step: find the next CRLF */
+    int n = (client->in_scan > client->in_begin) ? client->in_scan : client->in_begin + 1;
+    while(n < client->in_end &&
+	  (client->inbuf[n] != '\n' || client->inbuf[n - 1] != '\r'))
+      ++n;
+
+    if (n >= client->in_end) {
+      client->in_scan = client->in_end;
+      break;
     }
 
-    NETECI_DEBUG(cerr << "copying '" << buffer[n] << "'\n");
-    client->buffer[client->buffer_current_ptr] = buffer[n];
-    if (client->buffer_current_ptr > 0 &&
-	client->buffer[client->buffer_current_ptr] == '\n' &&
-	client->buffer[client->buffer_current_ptr - 1] == '\r') {
+    const char* cmd = client->inbuf + client->in_begin;
+    int len = n - 1 - client->in_begin;
+    client->in_begin = client->in_scan = n + 1;
 
-      string cmd (client->buffer, client->buffer_current_ptr - 1);
-      NETECI_DEBUG(cerr << "storing command '" <<	cmd << "'" << endl);
-      parsed_cmd_queue_rep.push_back(cmd);
-      
-      NETECI_DEBUG(cerr << "copying " 
-		   << client->buffer_length - client->buffer_current_ptr - 1
-		   << " bytes from " << client->buffer_current_ptr + 1 
-		   << " to the beginning of the buffer."
-		   << " Index is " << client->buffer_current_ptr << endl);
-      
-      DBC_CHECK(client->buffer_current_ptr < client->buffer_length);
-      
-#if 0
-      /* must not use memcpy() as the 
-	 affected areas may overlap! */
-      for(int o = 0, p = index + 1; 
-	  p < client->buffer_length; o++, p++) {
-	client->buffer[o] = client->buffer[p];
-      }
-#endif
-      client->buffer_current_ptr = 0;
+    if ((len == 4 && strncmp(cmd, "quit", 4) == 0) ||
+	(len == 1 && cmd[0] == 'q')) {
+      NETECI_DEBUG(cerr << "client initiated quit, removing client-fd " << client->fd << "." << endl);
+      client->quit_requested = true;
     }
     else {
-      // NETECI_DEBUG(cerr << "crlf not found, index=" << index << ", n=" << n << "cur_ptr=" << client->buffer_current_ptr << ".\n");
-      client->buffer_current_ptr++;
+      handle_eci_command(cmd, len, client);
     }
+    ++executed;
   }
 
-  DBC_ENSURE(client->buffer_current_ptr > old_client_ptr ||
-	     parsed_cmd_queue_rep.size() > old_cmd_queue_size);
+  if (client->in_begin == client->in_end) 
+    client->in_begin = client->in_end = client->in_scan = 0;
+
+  if (client->fd != -1 &&
+      client->quit_requested == true &&
+      client->out_pos == client->outbuf.size())
+    remove_client(client);
+
+  return executed == ECA_NETECI_MAX_COMMANDS_PER_PASS;
 }
 
-void ECA_NETECI_SERVER::handle_eci_command(const string& cmd, struct ecasound_neteci_server_client* client)
+/**
+ * Executes ECI command 'cmd' (of 'len' bytes, not 
+ * null-terminated) and appends the reply to the output
+ * buffer of 'client'.
+ */
+void ECA_NETECI_SERVER::handle_eci_command(const char* cmd, int len, struct ecasound_neteci_server_client* client)
 {
   ECA_CONTROL_MT* ctrl = state_repp->control;
 
-  NETECI_DEBUG(cerr << "handle eci command: " << cmd << endl);
+  string cmdstr (cmd, len);
+  NETECI_DEBUG(cerr << "handle eci command: " << cmdstr << endl);
 
   assert(ctrl != 0);
 
   struct eci_return_value retval;
-  ctrl->command(cmd, &retval);
+  ctrl->command(cmdstr, &retval);
 
-  string strtosend =
+  client->outbuf +=
     ECA_LOGGER_WELLFORMED::create_wellformed_message(ECA_LOGGER::eiam_return_values,
       std::string(ECA_CONTROL_MAIN::return_value_type_to_string(&retval))
       + " " + 
       ECA_CONTROL_MAIN::return_value_to_string(&retval));
+}
 
-  int bytes_to_send = strtosend.size();
-  while(bytes_to_send > 0) {
-    int ret = kvu_fd_write(client->fd, strtosend.c_str(), strtosend.size(), 5000);
-    if (ret < 0) {
-      cerr << "error in kvu_fd_write(), removing client.\n";
-      remove_client(client);
+/**
+ * Sends as much of the buffered output of 'client' as
+ * can be sent without blocking.
+ */
+void ECA_NETECI_SERVER::flush_client_output(struct ecasound_neteci_server_client* client)
+{
+  while(client->out_pos < client->outbuf.size()) {
+    ssize_t ret = send(client->fd, 
+		       client->outbuf.data() + client->out_pos, 
+		       client->outbuf.size() - client->out_pos,
+		       MSG_NOSIGNAL);
+    if (ret > 0) {
+      client->out_pos += ret;
+    }
+    else if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
       break;
     }
     else {
-      bytes_to_send -= ret;
+      cerr << "error in send(), removing client.\n";
+      remove_client(client);
+      return;
     }
   }
+
+  if (client->out_pos == client->outbuf.size()) {
+    /* note: clear() keeps the allocated capacity */
+    client->outbuf.clear();
+    client->out_pos = 0;
+  }
+}
+
+/**
+ * Updates the set of socket events monitored
+ * for 'client'. Output is waited for only when 
+ * there are unsent replies, and input only when
+ * there is room in the input buffer.
+ */
+void ECA_NETECI_SERVER::update_client_events(struct ecasound_neteci_server_client* client)
+{
+  short mask = 0;
+  if (client->quit_requested != true &&
+      (client->in_end - client->in_begin < ECA_NETECI_MAX_BUFFER_SIZE ||
+       client->in_scan < client->in_end))
+    mask |= POLLIN;
+  if (client->out_pos < client->outbuf.size())
+    mask |= POLLOUT;
+
+  if (mask == client->event_mask)
+    return;
+
+  client->event_mask = mask;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (epollfd_rep >= 0) {
+    struct epoll_event ev;
+    ev.events = 0;
+    if (mask & POLLIN) ev.events |= EPOLLIN;
+    if (mask & POLLOUT) ev.events |= EPOLLOUT;
+    ev.data.ptr = client;
+    epoll_ctl(epollfd_rep, EPOLL_CTL_MOD, client->fd, &ev);
+  }
+#endif
 }
 
 /**
@@ -509,6 +709,7 @@ void ECA_NETECI_SERVER::remove_client(struct ecasound_neteci_server_client* clie
     ECA_LOG_MSG(ECA_LOGGER::info, 
 		"Closing connection " +
 		client->peername + ".");
+    /* note: closing the fd also removes it from the epoll set */
     close(client->fd);
     client->fd = -1;
   }
@@ -532,9 +733,9 @@ void ECA_NETECI_SERVER::clean_removed_clients(void)
   while(p != clients_rep.end()) {
     NETECI_DEBUG(std::cerr << "checking for delete, client " << *p << std::endl);
     if (*p != 0 && (*p)->fd == -1) {
-      if ((*p)->buffer != 0) {
-	delete[] (*p)->buffer;
-	(*p)->buffer = 0;
+      if ((*p)->inbuf != 0) {
+	delete[] (*p)->inbuf;
+	(*p)->inbuf = 0;
       }
       std::list<struct ecasound_neteci_server_client*>::iterator q = p;
       ++q;
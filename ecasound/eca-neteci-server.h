@@ -3,7 +3,9 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
+#include <sys/poll.h>     /* POSIX: struct pollfd */
 #include <sys/socket.h>   /* Generic socket definitions */
 #include <sys/un.h>       /* UNIX socket definitions */
 #include <netinet/in.h>   /* IP socket definitions */
@@ -11,17 +13,41 @@
 struct ecasound_state;
 class ECASOUND_RUN_STATE;
 
+/**
+ * State of one NetECI client connection.
+ *
+ * Incoming data is stored to 'inbuf'. Bytes between
+ * 'in_begin' and 'in_end' have been received, but not
+ * yet executed as commands. Replies are appended to
+ * 'outbuf' and sent from offset 'out_pos' onwards
+ * whenever the socket is writable.
+ */
 struct ecasound_neteci_server_client {
   std::string peername;
-  char* buffer;
   int fd;
-  int buffer_current_ptr;
-  int buffer_length;
+  char* inbuf;
+  int in_begin;
+  int in_end;
+  int in_scan;
+  int in_size;
+  std::string outbuf;
+  size_t out_pos;
+  short event_mask;
+  bool quit_requested;
 };
 
 /**
  * NetECI server implementation.
  *
+ * The server is event-driven. All sockets are non-blocking
+ * and they are monitored with epoll (or poll() on systems
+ * where epoll is not available). Clients may pipeline
+ * commands, ie. send multiple commands without waiting
+ * for the replies. Commands are executed in the order they
+ * were received, and at most a fixed number of commands
+ * per client is executed on each pass, so that a busy client
+ * does not delay commands of other clients.
+ *
  * @author Kai Vehmanen
  */
 class ECA_NETECI_SERVER {
@@ -49,12 +75,13 @@ class ECA_NETECI_SERVER {
   void close_server_socket(void);
   void listen_for_events(void);
   void check_for_events(int timeout);
+  void wait_for_events(int timeout);
   void handle_connection(int fd);
-  void handle_client_messages(struct ecasound_neteci_server_client* client);
-  void handle_eci_command(const std::string& cmd, struct ecasound_neteci_server_client* client);
-  void parse_raw_incoming_data(const char* buffer, 
-			       ssize_t bytes,
-			       struct ecasound_neteci_server_client* client);
+  void handle_client_input(struct ecasound_neteci_server_client* client);
+  bool handle_client_commands(struct ecasound_neteci_server_client* client);
+  void handle_eci_command(const char* cmd, int len, struct ecasound_neteci_server_client* client);
+  void flush_client_output(struct ecasound_neteci_server_client* client);
+  void update_client_events(struct ecasound_neteci_server_client* client);
   void remove_client(struct ecasound_neteci_server_client* client);
   void clean_removed_clients(void);
 
@@ -64,14 +91,15 @@ class ECA_NETECI_SERVER {
   ECASOUND_RUN_STATE* state_repp;
 
   std::list<struct ecasound_neteci_server_client*> clients_rep;
-  /* FIXME: turn into a buffer of pointers to allow ptr-fields */
-  std::list<std::string> parsed_cmd_queue_rep;
+  std::vector<struct pollfd> pollfds_rep;
   std::string socketpath_rep;
 
   int srvfd_rep;
+  int epollfd_rep;
   bool server_listening_rep;
   bool unix_sockets_rep;
   bool cleanup_request_rep;
+  bool commands_pending_rep;
 
 };
 
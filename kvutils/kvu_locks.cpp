@@ -69,6 +69,11 @@ void ATOMIC_INTEGER::set(int value)
   value_rep = value;
 }
 
+int ATOMIC_INTEGER::add(int delta)
+{
+  return __sync_fetch_and_add(&value_rep, delta);
+}
+
 KVU_GUARD_LOCK::KVU_GUARD_LOCK(pthread_mutex_t* lock_arg)
 {
   lock_repp = lock_arg;
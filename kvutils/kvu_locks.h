@@ -13,7 +13,8 @@
  * both single- and multiprocessor concurrency. Ordering of 
  * concurrent reads and writes is however not guaranteed.
  *
- * Note! Atomic test-and-modify operations are not provided.
+ * Note! Of the test-and-modify operations, only add() 
+ *       is provided.
  */
 class ATOMIC_INTEGER {
 
@@ -37,6 +38,15 @@ class ATOMIC_INTEGER {
    */
   void set(int value);
 
+  /**
+   * Adds 'delta' to the stored value and returns the 
+   * value held before the addition.
+   *
+   * Non-blocking. Atomic for both single- and 
+   * multiprocessor concurrency.
+   */
+  int add(int delta);
+
   ATOMIC_INTEGER(int value = 0);
   ~ATOMIC_INTEGER(void);
 
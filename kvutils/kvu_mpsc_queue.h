@@ -0,0 +1,159 @@
+// ------------------------------------------------------------------------
+// kvu_mpsc_queue.h: Bounded lock-free queue for RT msg passing
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifndef INCLUDE_KVU_MPSC_QUEUE_H
+#define INCLUDE_KVU_MPSC_QUEUE_H
+
+#include <vector>
+
+#include <stddef.h>
+
+/**
+ * A bounded queue for passing fixed-size records from
+ * multiple producer threads to a single consumer thread.
+ *
+ * The queue is a ring of preallocated cells. Each cell
+ * carries a sequence number that tells whether it is free
+ * for the producer claiming that ring position, or holds
+ * a record ready for the consumer. Producers claim
+ * positions with an atomic compare-and-swap, so neither
+ * producers nor the consumer ever take a lock.
+ *
+ * All operations are real-time safe, i.e. they have bounded
+ * execution time and do not allocate memory. If the queue
+ * is full, push() fails instead of blocking.
+ *
+ * 'T' should be a plain-old-data type, as records are
+ * copied in and out of the ring.
+ *
+ * @author Kai Vehmanen
+ */
+template<class T>
+class MPSC_QUEUE_RT_C {
+
+public:
+
+  /**
+   * Class constructor. Capacity is rounded up to the next
+   * power of two.
+   *
+   * Execution note: allocates memory
+   */
+  MPSC_QUEUE_RT_C(size_t capacity = 1024)
+    : enqueue_pos_rep(0),
+      dequeue_pos_rep(0) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    cells_rep.resize(size);
+    for(size_t n = 0; n < size; n++)
+      cells_rep[n].sequence = n;
+    mask_rep = size - 1;
+  }
+
+  /**
+   * Adds a copy of 'arg' to the end of the queue.
+   *
+   * Execution note: rt-safe, does not block, can be called
+   *                 from multiple threads concurrently
+   *
+   * @return true on success, false if queue is full
+   */
+  bool push(const T& arg) {
+    size_t pos = enqueue_pos_rep;
+    Cell* cell;
+    for(;;) {
+      cell = &cells_rep[pos & mask_rep];
+      long int dif = static_cast<long int>(cell->sequence) - static_cast<long int>(pos);
+      if (dif == 0) {
+	if (__sync_bool_compare_and_swap(&enqueue_pos_rep, pos, pos + 1))
+	  break;
+      }
+      else if (dif < 0) {
+	/* note: the cell still holds a record from the
+	 *       previous lap, queue is full */
+	return false;
+      }
+      pos = enqueue_pos_rep;
+    }
+
+    cell->data = arg;
+    __sync_synchronize();
+    cell->sequence = pos + 1;
+    return true;
+  }
+
+  /**
+   * Fetches, and removes, the front item in the queue.
+   *
+   * Execution note: rt-safe, does not block, must only
+   *                 be called from one thread
+   *
+   * @return true on success, false if queue is empty
+   */
+  bool pop(T* front_msg) {
+    Cell* cell = &cells_rep[dequeue_pos_rep & mask_rep];
+    if (cell->sequence != dequeue_pos_rep + 1) {
+      /* note: empty, or the producer that claimed the front
+       *       position has not yet finished writing */
+      return false;
+    }
+    __sync_synchronize();
+    if (front_msg != 0)
+      *front_msg = cell->data;
+    __sync_synchronize();
+    cell->sequence = dequeue_pos_rep + mask_rep + 1;
+    ++dequeue_pos_rep;
+    return true;
+  }
+
+  /**
+   * Is queue empty?
+   *
+   * Execution note: rt-safe, does not block
+   */
+  bool is_empty(void) const {
+    const Cell* cell = &cells_rep[dequeue_pos_rep & mask_rep];
+    return cell->sequence != dequeue_pos_rep + 1;
+  }
+
+  /**
+   * Returns the number of records queue can hold.
+   */
+  size_t capacity(void) const { return mask_rep + 1; }
+
+private:
+
+  struct Cell {
+    volatile size_t sequence;
+    T data;
+  };
+
+  MPSC_QUEUE_RT_C(const MPSC_QUEUE_RT_C&) {}
+  MPSC_QUEUE_RT_C& operator=(const MPSC_QUEUE_RT_C&) { return *this; }
+
+  std::vector<Cell> cells_rep;
+  size_t mask_rep;            // only modified in constructor
+  volatile size_t enqueue_pos_rep;
+  size_t dequeue_pos_rep;     // only modified by the consumer
+};
+
+#endif /* INCLUDE_KVU_MPSC_QUEUE_H */
@@ -32,6 +32,7 @@
 #include <stddef.h>  /* ANSI-C: size_t */
 #include <stdio.h>   /* for AIX */
 #include <time.h>    /* ANSI-C: clock() */
+#include <sched.h>   /* POSIX: sched_yield() */
 
 #include "kvu_dbc.h"
 #include "kvu_locks.h"
@@ -41,6 +42,7 @@
 #include "kvu_utils.h"
 #include "kvu_value_queue.h"
 #include "kvu_message_queue.h"
+#include "kvu_mpsc_queue.h"
 
 using namespace std;
 
@@ -82,6 +84,7 @@ static int kvu_test_3(void);
 static int kvu_test_4(void);
 static int kvu_test_5_timestamp(void);
 static int kvu_test_6_msgqueue(void);
+static int kvu_test_7_mpscqueue(void);
 
 static kvu_test_t kvu_funcs[] = { 
   kvu_test_1,  /* kvu_locks.h: ATOMIC_INTEGER */
@@ -90,6 +93,7 @@ static kvu_test_t kvu_funcs[] = {
   kvu_test_4,  /* kvu_value_queue.h */
   kvu_test_5_timestamp, /* kvu_timestamp.h */
   kvu_test_6_msgqueue,  /* kvu_message_queue.h */
+  kvu_test_7_mpscqueue, /* kvu_mpsc_queue.h */
   NULL 
 };
 
@@ -600,3 +604,108 @@ static void* kvu_test_6_helper(void* ptr)
   /* never reached */
   return 0;
 }
+
+static const int kvu_test_7_producers_const = 4;
+static const int kvu_test_7_items_const = 20000;
+
+struct kvu_test_7_item {
+  int producer;
+  int seq;
+};
+
+struct kvu_test_7_producer {
+  MPSC_QUEUE_RT_C<kvu_test_7_item>* queue;
+  int id;
+};
+
+/**
+ * Pushes kvu_test_7_items_const items, retrying 
+ * while the queue is full.
+ */
+static void* kvu_test_7_helper(void* ptr)
+{
+  kvu_test_7_producer* p = static_cast<kvu_test_7_producer*>(ptr);
+
+  for(int n = 0; n < kvu_test_7_items_const; n++) {
+    kvu_test_7_item item;
+    item.producer = p->id;
+    item.seq = n;
+    while(p->queue->push(item) != true)
+      sched_yield();
+  }
+
+  return 0;
+}
+
+/**
+ * Tests the MPSC_QUEUE_RT_C class implementation.
+ */
+static int kvu_test_7_mpscqueue(void)
+{
+  ECA_TEST_ENTRY();
+
+  /* note: small queue, so producers often find it full */
+  MPSC_QUEUE_RT_C<kvu_test_7_item> queue (16);
+  if (queue.capacity() != 16)
+    ECA_TEST_FAIL(1, "kvu_test_7 capacity"); 
+
+  kvu_test_7_item item;
+  if (queue.pop(&item) == true || queue.is_empty() != true)
+    ECA_TEST_FAIL(1, "kvu_test_7 initially not empty"); 
+
+  for(int n = 0; n < 16; n++) {
+    item.producer = 0;
+    item.seq = n;
+    if (queue.push(item) != true)
+      ECA_TEST_FAIL(1, "kvu_test_7 push failed"); 
+  }
+  if (queue.push(item) == true)
+    ECA_TEST_FAIL(1, "kvu_test_7 push to a full queue"); 
+  for(int n = 0; n < 16; n++) {
+    if (queue.pop(&item) != true || item.seq != n)
+      ECA_TEST_FAIL(1, "kvu_test_7 pop order"); 
+  }
+
+  ECA_TEST_NOTE("start-threads");
+
+  pthread_t threads[kvu_test_7_producers_const];
+  kvu_test_7_producer producers[kvu_test_7_producers_const];
+  for(int n = 0; n < kvu_test_7_producers_const; n++) {
+    producers[n].queue = &queue;
+    producers[n].id = n;
+    pthread_create(&threads[n], NULL, kvu_test_7_helper, &producers[n]);
+  }
+
+  /* note: items of each producer must arrive in order,
+   *       without losses or duplicates */
+  int next_seq[kvu_test_7_producers_const];
+  for(int n = 0; n < kvu_test_7_producers_const; n++)
+    next_seq[n] = 0;
+
+  int failed = 0;
+  int total = kvu_test_7_producers_const * kvu_test_7_items_const;
+  for(int received = 0; received < total; ) {
+    if (queue.pop(&item) != true) {
+      sched_yield();
+      continue;
+    }
+    if (item.producer < 0 || 
+	item.producer >= kvu_test_7_producers_const ||
+	item.seq != next_seq[item.producer]) {
+      failed = 1;
+      break;
+    }
+    ++next_seq[item.producer];
+    ++received;
+  }
+
+  for(int n = 0; n < kvu_test_7_producers_const; n++)
+    pthread_join(threads[n], NULL);
+
+  if (failed != 0)
+    ECA_TEST_FAIL(1, "kvu_test_7 queue-sync-error"); 
+
+  ECA_TEST_NOTE("end-test.");
+
+  ECA_TEST_SUCCESS();
+}
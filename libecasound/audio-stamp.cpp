@@ -54,6 +54,14 @@ void AUDIO_STAMP_SERVER::fetch_stamp(int id, SAMPLE_BUFFER* x) {
   }
 }
 
+/**
+ * Exchanges the registered stamps with 'other'. Does 
+ * not allocate memory.
+ */
+void AUDIO_STAMP_SERVER::swap(AUDIO_STAMP_SERVER* other) {
+  stamp_map_rep.swap(other->stamp_map_rep);
+}
+
 AUDIO_STAMP_CLIENT::AUDIO_STAMP_CLIENT(void) 
   : id_rep(0),
     id_set_rep(false),
@@ -31,6 +31,7 @@ class AUDIO_STAMP_SERVER {
 
   void register_stamp(AUDIO_STAMP* stamp);
   void fetch_stamp(int id, SAMPLE_BUFFER* x);
+  void swap(AUDIO_STAMP_SERVER* other);
 
  private:
 
@@ -61,6 +61,8 @@ void EFFECT_AMPLITUDE::release(void)
 }
 
 EFFECT_AMPLIFY::EFFECT_AMPLIFY (EFFECT_AMPLITUDE::parameter_t multiplier_percent)
+  : gain_ramp_repp(0),
+    sbuf_repp(0)
 {
   set_parameter(1, multiplier_percent);
 }
@@ -74,6 +76,7 @@ void EFFECT_AMPLIFY::set_parameter(int param, parameter_t value)
   switch (param) {
   case 1: 
     gain_rep = value / 100.0;
+    gain_ramp_repp = 0;
     break;
   }
 }
@@ -87,6 +90,15 @@ CHAIN_OPERATOR::parameter_t EFFECT_AMPLIFY::get_parameter(int param) const
   return 0.0;
 }
 
+void EFFECT_AMPLIFY::set_parameter_ramp(int param, const parameter_t* values)
+{
+  switch (param) {
+  case 1: 
+    gain_ramp_repp = values;
+    break;
+  }
+}
+
 void EFFECT_AMPLIFY::parameter_description(int param, struct PARAM_DESCRIPTION *pd) const
 {
   OPERATOR::parameter_description(param, pd);
@@ -96,6 +108,7 @@ void EFFECT_AMPLIFY::init(SAMPLE_BUFFER* sbuf)
 {
   i.init(sbuf);
   sbuf_repp = sbuf;
+  gain_ramp_repp = 0;
 }
 
 void EFFECT_AMPLIFY::release(void)
@@ -105,7 +118,22 @@ void EFFECT_AMPLIFY::release(void)
 
 void EFFECT_AMPLIFY::process(void)
 {
-  sbuf_repp->multiply_by(gain_rep);
+  if (gain_ramp_repp == 0) {
+    sbuf_repp->multiply_by(gain_rep);
+    return;
+  }
+
+  /* note: gain follows the ramp sample by sample */
+  SAMPLE_BUFFER::buf_size_t len = sbuf_repp->length_in_samples();
+  for(int c = 0; c < sbuf_repp->number_of_channels(); c++) {
+    SAMPLE_BUFFER::sample_t* buf = sbuf_repp->buffer[c];
+    for(SAMPLE_BUFFER::buf_size_t n = 0; n < len; n++) {
+      buf[n] *= static_cast<SAMPLE_BUFFER::sample_t>(gain_ramp_repp[n] / 100.0);
+    }
+  }
+  if (len > 0) 
+    gain_rep = gain_ramp_repp[len - 1] / 100.0;
+  gain_ramp_repp = 0;
 }
 
 /**
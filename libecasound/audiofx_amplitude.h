@@ -36,6 +36,7 @@ protected:
 class EFFECT_AMPLIFY: public EFFECT_AMPLITUDE {
 
   parameter_t gain_rep;
+  const parameter_t* gain_ramp_repp;
   SAMPLE_ITERATOR i;
   SAMPLE_BUFFER* sbuf_repp;
 
@@ -48,6 +49,9 @@ class EFFECT_AMPLIFY: public EFFECT_AMPLITUDE {
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
 
+  virtual bool supports_parameter_ramp(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, const parameter_t* values);
+
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
   virtual void process(void);
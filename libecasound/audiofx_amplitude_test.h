@@ -18,7 +18,9 @@
 // ------------------------------------------------------------------------
 
 #include <string>
+#include <vector>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -86,6 +88,42 @@ void EFFECT_AMPLIFY_TEST::do_run(void)
       ECA_TEST_FAILURE("optimized EFFECT_AMPLIFY");
     }
   }
+
+  /* case: set_parameter_ramp, with a constant ramp */
+  {
+    std::fprintf(stdout, "%s: EFFECT_AMPLIFY::set_parameter_ramp\n",
+		 __FILE__);
+    SAMPLE_BUFFER sbuf_test (bufsize, channels);
+    SAMPLE_BUFFER sbuf_ref (bufsize, channels);
+
+    EFFECT_AMPLIFY amp_test;
+    EFFECT_AMPLIFY amp_ref;
+    
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&sbuf_ref);
+    sbuf_test.copy_all_content(sbuf_ref);
+
+    amp_test.init(&sbuf_test);
+    amp_ref.init(&sbuf_ref);
+
+    std::vector<CHAIN_OPERATOR::parameter_t> ramp (bufsize, multiplier);
+    if (amp_test.supports_parameter_ramp(1) != true) {
+      ECA_TEST_FAILURE("supports_parameter_ramp");
+    }
+    amp_test.set_parameter_ramp(1, &ramp[0]);
+    amp_ref.set_parameter(1, multiplier);
+
+    amp_test.process();
+    amp_ref.process_ref();
+    
+    if (SAMPLE_BUFFER_FUNCTIONS::is_almost_equal(sbuf_ref, sbuf_test) != true) {
+      ECA_TEST_FAILURE("EFFECT_AMPLIFY with a parameter ramp");
+    }
+
+    /* note: parameter keeps the last value of the ramp */
+    if (std::fabs(amp_test.get_parameter(1) - multiplier) > 0.01) {
+      ECA_TEST_FAILURE("EFFECT_AMPLIFY parameter after ramp");
+    }
+  }
 }
 
 /**
@@ -36,6 +36,75 @@ static void priv_resize_buffer(std::vector<SAMPLE_SPECS::sample_t> *buffer, int
     (*buffer)[i] = 0.0;
 }
 
+/**
+ * Converts a delay parameter to a sample count. Fractional
+ * delays are rounded up.
+ */
+static long int priv_delay_in_samples(CHAIN_OPERATOR::parameter_t value)
+{
+  if (value <= 0.0) return 0;
+  return static_cast<long int>(std::ceil(value));
+}
+
+/**
+ * Feedback comb filters need at least one sample of delay.
+ */
+static long int priv_comb_delay_in_samples(CHAIN_OPERATOR::parameter_t value)
+{
+  long int delay = priv_delay_in_samples(value);
+  return (delay < 1) ? 1 : delay;
+}
+
+/**
+ * Maximum number of samples moved with one block
+ * operation on a delay line.
+ */
+static const long int max_span_length = 256;
+
+/**
+ * Makes room for 'delay + extra' samples, and for at least
+ * one second of audio, so that the delay can later be changed
+ * with set_parameter() without allocating memory. Called
+ * only from init().
+ */
+static void priv_reserve_delay_lines(std::vector<DELAY_LINE> *lines, long int delay, long int extra, SAMPLE_SPECS::sample_rate_t srate)
+{
+  if (delay < srate) delay = srate;
+  for(size_t n = 0; n < lines->size(); n++)
+    (*lines)[n].reserve(delay + extra);
+}
+
+/**
+ * Whether a delay of 'delay' samples does not fit in the
+ * capacity reserved for 'lines' in init().
+ */
+static bool priv_exceeds_capacity(const std::vector<DELAY_LINE>& lines, long int delay, long int extra)
+{
+  return (lines.size() > 0 && delay > lines[0].capacity() - extra);
+}
+
+/**
+ * Limits 'delay' so that 'lines' can hold 'delay + extra'
+ * samples. This only happens if the delay is raised from
+ * the engine thread, e.g. by a controller. A warning is
+ * logged when the limiting starts.
+ */
+static long int priv_clamp_delay(const std::vector<DELAY_LINE>& lines, long int delay, long int extra, bool *limited)
+{
+  long int max = lines[0].capacity() - extra;
+  if (delay <= max) {
+    *limited = false;
+    return delay;
+  }
+  if (*limited != true) {
+    *limited = true;
+    ECA_LOG_MSG_RT(ECA_LOGGER::info,
+		   "WARNING: delay of %ld samples exceeds the reserved %ld samples, delay limited until reinitialized",
+		   delay, max);
+  }
+  return max;
+}
+
 EFFECT_FILTER::~EFFECT_FILTER(void)
 {
 }
@@ -125,41 +194,22 @@ CHAIN_OPERATOR::parameter_t EFFECT_BANDREJECT::get_parameter(int param) const
 
 void EFFECT_BW_FILTER::init(SAMPLE_BUFFER *insample)
 {
-  i.init(insample);
+  sbuf_repp = insample;
 
   set_channels(insample->number_of_channels());
-
-  const size_t buflen = 2;
-
-  sin.resize(insample->number_of_channels(), std::vector<SAMPLE_SPECS::sample_t> (buflen));
-  sout.resize(insample->number_of_channels(), std::vector<SAMPLE_SPECS::sample_t> (buflen));
-
-  for(int i = 0; i < insample->number_of_channels(); i++) {
-    for(size_t j = 0; j < buflen; j++) {
-      sin[i][j] = 0.0f;
-      sout[i][j] = 0.0f;
-    }
-  }
+  filter_rep.set_channels(insample->number_of_channels());
 }
 
 void EFFECT_BW_FILTER::process(void)
 {
-  i.begin();
-  while(!i.end()) {
-    outputSample = ecaops_flush_to_zero(a[0] * (*i.current()) + 
-					a[1] * sin[i.channel()][0] + 
-					a[2] * sin[i.channel()][1] - 
-					b[0] * sout[i.channel()][0] - 
-					b[1] * sout[i.channel()][1]);
-    sin[i.channel()][1] = sin[i.channel()][0];
-    sin[i.channel()][0] = *i.current();
-
-    sout[i.channel()][1] = sout[i.channel()][0];
-    sout[i.channel()][0] = outputSample;
-
-    *i.current() = outputSample;
-    i.next();
-  }
+  int channels = sbuf_repp->number_of_channels();
+  if (channels > filter_rep.channels())
+    channels = filter_rep.channels();
+
+  /* note: coefficients are set by subclasses, so pick
+   *       up any changes made since the last block */
+  filter_rep.set_coefficients(a[0], a[1], a[2], b[0], b[1]);
+  filter_rep.process(&sbuf_repp->buffer[0], channels, sbuf_repp->length_in_samples());
 }
 
 void EFFECT_BW_FILTER::process_notused(SAMPLE_BUFFER* sbuf)
@@ -223,8 +273,10 @@ CHAIN_OPERATOR::parameter_t EFFECT_HIGHPASS::get_parameter(int param) const
 }
 
 EFFECT_ALLPASS_FILTER::EFFECT_ALLPASS_FILTER (void)
-  : feedback_gain(0.0),
-    D(0.0)
+  : sbuf_repp(0),
+    feedback_gain(0.0),
+    D(0.0),
+    delay_limited(false)
 {
 
 }
@@ -234,11 +286,6 @@ void EFFECT_ALLPASS_FILTER::set_parameter(int param, CHAIN_OPERATOR::parameter_t
   switch (param) {
   case 1: 
     D = value;
-//    assert(inbuf.size() == outbuf.size());
-    for(int n = 0; n < static_cast<int>(inbuf.size()); n++) {
-      if (inbuf[n].size() > D) inbuf[n].resize(static_cast<unsigned int>(D));
-//      if (outbuf[n].size() > D) inbuf[n].resize(D);
-    }
     break;
   case 2: 
     feedback_gain = value / 100.0;
@@ -259,47 +306,72 @@ CHAIN_OPERATOR::parameter_t EFFECT_ALLPASS_FILTER::get_parameter(int param) cons
 
 void EFFECT_ALLPASS_FILTER::init(SAMPLE_BUFFER* insample)
 {
-  i.init(insample);
+  sbuf_repp = insample;
 
   set_channels(insample->number_of_channels());
 
   inbuf.resize(insample->number_of_channels());
   for(size_t i = 0; i < inbuf.size(); i++)
     inbuf[i].clear();
+  temp.resize(max_span_length);
+  delay_limited = false;
+  priv_reserve_delay_lines(&inbuf, priv_delay_in_samples(D), max_span_length, samples_per_second());
+}
+
+bool EFFECT_ALLPASS_FILTER::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
+{
+  if (param != 1)
+    return false;
+  return priv_exceeds_capacity(inbuf, priv_delay_in_samples(value), max_span_length);
 }
 
 void EFFECT_ALLPASS_FILTER::process(void)
 {
-  i.begin();
-  while(!i.end()) {
-    if (inbuf[i.channel()].size() >= D) {
-      inbuf[i.channel()].push_back(*i.current());
-
-      //      *i.current() = -feedback_gain * (*i.current()) +
-      //	             inbuf[i.channel()].front() +
-      //	             feedback_gain * outbuf[i.channel()].front();
-
-      *i.current() = ecaops_flush_to_zero(-feedback_gain * (*i.current()) +
-					  (feedback_gain * inbuf[i.channel()].front() +
-					   *i.current()) * 
-					  (1.0 - feedback_gain * feedback_gain));
-
-      //      feedback_gain * outbuf[i.channel()].front();
-      //      outbuf[i.channel()].push_back(*i.current());
-
-      inbuf[i.channel()].pop_front();
-      // outbuf[i.channel()].pop_front();
-    } 
-    else {
-      inbuf[i.channel()].push_back(*i.current());
-      *i.current() = ecaops_flush_to_zero(*i.current() * (1.0 - feedback_gain));
-      // outbuf[i.channel()].push_back(*i.current());
+  long int delay = priv_clamp_delay(inbuf, priv_delay_in_samples(D), max_span_length, &delay_limited);
+
+  int channels = sbuf_repp->number_of_channels();
+  if (channels > static_cast<int>(inbuf.size()))
+    channels = inbuf.size();
+
+  long int len = sbuf_repp->length_in_samples();
+  for(int c = 0; c < channels; c++) {
+    DELAY_LINE& line = inbuf[c];
+    SAMPLE_SPECS::sample_t* data = sbuf_repp->buffer[c];
+
+    for(long int pos = 0; pos < len;) {
+      long int span = len - pos;
+      if (span > max_span_length) span = max_span_length;
+
+      /* note: output is produced only after 'delay' input
+       *       samples have been written to the line */
+      long int unfilled = delay - line.filled();
+      if (unfilled < 0) unfilled = 0;
+      if (unfilled > span) unfilled = span;
+
+      /* note: the line holds the input, so the span is
+       *       written first, and then read back 'delay'
+       *       samples behind */
+      line.write_block(data + pos, span);
+      line.read_block(&temp[0], delay + span, span);
+
+      for(long int n = 0; n < unfilled; n++) {
+	data[pos + n] = ecaops_flush_to_zero(data[pos + n] * (1.0 - feedback_gain));
+      }
+      for(long int n = unfilled; n < span; n++) {
+	data[pos + n] = ecaops_flush_to_zero(-feedback_gain * data[pos + n] +
+					     (feedback_gain * temp[n] +
+					      data[pos + n]) *
+					     (1.0 - feedback_gain * feedback_gain));
+      }
+
+      pos += span;
     }
-    i.next();
   }
 }
 
 EFFECT_COMB_FILTER::EFFECT_COMB_FILTER (int delay_in_samples, CHAIN_OPERATOR::parameter_t radius)
+  : sbuf_repp(0),
+    delay_limited(false)
 {
   set_parameter(1, (CHAIN_OPERATOR::parameter_t)delay_in_samples);
   set_parameter(2, radius);
@@ -311,13 +383,6 @@ void EFFECT_COMB_FILTER::set_parameter(int param, CHAIN_OPERATOR::parameter_t va
   case 1: 
     {
       C = value;
-      std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	if (p->size() > C) {
-	  p->resize(static_cast<unsigned int>(C));
-	}
-	++p;
-      }
       break;
     }
 
@@ -340,34 +405,64 @@ CHAIN_OPERATOR::parameter_t EFFECT_COMB_FILTER::get_parameter(int param) const
 
 void EFFECT_COMB_FILTER::init(SAMPLE_BUFFER* insample)
 {
-  i.init(insample);
+  sbuf_repp = insample;
 
   set_channels(insample->number_of_channels());
 
   buffer.resize(insample->number_of_channels());
   for(size_t i = 0; i < buffer.size(); i++)
     buffer[i].clear();
+  temp.resize(max_span_length);
+  delay_limited = false;
+  priv_reserve_delay_lines(&buffer, priv_comb_delay_in_samples(C), 0, samples_per_second());
+}
 
+bool EFFECT_COMB_FILTER::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
+{
+  if (param != 1)
+    return false;
+  return priv_exceeds_capacity(buffer, priv_comb_delay_in_samples(value), 0);
 }
 
 void EFFECT_COMB_FILTER::process(void)
 {
-  i.begin();
-  while(!i.end()) {
-    if (buffer[i.channel()].size() >= C) {
-      *i.current() = (*i.current())  + (pow(D, C) *
-					buffer[i.channel()].front());
-      buffer[i.channel()].push_back(*i.current());
-      buffer[i.channel()].pop_front();
-    } 
-    else {
-      buffer[i.channel()].push_back(*i.current());
+  long int delay = priv_clamp_delay(buffer, priv_comb_delay_in_samples(C), 0, &delay_limited);
+  SAMPLE_SPECS::sample_t gain = pow(D, C);
+
+  int channels = sbuf_repp->number_of_channels();
+  if (channels > static_cast<int>(buffer.size()))
+    channels = buffer.size();
+
+  long int len = sbuf_repp->length_in_samples();
+  for(int c = 0; c < channels; c++) {
+    DELAY_LINE& line = buffer[c];
+    SAMPLE_SPECS::sample_t* data = sbuf_repp->buffer[c];
+
+    for(long int pos = 0; pos < len;) {
+      /* note: the output is fed back to the line, so a span
+       *       can be at most 'delay' samples long */
+      long int span = len - pos;
+      if (span > max_span_length) span = max_span_length;
+      if (span > delay) span = delay;
+
+      long int unfilled = delay - line.filled();
+      if (unfilled < 0) unfilled = 0;
+      if (unfilled > span) unfilled = span;
+
+      line.read_block(&temp[0], delay, span);
+      for(long int n = unfilled; n < span; n++) {
+	data[pos + n] = data[pos + n] + gain * temp[n];
+      }
+      line.write_block(data + pos, span);
+
+      pos += span;
     }
-    i.next();
   }
 }
 
 EFFECT_INVERSE_COMB_FILTER::EFFECT_INVERSE_COMB_FILTER (int delay_in_samples, CHAIN_OPERATOR::parameter_t radius)
+  : sbuf_repp(0),
+    delay_limited(false)
 {
   // 
   // delay in number of samples
@@ -402,32 +497,58 @@ CHAIN_OPERATOR::parameter_t EFFECT_INVERSE_COMB_FILTER::get_parameter(int param)
 
 void EFFECT_INVERSE_COMB_FILTER::init(SAMPLE_BUFFER* insample)
 {
-  i.init(insample);
+  sbuf_repp = insample;
 
   set_channels(insample->number_of_channels());
 
   buffer.resize(insample->number_of_channels());
   for(size_t i = 0; i < buffer.size(); i++)
     buffer[i].clear();
+  temp.resize(max_span_length);
+  delay_limited = false;
+  priv_reserve_delay_lines(&buffer, priv_delay_in_samples(C), max_span_length, samples_per_second());
+}
 
-  priv_resize_buffer(&laskuri, insample->number_of_channels());
+bool EFFECT_INVERSE_COMB_FILTER::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
+{
+  if (param != 1)
+    return false;
+  return priv_exceeds_capacity(buffer, priv_delay_in_samples(value), max_span_length);
 }
 
 void EFFECT_INVERSE_COMB_FILTER::process(void)
 {
-  i.begin();
-  while(!i.end()) {
-    buffer[i.channel()].push_back(*i.current());
-    
-    if (laskuri[i.channel()] >= C) {
-      *i.current() = (*i.current())  - (pow(D, C) *
-					buffer[i.channel()].front());
-      buffer[i.channel()].pop_front();
-    } 
-    else {
-      laskuri[i.channel()]++;
+  long int delay = priv_clamp_delay(buffer, priv_delay_in_samples(C), max_span_length, &delay_limited);
+  SAMPLE_SPECS::sample_t gain = pow(D, C);
+
+  int channels = sbuf_repp->number_of_channels();
+  if (channels > static_cast<int>(buffer.size()))
+    channels = buffer.size();
+
+  long int len = sbuf_repp->length_in_samples();
+  for(int c = 0; c < channels; c++) {
+    DELAY_LINE& line = buffer[c];
+    SAMPLE_SPECS::sample_t* data = sbuf_repp->buffer[c];
+
+    for(long int pos = 0; pos < len;) {
+      long int span = len - pos;
+      if (span > max_span_length) span = max_span_length;
+
+      long int unfilled = delay - line.filled();
+      if (unfilled < 0) unfilled = 0;
+      if (unfilled > span) unfilled = span;
+
+      /* note: the line holds the input, so the span is
+       *       written first, and then read back 'delay'
+       *       samples behind */
+      line.write_block(data + pos, span);
+      line.read_block(&temp[0], delay + span, span);
+      for(long int n = unfilled; n < span; n++) {
+	data[pos + n] = data[pos + n] - gain * temp[n];
+      }
+
+      pos += span;
     }
-    i.next();
   }
 }
 
@@ -1,11 +1,12 @@
 #ifndef INCLUDED_AUDIOFX_FILTER_H
 #define INCLUDED_AUDIOFX_FILTER_H
 
-#include <deque>
 #include <string>
 #include <vector>
 
 #include "audiofx.h"
+#include "biquad-filter.h"
+#include "delay-line.h"
 #include "samplebuffer_iterators.h"
 
 /**
@@ -23,16 +24,16 @@ class EFFECT_FILTER : public EFFECT_BASE {
  * 
  * Based on SPKit Butterworth algorithms. 
  * (for more info, see http://www.music.helsinki.fi/research/spkit)
+ *
+ * Subclasses set the coefficients 'a' and 'b'. Audio is
+ * filtered a block at a time with BIQUAD_FILTER.
  */
 class EFFECT_BW_FILTER : public EFFECT_FILTER {
 
 private:
   
-  SAMPLE_SPECS::sample_t outputSample;
-  SAMPLE_ITERATOR_CHANNELS i;
-
-  std::vector<std::vector<SAMPLE_SPECS::sample_t> > sin;
-  std::vector<std::vector<SAMPLE_SPECS::sample_t> > sout;
+  SAMPLE_BUFFER* sbuf_repp;
+  BIQUAD_FILTER filter_rep;
 
   void init_values(void);
 
@@ -51,7 +52,7 @@ public:
 
   //  EFFECT_BW_FILTER(void) : sin(2), sout(2), a(3), b(2) {
 
-  EFFECT_BW_FILTER(void) : a(3), b(2) {
+  EFFECT_BW_FILTER(void) : sbuf_repp(0), a(3), b(2) {
     init_values();
   }
 };
@@ -145,11 +146,13 @@ public:
  */
 class EFFECT_ALLPASS_FILTER : public EFFECT_FILTER {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > inbuf, outbuf;
-  SAMPLE_ITERATOR_CHANNELS i;
+  std::vector<DELAY_LINE> inbuf;
+  std::vector<SAMPLE_SPECS::sample_t> temp;
+  SAMPLE_BUFFER* sbuf_repp;
 
   parameter_t feedback_gain;
   parameter_t D;
+  bool delay_limited;
 
 public:
 
@@ -161,6 +164,7 @@ public:
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void process(void);
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   EFFECT_ALLPASS_FILTER* clone(void) const { return new EFFECT_ALLPASS_FILTER(*this); }  
   EFFECT_ALLPASS_FILTER* new_expr(void) const { return new EFFECT_ALLPASS_FILTER(); }
@@ -176,12 +180,13 @@ public:
  */
 class EFFECT_COMB_FILTER : public EFFECT_FILTER {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
+  std::vector<DELAY_LINE> buffer;
   std::vector<SAMPLE_SPECS::sample_t> temp;
-  SAMPLE_ITERATOR_CHANNELS i;
+  SAMPLE_BUFFER* sbuf_repp;
 
   parameter_t C;
   parameter_t D;
+  bool delay_limited;
 
 public:
 
@@ -193,6 +198,7 @@ public:
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void process(void);
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   EFFECT_COMB_FILTER* clone(void) const { return new EFFECT_COMB_FILTER(*this); }  
   EFFECT_COMB_FILTER* new_expr(void) const { return new EFFECT_COMB_FILTER(); }
@@ -207,13 +213,13 @@ public:
  */
 class EFFECT_INVERSE_COMB_FILTER : public EFFECT_FILTER {
 
-  std::vector<parameter_t> laskuri;
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
+  std::vector<DELAY_LINE> buffer;
   std::vector<SAMPLE_SPECS::sample_t> temp;
-  SAMPLE_ITERATOR_CHANNELS i;
+  SAMPLE_BUFFER* sbuf_repp;
 
   parameter_t C;
   parameter_t D;
+  bool delay_limited;
 
 public:
 
@@ -225,6 +231,7 @@ public:
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void process(void);
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   EFFECT_INVERSE_COMB_FILTER* clone(void) const { return new EFFECT_INVERSE_COMB_FILTER(*this); }  
   EFFECT_INVERSE_COMB_FILTER* new_expr(void) const { return new EFFECT_INVERSE_COMB_FILTER(); }
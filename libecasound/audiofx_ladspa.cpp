@@ -33,6 +33,7 @@
 #include <kvu_numtostr.h>
 #include "samplebuffer.h"
 #include "audiofx_ladspa.h"
+#include "eca-ladspa-plugin-cache.h"
 #include "eca-error.h"
 #include "eca-logger.h"
 
@@ -50,6 +51,7 @@ EFFECT_LADSPA::EFFECT_LADSPA (const LADSPA_Descriptor *pdesc) throw(ECA_ERROR&)
   maker_rep = string(plugin_desc->Maker);
   unique_number_rep = static_cast<long int>(plugin_desc->UniqueID);
   buffer_repp = 0;
+  worker_pool_repp = 0;
 
   init_ports();
 }
@@ -82,6 +84,22 @@ EFFECT_LADSPA* EFFECT_LADSPA::clone(void) const
   return result;
 }
 
+/**
+ * Loads the plugin library if the object was created
+ * from a cached descriptor. Returns false if the library
+ * can not be loaded, or if it no longer contains
+ * the plugin.
+ */
+bool EFFECT_LADSPA::load(void)
+{
+  const LADSPA_Descriptor* real_desc = ECA_LADSPA_PLUGIN_CACHE::resolve(plugin_desc);
+  if (real_desc == 0)
+    return false;
+
+  plugin_desc = real_desc;
+  return true;
+}
+
 void EFFECT_LADSPA::init_ports(void)
 {
   // note: run from plugin constructor
@@ -325,6 +343,14 @@ void EFFECT_LADSPA::init(SAMPLE_BUFFER *insample)
     }
   }
 
+  if (load() != true) {
+    plugins_rep.clear();
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"ERROR: Unable to load LADSPA plugin \"" + unique_rep +
+		"\", plugin disabled.");
+    return;
+  }
+
   // NOTE: the fancy definition :)
   //       if ((in_audio_ports > 1 &&
   //            in_audio_ports <= channels() &&
@@ -411,8 +437,28 @@ void EFFECT_LADSPA::release(void)
   buffer_repp = 0;
 }
 
+/**
+ * If one plugin instance is run per channel, and a
+ * worker pool has been set, the instances are run
+ * in parallel.
+ */
 void EFFECT_LADSPA::process(void)
 {
+  if (worker_pool_repp != 0 &&
+      plugins_rep.size() > 1 &&
+      worker_pool_repp->try_execute(this, plugins_rep.size()) == true)
+    return;
+
   for(unsigned long m = 0; m < plugins_rep.size(); m++)
     plugin_desc->run(plugins_rep[m], buffer_repp->length_in_samples());
 }
+
+/**
+ * Runs the plugin instance of channel 'index'.
+ *
+ * Reimplemented from ECA_WORKER_POOL_JOB.
+ */
+void EFFECT_LADSPA::run_item(int index)
+{
+  plugin_desc->run(plugins_rep[index], buffer_repp->length_in_samples());
+}
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "audiofx.h"
+#include "eca-worker-pool.h"
 
 /* prefer already installed LADSPA header over the 
  * version shipped with ecasound */
@@ -18,9 +19,17 @@ class SAMPLE_BUFFER;
 
 /**
  * Wrapper class for LADSPA plugins
+ *
+ * The plugin descriptor may be a copy stored in
+ * ECA_LADSPA_PLUGIN_CACHE. In this case the plugin
+ * library is loaded, and the descriptor replaced with
+ * the real one, when load() is called. ECA_OBJECT_FACTORY
+ * does this for every plugin instance it creates.
+ *
  * @author Kai Vehmanen
  */
-class EFFECT_LADSPA : public EFFECT_BASE {
+class EFFECT_LADSPA : public EFFECT_BASE,
+                      public ECA_WORKER_POOL_JOB {
 
 public:
 
@@ -49,6 +58,8 @@ public:
    */
   long int unique_number(void) const { return(unique_number_rep); }
 
+  bool load(void);
+
   virtual int output_channels(int i_channels) const;
 
   virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
@@ -58,6 +69,9 @@ public:
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
   virtual void process(void);
+  virtual void set_worker_pool(ECA_WORKER_POOL* pool) { worker_pool_repp = pool; }
+
+  virtual void run_item(int index);
 
  private:
 
@@ -67,6 +81,7 @@ public:
 private:
 
   SAMPLE_BUFFER* buffer_repp;
+  ECA_WORKER_POOL* worker_pool_repp;
   
   const LADSPA_Descriptor *plugin_desc;
   std::vector<LADSPA_Handle> plugins_rep;
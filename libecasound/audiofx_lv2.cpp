@@ -55,6 +55,7 @@ EFFECT_LV2::EFFECT_LV2 (Lilv::Plugin pdesc) throw(ECA_ERROR&) :plugin_desc(pdesc
     maker_rep = string();
   }
   buffer_repp = 0;
+  worker_pool_repp = 0;
   init_ports();
 }
 
@@ -360,10 +361,30 @@ void EFFECT_LV2::release(void)
   buffer_repp = 0;
 }
 
+/**
+ * If one plugin instance is run per channel, and a
+ * worker pool has been set, the instances are run
+ * in parallel.
+ */
 void EFFECT_LV2::process(void)
 {
+  if (worker_pool_repp != 0 &&
+      plugins_rep.size() > 1 &&
+      worker_pool_repp->try_execute(this, plugins_rep.size()) == true)
+    return;
+
   for(unsigned long m = 0; m < plugins_rep.size(); m++)
     lilv_instance_run(plugins_rep[m]->me, buffer_repp->length_in_samples());
 }
 
+/**
+ * Runs the plugin instance of channel 'index'.
+ *
+ * Reimplemented from ECA_WORKER_POOL_JOB.
+ */
+void EFFECT_LV2::run_item(int index)
+{
+  lilv_instance_run(plugins_rep[index]->me, buffer_repp->length_in_samples());
+}
+
 #endif /* ECA_USE_LIBLILV */
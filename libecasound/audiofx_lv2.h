@@ -5,6 +5,7 @@
 #include <string>
 
 #include "audiofx.h"
+#include "eca-worker-pool.h"
 
 #if ECA_USE_LIBLILV
 
@@ -16,7 +17,8 @@ class SAMPLE_BUFFER;
  * Wrapper class for LV2 plugins
  * @author Jeremy Salwen
  */
-class EFFECT_LV2 : public EFFECT_BASE {
+class EFFECT_LV2 : public EFFECT_BASE,
+                   public ECA_WORKER_POOL_JOB {
 
 public:
 
@@ -46,6 +48,9 @@ public:
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
   virtual void process(void);
+  virtual void set_worker_pool(ECA_WORKER_POOL* pool) { worker_pool_repp = pool; }
+
+  virtual void run_item(int index);
 
  private:
 
@@ -55,6 +60,7 @@ public:
 private:
 
   SAMPLE_BUFFER* buffer_repp;
+  ECA_WORKER_POOL* worker_pool_repp;
   
   Lilv::Plugin plugin_desc;
   std::vector<Lilv::Instance*> plugins_rep;
@@ -42,12 +42,72 @@ static void priv_check_for_zerodelay(long int *dtime, OPERATOR::parameter_t *dti
   }
 }
 
+/**
+ * Maximum number of samples moved with one block
+ * operation on a delay line.
+ */
+static const long int max_span_length = 256;
+
+/**
+ * Converts a delay time in milliseconds to samples.
+ */
+static long int priv_delay_in_samples(CHAIN_OPERATOR::parameter_t msec, long int srate)
+{
+  long int dtime = msec * (CHAIN_OPERATOR::parameter_t)srate / 1000;
+  return (dtime == 0) ? 1 : dtime;
+}
+
+/**
+ * Makes room for 'delay + extra' samples, and for at least
+ * one second of audio, so that the delay time can later be
+ * increased without allocating memory. Called only from
+ * init(), as set_parameter() may be called from the
+ * engine thread.
+ */
+static void priv_reserve_delay_lines(std::vector<DELAY_LINE> *lines, long int delay, long int extra, SAMPLE_SPECS::sample_rate_t srate)
+{
+  if (delay < srate) delay = srate;
+  for(size_t n = 0; n < lines->size(); n++)
+    (*lines)[n].reserve(delay + extra);
+}
+
+/**
+ * Whether a delay of 'delay' samples does not fit in the
+ * capacity reserved for 'lines' in init().
+ */
+static bool priv_exceeds_capacity(const std::vector<DELAY_LINE>& lines, long int delay, long int extra)
+{
+  return (lines.size() > 0 && delay > lines[0].capacity() - extra);
+}
+
+/**
+ * Limits 'delay' so that 'lines' can hold 'delay + extra'
+ * samples. This only happens if the delay is raised from
+ * the engine thread, e.g. by a controller. A warning is
+ * logged when the limiting starts.
+ */
+static long int priv_clamp_delay(const std::vector<DELAY_LINE>& lines, long int delay, long int extra, bool *limited)
+{
+  long int max = lines[0].capacity() - extra;
+  if (delay <= max) {
+    *limited = false;
+    return delay;
+  }
+  if (*limited != true) {
+    *limited = true;
+    ECA_LOG_MSG_RT(ECA_LOGGER::info,
+		   "WARNING: delay of %ld samples exceeds the reserved %ld samples, delay limited until reinitialized",
+		   delay, max);
+  }
+  return max;
+}
+
 EFFECT_DELAY::EFFECT_DELAY (CHAIN_OPERATOR::parameter_t delay_time, int surround_mode, 
 			    int num_of_delays, CHAIN_OPERATOR::parameter_t mix_percent,
 			    CHAIN_OPERATOR::parameter_t feedback_percent) 
+  : sbuf_repp(0),
+    delay_limited(false)
 {
-  laskuri = 0.0;
-
   set_parameter(1, delay_time);
   set_parameter(2, surround_mode);
   set_parameter(3, num_of_delays);
@@ -146,18 +206,6 @@ void EFFECT_DELAY::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
       dtime_msec = value;
       dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
       priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-      std::vector<std::vector<SINGLE_BUFFER> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	std::vector<SINGLE_BUFFER>::iterator q = p->begin();
-	while(q != p->end()) {
-	  if (q->size() > static_cast<size_t>(dtime)) {
-	    q->resize(static_cast<size_t>(dtime));
-	    laskuri = dtime;
-	  }
-	  ++q;
-	}
-	++p;
-      }
       break;
     }
 
@@ -169,12 +217,6 @@ void EFFECT_DELAY::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
     {
       if (value != 0.0) dnum = static_cast<long int>(value);
       else dnum = 1.0;
-      std::vector<std::vector<SINGLE_BUFFER> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	p->resize(static_cast<unsigned int>(dnum));
-	++p;
-      }
-      laskuri = 0;
       break;
     }
 
@@ -194,49 +236,87 @@ void EFFECT_DELAY::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
 
 void EFFECT_DELAY::init(SAMPLE_BUFFER* insample)
 {
-  l.init(insample);
-  r.init(insample);
+  sbuf_repp = insample;
 
   EFFECT_BASE::init(insample);
 
+  buffer.resize(2);
+  for(size_t i = 0; i < buffer.size(); i++)
+    buffer[i].clear();
+  temp.resize(max_span_length * 4);
+  delay_limited = false;
+
   set_parameter(1, dtime_msec);
+  priv_reserve_delay_lines(&buffer, static_cast<long int>(dtime * dnum), max_span_length, samples_per_second());
+}
 
-  buffer.resize(2, std::vector<SINGLE_BUFFER> (static_cast<unsigned int>(dnum)));
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
+bool EFFECT_DELAY::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
+{
+  long int delay;
+  switch (param) {
+  case 1:
+    delay = static_cast<long int>(priv_delay_in_samples(value, samples_per_second()) * dnum);
+    break;
+  case 3:
+    delay = dtime * ((value != 0.0) ? static_cast<long int>(value) : 1);
+    break;
+  default:
+    return false;
   }
+  return priv_exceeds_capacity(buffer, delay, max_span_length);
 }
 
 void EFFECT_DELAY::process(void)
 {
-  l.begin(SAMPLE_SPECS::ch_left);
-  r.begin(SAMPLE_SPECS::ch_right);
-
-  while(!l.end() && !r.end()) {
-    SAMPLE_SPECS::sample_t temp2_left = 0.0;
-    SAMPLE_SPECS::sample_t temp2_right = 0.0;
+  if (sbuf_repp->number_of_channels() < 2)
+    return;
+
+  SAMPLE_SPECS::sample_t* left = sbuf_repp->buffer[SAMPLE_SPECS::ch_left];
+  SAMPLE_SPECS::sample_t* right = sbuf_repp->buffer[SAMPLE_SPECS::ch_right];
+  SAMPLE_SPECS::sample_t* tap_left = &temp[0];
+  SAMPLE_SPECS::sample_t* tap_right = &temp[max_span_length];
+  SAMPLE_SPECS::sample_t* sum_left = &temp[max_span_length * 2];
+  SAMPLE_SPECS::sample_t* sum_right = &temp[max_span_length * 3];
+
+  long int len = sbuf_repp->length_in_samples();
+  for(long int pos = 0; pos < len;) {
+    long int span = len - pos;
+    if (span > max_span_length) span = max_span_length;
+
+    /* note: the lines hold the dry input, so the span is
+     *       written first, and the taps are then read
+     *       'tap' samples behind each written sample */
+    buffer[SAMPLE_SPECS::ch_left].write_block(left + pos, span);
+    buffer[SAMPLE_SPECS::ch_right].write_block(right + pos, span);
+
+    for(long int n = 0; n < span; n++) {
+      sum_left[n] = 0.0;
+      sum_right[n] = 0.0;
+    }
 
     // Initializing the feedback factor to one. (x*1 = x)
     SAMPLE_SPECS::sample_t feedfact = 1;
 
+    // Taps are read from the same line, 'dtime' samples apart.
     for(int nm2 = 0; nm2 < dnum; nm2++) {
-      SAMPLE_SPECS::sample_t temp_left = 0.0;
-      SAMPLE_SPECS::sample_t temp_right = 0.0;
-
       // Preparing the factor...
       feedfact *= feedback;
 
-      if (laskuri >= dtime * (nm2 + 1)) {
+      long int tap = priv_clamp_delay(buffer, dtime * (nm2 + 1), max_span_length, &delay_limited);
+      buffer[SAMPLE_SPECS::ch_left].read_block(tap_left, tap + span, span);
+      buffer[SAMPLE_SPECS::ch_right].read_block(tap_right, tap + span, span);
+
+      for(long int n = 0; n < span; n++) {
+	SAMPLE_SPECS::sample_t temp_left = 0.0;
+	SAMPLE_SPECS::sample_t temp_right = 0.0;
 
 	switch ((int)surround) {
 	case 0: 
 	  {
 	    // ---
 	    // surround
-	    temp_left = buffer[SAMPLE_SPECS::ch_left][nm2].front();
-	    temp_right = buffer[SAMPLE_SPECS::ch_right][nm2].front();
+	    temp_left = tap_left[n];
+	    temp_right = tap_right[n];
 	    break;
 	  }
 
@@ -244,22 +324,18 @@ void EFFECT_DELAY::process(void)
 	  {
 	    // ---
 	    // surround
-	    temp_left = buffer[SAMPLE_SPECS::ch_right][nm2].front();
-	    temp_right = buffer[SAMPLE_SPECS::ch_left][nm2].front();
+	    temp_left = tap_right[n];
+	    temp_right = tap_left[n];
 	    break;
 	  }
 	case 2: 
 	  {
 	    if (nm2 % 2 == 0) {
-	      temp_left = (buffer[SAMPLE_SPECS::ch_left][nm2].front()
-			   + 
-			   buffer[SAMPLE_SPECS::ch_right][nm2].front()) / 2.0;
+	      temp_left = (tap_left[n] + tap_right[n]) / 2.0;
 	      temp_right = 0.0;
 	    }
 	    else {
-	      temp_right = (buffer[SAMPLE_SPECS::ch_left][nm2].front()
-			   + 
-			   buffer[SAMPLE_SPECS::ch_right][nm2].front()) / 2.0;
+	      temp_right = (tap_left[n] + tap_right[n]) / 2.0;
 	      temp_left = 0.0;
 	    }
 	    break;
@@ -270,23 +346,17 @@ void EFFECT_DELAY::process(void)
 	temp_left *= feedfact;
 	temp_right *= feedfact;
 
-	buffer[SAMPLE_SPECS::ch_left][nm2].pop_front();
-	buffer[SAMPLE_SPECS::ch_right][nm2].pop_front();
+	sum_left[n] += temp_left / dnum;
+	sum_right[n] += temp_right / dnum;
       }
-      buffer[SAMPLE_SPECS::ch_left][nm2].push_back(*l.current());
-      buffer[SAMPLE_SPECS::ch_right][nm2].push_back(*r.current());
-
-      temp2_left += temp_left / dnum;
-      temp2_right += temp_right / dnum;
-
     }
-    *l.current() = (*l.current() * (1.0 - mix)) + (temp2_left * mix);
-    *r.current() = (*r.current() * (1.0 - mix)) + (temp2_right * mix);
 
-    l.next();
-    r.next();
+    for(long int n = 0; n < span; n++) {
+      left[pos + n] = (left[pos + n] * (1.0 - mix)) + (sum_left[n] * mix);
+      right[pos + n] = (right[pos + n] * (1.0 - mix)) + (sum_right[n] * mix);
+    }
 
-    if (laskuri < dtime * dnum) laskuri++;
+    pos += span;
   }
 }
 
@@ -453,6 +523,8 @@ void EFFECT_MULTITAP_DELAY::process(void)
 }
 
 EFFECT_FAKE_STEREO::EFFECT_FAKE_STEREO (CHAIN_OPERATOR::parameter_t delay_time)
+  : sbuf_repp(0),
+    delay_limited(false)
 {
    set_parameter(1, delay_time);
 }
@@ -491,67 +563,73 @@ void EFFECT_FAKE_STEREO::set_parameter(int param, CHAIN_OPERATOR::parameter_t va
     dtime_msec = value;
     dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
     priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-    std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-    while(p != buffer.end()) {
-      if (p->size() > static_cast<size_t>(dtime)) {
-	p->resize(static_cast<size_t>(dtime));
-      }
-      ++p;
-    }
     break;
   }
 }
 
 void EFFECT_FAKE_STEREO::init(SAMPLE_BUFFER* insample)
 {
-  l.init(insample);
-  r.init(insample);
+  sbuf_repp = insample;
 
   EFFECT_BASE::init(insample);
 
-  set_parameter(1, dtime_msec);
   buffer.resize(2);
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
-  }
+  for(size_t i = 0; i < buffer.size(); i++)
+    buffer[i].clear();
+  temp.resize(max_span_length * 2);
+  delay_limited = false;
+
+  set_parameter(1, dtime_msec);
+  priv_reserve_delay_lines(&buffer, dtime, max_span_length, samples_per_second());
 }
 
-void EFFECT_FAKE_STEREO::process(void)
+bool EFFECT_FAKE_STEREO::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
 {
-  l.begin(SAMPLE_SPECS::ch_left);
-  r.begin(SAMPLE_SPECS::ch_right);
-  while(!l.end() && !r.end()) {
-    SAMPLE_SPECS::sample_t temp_left = 0;
-    SAMPLE_SPECS::sample_t temp_right = 0;
-    if (buffer[SAMPLE_SPECS::ch_left].size() >= static_cast<size_t>(dtime)) {
-      temp_left = buffer[SAMPLE_SPECS::ch_left].front();
-      temp_right = buffer[SAMPLE_SPECS::ch_right].front();
-
-      temp_right = (temp_left + temp_right) / 2.0;
-      temp_left = (*l.current() + *r.current()) / 2.0;
+  if (param != 1)
+    return false;
+  return priv_exceeds_capacity(buffer, priv_delay_in_samples(value, samples_per_second()), max_span_length);
+}
 
-      buffer[SAMPLE_SPECS::ch_left].pop_front();
-      buffer[SAMPLE_SPECS::ch_right].pop_front();
-    }
-    else {
-      temp_left = (*l.current() + *r.current()) / 2.0;
-      temp_right = 0.0;
+void EFFECT_FAKE_STEREO::process(void)
+{
+  if (sbuf_repp->number_of_channels() < 2)
+    return;
+
+  long int delay = priv_clamp_delay(buffer, dtime, max_span_length, &delay_limited);
+
+  SAMPLE_SPECS::sample_t* left = sbuf_repp->buffer[SAMPLE_SPECS::ch_left];
+  SAMPLE_SPECS::sample_t* right = sbuf_repp->buffer[SAMPLE_SPECS::ch_right];
+  SAMPLE_SPECS::sample_t* delayed_left = &temp[0];
+  SAMPLE_SPECS::sample_t* delayed_right = &temp[max_span_length];
+
+  long int len = sbuf_repp->length_in_samples();
+  for(long int pos = 0; pos < len;) {
+    long int span = len - pos;
+    if (span > max_span_length) span = max_span_length;
+
+    /* note: samples not yet written read as zero, which
+     *       silences the right channel until the line
+     *       is filled */
+    buffer[SAMPLE_SPECS::ch_left].write_block(left + pos, span);
+    buffer[SAMPLE_SPECS::ch_right].write_block(right + pos, span);
+    buffer[SAMPLE_SPECS::ch_left].read_block(delayed_left, delay + span, span);
+    buffer[SAMPLE_SPECS::ch_right].read_block(delayed_right, delay + span, span);
+
+    for(long int n = 0; n < span; n++) {
+      SAMPLE_SPECS::sample_t temp_left = (left[pos + n] + right[pos + n]) / 2.0;
+      SAMPLE_SPECS::sample_t temp_right = (delayed_left[n] + delayed_right[n]) / 2.0;
+      left[pos + n] = temp_left;
+      right[pos + n] = temp_right;
     }
-    buffer[SAMPLE_SPECS::ch_left].push_back(*l.current());
-    buffer[SAMPLE_SPECS::ch_right].push_back(*r.current());
-
-    *l.current() = temp_left;
-    *r.current() = temp_right;
 
-    l.next();
-    r.next();
+    pos += span;
   }
 }
 
 EFFECT_REVERB::EFFECT_REVERB (CHAIN_OPERATOR::parameter_t delay_time, int surround_mode, 
 			      CHAIN_OPERATOR::parameter_t feedback_percent) 
+  : sbuf_repp(0),
+    delay_limited(false)
 {
   set_parameter(1, delay_time);
   set_parameter(2, surround_mode);
@@ -622,13 +700,6 @@ void EFFECT_REVERB::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
       dtime_msec = value;
       dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
       priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-      std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-        if (p->size() > static_cast<size_t>(dtime)) {
-          p->resize(static_cast<size_t>(dtime));
-        }
-        ++p;
-      }
       break;
     }
 
@@ -644,53 +715,65 @@ void EFFECT_REVERB::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
 
 void EFFECT_REVERB::init(SAMPLE_BUFFER* insample)
 {
-  l.init(insample);
-  r.init(insample);
+  sbuf_repp = insample;
 
   EFFECT_BASE::init(insample);
 
+  buffer.resize(2);
+  for(size_t i = 0; i < buffer.size(); i++)
+    buffer[i].clear();
+  temp.resize(max_span_length * 2);
+  delay_limited = false;
+
   set_parameter(1, dtime_msec);
+  priv_reserve_delay_lines(&buffer, dtime, 0, samples_per_second());
+}
 
-  buffer.resize(2);
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
-  }
+bool EFFECT_REVERB::parameter_needs_init(int param, CHAIN_OPERATOR::parameter_t value) const
+{
+  if (param != 1)
+    return false;
+  return priv_exceeds_capacity(buffer, priv_delay_in_samples(value, samples_per_second()), 0);
 }
 
 void EFFECT_REVERB::process(void)
 {
-  l.begin(SAMPLE_SPECS::ch_left);
-  r.begin(SAMPLE_SPECS::ch_right);
-  while(!l.end() && !r.end()) {
-    SAMPLE_SPECS::sample_t temp_left = 0.0;
-    SAMPLE_SPECS::sample_t temp_right = 0.0;
-    if (buffer[SAMPLE_SPECS::ch_left].size() >= static_cast<size_t>(dtime)) {
-      temp_left = buffer[SAMPLE_SPECS::ch_left].front();
-      temp_right = buffer[SAMPLE_SPECS::ch_right].front();
-      
-      if (surround == 0) {
-	*l.current() = (*l.current() * (1 - feedback)) + (temp_left *  feedback);
-	*r.current() = (*r.current() * (1 - feedback)) + (temp_right * feedback);
-      }
-      else {
-	*l.current() = (*l.current() * (1 - feedback)) + (temp_right *  feedback);
-	*r.current() = (*r.current() * (1 - feedback)) + (temp_left * feedback);
-      }
-      buffer[SAMPLE_SPECS::ch_left].pop_front();
-      buffer[SAMPLE_SPECS::ch_right].pop_front();
+  if (sbuf_repp->number_of_channels() < 2)
+    return;
+
+  long int delay = priv_clamp_delay(buffer, dtime, 0, &delay_limited);
+
+  SAMPLE_SPECS::sample_t* left = sbuf_repp->buffer[SAMPLE_SPECS::ch_left];
+  SAMPLE_SPECS::sample_t* right = sbuf_repp->buffer[SAMPLE_SPECS::ch_right];
+  SAMPLE_SPECS::sample_t* delayed_left = &temp[0];
+  SAMPLE_SPECS::sample_t* delayed_right = &temp[max_span_length];
+
+  long int len = sbuf_repp->length_in_samples();
+  for(long int pos = 0; pos < len;) {
+    /* note: the output is fed back to the lines, so a span
+     *       can be at most 'delay' samples long */
+    long int span = len - pos;
+    if (span > max_span_length) span = max_span_length;
+    if (span > delay) span = delay;
+
+    /* note: samples not yet written read as zero */
+    buffer[SAMPLE_SPECS::ch_left].read_block(delayed_left, delay, span);
+    buffer[SAMPLE_SPECS::ch_right].read_block(delayed_right, delay, span);
+    if (surround != 0) {
+      SAMPLE_SPECS::sample_t* p = delayed_left;
+      delayed_left = delayed_right;
+      delayed_right = p;
     }
-    else {
-	*l.current() = (*l.current() * (1 - feedback));
-	*r.current() = (*r.current() * (1 - feedback));
+
+    for(long int n = 0; n < span; n++) {
+      left[pos + n] = ecaops_flush_to_zero((left[pos + n] * (1 - feedback)) + (delayed_left[n] * feedback));
+      right[pos + n] = ecaops_flush_to_zero((right[pos + n] * (1 - feedback)) + (delayed_right[n] * feedback));
     }
-    *l.current() = ecaops_flush_to_zero(*l.current());
-    *r.current() = ecaops_flush_to_zero(*r.current());
-    buffer[SAMPLE_SPECS::ch_left].push_back(*l.current());
-    buffer[SAMPLE_SPECS::ch_right].push_back(*r.current());
-    l.next();
-    r.next();
+
+    buffer[SAMPLE_SPECS::ch_left].write_block(left + pos, span);
+    buffer[SAMPLE_SPECS::ch_right].write_block(right + pos, span);
+
+    pos += span;
   }
 }
 
@@ -2,15 +2,13 @@
 #define INCLUDED_AUDIOFX_TIMEBASED_H
 
 #include <vector>
-#include <deque>
 #include <string>
 
 #include "audiofx.h"
 #include "audiofx_filter.h"
+#include "delay-line.h"
 #include "osc-sine.h"
 
-typedef std::deque<SAMPLE_SPECS::sample_t> SINGLE_BUFFER;
-
 /**
  * Base class for time-based effects (delays, reverbs, etc).
  */
@@ -28,7 +26,7 @@ class EFFECT_DELAY : public EFFECT_TIME_BASED {
 
  private:
 
-  SAMPLE_ITERATOR_CHANNEL l,r;
+  SAMPLE_BUFFER* sbuf_repp;
 
   parameter_t surround;
   parameter_t dnum;
@@ -37,8 +35,9 @@ class EFFECT_DELAY : public EFFECT_TIME_BASED {
   parameter_t mix;
   parameter_t feedback;
 
-  parameter_t laskuri;
-  std::vector<std::vector<SINGLE_BUFFER> > buffer;
+  std::vector<DELAY_LINE> buffer;
+  std::vector<SAMPLE_SPECS::sample_t> temp;
+  bool delay_limited;
 
  public:
 
@@ -52,6 +51,7 @@ class EFFECT_DELAY : public EFFECT_TIME_BASED {
   virtual void init(SAMPLE_BUFFER* insample);
   virtual void process(void);
   virtual int output_channels(int i_channels) const { return(2); }
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   parameter_t get_delta_in_samples(void) { return(dnum * dtime); }
 
@@ -102,10 +102,12 @@ class EFFECT_MULTITAP_DELAY : public EFFECT_TIME_BASED {
  */
 class EFFECT_FAKE_STEREO : public EFFECT_TIME_BASED {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
-  SAMPLE_ITERATOR_CHANNEL l,r;
+  std::vector<DELAY_LINE> buffer;
+  std::vector<SAMPLE_SPECS::sample_t> temp;
+  SAMPLE_BUFFER* sbuf_repp;
   long int dtime;
   parameter_t dtime_msec;
+  bool delay_limited;
 
  public:
 
@@ -119,6 +121,7 @@ class EFFECT_FAKE_STEREO : public EFFECT_TIME_BASED {
   virtual void init(SAMPLE_BUFFER* insample);
   virtual void process(void);
   virtual int output_channels(int i_channels) const { return(2); }
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   EFFECT_FAKE_STEREO* clone(void) const { return new EFFECT_FAKE_STEREO(*this); }
   EFFECT_FAKE_STEREO* new_expr(void) const { return new EFFECT_FAKE_STEREO(); }
@@ -132,13 +135,15 @@ class EFFECT_REVERB : public EFFECT_TIME_BASED {
 
  private:
     
-  std::vector<std::deque<SAMPLE_SPECS::sample_t>  > buffer;
-  SAMPLE_ITERATOR_CHANNEL l,r;
+  std::vector<DELAY_LINE> buffer;
+  std::vector<SAMPLE_SPECS::sample_t> temp;
+  SAMPLE_BUFFER* sbuf_repp;
 
   parameter_t surround;
   parameter_t feedback;
   long int dtime;
   parameter_t dtime_msec;
+  bool delay_limited;
 
  public:
 
@@ -152,6 +157,7 @@ class EFFECT_REVERB : public EFFECT_TIME_BASED {
   virtual void init(SAMPLE_BUFFER* insample);
   virtual void process(void);
   virtual int output_channels(int i_channels) const { return(2); }
+  virtual bool parameter_needs_init(int param, parameter_t value) const;
 
   parameter_t get_delta_in_samples(void) { return(dtime); }
 
@@ -0,0 +1,246 @@
+// ------------------------------------------------------------------------
+// audiofx_timebased_test.h: Unit test for time-based effects
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "kvu_numtostr.h"
+
+#include "audiofx_timebased.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for EFFECT_DELAY, EFFECT_FAKE_STEREO and
+ * EFFECT_REVERB
+ *
+ * Effects are run over a stereo signal in buffers of
+ * varying size, and the output is compared to a direct
+ * per-sample evaluation of the effect. Sample rate is
+ * set to 1000Hz, so delay times in milliseconds equal
+ * delays in samples.
+ */
+class EFFECT_TIME_BASED_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("EFFECT_TIME_BASED"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~EFFECT_TIME_BASED_TEST(void) { }
+
+private:
+
+  vector<SAMPLE_SPECS::sample_t> in_rep[2];
+
+  void process(EFFECT_BASE* effect, vector<SAMPLE_SPECS::sample_t>* out);
+  void compare(const string& name,
+	       const vector<SAMPLE_SPECS::sample_t>* out,
+	       const vector<SAMPLE_SPECS::sample_t>* expected);
+
+  void test_delay(int dtime, int dnum, int surround);
+  void test_fake_stereo(int dtime);
+  void test_reverb(int dtime, int surround);
+  void test_parameter_needs_init(void);
+};
+
+static const long int effect_time_based_test_frames = 3000;
+static const SAMPLE_SPECS::sample_rate_t effect_time_based_test_srate = 1000;
+
+/**
+ * Runs 'effect' over the test input, in buffers
+ * of varying size.
+ */
+void EFFECT_TIME_BASED_TEST::process(EFFECT_BASE* effect, vector<SAMPLE_SPECS::sample_t>* out)
+{
+  const long int sizes[] = { 300, 1, 64, 257, 1024, 7 };
+  SAMPLE_BUFFER sbuf (1024, 2);
+
+  effect->set_samples_per_second(effect_time_based_test_srate);
+  effect->init(&sbuf);
+
+  for(int c = 0; c < 2; c++)
+    out[c].resize(effect_time_based_test_frames);
+
+  long int pos = 0;
+  for(int n = 0; pos < effect_time_based_test_frames; n++) {
+    long int len = sizes[n % (sizeof(sizes) / sizeof(sizes[0]))];
+    if (pos + len > effect_time_based_test_frames)
+      len = effect_time_based_test_frames - pos;
+    sbuf.length_in_samples(len);
+    for(int c = 0; c < 2; c++) {
+      for(long int i = 0; i < len; i++)
+	sbuf.buffer[c][i] = in_rep[c][pos + i];
+    }
+    effect->process();
+    for(int c = 0; c < 2; c++) {
+      for(long int i = 0; i < len; i++)
+	out[c][pos + i] = sbuf.buffer[c][i];
+    }
+    pos += len;
+  }
+}
+
+void EFFECT_TIME_BASED_TEST::compare(const string& name,
+				     const vector<SAMPLE_SPECS::sample_t>* out,
+				     const vector<SAMPLE_SPECS::sample_t>* expected)
+{
+  for(int c = 0; c < 2; c++) {
+    for(long int i = 0; i < effect_time_based_test_frames; i++) {
+      if (std::fabs(out[c][i] - expected[c][i]) > 1e-5) {
+	ECA_TEST_FAILURE(name + ", channel " + kvu_numtostr(c) +
+			 ", sample " + kvu_numtostr(i));
+	return;
+      }
+    }
+  }
+}
+
+void EFFECT_TIME_BASED_TEST::test_delay(int dtime, int dnum, int surround)
+{
+  const SAMPLE_SPECS::sample_t mix = 0.4, feedback = 0.7;
+  EFFECT_DELAY effect (dtime, surround, dnum, mix * 100.0, feedback * 100.0);
+
+  vector<SAMPLE_SPECS::sample_t> out[2], expected[2];
+  process(&effect, out);
+
+  for(int c = 0; c < 2; c++) {
+    expected[c].resize(effect_time_based_test_frames);
+    for(long int i = 0; i < effect_time_based_test_frames; i++) {
+      double sum = 0.0, fact = 1.0;
+      for(int t = 1; t <= dnum; t++) {
+	fact *= feedback;
+	long int k = i - t * dtime;
+	if (k < 0)
+	  continue;
+	double tap = 0.0;
+	if (surround == 0)
+	  tap = in_rep[c][k];
+	else if (surround == 1)
+	  tap = in_rep[1 - c][k];
+	else if ((t - 1) % 2 == c)
+	  tap = (in_rep[0][k] + in_rep[1][k]) / 2.0;
+	sum += tap * fact / dnum;
+      }
+      expected[c][i] = in_rep[c][i] * (1.0 - mix) + sum * mix;
+    }
+  }
+
+  compare("delay " + kvu_numtostr(dtime) + "," + kvu_numtostr(dnum) +
+	  "," + kvu_numtostr(surround), out, expected);
+}
+
+void EFFECT_TIME_BASED_TEST::test_fake_stereo(int dtime)
+{
+  EFFECT_FAKE_STEREO effect (dtime);
+
+  vector<SAMPLE_SPECS::sample_t> out[2], expected[2];
+  process(&effect, out);
+
+  for(int c = 0; c < 2; c++)
+    expected[c].resize(effect_time_based_test_frames);
+  for(long int i = 0; i < effect_time_based_test_frames; i++) {
+    expected[0][i] = (in_rep[0][i] + in_rep[1][i]) / 2.0;
+    if (i >= dtime)
+      expected[1][i] = (in_rep[0][i - dtime] + in_rep[1][i - dtime]) / 2.0;
+    else
+      expected[1][i] = 0.0;
+  }
+
+  compare("fake stereo " + kvu_numtostr(dtime), out, expected);
+}
+
+void EFFECT_TIME_BASED_TEST::test_reverb(int dtime, int surround)
+{
+  const SAMPLE_SPECS::sample_t feedback = 0.6;
+  EFFECT_REVERB effect (dtime, surround, feedback * 100.0);
+
+  vector<SAMPLE_SPECS::sample_t> out[2], expected[2];
+  process(&effect, out);
+
+  for(int c = 0; c < 2; c++)
+    expected[c].resize(effect_time_based_test_frames);
+  for(long int i = 0; i < effect_time_based_test_frames; i++) {
+    for(int c = 0; c < 2; c++) {
+      double delayed = 0.0;
+      if (i >= dtime)
+	delayed = expected[(surround == 0) ? c : 1 - c][i - dtime];
+      expected[c][i] = in_rep[c][i] * (1.0 - feedback) + delayed * feedback;
+    }
+  }
+
+  compare("reverb " + kvu_numtostr(dtime) + "," + kvu_numtostr(surround),
+	  out, expected);
+}
+
+void EFFECT_TIME_BASED_TEST::test_parameter_needs_init(void)
+{
+  SAMPLE_BUFFER sbuf (64, 2);
+  EFFECT_DELAY effect (100.0, 0, 2);
+  effect.set_samples_per_second(effect_time_based_test_srate);
+
+  /* case: before init(), nothing is reserved */
+  if (effect.parameter_needs_init(1, 10000.0) == true)
+    ECA_TEST_FAILURE("needs init before init()");
+
+  /* case: at least one second of audio is reserved */
+  effect.init(&sbuf);
+  if (effect.parameter_needs_init(1, 400.0) == true)
+    ECA_TEST_FAILURE("needs init, 2x400ms");
+  if (effect.parameter_needs_init(1, 2000.0) != true)
+    ECA_TEST_FAILURE("needs init, 2x2000ms");
+  if (effect.parameter_needs_init(3, 100.0) != true)
+    ECA_TEST_FAILURE("needs init, 100x100ms");
+  if (effect.parameter_needs_init(4, 10.0) == true)
+    ECA_TEST_FAILURE("needs init, mix");
+}
+
+void EFFECT_TIME_BASED_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  std::srand(1);
+  for(int c = 0; c < 2; c++) {
+    in_rep[c].resize(effect_time_based_test_frames);
+    for(long int i = 0; i < effect_time_based_test_frames; i++)
+      in_rep[c][i] = (std::rand() % 2001 - 1000) / 1000.0;
+  }
+
+  /* note: delays shorter and longer than the spans
+   *       used for processing */
+  const int dtimes[] = { 1, 3, 255, 256, 700 };
+  for(size_t n = 0; n < sizeof(dtimes) / sizeof(dtimes[0]); n++) {
+    for(int surround = 0; surround < 3; surround++) {
+      test_delay(dtimes[n], 3, surround);
+    }
+    test_fake_stereo(dtimes[n]);
+    test_reverb(dtimes[n], 0);
+    test_reverb(dtimes[n], 1);
+  }
+
+  test_parameter_needs_init();
+}
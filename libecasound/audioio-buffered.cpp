@@ -22,10 +22,12 @@
 
 #include "eca-logger.h"
 #include "samplebuffer.h"
+#include "samplebuffer_convert.h"
 #include "audioio-buffered.h"
 
 AUDIO_IO_BUFFERED::AUDIO_IO_BUFFERED(void) 
   : buffersize_rep(0),
+    batch_buffers_rep(1),
     iobuf_uchar_repp(0),
     iobuf_size_rep(0)
 {
@@ -57,12 +59,30 @@ void AUDIO_IO_BUFFERED::reserve_buffer_space(long int bytes)
 void AUDIO_IO_BUFFERED::set_buffersize(long int samples)
 {
   if (buffersize_rep != samples ||
-      static_cast<long int>(iobuf_size_rep) < buffersize_rep * frame_size()) {
+      static_cast<long int>(iobuf_size_rep) < buffersize_rep * frame_size() * batch_buffers_rep) {
     buffersize_rep = samples;
-    reserve_buffer_space(buffersize_rep * frame_size());
+    reserve_buffer_space(buffersize_rep * frame_size() * batch_buffers_rep);
   }
 }
 
+/**
+ * Sets the maximum number of buffers transferred with
+ * one read_buffers() or write_buffers() call, and
+ * allocates raw I/O space for them. Must not be called
+ * while I/O is running.
+ *
+ * @pre count > 0
+ */
+void AUDIO_IO_BUFFERED::set_batch_buffers(int count)
+{
+  // --------
+  DBC_REQUIRE(count > 0);
+  // --------
+
+  batch_buffers_rep = count;
+  reserve_buffer_space(buffersize_rep * frame_size() * batch_buffers_rep);
+}
+
 void AUDIO_IO_BUFFERED::read_buffer(SAMPLE_BUFFER* sbuf)
 {
   // --------
@@ -70,22 +90,46 @@ void AUDIO_IO_BUFFERED::read_buffer(SAMPLE_BUFFER* sbuf)
   DBC_REQUIRE(static_cast<long int>(iobuf_size_rep) >= buffersize_rep * frame_size());
   // --------
 
-  if (interleaved_channels() == true) {
-    sbuf->import_interleaved(iobuf_uchar_repp,
-			     read_samples(iobuf_uchar_repp, buffersize_rep),
+  /* note: if supported, convert directly from the source 
+   *       object's storage, saving one copy */
+  unsigned char* source = iobuf_uchar_repp;
+  long int frames = read_samples_in_place(&source, buffersize_rep);
+  bool direct = false;
+  if (frames < 0 || source == 0) {
+    direct = is_direct_channel_format(sample_format(), sample_coding());
+    if (direct == true) {
+      /* note: raw data is already in the internal format, so 
+       *       read directly to channel memory, skipping iobuf */
+      sbuf->number_of_channels(1);
+      sbuf->length_in_samples(buffersize_rep);
+      frames = read_samples(sbuf->buffer[0], buffersize_rep);
+      sbuf->length_in_samples(frames < 0 ? 0 : frames);
+    }
+    else {
+      source = iobuf_uchar_repp;
+      frames = read_samples(iobuf_uchar_repp, buffersize_rep);
+    }
+  }
+
+  if (direct == true) {
+    /* no-op, data already in 'sbuf' */
+  }
+  else if (interleaved_channels() == true) {
+    sbuf->import_interleaved(source,
+			     frames,
 			     sample_format(),
 			     channels());
   }
   else {
-    sbuf->import_noninterleaved(iobuf_uchar_repp,
-				read_samples(iobuf_uchar_repp, buffersize_rep),
+    sbuf->import_noninterleaved(source,
+				frames,
 				sample_format(),
 				channels());
   }
 
   if (sbuf->length_in_samples() < buffersize_rep) {
-    ECA_LOG_MSG(ECA_LOGGER::user_objects, "end-of-stream tag detected for '"
-		+ description() + "'");
+    ECA_LOG_MSG_RT(ECA_LOGGER::user_objects, "end-of-stream tag detected for '%s'",
+		   label().c_str());
     sbuf->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream);
   }
 
@@ -105,6 +149,16 @@ void AUDIO_IO_BUFFERED::write_buffer(SAMPLE_BUFFER* sbuf)
 
   set_buffersize(sbuf->length_in_samples());
 
+  if (sbuf->number_of_channels() > 0 &&
+      is_direct_channel_format(sample_format(), sample_coding()) == true) {
+    /* note: no conversion or clipping needed, write 
+     *       directly from channel memory */
+    write_samples(sbuf->buffer[0], sbuf->length_in_samples());
+    change_position_in_samples(sbuf->length_in_samples());
+    extend_position();
+    return;
+  }
+
   if (interleaved_channels() == true) {
     sbuf->export_interleaved(iobuf_uchar_repp,
 			     sample_format(),
@@ -123,6 +177,121 @@ void AUDIO_IO_BUFFERED::write_buffer(SAMPLE_BUFFER* sbuf)
   extend_position();
 }
 
+/**
+ * Reads up to batch_buffers() buffers worth of data with
+ * a single read_samples() call, and splits the result
+ * into the sample buffers.
+ */
+int AUDIO_IO_BUFFERED::read_buffers(SAMPLE_BUFFER** sbufs, int count)
+{
+  if (count > batch_buffers_rep) count = batch_buffers_rep;
+
+  /* note: noninterleaved data cannot be split without
+   *       an extra copy, and data in the direct channel
+   *       format is read without any copies by read_buffer() */
+  if (count < 2 || interleaved_channels() != true ||
+      is_direct_channel_format(sample_format(), sample_coding()) == true)
+    return AUDIO_IO::read_buffers(sbufs, count);
+
+  long int frames_total = buffersize_rep * count;
+
+  // --------
+  DBC_CHECK(static_cast<long int>(iobuf_size_rep) >= frames_total * frame_size());
+  // --------
+
+  unsigned char* source = iobuf_uchar_repp;
+  long int frames = read_samples_in_place(&source, frames_total);
+  if (frames < 0 || source == 0) {
+    source = iobuf_uchar_repp;
+    frames = read_samples(iobuf_uchar_repp, frames_total);
+  }
+
+  int n = 0;
+  long int offset = 0;
+  while(n < count) {
+    long int len = frames - offset;
+    if (len > buffersize_rep) len = buffersize_rep;
+    if (len < 0) len = 0;
+
+    sbufs[n]->import_interleaved(source + offset * frame_size(),
+				 len,
+				 sample_format(),
+				 channels());
+    change_position_in_samples(len);
+    offset += len;
+    ++n;
+
+    if (len < buffersize_rep) {
+      ECA_LOG_MSG_RT(ECA_LOGGER::user_objects, "end-of-stream tag detected for '%s'",
+		     label().c_str());
+      sbufs[n - 1]->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream);
+      break;
+    }
+  }
+
+  return n;
+}
+
+/**
+ * Writes data from 'count' sample buffers with one
+ * write_samples() call per batch_buffers() buffers.
+ */
+void AUDIO_IO_BUFFERED::write_buffers(SAMPLE_BUFFER** sbufs, int count)
+{
+  if (batch_buffers_rep < 2 || interleaved_channels() != true ||
+      is_direct_channel_format(sample_format(), sample_coding()) == true) {
+    AUDIO_IO::write_buffers(sbufs, count);
+    return;
+  }
+
+  while(count > 0) {
+    int batch = (count < batch_buffers_rep) ? count : batch_buffers_rep;
+
+    long int frames_total = 0;
+    for(int n = 0; n < batch; n++)
+      frames_total += sbufs[n]->length_in_samples();
+
+    /* note: buffers longer than buffersize() do not fit
+     *       to the preallocated space */
+    if (batch < 2 ||
+	frames_total * frame_size() > static_cast<long int>(iobuf_size_rep)) {
+      AUDIO_IO::write_buffers(sbufs, batch);
+    }
+    else {
+      long int offset = 0;
+      for(int n = 0; n < batch; n++) {
+	sbufs[n]->export_interleaved(iobuf_uchar_repp + offset * frame_size(),
+				     sample_format(),
+				     sample_coding(),
+				     channels());
+	offset += sbufs[n]->length_in_samples();
+      }
+
+      write_samples(iobuf_uchar_repp, frames_total);
+      change_position_in_samples(frames_total);
+      extend_position();
+    }
+
+    if (finished() == true) break;
+    sbufs += batch;
+    count -= batch;
+  }
+}
+
+/**
+ * Whether raw data of format 'fmt' and coding 'coding'
+ * can be transferred directly to and from the channel 
+ * memory of a sample buffer. This is the case for single 
+ * channel data that is already in the internal sample 
+ * format (native endian 32bit floats).
+ */
+bool AUDIO_IO_BUFFERED::is_direct_channel_format(Sample_format fmt, Sample_coding coding) const
+{
+  return (channels() == 1 &&
+	  coding == ECA_AUDIO_FORMAT::sc_float &&
+	  SAMPLE_BUFFER_CONVERT::is_native_format(fmt) == true);
+}
+
 void AUDIO_IO_BUFFERED::set_channels(SAMPLE_SPECS::channel_t v)
 {
   AUDIO_IO::set_channels(v);
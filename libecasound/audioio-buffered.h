@@ -18,10 +18,15 @@ class AUDIO_IO_BUFFERED : public AUDIO_IO {
 
   virtual void read_buffer(SAMPLE_BUFFER* sbuf);
   virtual void write_buffer(SAMPLE_BUFFER* sbuf);
+  virtual int read_buffers(SAMPLE_BUFFER** sbufs, int count);
+  virtual void write_buffers(SAMPLE_BUFFER** sbufs, int count);
 
   virtual void set_buffersize(long int samples);
   virtual long int buffersize(void) const { return(buffersize_rep); }
 
+  void set_batch_buffers(int count);
+  int batch_buffers(void) const { return(batch_buffers_rep); }
+
   /**
    * Low-level routine for reading samples. Number of read sample
    * frames is returned. This must be implemented by all subclasses.
@@ -34,6 +39,18 @@ class AUDIO_IO_BUFFERED : public AUDIO_IO {
    */
   virtual void write_samples(void* target_buffer, long int sample_frames) = 0;
 
+  /**
+   * Low-level routine for reading samples without copying. 
+   * If supported, '*source' is set to point to raw data of 
+   * the next 'sample_frames' sample frames, and the number of 
+   * frames available there is returned. The data must stay 
+   * valid until the next call to any I/O routine.
+   *
+   * Returns -1 if not supported, in which case read_samples() 
+   * is used instead.
+   */
+  virtual long int read_samples_in_place(unsigned char** source, long int sample_frames) { return -1; }
+
   /** @name Reimplemented functions from ECA_AUDIO_FORMAT */
   /*@{*/
 
@@ -45,12 +62,14 @@ class AUDIO_IO_BUFFERED : public AUDIO_IO {
  protected:
 
   void reserve_buffer_space(long int bytes);
+  bool is_direct_channel_format(Sample_format fmt, Sample_coding coding) const;
   unsigned char* get_iobuf(void) const { return(iobuf_uchar_repp); }
   size_t get_iobuf_size(void) const { return(iobuf_size_rep); }
 
  private:
 
   long int buffersize_rep;
+  int batch_buffers_rep;
   unsigned char* iobuf_uchar_repp;  // buffer for raw-I/O
   size_t iobuf_size_rep;
 };
@@ -0,0 +1,606 @@
+// ------------------------------------------------------------------------
+// audioio-cache.cpp: A proxy class that caches the child object's
+//                    decoded data on disk.
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib> /* realpath() */
+#include <cstring>
+#include <vector>
+
+#include <errno.h>
+#include <limits.h> /* PATH_MAX */
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "audioio-cache.h"
+#include "eca-fileio-mmap.h"
+#include "eca-logger.h"
+#include "eca-object-factory.h"
+#include "samplebuffer.h"
+
+/**
+ * Layout of the cache files:
+ *
+ *    - header (struct eca_audio_cache_header)
+ *    - cache key, 'key_length' bytes (see cache_key())
+ *    - zero padding up to 'data_offset'
+ *    - 'frames' frames of interleaved sample data
+ *
+ * The key is stored to the file, so that hash
+ * collisions are detected when the file is mapped.
+ */
+struct eca_audio_cache_header {
+  char magic[16];
+  uint32_t sample_size;
+  uint32_t channels;
+  uint32_t srate;
+  uint32_t key_length;
+  int64_t frames;
+  int64_t data_offset;
+};
+
+static const char eca_audio_cache_magic[16] = "ecasound-cache1";
+
+/* note: samples are stored as native-endian floats,
+ *       matching SAMPLE_SPECS::sample_t */
+#ifdef WORDS_BIGENDIAN
+static const ECA_AUDIO_FORMAT::Sample_format eca_audio_cache_format = ECA_AUDIO_FORMAT::sfmt_f32_be;
+#else
+static const ECA_AUDIO_FORMAT::Sample_format eca_audio_cache_format = ECA_AUDIO_FORMAT::sfmt_f32_le;
+#endif
+
+static std::string eca_audio_cache_hash(const std::string& key);
+static int eca_audio_cache_make_directory(const std::string& dir);
+
+std::string AUDIO_IO_CACHE::cache_directory_rep;
+
+/**
+ * Sets the directory where cache files are stored.
+ * If empty, caching is disabled.
+ */
+void AUDIO_IO_CACHE::set_cache_directory(const std::string& value)
+{
+  AUDIO_IO_CACHE::cache_directory_rep = value;
+}
+
+/**
+ * Constructor.
+ */
+AUDIO_IO_CACHE::AUDIO_IO_CACHE (void)
+  : init_rep(false),
+    finished_rep(false),
+    file_repp(0),
+    frames_rep(0),
+    data_offset_rep(0)
+{
+}
+
+/**
+ * Destructor.
+ */
+AUDIO_IO_CACHE::~AUDIO_IO_CACHE (void)
+{
+  if (file_repp != 0) {
+    file_repp->close_file();
+    delete file_repp;
+  }
+}
+
+AUDIO_IO_CACHE* AUDIO_IO_CACHE::clone(void) const
+{
+  AUDIO_IO_CACHE* target = new AUDIO_IO_CACHE();
+  for(int n = 0; n < number_of_params(); n++) {
+    target->set_parameter(n + 1, get_parameter(n + 1));
+  }
+  return target;
+}
+
+void AUDIO_IO_CACHE::open(void) throw(AUDIO_IO::SETUP_ERROR&)
+{
+  ECA_LOG_MSG(ECA_LOGGER::user_objects, "open " + label() + ".");
+
+  if (io_mode() != AUDIO_IO::io_read) {
+      throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-CACHE: Caching of output objects not supported!"));
+  }
+
+  const string& objname =
+    child_params_as_string(1 + AUDIO_IO_CACHE::child_parameter_offset, &params_rep);
+
+  if (init_rep != true) {
+    AUDIO_IO* tmp = 0;
+
+    if (objname.size() > 0)
+      tmp = ECA_OBJECT_FACTORY::create_audio_object(objname);
+
+    if (tmp == 0)
+      throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-CACHE: unable to open child object '" + objname + "'"));
+
+    set_child(tmp);
+
+    int numparams = child()->number_of_params();
+    for(int n = 0; n < numparams; n++) {
+      child()->set_parameter(n + 1, get_parameter(n + 1 + AUDIO_IO_CACHE::child_parameter_offset));
+      if (child()->variable_params())
+	numparams = child()->number_of_params();
+    }
+
+    init_rep = true; /* must be set after dyn. parameters */
+  }
+
+  finished_rep = false;
+
+  /* note: child is opened also when cache file exists, as
+   *       the key depends on the child's audio format; opening
+   *       a file does not yet start decoding */
+  open_child();
+
+  if (child()->finite_length_stream() != true) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Unable to cache an infinite length audio object " +
+		objname + ".");
+  }
+  else if (cache_directory_rep.size() == 0) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"cache directory not set, reading " + objname + " directly.");
+  }
+  else {
+    const std::string key = cache_key(objname);
+    cache_file_rep = cache_directory_rep + "/" + eca_audio_cache_hash(key) + ".cache";
+
+    if (map_cache_file(key) != true) {
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "Decoding " + objname + " to cache file " + cache_file_rep + ".");
+      if (write_cache_file(key) == true) {
+	map_cache_file(key);
+      }
+      else {
+	ECA_LOG_MSG(ECA_LOGGER::info,
+		    "WARNING: Unable to write cache file " + cache_file_rep +
+		    ", reading " + objname + " directly.");
+      }
+      if (file_repp == 0) {
+	/* note: restart the child from the beginning */
+	child()->close();
+	open_child();
+      }
+    }
+
+    if (file_repp != 0) {
+      child()->close();
+
+      /* note: sample format is left as is, so that the
+       *       child gets the same format when reopened */
+      set_channels(child()->channels());
+      set_samples_per_second(child()->samples_per_second());
+      set_length_in_samples(frames_rep);
+    }
+  }
+
+  set_label("cache:" + objname);
+
+  AUDIO_IO::open();
+}
+
+void AUDIO_IO_CACHE::close(void)
+{
+  if (file_repp != 0) {
+    file_repp->close_file();
+    delete file_repp;
+    file_repp = 0;
+  }
+
+  if (child()->is_open() == true) child()->close();
+
+  AUDIO_IO::close();
+}
+
+/**
+ * Opens the child object with the current audio
+ * parameters.
+ */
+void AUDIO_IO_CACHE::open_child(void)
+{
+  pre_child_open();
+  child()->open();
+  post_child_open();
+}
+
+/**
+ * Returns a string that uniquely identifies the
+ * decoded data of the child object.
+ *
+ * require:
+ *  child()->is_open() == true
+ */
+std::string AUDIO_IO_CACHE::cache_key(const std::string& objname) const
+{
+  DBC_REQUIRE(child()->is_open() == true);
+
+  std::string key =
+    "object=" + objname + "\n" +
+    "format=" + child()->format_string() + "," +
+    kvu_numtostr(child()->channels()) + "," +
+    kvu_numtostr(child()->samples_per_second()) + "\n" +
+    "sample=" + kvu_numtostr(static_cast<int>(sizeof(SAMPLE_SPECS::sample_t))) + "\n";
+
+  /* note: any parameter naming a regular file is assumed to
+   *       be a source of audio data */
+  for(size_t n = AUDIO_IO_CACHE::child_parameter_offset; n < params_rep.size(); n++) {
+    struct stat buf;
+    if (::stat(params_rep[n].c_str(), &buf) == 0 &&
+	S_ISREG(buf.st_mode)) {
+      char path[PATH_MAX];
+      std::string fname = params_rep[n];
+      if (::realpath(fname.c_str(), path) != 0)
+	fname = path;
+      key += "file=" + fname + "," +
+	kvu_numtostr(static_cast<long long int>(buf.st_mtime)) + "," +
+	kvu_numtostr(static_cast<long long int>(buf.st_size)) + "\n";
+    }
+  }
+
+  return key;
+}
+
+/**
+ * Maps 'cache_file_rep' to memory if it exists and
+ * matches 'key'.
+ *
+ * @return true if file was mapped
+ */
+bool AUDIO_IO_CACHE::map_cache_file(const std::string& key)
+{
+  DBC_REQUIRE(file_repp == 0);
+
+  ECA_FILE_IO_MMAP* file = new ECA_FILE_IO_MMAP();
+  file->open_file(cache_file_rep, "rb");
+  if (file->is_file_ready() != true) {
+    delete file;
+    return false;
+  }
+
+  struct eca_audio_cache_header header;
+  file->read_to_buffer(&header, sizeof(header));
+
+  bool valid =
+    file->file_bytes_processed() == static_cast<off_t>(sizeof(header)) &&
+    std::memcmp(header.magic, eca_audio_cache_magic, sizeof(header.magic)) == 0 &&
+    header.sample_size == sizeof(SAMPLE_SPECS::sample_t) &&
+    header.channels == static_cast<uint32_t>(child()->channels()) &&
+    header.key_length == key.size() &&
+    header.frames >= 0 &&
+    header.data_offset >= static_cast<int64_t>(sizeof(header) + key.size()) &&
+    file->get_file_length() ==
+    header.data_offset + header.frames * header.channels * header.sample_size;
+
+  if (valid == true) {
+    const unsigned char* stored = file->read_in_place(key.size());
+    valid = (file->file_bytes_processed() == static_cast<off_t>(key.size()) &&
+	     std::memcmp(stored, key.data(), key.size()) == 0);
+  }
+
+  if (valid != true) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Ignoring invalid or stale cache file " + cache_file_rep + ".");
+    file->close_file();
+    delete file;
+    return false;
+  }
+
+  file_repp = file;
+  frames_rep = header.frames;
+  data_offset_rep = header.data_offset;
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "using cache file " + cache_file_rep + ", " +
+	      kvu_numtostr(frames_rep) + " frames.");
+
+  return true;
+}
+
+/**
+ * Reads the child object to the end and writes its
+ * data to 'cache_file_rep'. The file is first written
+ * under a temporary name, so other processes never
+ * see partially written cache files.
+ *
+ * @return true if file was written
+ */
+bool AUDIO_IO_CACHE::write_cache_file(const std::string& key)
+{
+  int err = eca_audio_cache_make_directory(cache_directory_rep);
+  if (err != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"ERROR: Unable to create cache directory " + cache_directory_rep +
+		": " + std::strerror(err) + ".");
+    return false;
+  }
+
+  std::string tmpname = cache_file_rep + ".XXXXXX";
+  std::vector<char> tmpname_buf (tmpname.begin(), tmpname.end());
+  tmpname_buf.push_back(0);
+  int fd = ::mkstemp(&tmpname_buf[0]);
+  if (fd < 0) {
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"ERROR: Unable to create cache file in " + cache_directory_rep +
+		": " + std::strerror(errno) + ".");
+    return false;
+  }
+  tmpname = &tmpname_buf[0];
+  ::fchmod(fd, 0644);
+
+  std::FILE* f = ::fdopen(fd, "wb");
+  if (f == 0) {
+    ::close(fd);
+    ::unlink(tmpname.c_str());
+    return false;
+  }
+
+  const int ch = channels();
+  const size_t frame_bytes = ch * sizeof(SAMPLE_SPECS::sample_t);
+
+  struct eca_audio_cache_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, eca_audio_cache_magic, sizeof(header.magic));
+  header.sample_size = sizeof(SAMPLE_SPECS::sample_t);
+  header.channels = ch;
+  header.srate = samples_per_second();
+  header.key_length = key.size();
+  header.frames = 0;
+  /* note: sample data is aligned to a cache line */
+  header.data_offset = ((sizeof(header) + key.size() + 63) / 64) * 64;
+
+  std::vector<char> padding (header.data_offset - sizeof(header) - key.size(), 0);
+  std::fwrite(&header, sizeof(header), 1, f);
+  std::fwrite(key.data(), 1, key.size(), f);
+  if (padding.size() > 0)
+    std::fwrite(&padding[0], 1, padding.size(), f);
+
+  long int bsize = buffersize() > 0 ? buffersize() : 1024;
+  SAMPLE_BUFFER sbuf (bsize, ch);
+  std::vector<unsigned char> data;
+  int empty_reads = 0;
+
+  while(child()->finished() != true && std::ferror(f) == 0) {
+    child()->read_buffer(&sbuf);
+    long int count = sbuf.length_in_samples();
+    if (count == 0) {
+      /* note: guard against children that never finish */
+      if (++empty_reads > 16) break;
+      continue;
+    }
+    empty_reads = 0;
+
+    sbuf.number_of_channels(ch);
+    data.resize(count * frame_bytes);
+    sbuf.export_interleaved(&data[0], eca_audio_cache_format, ECA_AUDIO_FORMAT::sc_float, ch);
+    std::fwrite(&data[0], 1, data.size(), f);
+    header.frames += count;
+  }
+
+  std::fseek(f, 0, SEEK_SET);
+  std::fwrite(&header, sizeof(header), 1, f);
+
+  bool ok = (std::fflush(f) == 0 && std::ferror(f) == 0);
+  if (std::fclose(f) != 0) ok = false;
+
+  if (ok == true && ::rename(tmpname.c_str(), cache_file_rep.c_str()) == 0) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"wrote cache file " + cache_file_rep + ", " +
+		kvu_numtostr(static_cast<long long int>(header.frames)) + " frames.");
+    return true;
+  }
+
+  ::unlink(tmpname.c_str());
+  return false;
+}
+
+bool AUDIO_IO_CACHE::finished(void) const
+{
+  if (file_repp == 0)
+    return child()->finished();
+
+  return finished_rep;
+}
+
+bool AUDIO_IO_CACHE::supports_seeking(void) const
+{
+  if (file_repp == 0)
+    return child()->supports_seeking();
+
+  return true;
+}
+
+bool AUDIO_IO_CACHE::supports_seeking_sample_accurate(void) const
+{
+  if (file_repp == 0)
+    return child()->supports_seeking_sample_accurate();
+
+  return true;
+}
+
+string AUDIO_IO_CACHE::parameter_names(void) const
+{
+  return string("cache,") + child()->parameter_names();
+}
+
+void AUDIO_IO_CACHE::set_parameter(int param, string value)
+{
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"set_parameter " + label() + ".");
+
+  /* total of n+1 params, where n is number of childobj params */
+  if (param > static_cast<int>(params_rep.size())) params_rep.resize(param);
+
+  if (param > 0) {
+    params_rep[param - 1] = value;
+  }
+
+  if (param > AUDIO_IO_CACHE::child_parameter_offset && init_rep == true) {
+    child()->set_parameter(param - AUDIO_IO_CACHE::child_parameter_offset, value);
+  }
+}
+
+string AUDIO_IO_CACHE::get_parameter(int param) const
+{
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"get_parameter " + label() + ".");
+
+  if (param > 0 && param < static_cast<int>(params_rep.size()) + 1) {
+    if (param > AUDIO_IO_CACHE::child_parameter_offset
+	&& init_rep == true) {
+      params_rep[param - 1] =
+	child()->get_parameter(param - AUDIO_IO_CACHE::child_parameter_offset);
+    }
+    return params_rep[param - 1];
+  }
+
+  return "";
+}
+
+SAMPLE_SPECS::sample_pos_t AUDIO_IO_CACHE::seek_position(SAMPLE_SPECS::sample_pos_t pos)
+{
+  if (file_repp == 0) {
+    /* note: the child keeps track of its own position
+     *       (see AUDIO_IO_DB_CLIENT::seek_position()) */
+    child()->seek_position_in_samples(pos);
+    return child()->position_in_samples();
+  }
+
+  if (pos > frames_rep) pos = frames_rep;
+  if (pos < 0) pos = 0;
+  finished_rep = (pos >= frames_rep);
+
+  /* note: reads are served directly from the mapping,
+   *       this only triggers readahead */
+  file_repp->set_file_position(data_offset_rep + pos * channels() * sizeof(SAMPLE_SPECS::sample_t), true);
+
+  return pos;
+}
+
+void AUDIO_IO_CACHE::read_buffer(SAMPLE_BUFFER* sbuf)
+{
+  if (file_repp == 0) {
+    child()->read_buffer(sbuf);
+    set_position_in_samples(child()->position_in_samples());
+    return;
+  }
+
+  const size_t frame_bytes = channels() * sizeof(SAMPLE_SPECS::sample_t);
+  SAMPLE_SPECS::sample_pos_t pos = position_in_samples();
+  SAMPLE_SPECS::sample_pos_t count = buffersize();
+  if (pos + count > frames_rep)
+    count = frames_rep - pos;
+  if (count < 0)
+    count = 0;
+
+  if (count > 0) {
+    file_repp->set_file_position(data_offset_rep + pos * frame_bytes, false);
+    const unsigned char* data = file_repp->read_in_place(count * frame_bytes);
+    DBC_CHECK(file_repp->file_bytes_processed() == static_cast<off_t>(count * frame_bytes));
+    sbuf->import_interleaved(const_cast<unsigned char*>(data),
+			     count,
+			     eca_audio_cache_format,
+			     channels());
+  }
+  else {
+    sbuf->number_of_channels(channels());
+    sbuf->length_in_samples(0);
+  }
+
+  if (count < buffersize()) {
+    sbuf->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream);
+    finished_rep = true;
+  }
+
+  change_position_in_samples(count);
+
+  DBC_ENSURE(sbuf->number_of_channels() == channels());
+}
+
+void AUDIO_IO_CACHE::start_io(void)
+{
+  /* note: child is closed when served from the cache */
+  if (file_repp == 0)
+    AUDIO_IO_PROXY::start_io();
+}
+
+void AUDIO_IO_CACHE::stop_io(void)
+{
+  if (file_repp == 0)
+    AUDIO_IO_PROXY::stop_io();
+}
+
+/**
+ * Returns a 128bit FNV-1a hash of 'key' as
+ * a hex string.
+ */
+static std::string eca_audio_cache_hash(const std::string& key)
+{
+  uint64_t h1 = 14695981039346656037ULL;
+  uint64_t h2 = 14695981039346656037ULL ^ 0x5bd1e9955bd1e995ULL;
+  for(size_t n = 0; n < key.size(); n++) {
+    h1 = (h1 ^ static_cast<unsigned char>(key[n])) * 1099511628211ULL;
+    h2 = (h2 ^ static_cast<unsigned char>(key[key.size() - n - 1])) * 1099511628211ULL;
+  }
+
+  char buf[33];
+  std::snprintf(buf, sizeof(buf), "%016llx%016llx",
+		static_cast<unsigned long long>(h1),
+		static_cast<unsigned long long>(h2));
+  return buf;
+}
+
+/**
+ * Creates directory 'dir' and any missing parent
+ * directories.
+ *
+ * @return 0 on success, otherwise an errno value
+ */
+static int eca_audio_cache_make_directory(const std::string& dir)
+{
+  std::string::size_type pos = 0;
+  while(pos != std::string::npos) {
+    pos = dir.find('/', pos + 1);
+    std::string path = dir.substr(0, pos);
+    if (path.size() == 0) continue;
+
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+      return errno;
+  }
+
+  struct stat st;
+  if (::stat(dir.c_str(), &st) != 0)
+    return errno;
+  if (S_ISDIR(st.st_mode) == 0)
+    return ENOTDIR;
+
+  return 0;
+}
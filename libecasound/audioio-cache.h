@@ -0,0 +1,133 @@
+#ifndef INCLUDED_AUDIOIO_CACHE_H
+#define INCLUDED_AUDIOIO_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "audioio-proxy.h"
+
+class ECA_FILE_IO_MMAP;
+class SAMPLE_BUFFER;
+
+/**
+ * A proxy class that stores the decoded audio data
+ * of its child object to a persistent on-disk cache.
+ *
+ * When opened for the first time, the child object is
+ * read to the end and its data is written to a cache
+ * file as interleaved native-endian samples of type
+ * SAMPLE_SPECS::sample_t. The cache file is named after
+ * a hash of the child object parameters, the child's
+ * audio format and the path, modification time and
+ * size of every file given as a parameter. Later opens
+ * of the same source are served from the cache file
+ * using mmap, and support fast sample accurate seeking.
+ *
+ * If the cache directory is not set or not writable, or
+ * the child is an infinite stream, data is read directly
+ * from the child object.
+ *
+ * Related design patterns:
+ *     - Proxy (GoF207
+ *
+ * @author Kai Vehmanen
+ */
+class AUDIO_IO_CACHE : public AUDIO_IO_PROXY {
+
+ public:
+
+  /** @name Public functions */
+  /*@{*/
+
+  AUDIO_IO_CACHE (void);
+  virtual ~AUDIO_IO_CACHE(void);
+
+  static void set_cache_directory(const std::string& value);
+  static const std::string& cache_directory(void) { return cache_directory_rep; }
+
+  bool is_cached(void) const { return file_repp != 0; }
+  const std::string& cache_file_name(void) const { return cache_file_rep; }
+
+  /*@}*/
+
+  /** @name Reimplemented functions from ECA_OBJECT */
+  /*@{*/
+
+  virtual std::string name(void) const { return(string("Cache => ") + child()->name()); }
+
+  /*@}*/
+
+  /** @name Reimplemented functions from DYNAMIC_PARAMETERS<string> */
+  /*@{*/
+
+  virtual std::string parameter_names(void) const;
+  virtual void set_parameter(int param, std::string value);
+  virtual std::string get_parameter(int param) const;
+
+  /*@}*/
+
+  /** @name Reimplemented functions from DYNAMIC_OBJECT<string> */
+  /*@{*/
+
+  virtual AUDIO_IO_CACHE* clone(void) const;
+  virtual AUDIO_IO_CACHE* new_expr(void) const { return(new AUDIO_IO_CACHE()); }
+
+  /*@}*/
+
+  /** @name Reimplemented functions from ECA_AUDIO_POSITION */
+  /*@{*/
+
+  virtual SAMPLE_SPECS::sample_pos_t seek_position(SAMPLE_SPECS::sample_pos_t pos);
+  virtual bool supports_seeking(void) const;
+  virtual bool supports_seeking_sample_accurate(void) const;
+
+  /*@}*/
+
+  /** @name Reimplemented functions from AUDIO_IO */
+  /*@{*/
+
+  virtual int supported_io_modes(void) const { return(io_read); }
+
+  virtual void read_buffer(SAMPLE_BUFFER* sbuf);
+  virtual void write_buffer(SAMPLE_BUFFER* sbuf) { child()->write_buffer(sbuf); }
+
+  virtual void open(void) throw(AUDIO_IO::SETUP_ERROR&);
+  virtual void close(void);
+
+  virtual bool finished(void) const;
+
+  /*@}*/
+
+  /** @name Reimplemented functions from AUDIO_IO_BARRIER */
+  /*@{*/
+
+  virtual void start_io(void);
+  virtual void stop_io(void);
+
+  /*@}*/
+
+ private:
+
+  static std::string cache_directory_rep;
+
+  mutable std::vector<std::string> params_rep;
+  bool init_rep;
+  bool finished_rep;
+  ECA_FILE_IO_MMAP* file_repp;
+  std::string cache_file_rep;
+  SAMPLE_SPECS::sample_pos_t frames_rep;
+  off_t data_offset_rep;
+
+  static const int child_parameter_offset = 1;
+
+  std::string cache_key(const std::string& objname) const;
+  bool map_cache_file(const std::string& key);
+  bool write_cache_file(const std::string& key);
+  void open_child(void);
+
+  AUDIO_IO_CACHE& operator=(const AUDIO_IO_CACHE& x) { return *this; }
+  AUDIO_IO_CACHE (const AUDIO_IO_CACHE& x) { }
+
+};
+
+#endif
@@ -0,0 +1,266 @@
+// ------------------------------------------------------------------------
+// audioio-cache_test.h: Unit test for AUDIO_IO_CACHE
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "kvu_numtostr.h"
+
+#include "audioio-cache.h"
+#include "eca-object-factory.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for AUDIO_IO_CACHE
+ */
+class AUDIO_IO_CACHE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("AUDIO_IO_CACHE"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~AUDIO_IO_CACHE_TEST(void) { }
+
+private:
+
+  AUDIO_IO* open_object(const string& arg);
+  vector<SAMPLE_SPECS::sample_t> read_all(AUDIO_IO* obj);
+  void write_source(const string& fname, int frames);
+  vector<SAMPLE_SPECS::sample_t> read_from(const string& arg, SAMPLE_SPECS::sample_pos_t pos,
+					   SAMPLE_SPECS::sample_pos_t* length, string* cachefile);
+  void test_reverse_seek(const string& source, const string& cachedir);
+
+};
+
+AUDIO_IO* AUDIO_IO_CACHE_TEST::open_object(const string& arg)
+{
+  AUDIO_IO* obj = ECA_OBJECT_FACTORY::create_audio_object(arg);
+  if (obj == 0) {
+    ECA_TEST_FAILURE("create " + arg);
+    return 0;
+  }
+  obj->set_io_mode(AUDIO_IO::io_read);
+  obj->set_audio_format(ECA_AUDIO_FORMAT(2, 44100, ECA_AUDIO_FORMAT::sfmt_s16_le, true));
+  obj->set_buffersize(256);
+  obj->open();
+  return obj;
+}
+
+/**
+ * Reads 'obj' to the end and returns the
+ * interleaved samples.
+ */
+vector<SAMPLE_SPECS::sample_t> AUDIO_IO_CACHE_TEST::read_all(AUDIO_IO* obj)
+{
+  vector<SAMPLE_SPECS::sample_t> res;
+  SAMPLE_BUFFER sbuf (256, 2);
+  while(obj->finished() != true) {
+    obj->read_buffer(&sbuf);
+    for(long int i = 0; i < sbuf.length_in_samples(); i++) {
+      for(int c = 0; c < sbuf.number_of_channels(); c++) {
+	res.push_back(sbuf.buffer[c][i]);
+      }
+    }
+    if (sbuf.length_in_samples() == 0) break;
+  }
+  return res;
+}
+
+void AUDIO_IO_CACHE_TEST::write_source(const string& fname, int frames)
+{
+  std::FILE* f = std::fopen(fname.c_str(), "wb");
+  for(int i = 0; i < frames * 2; i++) {
+    short v = static_cast<short>((i * 37) % 2000 - 1000);
+    std::fwrite(&v, sizeof(v), 1, f);
+  }
+  std::fclose(f);
+}
+
+/**
+ * Opens 'arg', seeks to 'pos' and reads the object
+ * to the end. If 'arg' is read from a cache file,
+ * its name is stored to 'cachefile'.
+ */
+vector<SAMPLE_SPECS::sample_t> AUDIO_IO_CACHE_TEST::read_from(const string& arg,
+							      SAMPLE_SPECS::sample_pos_t pos,
+							      SAMPLE_SPECS::sample_pos_t* length,
+							      string* cachefile)
+{
+  vector<SAMPLE_SPECS::sample_t> res;
+  AUDIO_IO* obj = open_object(arg);
+  if (obj == 0) return res;
+
+  *length = obj->length_in_samples();
+  AUDIO_IO_CACHE* cobj = dynamic_cast<AUDIO_IO_CACHE*>(obj);
+  *cachefile = (cobj != 0 && cobj->is_cached() == true) ? cobj->cache_file_name() : "";
+
+  obj->seek_position_in_samples(pos);
+  if (obj->position_in_samples() != pos)
+    ECA_TEST_FAILURE(arg + ": position after seek " + kvu_numtostr(obj->position_in_samples()));
+  res = read_all(obj);
+  delete obj;
+  return res;
+}
+
+/**
+ * Seeks a cached reverse object, with and without
+ * a usable cache, and compares the output to that
+ * of the reverse object read directly.
+ */
+void AUDIO_IO_CACHE_TEST::test_reverse_seek(const string& source, const string& cachedir)
+{
+  const SAMPLE_SPECS::sample_pos_t pos = 1234;
+  SAMPLE_SPECS::sample_pos_t length, ref_length;
+  string cachefile, ref_cachefile;
+
+  AUDIO_IO* src = open_object(source);
+  vector<SAMPLE_SPECS::sample_t> forward = read_all(src);
+  delete src;
+
+  vector<SAMPLE_SPECS::sample_t> expected =
+    read_from("reverse," + source, pos, &ref_length, &ref_cachefile);
+  vector<SAMPLE_SPECS::sample_t> reversed;
+  for(size_t n = forward.size() - pos * 2; n > 0; n -= 2) {
+    reversed.push_back(forward[n - 2]);
+    reversed.push_back(forward[n - 1]);
+  }
+  if (expected != reversed) {
+    ECA_TEST_FAILURE("reverse, " + kvu_numtostr(expected.size() / 2) + " frames after seek");
+  }
+
+  /* case: decoded to the cache */
+  AUDIO_IO_CACHE::set_cache_directory(cachedir);
+  vector<SAMPLE_SPECS::sample_t> res =
+    read_from("cache,reverse," + source, pos, &length, &cachefile);
+  if (cachefile.size() == 0 || length != ref_length || res != expected) {
+    ECA_TEST_FAILURE("cached reverse, " + kvu_numtostr(res.size() / 2) + " frames after seek");
+  }
+
+  std::remove(cachefile.c_str());
+
+  /* case: caching disabled */
+  AUDIO_IO_CACHE::set_cache_directory("");
+  res = read_from("cache,reverse," + source, pos, &length, &cachefile);
+  if (cachefile.size() > 0 || length != ref_length || res != expected) {
+    ECA_TEST_FAILURE("uncached reverse, " + kvu_numtostr(res.size() / 2) + " frames after seek");
+  }
+
+  /* case: cache file cannot be written */
+  AUDIO_IO_CACHE::set_cache_directory(source + "/cache");
+  res = read_from("cache,reverse," + source, pos, &length, &cachefile);
+  if (cachefile.size() > 0 || length != ref_length || res != expected) {
+    ECA_TEST_FAILURE("unwritable cache, " + kvu_numtostr(res.size() / 2) + " frames after seek");
+  }
+
+  AUDIO_IO_CACHE::set_cache_directory(cachedir);
+}
+
+void AUDIO_IO_CACHE_TEST::do_run(void)
+{
+  char dirname[] = "/tmp/eca-audio-cache-test-XXXXXX";
+  if (::mkdtemp(dirname) == 0) {
+    ECA_TEST_FAILURE("mkdtemp");
+    return;
+  }
+  const string source = string(dirname) + "/source.raw";
+  const string cachedir = string(dirname) + "/cache";
+  const int frames = 3000;
+
+  string old_cachedir = AUDIO_IO_CACHE::cache_directory();
+  AUDIO_IO_CACHE::set_cache_directory(cachedir);
+  write_source(source, frames);
+
+  AUDIO_IO* ref = open_object(source);
+  vector<SAMPLE_SPECS::sample_t> expected = read_all(ref);
+  delete ref;
+
+  /* case: first open decodes to the cache */
+  AUDIO_IO_CACHE* obj = dynamic_cast<AUDIO_IO_CACHE*>(open_object("cache," + source));
+  if (obj == 0 || obj->is_cached() != true) {
+    ECA_TEST_FAILURE("first open not cached");
+    delete obj;
+    return;
+  }
+  if (obj->length_in_samples() != frames || obj->channels() != 2) {
+    ECA_TEST_FAILURE("length " + kvu_numtostr(obj->length_in_samples()));
+  }
+  if (read_all(obj) != expected) {
+    ECA_TEST_FAILURE("data after decode");
+  }
+
+  /* case: sample accurate seek */
+  obj->seek_position_in_samples(1234);
+  vector<SAMPLE_SPECS::sample_t> tail = read_all(obj);
+  if (tail != vector<SAMPLE_SPECS::sample_t>(expected.begin() + 1234 * 2, expected.end())) {
+    ECA_TEST_FAILURE("data after seek");
+  }
+
+  string cachefile = obj->cache_file_name();
+  struct stat buf1;
+  ::stat(cachefile.c_str(), &buf1);
+  obj->close();
+  delete obj;
+
+  /* case: second open is served from the existing file */
+  obj = dynamic_cast<AUDIO_IO_CACHE*>(open_object("cache," + source));
+  struct stat buf2;
+  ::stat(cachefile.c_str(), &buf2);
+  if (obj == 0 || obj->is_cached() != true ||
+      obj->cache_file_name() != cachefile ||
+      buf1.st_ino != buf2.st_ino) {
+    ECA_TEST_FAILURE("second open");
+  }
+  else if (read_all(obj) != expected) {
+    ECA_TEST_FAILURE("data from cache");
+  }
+  delete obj;
+
+  /* case: modified source gets a new cache file */
+  write_source(source, frames + 100);
+  obj = dynamic_cast<AUDIO_IO_CACHE*>(open_object("cache," + source));
+  if (obj == 0 || obj->is_cached() != true ||
+      obj->cache_file_name() == cachefile ||
+      obj->length_in_samples() != frames + 100) {
+    ECA_TEST_FAILURE("modified source");
+  }
+  string cachefile2 = (obj != 0 ? obj->cache_file_name() : "");
+  delete obj;
+
+  /* case: seeking a reverse object */
+  test_reverse_seek(source, cachedir);
+
+  std::remove(cachefile.c_str());
+  std::remove(cachefile2.c_str());
+  ::rmdir(cachedir.c_str());
+  std::remove(source.c_str());
+  ::rmdir(dirname);
+
+  AUDIO_IO_CACHE::set_cache_directory(old_cachedir);
+}
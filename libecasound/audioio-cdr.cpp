@@ -42,11 +42,15 @@ typedef long int off_t;
 
 #include "sample-specs.h"
 #include "audioio-cdr.h"
+#include "eca-fileio-stream.h"
+#include "eca-fileio-uring.h"
 #include "eca-logger.h"
 
 CDRFILE::CDRFILE(const std::string& name)
 {
   set_label(name);
+  fio_repp = 0;
+  fileio_rep = "";
 }
 
 CDRFILE::~CDRFILE(void)
@@ -74,25 +78,34 @@ void CDRFILE::open(void) throw(AUDIO_IO::SETUP_ERROR &)
   switch(io_mode()) {
   case io_read:
     {
-      fobject = std::fopen(label().c_str(),"rb");
-      if (!fobject)
+      fio_repp = ECA_FILE_IO_URING::create(fileio_rep, label(), "rb");
+      if (fio_repp == 0) {
+	fio_repp = new ECA_FILE_IO_STREAM();
+	fio_repp->open_file(label(), "rb");
+      }
+      if (fio_repp->is_file_ready() != true)
 	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-CDR: Can't open " + label() + " for reading."));
       set_length_in_bytes();
       break;
     }
   case io_write: 
     {
-      fobject = std::fopen(label().c_str(),"wb");
-      if (!fobject) 
+      fio_repp = ECA_FILE_IO_URING::create(fileio_rep, label(), "wb");
+      if (fio_repp == 0) {
+	fio_repp = new ECA_FILE_IO_STREAM();
+	fio_repp->open_file(label(), "wb");
+      }
+      if (fio_repp->is_file_ready() != true)
 	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-CDR: Can't open " + label() + " for writing."));
       break;
     }
   case io_readwrite:
     {
-      fobject = std::fopen(label().c_str(),"r+b");
-      if (!fobject) {
-	fobject = std::fopen(label().c_str(),"w+b");
-	if (!fobject)
+      fio_repp = new ECA_FILE_IO_STREAM();
+      fio_repp->open_file(label(), "r+b");
+      if (fio_repp->file_mode() == "") {
+	fio_repp->open_file(label(), "w+b");
+	if (fio_repp->is_file_ready() != true)
 	  throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-CDR: Can't open " + label() + " for read&write."));
       }
       set_length_in_bytes();
@@ -105,18 +118,22 @@ void CDRFILE::open(void) throw(AUDIO_IO::SETUP_ERROR &)
 
 void CDRFILE::close(void)
 { 
-  if (io_mode() != io_read)
-    pad_to_sectorsize();
+  if (fio_repp != 0) {
+    if (io_mode() != io_read)
+      pad_to_sectorsize();
 
-  std::fclose(fobject);
+    fio_repp->close_file();
+    delete fio_repp;
+    fio_repp = 0;
+  }
 
   AUDIO_IO::close();
 }
 
 bool CDRFILE::finished(void) const
 {
- if (std::ferror(fobject) ||
-     std::feof(fobject))
+ if (fio_repp->is_file_error() ||
+     !fio_repp->is_file_ready())
    return true;
 
  return false;
@@ -124,12 +141,13 @@ bool CDRFILE::finished(void) const
 
 long int CDRFILE::read_samples(void* target_buffer, long int samples)
 {
-  return std::fread(target_buffer, frame_size(), samples, fobject);
+  fio_repp->read_to_buffer(target_buffer, frame_size() * samples);
+  return fio_repp->file_bytes_processed() / frame_size();
 }
 
 void CDRFILE::write_samples(void* target_buffer, long int samples)
 {
-  std::fwrite(target_buffer, frame_size(), samples, fobject);
+  fio_repp->write_from_buffer(target_buffer, frame_size() * samples);
 }
 
 SAMPLE_SPECS::sample_pos_t CDRFILE::seek_position(SAMPLE_SPECS::sample_pos_t pos)
@@ -137,32 +155,7 @@ SAMPLE_SPECS::sample_pos_t CDRFILE::seek_position(SAMPLE_SPECS::sample_pos_t pos
   if (is_open() == true) {
     off_t curpos_rep = pos * frame_size();
     DBC_CHECK(curpos_rep >= 0);
-/* fseeko doesn't seem to work with glibc 2.1.x */
-#if _FILE_OFFSET_BITS==64
-    off_t seekpos = 0;
-    off_t seekstep = 0;
-    int whence = SEEK_SET;
-    while(curpos_rep - seekpos > 0) {
-      if (curpos_rep - seekpos > LONG_MAX)
-	seekstep = LONG_MAX;
-      else
-	seekstep = curpos_rep - seekpos;
-
-      // std::cerr << "(audioio-cdr) fw-seeking from " << seekpos << " to " << seekpos+seekstep << std::endl;
-      int res = std::fseek(fobject, seekstep, whence);
-      if (res != 0) {
-	  ECA_LOG_MSG(ECA_LOGGER::info, "fseek() error! (lfs).");
-	  curpos_rep = 0;
-	  std::fseek(fobject, 0, SEEK_SET);
-	  break;
-      }
-      if (seekpos == 0) whence = SEEK_CUR;
-      seekpos += seekstep;
-    }
-#else
-    DBC_CHECK(sizeof(long int) == sizeof(off_t));
-    std::fseek(fobject, static_cast<long int>(curpos_rep), SEEK_SET);
-#endif
+    fio_repp->set_file_position(curpos_rep);
   }
 
   return pos;
@@ -176,16 +169,40 @@ void CDRFILE::pad_to_sectorsize(void)
   if (padsamps == CDRFILE::sectorsize) {
     return;
   }
-  for(int n = 0; n < padsamps; n++) ::fputc(0,fobject);
 
-  DBC_DECLARE(long int endpos);
-  DBC_DECLARE(endpos = std::ftell(fobject));
-  DBC_CHECK((endpos %  CDRFILE::sectorsize) == 0);
+  unsigned char zeros[CDRFILE::sectorsize];
+  std::memset(zeros, 0, padsamps);
+  fio_repp->write_from_buffer(zeros, padsamps);
+
+  DBC_CHECK((fio_repp->get_file_position() % CDRFILE::sectorsize) == 0);
 }
 
 void CDRFILE::set_length_in_bytes(void)
 {
-  struct stat temp;
-  stat(label().c_str(), &temp);
-  set_length_in_samples(temp.st_size / frame_size());
+  set_length_in_samples(fio_repp->get_file_length() / frame_size());
+}
+
+void CDRFILE::set_parameter(int param, std::string value)
+{
+  switch (param) {
+  case 1: 
+    set_label(value);
+    break;
+
+  case 2: 
+    fileio_rep = value;
+    break;
+  }
+}
+
+std::string CDRFILE::get_parameter(int param) const
+{
+  switch (param) {
+  case 1: 
+    return label();
+
+  case 2: 
+    return fileio_rep;
+  }
+  return "";
 }
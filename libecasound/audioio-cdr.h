@@ -10,6 +10,8 @@
 #include "sample-specs.h"
 #include "audioio-buffered.h"
 
+class ECA_FILE_IO;
+
 typedef struct {
   public:
   int16_t sample[2]; // signed short int
@@ -34,7 +36,8 @@ class CDRFILE : public AUDIO_IO_BUFFERED {
 
   long int samples_read;
 
-  FILE* fobject;
+  ECA_FILE_IO* fio_repp;
+  std::string fileio_rep;
   void pad_to_sectorsize(void);
   void set_length_in_bytes(void);
 
@@ -55,6 +58,10 @@ class CDRFILE : public AUDIO_IO_BUFFERED {
   std::string description(void) const { return("CD-R/CDDA audio files. This format is used when mastering audio-CDs."); }
 
   virtual bool locked_audio_format(void) const { return(true); }
+  virtual std::string parameter_names(void) const { return("label,fileio"); }
+
+  virtual void set_parameter(int param, std::string value);
+  virtual std::string get_parameter(int param) const;
 
   virtual void open(void) throw(AUDIO_IO::SETUP_ERROR &);
   virtual void close(void);
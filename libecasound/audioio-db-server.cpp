@@ -1,6 +1,6 @@
 // ------------------------------------------------------------------------
 // audioio-db-server.cpp: Audio i/o engine serving db clients.
-// Copyright (C) 2000-2005,2009,2011 Kai Vehmanen
+// Copyright (C) 2000-2005,2009,2011,2026 Kai Vehmanen
 //
 // Attributes:
 //     eca-style-version: 3
@@ -37,10 +37,12 @@
 #include <kvu_dbc.h>
 #include <kvu_utils.h>
 #include <kvu_numtostr.h>
+#include <kvu_rtcaps.h>
 
 #include "sample-specs.h"
 #include "samplebuffer.h"
 #include "eca-logger.h"
+#include "audioio-buffered.h"
 #include "audioio-db-server.h"
 #include "audioio-db-server_impl.h"
 
@@ -65,12 +67,22 @@
 
 const int AUDIO_IO_DB_SERVER::buffercount_default = 32;
 const long int AUDIO_IO_DB_SERVER::buffersize_default = 1024;
+const int AUDIO_IO_DB_SERVER::batch_buffers_max = 8;
 
 // --
 // Initialization of static, global functions
 
 static int timed_wait(pthread_mutex_t* mutex, pthread_cond_t* cond, long int usecs);
 static void timed_wait_print_result(int result, const char* tag, bool verbose);
+static int db_server_batch_size(int space, int contiguous, int margin, int max);
+
+/**
+ * Arguments passed to additional i/o threads.
+ */
+struct db_server_worker_arg {
+  AUDIO_IO_DB_SERVER* pserver;
+  int index;
+};
 
 /**
  * Helper function for starting the slave thread.
@@ -84,11 +96,34 @@ void* start_db_server_io_thread(void *ptr)
 
   AUDIO_IO_DB_SERVER* pserver =
     static_cast<AUDIO_IO_DB_SERVER*>(ptr);
+  pserver->init_thread_scheduling();
   pserver->io_thread();
 
   return 0;
 }
 
+/**
+ * Helper function for starting additional i/o threads.
+ */
+void* start_db_server_io_worker(void *ptr)
+{
+  sigset_t sigset;
+  sigemptyset(&sigset);
+  sigaddset(&sigset, SIGINT);
+  sigprocmask(SIG_BLOCK, &sigset, 0);
+
+  struct db_server_worker_arg* arg =
+    static_cast<struct db_server_worker_arg*>(ptr);
+  AUDIO_IO_DB_SERVER* pserver = arg->pserver;
+  int index = arg->index;
+  delete arg;
+
+  pserver->init_thread_scheduling();
+  pserver->io_worker(index);
+
+  return 0;
+}
+
 /**
  * Constructor.
  */
@@ -97,6 +132,9 @@ AUDIO_IO_DB_SERVER::AUDIO_IO_DB_SERVER (void)
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "constructor");
   buffercount_rep = buffercount_default;
   buffersize_rep = buffersize_default;
+  io_threads_rep = 1;
+  schedrealtime_rep = false;
+  schedpriority_rep = 0;
 
   impl_repp = new AUDIO_IO_DB_SERVER_impl;
 
@@ -112,6 +150,12 @@ AUDIO_IO_DB_SERVER::AUDIO_IO_DB_SERVER (void)
   pthread_mutex_init(&impl_repp->stop_mutex_rep, NULL);
   pthread_cond_init(&impl_repp->flush_cond_rep, NULL);
   pthread_mutex_init(&impl_repp->flush_mutex_rep, NULL);
+  pthread_cond_init(&impl_repp->sched_cond_rep, NULL);
+  pthread_cond_init(&impl_repp->run_cond_rep, NULL);
+  pthread_mutex_init(&impl_repp->sched_mutex_rep, NULL);
+
+  impl_repp->busy_clients_rep = 0;
+  impl_repp->sched_start_rep = 0;
 
   running_rep.set(0);
   full_rep.set(0);
@@ -126,6 +170,7 @@ AUDIO_IO_DB_SERVER::AUDIO_IO_DB_SERVER (void)
   impl_repp->profile_read_xrun_danger_rep = 0;
   impl_repp->profile_write_xrun_danger_rep = 0;
   impl_repp->profile_rounds_total_rep = 0;
+  impl_repp->profile_one_time_full_rep = false;
 }
 
 /**
@@ -137,8 +182,12 @@ AUDIO_IO_DB_SERVER::~AUDIO_IO_DB_SERVER(void)
   stop_request_rep.set(1);
   exit_request_rep.set(1);
   exit_ok_rep.set(0);
+  signal_workers();
   if (thread_running_rep == true) {
     pthread_join(impl_repp->io_thread_rep, 0);
+    for(unsigned int n = 0; n < impl_repp->worker_threads_rep.size(); n++) {
+      pthread_join(impl_repp->worker_threads_rep[n], 0);
+    }
   }
   for(unsigned int p = 0; p < buffers_rep.size(); p++) {
     delete buffers_rep[p];
@@ -176,8 +225,32 @@ void AUDIO_IO_DB_SERVER::start(void)
     thread_running_rep = true;
   }
 
+  /* note: threads are kept alive over stop/start cycles; if the
+   *       number of i/o threads has been reduced, the extra threads
+   *       stay idle (see io_worker()) */
+  while(static_cast<int>(impl_repp->worker_threads_rep.size()) < io_threads_rep - 1) {
+    struct db_server_worker_arg* arg = new struct db_server_worker_arg;
+    arg->pserver = this;
+    arg->index = impl_repp->worker_threads_rep.size() + 1;
+
+    pthread_t thread;
+    int ret = pthread_create(&thread,
+			     0,
+			     start_db_server_io_worker,
+			     static_cast<void *>(arg));
+    if (ret != 0) {
+      delete arg;
+      ECA_LOG_MSG(ECA_LOGGER::info, "WARNING: unable to create db i/o thread");
+      break;
+    }
+    impl_repp->worker_threads_rep.push_back(thread);
+  }
+
+  impl_repp->client_busy_rep.resize(clients_rep.size(), 0);
+
   stop_request_rep.set(0);
   running_rep.set(1);
+  signal_workers();
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "starting processing");
 }
 
@@ -253,9 +326,9 @@ static void timed_wait_print_result(int result, const char* tag, bool verbose)
 
   if (result != 0) {
     if (result == -ETIMEDOUT)
-      ECA_LOG_MSG(level, std::string(tag) + " failed; timeout");
+      ECA_LOG_MSG_RT(level, "%s failed; timeout", tag);
     else
-      ECA_LOG_MSG(level, std::string(tag) + " failed");
+      ECA_LOG_MSG_RT(level, "%s failed", tag);
   }
 }
 
@@ -278,18 +351,12 @@ void AUDIO_IO_DB_SERVER::signal_client_activity(void)
  * Function that blocks until some client
  * activity occurs.
  *
- * Only called by db server.
+ * Only called by db server i/o threads.
  *
  * @see signal_client_activity()
- *
- * @pre is_running() != true
  */
 void AUDIO_IO_DB_SERVER::wait_for_client_activity(void)
 {
-  // --
-  DBC_REQUIRE(is_running() == true);
-  // --
-
   /* note! we only wait for 100msec in case no clients
    *       clients signal activity but there's still
    *       room for new data 
@@ -389,6 +456,17 @@ void AUDIO_IO_DB_SERVER::signal_flush(void)
 }
 
 
+/**
+ * Wakes up additional i/o threads waiting for the
+ * server to be started or to exit.
+ */
+void AUDIO_IO_DB_SERVER::signal_workers(void)
+{
+  pthread_mutex_lock(&impl_repp->sched_mutex_rep);
+  pthread_cond_broadcast(&impl_repp->run_cond_rep);
+  pthread_mutex_unlock(&impl_repp->sched_mutex_rep);
+}
+
 /**
  * Sets new default values for sample buffers.
  * 
@@ -405,6 +483,40 @@ void AUDIO_IO_DB_SERVER::set_buffer_defaults(int buffers,
   buffersize_rep = buffersize;
 }
 
+/**
+ * Sets the number of threads used for servicing
+ * clients. Takes effect the next time the server
+ * is started.
+ * 
+ * @pre threads > 0
+ * @pre is_running() != true
+ */
+void AUDIO_IO_DB_SERVER::set_io_threads(int threads)
+{
+  // --
+  DBC_REQUIRE(threads > 0);
+  DBC_REQUIRE(is_running() != true);
+  // --
+
+  io_threads_rep = threads;
+}
+
+/**
+ * Sets the scheduling policy of the calling i/o
+ * thread. All i/o threads use realtime scheduling
+ * if enabled with set_schedrealtime().
+ */
+void AUDIO_IO_DB_SERVER::init_thread_scheduling(void)
+{
+  if (schedrealtime_rep == true) {
+    if (kvu_set_thread_scheduling(SCHED_FIFO, schedpriority_rep) != 0)
+      ECA_LOG_MSG(ECA_LOGGER::system_objects, "Unable to change scheduling policy!");
+    else
+      ECA_LOG_MSG(ECA_LOGGER::system_objects,
+		  std::string("Using realtime-scheduling (SCHED_FIFO:") + kvu_numtostr(schedpriority_rep) + ").");
+  }
+}
+
 /**
  * Registers a new client object.
  *
@@ -428,6 +540,12 @@ void AUDIO_IO_DB_SERVER::register_client(AUDIO_IO* aobject)
 					       buffersize_rep,
 					       aobject->channels()));
   client_map_rep[aobject] = clients_rep.size() - 1;
+
+  /* note: raw i/o space for batched transfers is
+   *       allocated here, not in the server thread */
+  AUDIO_IO_BUFFERED* buffered = dynamic_cast<AUDIO_IO_BUFFERED*>(aobject);
+  if (buffered != 0)
+    buffered->set_batch_buffers(batch_buffers_max);
 }
 
 /**
@@ -473,105 +591,287 @@ AUDIO_IO_DB_BUFFER* AUDIO_IO_DB_SERVER::get_client_buffer(AUDIO_IO* aobject)
 }
 
 /**
- * Slave thread.
+ * Returns the number of buffers to transfer at once
+ * when 'space' buffers are free (inputs) or filled
+ * (outputs), and 'contiguous' of them are before the
+ * end of the ring.
  */
-void AUDIO_IO_DB_SERVER::io_thread(void)
+static int db_server_batch_size(int space, int contiguous, int max)
 {
-  ECA_LOG_MSG(ECA_LOGGER::system_objects, "Hey, in the I/O loop!");
-
-  int processed = 0;
-  int passive_rounds = 0;
-  DB_PROFILING_STATEMENT(bool one_time_full = false);
+  int count = space;
+  if (contiguous < count) count = contiguous;
+  if (max < count) count = max;
+  if (count < 1) count = 1;
+  return count;
+}
 
-  /* set idle timeout to ~10% of total buffersize (using 44.1Hz as a reference) */
-  long int sleeplen = buffersize_rep * buffercount_rep * 1000 / 44100 / 10 * 1000000;
+/**
+ * Returns the number of free (inputs) or filled
+ * (outputs) buffers a client with a ring of 'size'
+ * buffers must have before it is serviced. This makes
+ * the server transfer full batches in steady state,
+ * instead of one buffer each time the engine has
+ * processed one.
+ */
+static int db_server_low_watermark(int size, int max)
+{
+  int count = (size - 1) / 2;
+  if (max < count) count = max;
+  if (count < 1) count = 1;
+  return count;
+}
 
-  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
-		"Using idle timeout of " +
-		kvu_numtostr(sleeplen) + 
-		" nsecs.");
+/**
+ * Returns the margin, in buffers left for the engine
+ * to process, below which a client with a ring of
+ * 'size' buffers is serviced even if it is below its
+ * low watermark.
+ */
+static int db_server_critical_margin(int size)
+{
+  return (size - 1) / 4;
+}
 
-  while(true) {
-    if (running_rep.get() == 0) {
-      kvu_sleep(0, sleeplen);
-      if (exit_request_rep.get() == 1) break;
-      continue;
-    }
+/**
+ * Returns the time, in seconds, the engine can process
+ * 'margin' buffers of 'client' before an xrun occurs.
+ */
+static double db_server_time_left(int margin, const AUDIO_IO* client)
+{
+  if (client->samples_per_second() <= 0)
+    return margin;
 
-    DB_PROFILING_INC(impl_repp->profile_rounds_total_rep);
+  return static_cast<double>(margin) * client->buffersize() / client->samples_per_second();
+}
 
-    processed = 0;
+/**
+ * Selects the next client to service and marks it 
+ * busy. The client with the least amount of buffered 
+ * data (inputs), or free space (outputs), measured in
+ * time, is picked first. Clients may differ in buffer
+ * size and sample rate, so this is the client whose
+ * deadline is closest. Ties are broken in round-robin
+ * order.
+ *
+ * Clients are skipped until a full batch can be
+ * transferred (see db_server_low_watermark()), unless
+ * the engine is close to an xrun on them. Clients that
+ * are already being serviced by another i/o thread are
+ * skipped as well.
+ *
+ * @param busy number of clients currently being serviced
+ *             (set also if no client is selected)
+ *
+ * @return index of the selected client, or -1 if
+ *         no client needs servicing
+ */
+int AUDIO_IO_DB_SERVER::claim_next_client(int* busy)
+{
+  int selected = -1;
+  double selected_time = 0.0;
 
-    int min_free_space = buffercount_rep;
+  pthread_mutex_lock(&impl_repp->sched_mutex_rep);
 
-    DB_PROFILING_STATEMENT(impl_repp->looptimer_rep.start());
+  if (running_rep.get() == 1 &&
+      stop_request_rep.get() == 0 &&
+      exit_request_rep.get() == 0) {
 
-    for(unsigned int p = 0; p < clients_rep.size(); p++) {
+    size_t clients = clients_rep.size();
+    for(size_t n = 0; n < clients; n++) {
+      size_t p = (impl_repp->sched_start_rep + n) % clients;
 
       if (clients_rep[p] == 0 ||
+	  impl_repp->client_busy_rep[p] != 0 ||
 	  buffers_rep[p]->finished_rep.get()) {
 	continue;
       }
       else if (clients_rep[p]->finished() == true) {
 	buffers_rep[p]->finished_rep.set(1);
+	continue;
       }
 
-      int free_space = 0;
-
+      /* space: number of buffers that can be transferred
+       * margin: number of buffers the engine can process
+       *         before an xrun occurs */
+      int space, margin;
       if (buffers_rep[p]->io_mode_rep == AUDIO_IO::io_read) {
-	free_space = buffers_rep[p]->write_space();
-	if (free_space > 0) {
-	  /* room available, so we can read at least one buffer of data */
+	space = buffers_rep[p]->write_space();
+	margin = buffers_rep[p]->read_space();
+      }
+      else {
+	space = buffers_rep[p]->read_space();
+	margin = buffers_rep[p]->write_space();
+      }
+      if (space <= 0) continue;
+
+      /* note: wait until a full batch can be transferred,
+       *       unless the client is close to an xrun */
+      int size = buffers_rep[p]->sbufs_rep.size();
+      if (space < db_server_low_watermark(size, batch_buffers_max) &&
+	  margin > db_server_critical_margin(size))
+	continue;
+
+      double time = db_server_time_left(margin, clients_rep[p]);
+      if (selected < 0 || time < selected_time) {
+	selected = p;
+	selected_time = time;
+      }
+    }
+
+    if (selected >= 0) {
+      impl_repp->client_busy_rep[selected] = 1;
+      ++impl_repp->busy_clients_rep;
+      impl_repp->sched_start_rep = selected + 1;
+    }
+  }
+
+  *busy = impl_repp->busy_clients_rep;
 
-	  if (clients_rep[p]->finished() != true) {
-	    clients_rep[p]->read_buffer(buffers_rep[p]->sbufs_rep[buffers_rep[p]->writeptr_rep.get()]);
-	    if (clients_rep[p]->finished() == true) buffers_rep[p]->finished_rep.set(1);
-	    buffers_rep[p]->advance_write_pointer();
-	    ++processed;
-	  }
+  pthread_mutex_unlock(&impl_repp->sched_mutex_rep);
+
+  return selected;
+}
+
+/**
+ * Marks a client, previously selected with 
+ * claim_next_client(), as no longer busy.
+ */
+void AUDIO_IO_DB_SERVER::release_client(int client)
+{
+  pthread_mutex_lock(&impl_repp->sched_mutex_rep);
+  impl_repp->client_busy_rep[client] = 0;
+  --impl_repp->busy_clients_rep;
+  bool idle = (impl_repp->busy_clients_rep == 0);
+  if (idle == true)
+    pthread_cond_broadcast(&impl_repp->sched_cond_rep);
+  pthread_mutex_unlock(&impl_repp->sched_mutex_rep);
+
+  /* note: wake up io_thread() if it is waiting for other
+   *       i/o threads to finish (see io_thread()) */
+  if (idle == true && io_threads_rep > 1)
+    signal_client_activity();
+}
+
+/**
+ * Blocks until no client is being serviced. 
+ * 
+ * Must only be called when new clients cannot 
+ * be claimed, ie. after a stop or exit request.
+ */
+void AUDIO_IO_DB_SERVER::wait_for_idle_clients(void)
+{
+  pthread_mutex_lock(&impl_repp->sched_mutex_rep);
+  while(impl_repp->busy_clients_rep > 0)
+    pthread_cond_wait(&impl_repp->sched_cond_rep, &impl_repp->sched_mutex_rep);
+  pthread_mutex_unlock(&impl_repp->sched_mutex_rep);
+}
+
+/**
+ * Transfers data between client 'p' and its db 
+ * buffer. Up to 'batch_buffers_max' buffers are 
+ * transferred with one read_buffers() or 
+ * write_buffers() call.
+ */
+void AUDIO_IO_DB_SERVER::service_client(int p)
+{
+  AUDIO_IO_DB_BUFFER* dbuf = buffers_rep[p];
+  int size = dbuf->sbufs_rep.size();
+
+  if (dbuf->io_mode_rep == AUDIO_IO::io_read) {
+    int writeptr = dbuf->writeptr_rep.get();
+    int count = db_server_batch_size(dbuf->write_space(),
+				     size - writeptr,
+				     batch_buffers_max);
+
+    count = clients_rep[p]->read_buffers(&dbuf->sbufs_rep[writeptr], count);
+    if (clients_rep[p]->finished() == true) dbuf->finished_rep.set(1);
+    for(int n = 0; n < count; n++)
+      dbuf->advance_write_pointer();
 
 #ifdef DB_PROFILING
-	  if (buffers_rep[p]->write_space() > 16 && one_time_full == true) {
-	    DB_PROFILING_INC(impl_repp->profile_read_xrun_danger_rep);
-	  }
+    if (buffers_rep[p]->write_space() > 16 && impl_repp->profile_one_time_full_rep == true) {
+      DB_PROFILING_INC(impl_repp->profile_read_xrun_danger_rep);
+    }
 #endif
+  }
+  else {
+    int readptr = dbuf->readptr_rep.get();
+    int count = db_server_batch_size(dbuf->read_space(),
+				     size - readptr,
+				     batch_buffers_max);
 
-	}
-      }
-      else {
-	free_space = buffers_rep[p]->read_space();
-	if (free_space > 0) {
-	  /* room available, so we can write at least one buffer of data */
-
-	  if (clients_rep[p]->finished() != true) {
-	    clients_rep[p]->write_buffer(buffers_rep[p]->sbufs_rep[buffers_rep[p]->readptr_rep.get()]);
-	    if (clients_rep[p]->finished() == true) buffers_rep[p]->finished_rep.set(1);
-	    buffers_rep[p]->advance_read_pointer();
-	    ++processed;
-	  }
+    clients_rep[p]->write_buffers(&dbuf->sbufs_rep[readptr], count);
+    if (clients_rep[p]->finished() == true) dbuf->finished_rep.set(1);
+    for(int n = 0; n < count; n++)
+      dbuf->advance_read_pointer();
 
 #ifdef DB_PROFILING
-	  if (buffers_rep[p]->read_space() < 16  && one_time_full == true) {
-	    DB_PROFILING_INC(impl_repp->profile_write_xrun_danger_rep);
-	  }
+    if (buffers_rep[p]->read_space() < 16  && impl_repp->profile_one_time_full_rep == true) {
+      DB_PROFILING_INC(impl_repp->profile_write_xrun_danger_rep);
+    }
 #endif
-	}
-      }
+  }
+}
 
-      if (free_space < min_free_space) min_free_space = free_space;
+/**
+ * Slave thread. Services clients, and takes care of 
+ * stop and exit requests, and of signaling when all
+ * buffers are full.
+ */
+void AUDIO_IO_DB_SERVER::io_thread(void)
+{
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, "Hey, in the I/O loop!");
+
+  int passive_rounds = 0;
+
+  /* set idle timeout to ~10% of total buffersize (using 44.1Hz as a reference) */
+  long int sleeplen = buffersize_rep * buffercount_rep * 1000 / 44100 / 10 * 1000000;
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+		"Using idle timeout of " +
+		kvu_numtostr(sleeplen) + 
+		" nsecs.");
+
+  while(true) {
+    if (running_rep.get() == 0) {
+      kvu_sleep(0, sleeplen);
+      if (exit_request_rep.get() == 1) break;
+      continue;
+    }
+
+    DB_PROFILING_INC(impl_repp->profile_rounds_total_rep);
+
+    /* service the most urgent clients, at most one batch per
+     * client per round, so that stop requests are noticed */
+    int processed = 0;
+    int busy = 0;
+
+    DB_PROFILING_STATEMENT(impl_repp->looptimer_rep.start());
+
+    for(unsigned int n = 0; n < clients_rep.size(); n++) {
+      int p = claim_next_client(&busy);
+      if (p < 0) break;
+      service_client(p);
+      release_client(p);
+      ++processed;
     }
 
     DB_PROFILING_STATEMENT(impl_repp->looptimer_rep.stop());
 
     if (stop_request_rep.get() == 1) {
+      /* note: no new clients are claimed once a stop has been 
+       *       requested, so we only need to wait for other i/o 
+       *       threads to finish their current transfers */
+      wait_for_idle_clients();
+      drain_outputs();
       stop_request_rep.set(0);
       running_rep.set(0);
       full_rep.set(0);
-      ECA_LOG_MSG(ECA_LOGGER::system_objects, "stop complete");
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "stop complete");
       signal_stop();
     }
     else {
-      if (processed == 0) passive_rounds++;
+      if (processed == 0 && busy == 0) passive_rounds++;
       else passive_rounds = 0;
 
       if (processed == 0) {
@@ -579,12 +879,13 @@ void AUDIO_IO_DB_SERVER::io_thread(void)
 	  /* case 1: nothing processed during the last two rounds ==> signal_full, wait_for_client_activity */
 	  DB_PROFILING_INC(impl_repp->profile_full_rep);
 	  full_rep.set(1);
-	  DB_PROFILING_STATEMENT(if (one_time_full != true) one_time_full = true);
+	  DB_PROFILING_STATEMENT(impl_repp->profile_one_time_full_rep = true);
 	  signal_full();
 	  DBC_CHECK(running_rep.get() == 1);
 	}
 	else {
-	  /* case 2: nothing processed during the last round ==> wait_for_client_activity */
+	  /* case 2: nothing processed during the last round, or
+	   *         other i/o threads still busy ==> wait_for_client_activity */
 	  DB_PROFILING_INC(impl_repp->profile_no_processing_rep);
 	}
 	
@@ -599,11 +900,45 @@ void AUDIO_IO_DB_SERVER::io_thread(void)
       // DB_PROFILING_INC(impl_repp->profile_not_full_anymore_rep);
     }
   }
+  wait_for_idle_clients();
   flush();
   exit_ok_rep.set(1);
   // std::cerr << "Exiting db server thread." << std::endl;
 }
 
+/**
+ * Additional i/o thread. Only services clients; 
+ * stop and exit requests are handled by io_thread().
+ *
+ * Threads with an index equal or larger than 
+ * io_threads() stay idle.
+ */
+void AUDIO_IO_DB_SERVER::io_worker(int index)
+{
+  while(exit_request_rep.get() == 0) {
+    if (running_rep.get() == 0 ||
+	index >= io_threads_rep) {
+      /* note: woken up by start() and the destructor */
+      pthread_mutex_lock(&impl_repp->sched_mutex_rep);
+      while(exit_request_rep.get() == 0 &&
+	    (running_rep.get() == 0 || index >= io_threads_rep))
+	pthread_cond_wait(&impl_repp->run_cond_rep, &impl_repp->sched_mutex_rep);
+      pthread_mutex_unlock(&impl_repp->sched_mutex_rep);
+      continue;
+    }
+
+    int busy;
+    int p = claim_next_client(&busy);
+    if (p >= 0) {
+      service_client(p);
+      release_client(p);
+    }
+    else {
+      wait_for_client_activity();
+    }
+  }
+}
+
 void AUDIO_IO_DB_SERVER::dump_profile_counters(void)
 {
   std::cerr << "(audioio-db-server) *** profile begin ***" << std::endl;
@@ -624,6 +959,26 @@ void AUDIO_IO_DB_SERVER::dump_profile_counters(void)
   std::cerr << "(audioio-db-server) *** profile end   ***" << std::endl;
 }
 
+/**
+ * Writes all data in the output buffers to disk.
+ * Unlike flush(), input buffers are left intact.
+ *
+ * Only called by io_thread() when no client is
+ * being serviced.
+ */
+void AUDIO_IO_DB_SERVER::drain_outputs(void)
+{
+  for(unsigned int p = 0; p < clients_rep.size(); p++) {
+    if (clients_rep[p] == 0 ||
+	buffers_rep[p]->io_mode_rep == AUDIO_IO::io_read)
+      continue;
+    while(buffers_rep[p]->finished_rep.get() == 0 &&
+	  buffers_rep[p]->read_space() > 0) {
+      service_client(p);
+    }
+  }
+}
+
 /**
  * Flushes all data in the buffers to disk.
  */
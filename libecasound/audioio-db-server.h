@@ -11,11 +11,19 @@ class AUDIO_IO_DB_SERVER_impl;
  * Audio i/o engine. Meant for serving all double-buffered client
  * audio objects (AUDIO_IO_DB_CLIENT). 
  *
+ * Clients are serviced by one or more i/o threads (see
+ * set_io_threads()). Each thread always picks the client
+ * that is closest to an underrun (inputs) or overrun
+ * (outputs), and that is not already being serviced by
+ * another thread. Thus one slow client can only stall
+ * one i/o thread.
+ *
  * @author Kai Vehmanen
  */
 class AUDIO_IO_DB_SERVER {
 
   friend void* start_db_server_io_thread(void *ptr);
+  friend void* start_db_server_io_worker(void *ptr);
 
  public:
 
@@ -32,6 +40,7 @@ class AUDIO_IO_DB_SERVER {
 
   bool is_running(void) const;
   bool is_full(void) const;
+  int io_threads(void) const { return io_threads_rep; }
 
   /*@}*/
 
@@ -64,6 +73,9 @@ class AUDIO_IO_DB_SERVER {
   /*@{*/
 
   void set_buffer_defaults(int buffers, long int buffersize);
+  void set_io_threads(int threads);
+  void set_schedrealtime(bool v) { schedrealtime_rep = v; }
+  void set_schedpriority(int v) { schedpriority_rep = v; }
   void register_client(AUDIO_IO* abject);
   void unregister_client(AUDIO_IO* abject);
   AUDIO_IO_DB_BUFFER* get_client_buffer(AUDIO_IO* abject);
@@ -75,6 +87,7 @@ class AUDIO_IO_DB_SERVER {
 
   static const int buffercount_default;
   static const long int buffersize_default;
+  static const int batch_buffers_max;
 
   std::vector<AUDIO_IO_DB_BUFFER*> buffers_rep;
   std::vector<AUDIO_IO*> clients_rep;
@@ -92,18 +105,29 @@ class AUDIO_IO_DB_SERVER {
   
   int buffercount_rep;
   long int buffersize_rep;
+  bool schedrealtime_rep;
   int schedpriority_rep;
+  int io_threads_rep;
 
   AUDIO_IO_DB_SERVER& operator=(const AUDIO_IO_DB_SERVER& x) { return *this; }
   AUDIO_IO_DB_SERVER (const AUDIO_IO_DB_SERVER& x) { }
 
   void io_thread(void);
+  void io_worker(int index);
+  void init_thread_scheduling(void);
+
+  int claim_next_client(int* busy);
+  void release_client(int client);
+  void service_client(int client);
+  void wait_for_idle_clients(void);
+  void drain_outputs(void);
 
   void wait_for_client_activity(void);
 
   void signal_full(void);
   void signal_stop(void);
   void signal_flush(void);
+  void signal_workers(void);
 
   void dump_profile_counters(void);
 
@@ -1,6 +1,7 @@
 #ifndef INCLUDED_AUDIOIO_DB_SERVER_IMPL_H
 #define INCLUDED_AUDIOIO_DB_SERVER_IMPL_H
 
+#include <vector>
 #include <pthread.h>
 #include <kvu_procedure_timer.h>
 
@@ -13,6 +14,13 @@ class AUDIO_IO_DB_SERVER_impl {
  private:
 
   pthread_t io_thread_rep;
+  std::vector<pthread_t> worker_threads_rep;
+  pthread_cond_t sched_cond_rep;
+  pthread_cond_t run_cond_rep;
+  pthread_mutex_t sched_mutex_rep;
+  std::vector<char> client_busy_rep;
+  int busy_clients_rep;
+  size_t sched_start_rep;
   pthread_cond_t client_cond_rep;
   pthread_mutex_t client_mutex_rep;
   pthread_cond_t data_cond_rep;
@@ -31,6 +39,7 @@ class AUDIO_IO_DB_SERVER_impl {
   size_t profile_read_xrun_danger_rep;
   size_t profile_write_xrun_danger_rep;
   size_t profile_rounds_total_rep;
+  bool profile_one_time_full_rep;
 
   PROCEDURE_TIMER looptimer_rep;
 };
@@ -0,0 +1,178 @@
+// ------------------------------------------------------------------------
+// audioio-db-server_test.h: Unit test for AUDIO_IO_DB_SERVER
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include <pthread.h>
+
+#include "kvu_numtostr.h"
+#include "kvu_utils.h"
+
+#include "audioio-null.h"
+#include "audioio-db-buffer.h"
+#include "audioio-db-server.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Null audio object that records the size of
+ * each batched transfer done by the db server.
+ */
+class AUDIO_IO_DB_SERVER_TEST_CLIENT : public NULLFILE {
+
+ public:
+
+  AUDIO_IO_DB_SERVER_TEST_CLIENT(void) { pthread_mutex_init(&lock_rep, NULL); }
+  virtual ~AUDIO_IO_DB_SERVER_TEST_CLIENT(void) { pthread_mutex_destroy(&lock_rep); }
+
+  virtual int read_buffers(SAMPLE_BUFFER** sbufs, int count) {
+    record(count);
+    return NULLFILE::read_buffers(sbufs, count);
+  }
+  virtual void write_buffers(SAMPLE_BUFFER** sbufs, int count) {
+    record(count);
+    NULLFILE::write_buffers(sbufs, count);
+  }
+
+  vector<int> batches(void) {
+    pthread_mutex_lock(&lock_rep);
+    vector<int> res = batches_rep;
+    pthread_mutex_unlock(&lock_rep);
+    return res;
+  }
+
+ private:
+
+  void record(int count) {
+    pthread_mutex_lock(&lock_rep);
+    batches_rep.push_back(count);
+    pthread_mutex_unlock(&lock_rep);
+  }
+
+  pthread_mutex_t lock_rep;
+  vector<int> batches_rep;
+};
+
+/**
+ * Unit test for AUDIO_IO_DB_SERVER
+ *
+ * The engine is simulated by consuming (inputs) or
+ * producing (outputs) one buffer at a time, and the
+ * batch sizes used by the server in steady state are
+ * checked.
+ */
+class AUDIO_IO_DB_SERVER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("AUDIO_IO_DB_SERVER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~AUDIO_IO_DB_SERVER_TEST(void) { }
+
+private:
+
+  void test_steady_state_batches(int mode);
+};
+
+static const int audioio_db_server_test_buffers = 32;
+static const long int audioio_db_server_test_buffersize = 64;
+static const int audioio_db_server_test_rounds = 200;
+
+void AUDIO_IO_DB_SERVER_TEST::test_steady_state_batches(int mode)
+{
+  string tag = (mode == AUDIO_IO::io_read) ? "input" : "output";
+
+  AUDIO_IO_DB_SERVER server;
+  server.set_buffer_defaults(audioio_db_server_test_buffers,
+			     audioio_db_server_test_buffersize);
+
+  AUDIO_IO_DB_SERVER_TEST_CLIENT client;
+  client.set_io_mode(mode);
+  client.set_audio_format(ECA_AUDIO_FORMAT(2, 44100, ECA_AUDIO_FORMAT::sfmt_s16_le, true));
+  client.set_buffersize(audioio_db_server_test_buffersize);
+  client.open();
+
+  server.register_client(&client);
+  AUDIO_IO_DB_BUFFER* dbuf = server.get_client_buffer(&client);
+  dbuf->io_mode_rep = (mode == AUDIO_IO::io_read) ? AUDIO_IO::io_read : AUDIO_IO::io_write;
+  for(unsigned int n = 0; n < dbuf->sbufs_rep.size(); n++) {
+    dbuf->sbufs_rep[n]->number_of_channels(2);
+    dbuf->sbufs_rep[n]->length_in_samples(audioio_db_server_test_buffersize);
+  }
+
+  server.start();
+  server.wait_for_full();
+  size_t warmup = client.batches().size();
+
+  /* step: process one buffer per millisecond, like the engine */
+  for(int n = 0; n < audioio_db_server_test_rounds; n++) {
+    if (mode == AUDIO_IO::io_read) {
+      if (dbuf->read_space() > 0)
+	dbuf->advance_read_pointer();
+    }
+    else {
+      if (dbuf->write_space() > 0)
+	dbuf->advance_write_pointer();
+    }
+    server.signal_client_activity();
+    kvu_sleep(0, 1000000);
+  }
+
+  server.stop();
+  server.wait_for_stop();
+
+  vector<int> batches = client.batches();
+  int calls = 0, transferred = 0;
+  for(size_t n = warmup; n < batches.size(); n++) {
+    ++calls;
+    transferred += batches[n];
+  }
+
+  if (mode != AUDIO_IO::io_read &&
+      (dbuf->read_space() != 0 || transferred != audioio_db_server_test_rounds)) {
+    ECA_TEST_FAILURE(tag + ": output not drained at stop, " +
+		     kvu_numtostr(transferred) + " buffers written");
+  }
+
+  /* note: without batching, one buffer would be transferred
+   *       per call in steady state */
+  if (calls == 0 || transferred < calls * 4) {
+    ECA_TEST_FAILURE(tag + ": " + kvu_numtostr(transferred) +
+		     " buffers transferred in " + kvu_numtostr(calls) + " calls");
+  }
+
+  server.unregister_client(&client);
+  client.close();
+}
+
+void AUDIO_IO_DB_SERVER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  test_steady_state_batches(AUDIO_IO::io_read);
+  test_steady_state_batches(AUDIO_IO::io_write);
+}
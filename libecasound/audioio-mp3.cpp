@@ -43,12 +43,14 @@
 #include <sys/stat.h> /* stat() */
 #include <sys/wait.h>
 
+#include <kvu_dbc.h>
 #include <kvu_inttypes.h>
 #include <kvu_message_item.h>
 #include <kvu_numtostr.h>
 
 #include "audioio-mp3.h"
 #include "audioio-mp3_impl.h"
+#include "eca-audio-decoder.h"
 #include "samplebuffer.h"
 #include "audioio.h"
 
@@ -335,6 +337,7 @@ MP3FILE::MP3FILE(const std::string& name)
   filedes_rep = -1;
   filehandle_rep = 0;
   mono_input_rep = false;
+  decoder_repp = 0;
   pcm_rep = 1;
   bitrate_rep = MP3FILE::conf_default_output_bitrate;
 }
@@ -351,9 +354,11 @@ MP3FILE::~MP3FILE(void)
 void MP3FILE::open(void) throw(AUDIO_IO::SETUP_ERROR &)
 { 
   if (io_mode() == io_read) {
-    /* decoder supports: fixed channel count and sample format, 
-                         sample rate set by parsing mp3 header */
-    get_mp3_params(label());
+    if (open_decoder() != true) {
+      /* decoder supports: fixed channel count and sample format, 
+	                   sample rate set by parsing mp3 header */
+      get_mp3_params(label());
+    }
   }
   else {
     /* encoder supports: srate configurable, fixed channel
@@ -388,8 +393,40 @@ void MP3FILE::open(void) throw(AUDIO_IO::SETUP_ERROR &)
   AUDIO_IO::open();
 }
 
+/**
+ * Opens the file with an in-process decoder, if one 
+ * is available.
+ *
+ * @return true if decoder was opened
+ */
+bool MP3FILE::open_decoder(void)
+{
+  DBC_CHECK(decoder_repp == 0);
+  decoder_repp = ECA_AUDIO_DECODER::create("mp3");
+  if (decoder_repp == 0) return false;
+
+  if (decoder_repp->open(label()) != true) {
+    delete decoder_repp;
+    decoder_repp = 0;
+    return false;
+  }
+
+  set_channels(decoder_repp->channels());
+  set_samples_per_second(decoder_repp->samples_per_second());
+  set_sample_format(ECA_AUDIO_DECODER::sample_format);
+  if (decoder_repp->length_in_samples() >= 0)
+    set_length_in_samples(decoder_repp->length_in_samples());
+
+  return true;
+}
+
 void MP3FILE::close(void)
 {
+  if (decoder_repp != 0) {
+    delete decoder_repp;
+    decoder_repp = 0;
+  }
+
   if (pid_of_child() > 0) {
       ECA_LOG_MSG(ECA_LOGGER::user_objects, "Cleaning child process pid=" + kvu_numtostr(pid_of_child()) + ".");
       /* note: mp3 input/output can handle SIGTERM */
@@ -410,6 +447,13 @@ void MP3FILE::process_mono_fix(char* target_buffer, long int bytes) {
 
 long int MP3FILE::read_samples(void* target_buffer, long int samples)
 {
+  if (decoder_repp != 0) {
+    if (finished_rep == true) return 0;
+    long int res = decoder_repp->read(static_cast<float*>(target_buffer), samples);
+    finished_rep = (res < samples);
+    return res;
+  }
+
   if (triggered_rep != true) {
     ECA_LOG_MSG(ECA_LOGGER::info, "WARNING: triggering an external program in real-time context"); 
     triggered_rep = true;
@@ -467,6 +511,20 @@ void MP3FILE::write_samples(void* target_buffer, long int samples)
 SAMPLE_SPECS::sample_pos_t MP3FILE::seek_position(SAMPLE_SPECS::sample_pos_t pos)
 {
   finished_rep = false;
+  if (decoder_repp != 0) {
+    SAMPLE_SPECS::sample_pos_t res = decoder_repp->seek_or_rewind(pos);
+    if (res != pos) {
+      ECA_LOG_MSG(ECA_LOGGER::info, 
+		  "WARNING: seek to " + kvu_numtostr(pos) + 
+		  " failed for " + label() + ".");
+    }
+    if (res < 0) {
+      /* note: decoder state is unknown, stop reading */
+      finished_rep = true;
+      return pos;
+    }
+    return res;
+  }
   if (triggered_rep == true &&
       last_position_rep != pos) {
     if (is_open() == true) {
@@ -563,6 +621,8 @@ void MP3FILE::get_mp3_params(const std::string& fname) throw(AUDIO_IO::SETUP_ERR
 
 void MP3FILE::start_io(void)
 {
+  if (decoder_repp != 0) return;
+
   if (triggered_rep != true) {
     if (io_mode() == io_read) 
       fork_input_process();
@@ -7,10 +7,16 @@
 #include "audioio-forked-stream.h"
 #include "sample-specs.h"
 
+class ECA_AUDIO_DECODER;
+
 /**
  * Interface for mp3 decoders and encoders that support 
  * input/output using standard streams. Defaults to
  * mpg123 and lame.
+ *
+ * If available, files are decoded in-process with
+ * libmpg123 instead (see ECA_AUDIO_DECODER).
+ *
  * @author Kai Vehmanen
  */
 class MP3FILE : public AUDIO_IO_BUFFERED,
@@ -42,7 +48,7 @@ class MP3FILE : public AUDIO_IO_BUFFERED,
 
   virtual int supported_io_modes(void) const { return(io_read | io_write); }
   virtual bool supports_seeking(void) const { return io_mode() == io_read; }
-  virtual bool supports_seeking_sample_accurate(void) const { return false; }
+  virtual bool supports_seeking_sample_accurate(void) const { return decoder_repp != 0; }
 
   virtual void open(void) throw(AUDIO_IO::SETUP_ERROR &);
   virtual void close(void);
@@ -79,7 +85,9 @@ class MP3FILE : public AUDIO_IO_BUFFERED,
   int filedes_rep;
   FILE* filehandle_rep;
   bool mono_input_rep;
+  ECA_AUDIO_DECODER* decoder_repp;
   
+  bool open_decoder(void);
   void process_mono_fix(char* target_buffer, long int bytes_rep);
   void get_mp3_params(const std::string& fname) throw(AUDIO_IO::SETUP_ERROR&);
   
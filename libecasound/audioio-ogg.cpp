@@ -25,10 +25,12 @@
 #include <unistd.h> /* stat() */
 #include <sys/stat.h> /* stat() */
 
+#include <kvu_dbc.h>
 #include <kvu_message_item.h>
 #include <kvu_numtostr.h>
 
 #include "audioio-ogg.h"
+#include "eca-audio-decoder.h"
 
 #include "eca-logger.h"
 
@@ -44,6 +46,7 @@ OGG_VORBIS_INTERFACE::OGG_VORBIS_INTERFACE(const std::string& name)
     finished_rep(false)
 {
   set_label(name);
+  decoder_repp = 0;
   bitrate_rep = OGG_VORBIS_INTERFACE::default_output_default_bitrate;
 }
 
@@ -62,7 +65,11 @@ void OGG_VORBIS_INTERFACE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
   triggered_rep = false;
   finished_rep = false;
 
-  if (io_mode() == io_read) {
+  if (io_mode() == io_read && open_decoder() == true) {
+    /* decoder supports: channel count, srate and length 
+     *                   read from the stream */
+  }
+  else if (io_mode() == io_read) {
     struct stat buf;
     int ret = ::stat(label().c_str(), &buf);
     if (ret != 0) {
@@ -92,8 +99,40 @@ void OGG_VORBIS_INTERFACE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
   AUDIO_IO::open();
 }
 
+/**
+ * Opens the file with an in-process decoder, if one 
+ * is available.
+ *
+ * @return true if decoder was opened
+ */
+bool OGG_VORBIS_INTERFACE::open_decoder(void)
+{
+  DBC_CHECK(decoder_repp == 0);
+  decoder_repp = ECA_AUDIO_DECODER::create("vorbis");
+  if (decoder_repp == 0) return false;
+
+  if (decoder_repp->open(label()) != true) {
+    delete decoder_repp;
+    decoder_repp = 0;
+    return false;
+  }
+
+  set_channels(decoder_repp->channels());
+  set_samples_per_second(decoder_repp->samples_per_second());
+  set_sample_format(ECA_AUDIO_DECODER::sample_format);
+  if (decoder_repp->length_in_samples() >= 0)
+    set_length_in_samples(decoder_repp->length_in_samples());
+
+  return true;
+}
+
 void OGG_VORBIS_INTERFACE::close(void)
 {
+  if (decoder_repp != 0) {
+    delete decoder_repp;
+    decoder_repp = 0;
+  }
+
   if (pid_of_child() > 0) {
       ECA_LOG_MSG(ECA_LOGGER::user_objects, "Cleaning child process pid=" + kvu_numtostr(pid_of_child()) + ".");
       clean_child();
@@ -105,6 +144,13 @@ void OGG_VORBIS_INTERFACE::close(void)
 
 long int OGG_VORBIS_INTERFACE::read_samples(void* target_buffer, long int samples)
 {
+  if (decoder_repp != 0) {
+    if (finished_rep == true) return 0;
+    long int res = decoder_repp->read(static_cast<float*>(target_buffer), samples);
+    finished_rep = (res < samples);
+    return res;
+  }
+
   if (triggered_rep != true) { 
     ECA_LOG_MSG(ECA_LOGGER::info, "WARNING: triggering an external program in real-time context"); 
     triggered_rep = true;
@@ -165,6 +211,27 @@ void OGG_VORBIS_INTERFACE::write_samples(void* target_buffer, long int samples)
   }
 }
 
+SAMPLE_SPECS::sample_pos_t OGG_VORBIS_INTERFACE::seek_position(SAMPLE_SPECS::sample_pos_t pos)
+{
+  if (decoder_repp != 0) {
+    finished_rep = false;
+    SAMPLE_SPECS::sample_pos_t res = decoder_repp->seek_or_rewind(pos);
+    if (res != pos) {
+      ECA_LOG_MSG(ECA_LOGGER::info, 
+		  "WARNING: seek to " + kvu_numtostr(pos) + 
+		  " failed for " + label() + ".");
+    }
+    if (res < 0) {
+      /* note: decoder state is unknown, stop reading */
+      finished_rep = true;
+      return pos;
+    }
+    return res;
+  }
+
+  return AUDIO_IO::seek_position(pos);
+}
+
 void OGG_VORBIS_INTERFACE::set_parameter(int param, string value)
 {
   switch (param) {
@@ -251,6 +318,8 @@ void OGG_VORBIS_INTERFACE::fork_output_process(void)
 
 void OGG_VORBIS_INTERFACE::start_io(void)
 {
+  if (decoder_repp != 0) return;
+
   if (triggered_rep != true) {
     if (io_mode() == io_read) 
       fork_input_process();
@@ -6,10 +6,15 @@
 #include "audioio-buffered.h"
 #include "audioio-forked-stream.h"
 
+class ECA_AUDIO_DECODER;
+
 /**
  * Interface for Ogg Vorbis decoders and encoders using UNIX 
  * pipe i/o. By default ogg123 and vorbize are used.
  *
+ * If available, files are decoded in-process with
+ * libvorbisfile instead (see ECA_AUDIO_DECODER).
+ *
  * @author Kai Vehmanen
  */
 class OGG_VORBIS_INTERFACE : public AUDIO_IO_BUFFERED,
@@ -40,7 +45,8 @@ class OGG_VORBIS_INTERFACE : public AUDIO_IO_BUFFERED,
   virtual bool locked_audio_format(void) const { return true; }
 
   virtual int supported_io_modes(void) const { return io_read | io_write; }
-  virtual bool supports_seeking(void) const { return false; }
+  virtual bool supports_seeking(void) const { return decoder_repp != 0; }
+  virtual bool supports_seeking_sample_accurate(void) const { return decoder_repp != 0; }
 
   virtual void open(void) throw(AUDIO_IO::SETUP_ERROR &);
   virtual void close(void);
@@ -49,6 +55,7 @@ class OGG_VORBIS_INTERFACE : public AUDIO_IO_BUFFERED,
   virtual void write_samples(void* target_buffer, long int samples);
 
   virtual bool finished(void) const { return(finished_rep); }
+  virtual SAMPLE_SPECS::sample_pos_t seek_position(SAMPLE_SPECS::sample_pos_t pos);
 
   virtual void set_parameter(int param, std::string value);
   virtual std::string get_parameter(int param) const;
@@ -72,7 +79,9 @@ class OGG_VORBIS_INTERFACE : public AUDIO_IO_BUFFERED,
   long int bitrate_rep;
   int filedes_rep;
   FILE* f1_rep;
+  ECA_AUDIO_DECODER* decoder_repp;
   
+  bool open_decoder(void);
   void fork_input_process(void);
   void fork_output_process(void);
 };
@@ -27,6 +27,7 @@
 
 #include "audioio-buffered.h"
 #include "audioio-raw.h"
+#include "eca-fileio-uring.h"
 #include "eca-error.h"
 #include "eca-logger.h"
 
@@ -34,6 +35,7 @@ RAWFILE::RAWFILE(const std::string& name)
 {
   set_label(name);
   fio_repp = 0;
+  mmap_repp = 0;
   mmaptoggle_rep = "0";
 }
 
@@ -70,11 +72,25 @@ void RAWFILE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
       }
       else {
 	if (mmaptoggle_rep == "1") {
-	  ECA_LOG_MSG(ECA_LOGGER::user_objects, "(audioio-wave) using mmap() mode for file access");
-	  fio_repp = new ECA_FILE_IO_MMAP();
+	  ECA_LOG_MSG(ECA_LOGGER::user_objects, "(audioio-raw) using mmap() mode for file access");
+	  mmap_repp = new ECA_FILE_IO_MMAP();
+	  mmap_repp->open_file(label(),"rb");
+	  if (mmap_repp->is_file_ready() == true) {
+	    fio_repp = mmap_repp;
+	  }
+	  else {
+	    ECA_LOG_MSG(ECA_LOGGER::user_objects, "(audioio-raw) mmap() failed, using normal file access");
+	    delete mmap_repp;
+	    mmap_repp = 0;
+	  }
+	}
+	if (fio_repp == 0) {
+	  fio_repp = ECA_FILE_IO_URING::create(mmaptoggle_rep, label(), "rb");
+	}
+	if (fio_repp == 0) {
+	  fio_repp = new ECA_FILE_IO_STREAM();
+	  fio_repp->open_file(label(),"rb");
 	}
-	else fio_repp = new ECA_FILE_IO_STREAM();
-	fio_repp->open_file(label(),"rb");
 	if (fio_repp->is_file_ready() != true) {
 	  throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-RAW: Couldn't open file " + label() + " for reading."));
 	}
@@ -83,16 +99,21 @@ void RAWFILE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
     }
   case io_write: 
     {
-      fio_repp = new ECA_FILE_IO_STREAM();
       if (label() == "stdout" || label().at(0) == '-') {
+	fio_repp = new ECA_FILE_IO_STREAM();
 	std::cerr << "(audioio-raw) Outputting to standard output [w].\n";
 	fio_repp->open_stdout();
       }
       else if (label() == "stderr" || label().at(0) == '-') {
+	fio_repp = new ECA_FILE_IO_STREAM();
 	fio_repp->open_stderr();
       }
       else {
-	fio_repp->open_file(label(),"wb");
+	fio_repp = ECA_FILE_IO_URING::create(mmaptoggle_rep, label(), "wb");
+	if (fio_repp == 0) {
+	  fio_repp = new ECA_FILE_IO_STREAM();
+	  fio_repp->open_file(label(),"wb");
+	}
 	if (fio_repp->is_file_ready() != true) {
 	  throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-RAW: Couldn't open file " + label() + " for writing."));
 	}
@@ -128,6 +149,7 @@ void RAWFILE::close(void)
     fio_repp->close_file();
     delete fio_repp;
     fio_repp = 0;
+    mmap_repp = 0;
   }
 
   AUDIO_IO::close();
@@ -148,6 +170,19 @@ long int RAWFILE::read_samples(void* target_buffer, long int samples)
   return(fio_repp->file_bytes_processed() / frame_size());
 }
 
+/**
+ * In mmap() mode, sample data is converted directly from 
+ * the file mapping.
+ */
+long int RAWFILE::read_samples_in_place(unsigned char** source, long int samples)
+{
+  if (mmap_repp == 0)
+    return -1;
+
+  *source = const_cast<unsigned char*>(mmap_repp->read_in_place(frame_size() * samples));
+  return mmap_repp->file_bytes_processed() / frame_size();
+}
+
 void RAWFILE::write_samples(void* target_buffer, long int samples)
 {
   fio_repp->write_from_buffer(target_buffer, frame_size() * samples);  
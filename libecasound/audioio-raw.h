@@ -32,6 +32,7 @@ class RAWFILE : public AUDIO_IO_BUFFERED {
   virtual void close(void);
 
   virtual long int read_samples(void* target_buffer, long int samples);
+  virtual long int read_samples_in_place(unsigned char** source, long int samples);
   virtual void write_samples(void* target_buffer, long int samples);
 
   virtual bool finished(void) const;
@@ -43,6 +44,7 @@ class RAWFILE : public AUDIO_IO_BUFFERED {
 private:
 
   ECA_FILE_IO* fio_repp;
+  ECA_FILE_IO_MMAP* mmap_repp;
   std::string mmaptoggle_rep;
 
   RAWFILE(const RAWFILE& x) { }
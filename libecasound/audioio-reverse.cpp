@@ -188,8 +188,10 @@ void AUDIO_IO_REVERSE::read_buffer(SAMPLE_BUFFER* sbuf)
   SAMPLE_SPECS::sample_pos_t curpos = position_in_samples();
   SAMPLE_SPECS::sample_pos_t newpos = child()->length_in_samples() - curpos - buffersize();
   if (newpos <= 0) {
+    /* note: less than a full buffer left */
     child()->seek_position_in_samples(0);
-    read_count = -newpos;
+    read_count = buffersize() + newpos;
+    if (read_count < 0) read_count = 0;
     finished_rep = true;
   }
   else {
@@ -45,6 +45,7 @@
 
 #include "eca-fileio-mmap.h"
 #include "eca-fileio-stream.h"
+#include "eca-fileio-uring.h"
 
 #include "eca-logger.h"
 
@@ -106,6 +107,7 @@ WAVEFILE::WAVEFILE (const std::string& name)
 {
   set_label(name);
   fio_repp = 0;
+  mmap_repp = 0;
   mmaptoggle_rep = "0";
 }
 
@@ -160,13 +162,24 @@ void WAVEFILE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
     {
       if (mmaptoggle_rep == "1") {
 	ECA_LOG_MSG(ECA_LOGGER::user_objects, "using mmap() mode for file access");
-	fio_repp = new ECA_FILE_IO_MMAP();
+	mmap_repp = new ECA_FILE_IO_MMAP();
+	mmap_repp->open_file(label(), "rb");
+	if (mmap_repp->is_file_ready() == true) {
+	  fio_repp = mmap_repp;
+	}
+	else {
+	  ECA_LOG_MSG(ECA_LOGGER::user_objects, "mmap() failed, using normal file access");
+	  delete mmap_repp;
+	  mmap_repp = 0;
+	}
       }
-      else  fio_repp = new ECA_FILE_IO_STREAM();
       if (fio_repp == 0) {
-	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-WAVE: Critical error when opening file \"" + label() + "\" for reading."));
+	fio_repp = ECA_FILE_IO_URING::create(mmaptoggle_rep, label(), "rb");
+      }
+      if (fio_repp == 0) {
+	fio_repp = new ECA_FILE_IO_STREAM();
+	fio_repp->open_file(label(), "rb");
       }
-      fio_repp->open_file(label(), "rb");
       if (fio_repp->is_file_ready() != true) {
 	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-WAVE: Couldn't open file \"" + label() + "\" for reading."));
       }
@@ -178,11 +191,11 @@ void WAVEFILE::open(void) throw (AUDIO_IO::SETUP_ERROR &)
     }
   case io_write:
     {
-      fio_repp = new ECA_FILE_IO_STREAM();
+      fio_repp = ECA_FILE_IO_URING::create(mmaptoggle_rep, label(), "w+b");
       if (fio_repp == 0) {
-	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-WAVE: Critical error when opening file \"" + label() + "\" for writing."));
+	fio_repp = new ECA_FILE_IO_STREAM();
+	fio_repp->open_file(label(), "w+b");
       }
-      fio_repp->open_file(label(), "w+b");
       if (fio_repp->is_file_ready() != true) {
 	throw(SETUP_ERROR(SETUP_ERROR::io_mode, "AUDIOIO-WAVE: Couldn't open file \"" + label() + "\" for writing."));
       }
@@ -244,6 +257,7 @@ void WAVEFILE::close(void)
     fio_repp->close_file();
     delete fio_repp;
     fio_repp = 0;
+    mmap_repp = 0;
   }
 
   AUDIO_IO::close();
@@ -522,6 +536,23 @@ long int WAVEFILE::read_samples(void* target_buffer, long int samples)
   return fio_repp->file_bytes_processed() / frame_size();
 }
 
+/**
+ * In mmap() mode, sample data is converted directly from 
+ * the file mapping.
+ */
+long int WAVEFILE::read_samples_in_place(unsigned char** source, long int samples)
+{
+  if (mmap_repp == 0)
+    return -1;
+
+  if (length_set() == true &&
+      position_in_samples() + samples >= length_in_samples())
+    samples = length_in_samples() - position_in_samples();
+
+  *source = const_cast<unsigned char*>(mmap_repp->read_in_place(frame_size() * samples));
+  return mmap_repp->file_bytes_processed() / frame_size();
+}
+
 void WAVEFILE::write_samples(void* target_buffer, long int samples)
 {
   // --------
@@ -10,6 +10,8 @@
 #include "samplebuffer.h"
 #include "eca-fileio.h"
 
+class ECA_FILE_IO_MMAP;
+
 /**
  * Represents a RIFF WAVE -file (wav).
  *
@@ -53,6 +55,7 @@ class WAVEFILE : public AUDIO_IO_BUFFERED {
  private:
 
   ECA_FILE_IO* fio_repp;
+  ECA_FILE_IO_MMAP* mmap_repp;
 
   RH riff_header_rep;
   RF riff_format_rep;
@@ -112,6 +115,7 @@ class WAVEFILE : public AUDIO_IO_BUFFERED {
 
   virtual long int read_samples(void* target_buffer, long int samples);
   virtual void write_samples(void* target_buffer, long int samples);
+  virtual long int read_samples_in_place(unsigned char** source, long int samples);
 
   virtual bool finished(void) const;
   virtual SAMPLE_SPECS::sample_pos_t seek_position(SAMPLE_SPECS::sample_pos_t pos);
@@ -28,6 +28,7 @@
 #include <kvu_numtostr.h>
 
 #include "eca-error.h"
+#include "samplebuffer.h"
 #include "audioio.h"
 #include "eca-logger.h"
 
@@ -296,6 +297,34 @@ void AUDIO_IO::close(void)
   open_rep = false;
 }
 
+int AUDIO_IO::read_buffers(SAMPLE_BUFFER** sbufs, int count)
+{
+  DBC_REQUIRE(count > 0);
+
+  int n = 0;
+  while(n < count) {
+    read_buffer(sbufs[n]);
+    ++n;
+    if (finished() == true ||
+	sbufs[n - 1]->event_tag_test(SAMPLE_BUFFER::tag_end_of_stream) == true)
+      break;
+  }
+
+  DBC_ENSURE(n > 0 && n <= count);
+  return n;
+}
+
+void AUDIO_IO::write_buffers(SAMPLE_BUFFER** sbufs, int count)
+{
+  DBC_REQUIRE(count > 0);
+
+  for(int n = 0; n < count; n++) {
+    write_buffer(sbufs[n]);
+    if (finished() == true)
+      break;
+  }
+}
+
 // ===================================================================
 // Runtime information
 
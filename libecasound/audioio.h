@@ -218,6 +218,34 @@ class AUDIO_IO : public DYNAMIC_OBJECT<string>,
    */
   virtual void write_buffer(SAMPLE_BUFFER* sbuf) = 0;
 
+  /**
+   * Reads data to up to 'count' sample buffers, 'sbufs[0]' 
+   * first. The result is the same as calling read_buffer() 
+   * for each buffer in turn, but implementations may 
+   * transfer the data with fewer, larger requests. 
+   * Reading stops after the first buffer that reaches
+   * end of stream.
+   *
+   * The default implementation calls read_buffer().
+   *
+   * @return number of buffers filled
+   *
+   * @pre count > 0
+   * @post return value > 0 && return value <= count
+   */
+  virtual int read_buffers(SAMPLE_BUFFER** sbufs, int count);
+
+  /**
+   * Writes all data from 'count' sample buffers, 'sbufs[0]'
+   * first. Notes concerning read_buffers() also apply to
+   * this routine.
+   *
+   * The default implementation calls write_buffer().
+   *
+   * @pre count > 0
+   */
+  virtual void write_buffers(SAMPLE_BUFFER** sbufs, int count);
+
   /**
    * Opens the audio object (possibly in exclusive mode).
    * This routine is used for initializing external connections 
@@ -0,0 +1,258 @@
+// ------------------------------------------------------------------------
+// biquad-filter.cpp: Second-order IIR filter section for multiple channels
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstring>
+
+#include <kvu_dbc.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ECA_BIQUAD_SSE2 1
+#endif
+
+#include "sample-ops_impl.h"
+#include "biquad-filter.h"
+
+BIQUAD_FILTER::BIQUAD_FILTER(void)
+  : channels_rep(0)
+{
+  set_coefficients(1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void BIQUAD_FILTER::set_coefficients(sample_t a0, sample_t a1, sample_t a2, sample_t b0, sample_t b1)
+{
+  coefs_rep.a0 = a0;
+  coefs_rep.a1 = a1;
+  coefs_rep.a2 = a2;
+  coefs_rep.b0 = b0;
+  coefs_rep.b1 = b1;
+}
+
+/**
+ * Sets the number of channels and clears the filter state.
+ *
+ * @post channels() == channels
+ */
+void BIQUAD_FILTER::set_channels(int channels)
+{
+  // --
+  DBC_REQUIRE(channels >= 0);
+  // --
+
+  channels_rep = channels;
+  state_rep.resize((channels + group_size - 1) / group_size);
+  clear();
+
+  // --
+  DBC_ENSURE(BIQUAD_FILTER::channels() == channels);
+  // --
+}
+
+/**
+ * Resets the filter state of all channels.
+ */
+void BIQUAD_FILTER::clear(void)
+{
+  if (state_rep.size() > 0)
+    std::memset(&state_rep[0], 0, state_rep.size() * sizeof(State));
+}
+
+/**
+ * Filters 'frames' samples of each of the first 'channels'
+ * buffers in place.
+ *
+ * @pre channels <= BIQUAD_FILTER::channels()
+ */
+void BIQUAD_FILTER::process(sample_t* const* buffers, int channels, long int frames)
+{
+  // --
+  DBC_REQUIRE(channels <= channels_rep);
+  // --
+
+  for(int c = 0; c < channels; c += group_size) {
+    int lanes = channels - c;
+    if (lanes > group_size) lanes = group_size;
+    process_group(coefs_rep, &state_rep[c / group_size], buffers + c, lanes, frames);
+  }
+}
+
+#ifdef ECA_BIQUAD_SSE2
+
+/**
+ * Same as ecaops_flush_to_zero(), for four samples.
+ */
+static inline __m128 priv_flush_to_zero_sse2(__m128 v)
+{
+  const __m128i expmask = _mm_set1_epi32(0x7f800000);
+  const __m128i limit = _mm_set1_epi32(0x08000000);
+  __m128i exponent = _mm_and_si128(_mm_castps_si128(v), expmask);
+  __m128 tiny = _mm_castsi128_ps(_mm_cmplt_epi32(exponent, limit));
+  return _mm_andnot_ps(tiny, v);
+}
+
+/**
+ * Filters up to four channels, one frame at a time, with
+ * each channel in its own SIMD lane. Blocks of four frames
+ * are transposed to frame-major order, so loads and stores
+ * stay contiguous.
+ *
+ * Partial groups are run with the unused lanes fed with
+ * silence, so that all channels are computed identically
+ * regardless of the channel count.
+ */
+void BIQUAD_FILTER::process_group(const Coefficients& c, State* state, sample_t* const* buffers, int lanes, long int frames)
+{
+  const __m128 a0 = _mm_set1_ps(c.a0);
+  const __m128 a1 = _mm_set1_ps(c.a1);
+  const __m128 a2 = _mm_set1_ps(c.a2);
+  const __m128 b0 = _mm_set1_ps(c.b0);
+  const __m128 b1 = _mm_set1_ps(c.b1);
+
+  __m128 x1 = _mm_loadu_ps(state->x1);
+  __m128 x2 = _mm_loadu_ps(state->x2);
+  __m128 y1 = _mm_loadu_ps(state->y1);
+  __m128 y2 = _mm_loadu_ps(state->y2);
+
+#define ECA_BIQUAD_STEP(x)						\
+  do {									\
+    __m128 y = _mm_add_ps(_mm_mul_ps(a0, x), _mm_mul_ps(a1, x1));	\
+    y = _mm_add_ps(y, _mm_mul_ps(a2, x2));				\
+    y = _mm_sub_ps(y, _mm_mul_ps(b0, y1));				\
+    y = _mm_sub_ps(y, _mm_mul_ps(b1, y2));				\
+    y = priv_flush_to_zero_sse2(y);					\
+    x2 = x1;								\
+    x1 = x;								\
+    y2 = y1;								\
+    y1 = y;								\
+    x = y;								\
+  } while(0)
+
+  __m128 sx1 = x1, sx2 = x2, sy1 = y1, sy2 = y2;
+#define ECA_BIQUAD_SAVE()						\
+  do {									\
+    sx1 = x1; sx2 = x2; sy1 = y1; sy2 = y2;				\
+  } while(0)
+
+  /* note: the filter arithmetic is expanded only once, so
+   *       every channel and frame is rounded the same way
+   *       even when the compiler reassociates (-ffast-math);
+   *       partial groups and blocks go through a zero-padded
+   *       copy, with state saved after the last valid frame */
+  sample_t block[group_size][4];
+  for(long int n = 0; n < frames; n += 4) {
+    long int len = frames - n;
+    if (len > 4) len = 4;
+    bool direct = (lanes == group_size && len == 4);
+
+    __m128 f0, f1, f2, f3;
+    if (direct == true) {
+      f0 = _mm_loadu_ps(buffers[0] + n);
+      f1 = _mm_loadu_ps(buffers[1] + n);
+      f2 = _mm_loadu_ps(buffers[2] + n);
+      f3 = _mm_loadu_ps(buffers[3] + n);
+    }
+    else {
+      std::memset(block, 0, sizeof(block));
+      for(int k = 0; k < lanes; k++)
+	std::memcpy(block[k], buffers[k] + n, len * sizeof(sample_t));
+      f0 = _mm_loadu_ps(block[0]);
+      f1 = _mm_loadu_ps(block[1]);
+      f2 = _mm_loadu_ps(block[2]);
+      f3 = _mm_loadu_ps(block[3]);
+    }
+    _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+
+    ECA_BIQUAD_STEP(f0);
+    if (len == 1) ECA_BIQUAD_SAVE();
+    ECA_BIQUAD_STEP(f1);
+    if (len == 2) ECA_BIQUAD_SAVE();
+    ECA_BIQUAD_STEP(f2);
+    if (len == 3) ECA_BIQUAD_SAVE();
+    ECA_BIQUAD_STEP(f3);
+    if (len == 4) ECA_BIQUAD_SAVE();
+
+    _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+    if (direct == true) {
+      _mm_storeu_ps(buffers[0] + n, f0);
+      _mm_storeu_ps(buffers[1] + n, f1);
+      _mm_storeu_ps(buffers[2] + n, f2);
+      _mm_storeu_ps(buffers[3] + n, f3);
+    }
+    else {
+      _mm_storeu_ps(block[0], f0);
+      _mm_storeu_ps(block[1], f1);
+      _mm_storeu_ps(block[2], f2);
+      _mm_storeu_ps(block[3], f3);
+      for(int k = 0; k < lanes; k++)
+	std::memcpy(buffers[k] + n, block[k], len * sizeof(sample_t));
+    }
+  }
+
+#undef ECA_BIQUAD_SAVE
+#undef ECA_BIQUAD_STEP
+
+  _mm_storeu_ps(state->x1, sx1);
+  _mm_storeu_ps(state->x2, sx2);
+  _mm_storeu_ps(state->y1, sy1);
+  _mm_storeu_ps(state->y2, sy2);
+}
+
+#else
+
+/**
+ * Filters one channel. State is kept in registers for
+ * the duration of the block.
+ */
+void BIQUAD_FILTER::process_channel(const Coefficients& c, State* state, int lane, sample_t* buffer, long int frames)
+{
+  sample_t x1 = state->x1[lane];
+  sample_t x2 = state->x2[lane];
+  sample_t y1 = state->y1[lane];
+  sample_t y2 = state->y2[lane];
+
+  for(long int n = 0; n < frames; n++) {
+    sample_t x = buffer[n];
+    sample_t y = ecaops_flush_to_zero(c.a0 * x +
+				      c.a1 * x1 +
+				      c.a2 * x2 -
+				      c.b0 * y1 -
+				      c.b1 * y2);
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    buffer[n] = y;
+  }
+
+  state->x1[lane] = x1;
+  state->x2[lane] = x2;
+  state->y1[lane] = y1;
+  state->y2[lane] = y2;
+}
+
+void BIQUAD_FILTER::process_group(const Coefficients& c, State* state, sample_t* const* buffers, int lanes, long int frames)
+{
+  for(int lane = 0; lane < lanes; lane++)
+    process_channel(c, state, lane, buffers[lane], frames);
+}
+
+#endif /* ECA_BIQUAD_SSE2 */
@@ -0,0 +1,89 @@
+#ifndef INCLUDED_BIQUAD_FILTER_H
+#define INCLUDED_BIQUAD_FILTER_H
+
+#include <vector>
+
+#include "sample-specs.h"
+
+/**
+ * Second-order IIR filter section for multiple channels.
+ *
+ * Computes the difference equation
+ *
+ *   y[n] = a0*x[n] + a1*x[n-1] + a2*x[n-2] - b0*y[n-1] - b1*y[n-2]
+ *
+ * separately for each channel. Coefficients are shared by
+ * all channels.
+ *
+ * Filter state is stored in one flat array, in groups of
+ * four channels. Channels are processed a whole block at a
+ * time, and where supported, four channels are processed in
+ * parallel using SIMD lanes.
+ */
+class BIQUAD_FILTER {
+
+ public:
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  BIQUAD_FILTER(void);
+
+  /*@}*/
+
+  /** @name Public functions for configuration */
+  /*@{*/
+
+  void set_coefficients(sample_t a0, sample_t a1, sample_t a2, sample_t b0, sample_t b1);
+  void set_channels(int channels);
+  void clear(void);
+
+  /*@}*/
+
+  /** @name Public functions for processing */
+  /*@{*/
+
+  void process(sample_t* const* buffers, int channels, long int frames);
+
+  /*@}*/
+
+  /** @name Public functions for acquiring status information */
+  /*@{*/
+
+  int channels(void) const { return channels_rep; }
+
+  /*@}*/
+
+ private:
+
+  /**
+   * Number of channels in one state group.
+   */
+  static const int group_size = 4;
+
+  /**
+   * Filter state of one group of channels. Each member
+   * holds one value per channel.
+   */
+  struct State {
+    sample_t x1[group_size];
+    sample_t x2[group_size];
+    sample_t y1[group_size];
+    sample_t y2[group_size];
+  };
+
+  struct Coefficients {
+    sample_t a0, a1, a2, b0, b1;
+  };
+
+  static void process_channel(const Coefficients& c, State* state, int lane, sample_t* buffer, long int frames);
+  static void process_group(const Coefficients& c, State* state, sample_t* const* buffers, int lanes, long int frames);
+
+  Coefficients coefs_rep;
+  std::vector<State> state_rep;
+  int channels_rep;
+};
+
+#endif
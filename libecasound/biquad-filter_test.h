@@ -0,0 +1,113 @@
+// ------------------------------------------------------------------------
+// biquad-filter_test.h: Unit test for BIQUAD_FILTER
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "kvu_numtostr.h"
+
+#include "biquad-filter.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for BIQUAD_FILTER
+ */
+class BIQUAD_FILTER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("BIQUAD_FILTER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~BIQUAD_FILTER_TEST(void) { }
+
+private:
+
+};
+
+void BIQUAD_FILTER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for BIQUAD_FILTER class\n",
+	       __FILE__);
+
+  typedef BIQUAD_FILTER::sample_t sample_t;
+
+  /* note: 7 channels, so both the grouped and the
+   *       per-channel code paths are used */
+  const int channels = 7;
+  const long int frames = 67;
+  const sample_t a0 = 0.2f, a1 = 0.4f, a2 = 0.2f, b0 = -0.6f, b1 = 0.25f;
+
+  vector<vector<sample_t> > input (channels, vector<sample_t> (frames));
+  std::srand(1);
+  for(int c = 0; c < channels; c++)
+    for(long int n = 0; n < frames; n++)
+      input[c][n] = (std::rand() / (sample_t)RAND_MAX) - 0.5f;
+
+  /* case: block processing, with the block split at an odd
+   *       offset, matches a direct evaluation of the
+   *       difference equation */
+  vector<vector<sample_t> > output (input);
+  vector<sample_t*> buffers (channels);
+  for(int c = 0; c < channels; c++)
+    buffers[c] = &output[c][0];
+
+  BIQUAD_FILTER filter;
+  filter.set_channels(channels);
+  filter.set_coefficients(a0, a1, a2, b0, b1);
+  filter.process(&buffers[0], channels, 5);
+  for(int c = 0; c < channels; c++)
+    buffers[c] += 5;
+  filter.process(&buffers[0], channels, frames - 5);
+
+  for(int c = 0; c < channels; c++) {
+    sample_t x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    for(long int n = 0; n < frames; n++) {
+      sample_t x = input[c][n];
+      sample_t y = a0 * x + a1 * x1 + a2 * x2 - b0 * y1 - b1 * y2;
+      x2 = x1; x1 = x;
+      y2 = y1; y1 = y;
+      if (std::fabs(output[c][n] - y) > 1e-6f) {
+	ECA_TEST_FAILURE("channel " + kvu_numtostr(c) +
+			 ", sample " + kvu_numtostr(n));
+	break;
+      }
+    }
+  }
+
+  /* case: clear resets the state */
+  filter.clear();
+  vector<sample_t> silence (4, 0.0f);
+  for(int c = 0; c < channels; c++)
+    buffers[c] = &silence[0];
+  filter.process(&buffers[0], 1, 4);
+  for(int n = 0; n < 4; n++) {
+    if (silence[n] != 0.0f) {
+      ECA_TEST_FAILURE("clear, sample " + kvu_numtostr(n));
+      break;
+    }
+  }
+}
@@ -0,0 +1,119 @@
+// ------------------------------------------------------------------------
+// delay-line.cpp: Circular delay line of audio samples
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstring>
+
+#include <kvu_dbc.h>
+
+#include "delay-line.h"
+
+DELAY_LINE::DELAY_LINE(void)
+  : buffer_rep(1, 0.0f),
+    mask_rep(0),
+    pos_rep(0),
+    filled_rep(0)
+{
+}
+
+/**
+ * Makes sure that samples up to 'delay' writes ago can
+ * be read. Capacity is never reduced. When the line is
+ * grown, previously written samples are preserved.
+ *
+ * @post capacity() >= delay
+ */
+void DELAY_LINE::reserve(long int delay)
+{
+  long int size = 1;
+  while(size < delay)
+    size <<= 1;
+
+  if (size <= capacity())
+    return;
+
+  std::vector<sample_t> newbuf (size, 0.0f);
+  read_block(&newbuf[0], filled_rep, filled_rep);
+  buffer_rep.swap(newbuf);
+
+  mask_rep = size - 1;
+  pos_rep = filled_rep & mask_rep;
+
+  // --
+  DBC_ENSURE(capacity() >= delay);
+  // --
+}
+
+/**
+ * Discards all written samples.
+ *
+ * @post filled() == 0
+ */
+void DELAY_LINE::clear(void)
+{
+  for(size_t n = 0; n < buffer_rep.size(); n++)
+    buffer_rep[n] = 0.0f;
+  pos_rep = 0;
+  filled_rep = 0;
+}
+
+/**
+ * Appends 'len' samples from 'source' to the delay line.
+ * If 'len' exceeds capacity(), only the last samples
+ * are stored.
+ */
+void DELAY_LINE::write_block(const sample_t* source, long int len)
+{
+  if (len > capacity()) {
+    source += len - capacity();
+    len = capacity();
+  }
+
+  long int first = capacity() - pos_rep;
+  if (first > len) first = len;
+  std::memcpy(&buffer_rep[pos_rep], source, first * sizeof(sample_t));
+  std::memcpy(&buffer_rep[0], source + first, (len - first) * sizeof(sample_t));
+
+  pos_rep = (pos_rep + len) & mask_rep;
+  filled_rep += len;
+  if (filled_rep > capacity()) filled_rep = capacity();
+}
+
+/**
+ * Copies 'len' consecutive samples to 'target', starting
+ * from the sample written 'delay' writes ago. In other
+ * words target[n] equals read(delay - n).
+ *
+ * @pre len <= delay && delay <= capacity()
+ */
+void DELAY_LINE::read_block(sample_t* target, long int delay, long int len) const
+{
+  // --
+  DBC_REQUIRE(len <= delay);
+  DBC_REQUIRE(delay <= capacity());
+  // --
+
+  long int start = (pos_rep - delay) & mask_rep;
+  long int first = capacity() - start;
+  if (first > len) first = len;
+  std::memcpy(target, &buffer_rep[start], first * sizeof(sample_t));
+  std::memcpy(target + first, &buffer_rep[0], (len - first) * sizeof(sample_t));
+}
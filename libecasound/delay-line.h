@@ -0,0 +1,90 @@
+#ifndef INCLUDED_DELAY_LINE_H
+#define INCLUDED_DELAY_LINE_H
+
+#include <vector>
+
+#include "sample-specs.h"
+
+/**
+ * Circular delay line of audio samples.
+ *
+ * Storage is a power-of-two sized ring, so reading and
+ * writing single samples is just a masked index operation.
+ * Memory is only allocated in reserve(), which should be
+ * called from the owning operator's init(), never from
+ * set_parameter() or while processing.
+ *
+ * Delays are counted relative to the next write position:
+ * read(1) returns the most recently written sample.
+ * Positions that have not been written to since the
+ * line was cleared read as zero.
+ */
+class DELAY_LINE {
+
+ public:
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  DELAY_LINE(void);
+
+  /*@}*/
+
+  /** @name Public functions for configuration */
+  /*@{*/
+
+  void reserve(long int delay);
+  void clear(void);
+
+  /*@}*/
+
+  /** @name Public functions for reading and writing samples */
+  /*@{*/
+
+  /**
+   * Appends 'value' to the delay line.
+   */
+  inline void write(sample_t value) {
+    buffer_rep[pos_rep] = value;
+    pos_rep = (pos_rep + 1) & mask_rep;
+    if (filled_rep <= mask_rep) ++filled_rep;
+  }
+
+  /**
+   * Returns the sample written 'delay' writes ago.
+   *
+   * @pre delay >= 1 && delay <= capacity()
+   */
+  inline sample_t read(long int delay) const {
+    return buffer_rep[(pos_rep - delay) & mask_rep];
+  }
+
+  void write_block(const sample_t* source, long int len);
+  void read_block(sample_t* target, long int delay, long int len) const;
+
+  /*@}*/
+
+  /** @name Public functions for acquiring status information */
+  /*@{*/
+
+  long int capacity(void) const { return mask_rep + 1; }
+
+  /**
+   * Number of samples written since the line was
+   * cleared, saturated at capacity().
+   */
+  long int filled(void) const { return filled_rep; }
+
+  /*@}*/
+
+ private:
+
+  std::vector<sample_t> buffer_rep;
+  long int mask_rep;
+  long int pos_rep;
+  long int filled_rep;
+};
+
+#endif
@@ -0,0 +1,104 @@
+// ------------------------------------------------------------------------
+// delay-line_test.h: Unit test for DELAY_LINE
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "kvu_numtostr.h"
+
+#include "delay-line.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for DELAY_LINE
+ */
+class DELAY_LINE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("DELAY_LINE"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~DELAY_LINE_TEST(void) { }
+
+private:
+
+};
+
+void DELAY_LINE_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for DELAY_LINE class\n",
+	       __FILE__);
+
+  DELAY_LINE line;
+
+  /* case: capacity is rounded up to a power of two */
+  line.reserve(5);
+  if (line.capacity() != 8)
+    ECA_TEST_FAILURE("reserve, capacity " + kvu_numtostr(line.capacity()));
+
+  /* case: single samples, wrapping around the ring */
+  for(int n = 0; n < 20; n++) {
+    line.write(n);
+    if (line.read(1) != n)
+      ECA_TEST_FAILURE("write/read, sample " + kvu_numtostr(n));
+    if (n >= 4 && line.read(5) != n - 4)
+      ECA_TEST_FAILURE("delayed read, sample " + kvu_numtostr(n));
+  }
+  if (line.filled() != line.capacity())
+    ECA_TEST_FAILURE("filled, " + kvu_numtostr(line.filled()));
+
+  /* case: growing preserves the written samples */
+  line.reserve(20);
+  if (line.capacity() != 32)
+    ECA_TEST_FAILURE("grow, capacity " + kvu_numtostr(line.capacity()));
+  if (line.filled() != 8)
+    ECA_TEST_FAILURE("grow, filled " + kvu_numtostr(line.filled()));
+  for(int n = 1; n <= 8; n++) {
+    if (line.read(n) != 20 - n) {
+      ECA_TEST_FAILURE("grow, read " + kvu_numtostr(n));
+      break;
+    }
+  }
+
+  /* case: block writes and reads across the ring boundary */
+  vector<DELAY_LINE::sample_t> src (24), dst (24);
+  for(int n = 0; n < 24; n++)
+    src[n] = 100 + n;
+  line.write_block(&src[0], 24);
+  line.write_block(&src[0], 10);
+  line.read_block(&dst[0], 24, 24);
+  for(int n = 0; n < 24; n++) {
+    DELAY_LINE::sample_t expected = (n < 14) ? 110 + n : 100 + n - 14;
+    if (dst[n] != expected) {
+      ECA_TEST_FAILURE("block read, sample " + kvu_numtostr(n));
+      break;
+    }
+  }
+
+  /* case: clear */
+  line.clear();
+  if (line.filled() != 0 || line.read(1) != 0.0f)
+    ECA_TEST_FAILURE("clear");
+}
@@ -0,0 +1,236 @@
+// ------------------------------------------------------------------------
+// eca-audio-decoder-flac.cpp: FLAC decoder using libFLAC
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// References:
+//     https://xiph.org/flac/api/group__flac__stream__decoder.html
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ECA_COMPILE_LIBFLAC
+
+#include <string>
+#include <vector>
+#include <cstring> /* memcpy */
+
+#include <FLAC/stream_decoder.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "eca-audio-decoder-flac.h"
+#include "eca-logger.h"
+
+class ECA_AUDIO_DECODER_FLAC_impl {
+public:
+  FLAC__StreamDecoder* decoder_repp;
+  int channels_rep;
+  long int srate_rep;
+  int bits_rep;
+  SAMPLE_SPECS::sample_pos_t length_rep;
+  bool error_rep;
+
+  /* decoded, interleaved samples not yet returned by read() */
+  std::vector<float> pending_rep;
+  size_t pending_pos_rep;
+};
+
+static FLAC__StreamDecoderWriteStatus eca_audio_decoder_flac_write(const FLAC__StreamDecoder* decoder,
+								    const FLAC__Frame* frame,
+								    const FLAC__int32* const buffer[],
+								    void* client_data)
+{
+  ECA_AUDIO_DECODER_FLAC_impl* impl = static_cast<ECA_AUDIO_DECODER_FLAC_impl*>(client_data);
+
+  if (static_cast<int>(frame->header.channels) != impl->channels_rep) {
+    impl->error_rep = true;
+    return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+  }
+
+  /* note: drop already consumed samples before appending */
+  if (impl->pending_pos_rep > 0) {
+    impl->pending_rep.erase(impl->pending_rep.begin(),
+			    impl->pending_rep.begin() + impl->pending_pos_rep);
+    impl->pending_pos_rep = 0;
+  }
+
+  const int ch = impl->channels_rep;
+  const unsigned int blocksize = frame->header.blocksize;
+  const float scale = 1.0f / static_cast<float>(1UL << (frame->header.bits_per_sample - 1));
+
+  size_t offset = impl->pending_rep.size();
+  impl->pending_rep.resize(offset + blocksize * ch);
+  float* out = &impl->pending_rep[offset];
+  for(unsigned int i = 0; i < blocksize; i++) {
+    for(int c = 0; c < ch; c++) {
+      *out++ = static_cast<float>(buffer[c][i]) * scale;
+    }
+  }
+
+  return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void eca_audio_decoder_flac_metadata(const FLAC__StreamDecoder* decoder,
+					    const FLAC__StreamMetadata* metadata,
+					    void* client_data)
+{
+  ECA_AUDIO_DECODER_FLAC_impl* impl = static_cast<ECA_AUDIO_DECODER_FLAC_impl*>(client_data);
+
+  if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
+    impl->channels_rep = metadata->data.stream_info.channels;
+    impl->srate_rep = metadata->data.stream_info.sample_rate;
+    impl->bits_rep = metadata->data.stream_info.bits_per_sample;
+    /* note: zero means the length is unknown */
+    if (metadata->data.stream_info.total_samples > 0)
+      impl->length_rep = metadata->data.stream_info.total_samples;
+  }
+}
+
+static void eca_audio_decoder_flac_error(const FLAC__StreamDecoder* decoder,
+					 FLAC__StreamDecoderErrorStatus status,
+					 void* client_data)
+{
+  ECA_LOG_MSG(ECA_LOGGER::errors,
+	      std::string("libFLAC decoding error: ") +
+	      FLAC__StreamDecoderErrorStatusString[status]);
+}
+
+ECA_AUDIO_DECODER_FLAC::ECA_AUDIO_DECODER_FLAC(void)
+{
+  impl_repp = new ECA_AUDIO_DECODER_FLAC_impl;
+  impl_repp->decoder_repp = 0;
+}
+
+ECA_AUDIO_DECODER_FLAC::~ECA_AUDIO_DECODER_FLAC(void)
+{
+  close();
+  delete impl_repp;
+}
+
+bool ECA_AUDIO_DECODER_FLAC::open(const std::string& fname)
+{
+  DBC_REQUIRE(impl_repp->decoder_repp == 0);
+
+  impl_repp->channels_rep = 0;
+  impl_repp->srate_rep = 0;
+  impl_repp->bits_rep = 0;
+  impl_repp->length_rep = -1;
+  impl_repp->error_rep = false;
+  impl_repp->pending_rep.clear();
+  impl_repp->pending_pos_rep = 0;
+
+  impl_repp->decoder_repp = FLAC__stream_decoder_new();
+  if (impl_repp->decoder_repp == 0)
+    return false;
+
+  FLAC__StreamDecoderInitStatus res =
+    FLAC__stream_decoder_init_file(impl_repp->decoder_repp,
+				   fname.c_str(),
+				   eca_audio_decoder_flac_write,
+				   eca_audio_decoder_flac_metadata,
+				   eca_audio_decoder_flac_error,
+				   impl_repp);
+  if (res != FLAC__STREAM_DECODER_INIT_STATUS_OK ||
+      FLAC__stream_decoder_process_until_end_of_metadata(impl_repp->decoder_repp) != true ||
+      impl_repp->channels_rep < 1 ||
+      impl_repp->bits_rep < 4 || impl_repp->bits_rep > 32) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: libFLAC can't decode \"" + fname + "\".");
+    close();
+    return false;
+  }
+
+  set_stream_info(impl_repp->channels_rep, impl_repp->srate_rep, impl_repp->length_rep);
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "libFLAC: " + fname + ", " + kvu_numtostr(impl_repp->channels_rep) +
+	      " channel(s), " + kvu_numtostr(impl_repp->srate_rep) + "Hz, " +
+	      kvu_numtostr(impl_repp->bits_rep) + "bit, " +
+	      kvu_numtostr(static_cast<long int>(impl_repp->length_rep)) + " frames");
+
+  return true;
+}
+
+void ECA_AUDIO_DECODER_FLAC::close(void)
+{
+  if (impl_repp->decoder_repp != 0) {
+    FLAC__stream_decoder_finish(impl_repp->decoder_repp);
+    FLAC__stream_decoder_delete(impl_repp->decoder_repp);
+    impl_repp->decoder_repp = 0;
+  }
+  impl_repp->pending_rep.clear();
+  impl_repp->pending_pos_rep = 0;
+}
+
+long int ECA_AUDIO_DECODER_FLAC::read(float* target, long int frames)
+{
+  DBC_REQUIRE(impl_repp->decoder_repp != 0);
+
+  const int ch = impl_repp->channels_rep;
+  long int total = 0;
+
+  while(total < frames) {
+    size_t avail = (impl_repp->pending_rep.size() - impl_repp->pending_pos_rep) / ch;
+    if (avail > 0) {
+      size_t count = avail;
+      if (count > static_cast<size_t>(frames - total))
+	count = frames - total;
+      std::memcpy(target + total * ch,
+		  &impl_repp->pending_rep[impl_repp->pending_pos_rep],
+		  count * ch * sizeof(float));
+      impl_repp->pending_pos_rep += count * ch;
+      total += count;
+      continue;
+    }
+
+    if (impl_repp->error_rep == true ||
+	FLAC__stream_decoder_get_state(impl_repp->decoder_repp) ==
+	FLAC__STREAM_DECODER_END_OF_STREAM ||
+	FLAC__stream_decoder_process_single(impl_repp->decoder_repp) != true)
+      break;
+  }
+
+  return total;
+}
+
+bool ECA_AUDIO_DECODER_FLAC::seek(SAMPLE_SPECS::sample_pos_t pos)
+{
+  DBC_REQUIRE(impl_repp->decoder_repp != 0);
+
+  impl_repp->pending_rep.clear();
+  impl_repp->pending_pos_rep = 0;
+
+  /* note: libFLAC passes the frame containing 'pos' to the
+   *       write callback, starting exactly at 'pos' */
+  if (FLAC__stream_decoder_seek_absolute(impl_repp->decoder_repp, pos) != true) {
+    if (FLAC__stream_decoder_get_state(impl_repp->decoder_repp) ==
+	FLAC__STREAM_DECODER_SEEK_ERROR) {
+      FLAC__stream_decoder_flush(impl_repp->decoder_repp);
+    }
+    return false;
+  }
+
+  return true;
+}
+
+#endif /* ECA_COMPILE_LIBFLAC */
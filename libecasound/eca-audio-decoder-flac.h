@@ -0,0 +1,34 @@
+#ifndef INCLUDED_ECA_AUDIO_DECODER_FLAC_H
+#define INCLUDED_ECA_AUDIO_DECODER_FLAC_H
+
+#include <string>
+
+#include "eca-audio-decoder.h"
+
+class ECA_AUDIO_DECODER_FLAC_impl;
+
+/**
+ * FLAC decoder using libFLAC.
+ *
+ * Decoded frames are converted to floats and queued
+ * in a decode buffer, from which read() requests are
+ * served.
+ */
+class ECA_AUDIO_DECODER_FLAC : public ECA_AUDIO_DECODER {
+
+ public:
+
+  ECA_AUDIO_DECODER_FLAC(void);
+  virtual ~ECA_AUDIO_DECODER_FLAC(void);
+
+  virtual bool open(const std::string& fname);
+  virtual void close(void);
+  virtual long int read(float* target, long int frames);
+  virtual bool seek(SAMPLE_SPECS::sample_pos_t pos);
+
+ private:
+
+  ECA_AUDIO_DECODER_FLAC_impl* impl_repp;
+};
+
+#endif
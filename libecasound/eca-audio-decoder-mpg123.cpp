@@ -0,0 +1,168 @@
+// ------------------------------------------------------------------------
+// eca-audio-decoder-mpg123.cpp: MPEG audio decoder using libmpg123
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// References:
+//     https://www.mpg123.de/api/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ECA_COMPILE_MPG123
+
+#include <string>
+#include <cstdio> /* SEEK_SET */
+
+#include <pthread.h>
+#include <mpg123.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "eca-audio-decoder-mpg123.h"
+#include "eca-logger.h"
+
+class ECA_AUDIO_DECODER_MPG123_impl {
+public:
+  mpg123_handle* handle_repp;
+};
+
+static pthread_once_t eca_audio_decoder_mpg123_once = PTHREAD_ONCE_INIT;
+
+static void eca_audio_decoder_mpg123_init(void)
+{
+  /* note: a no-op since libmpg123 1.27, but required by
+   *       older versions before any handles are created */
+  mpg123_init();
+}
+
+ECA_AUDIO_DECODER_MPG123::ECA_AUDIO_DECODER_MPG123(void)
+{
+  impl_repp = new ECA_AUDIO_DECODER_MPG123_impl;
+  impl_repp->handle_repp = 0;
+}
+
+ECA_AUDIO_DECODER_MPG123::~ECA_AUDIO_DECODER_MPG123(void)
+{
+  close();
+  delete impl_repp;
+}
+
+bool ECA_AUDIO_DECODER_MPG123::open(const std::string& fname)
+{
+  DBC_REQUIRE(impl_repp->handle_repp == 0);
+
+  pthread_once(&eca_audio_decoder_mpg123_once, eca_audio_decoder_mpg123_init);
+
+  int err = MPG123_OK;
+  mpg123_handle* mh = mpg123_new(0, &err);
+  if (mh == 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Unable to create a libmpg123 decoder: " +
+		std::string(mpg123_plain_strerror(err)));
+    return false;
+  }
+  impl_repp->handle_repp = mh;
+
+  mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET | MPG123_GAPLESS, 0.0);
+
+  /* note: only float output is accepted, so that
+   *       mpg123 does not clip or dither */
+  const long* rates = 0;
+  size_t nrates = 0;
+  mpg123_rates(&rates, &nrates);
+  mpg123_format_none(mh);
+  for(size_t n = 0; n < nrates; n++) {
+    mpg123_format(mh, rates[n], MPG123_MONO | MPG123_STEREO, MPG123_ENC_FLOAT_32);
+  }
+
+  long int srate = 0;
+  int channels = 0, encoding = 0;
+  if (mpg123_open(mh, fname.c_str()) != MPG123_OK ||
+      mpg123_scan(mh) != MPG123_OK ||
+      mpg123_getformat(mh, &srate, &channels, &encoding) != MPG123_OK ||
+      encoding != MPG123_ENC_FLOAT_32) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: libmpg123 can't decode \"" + fname + "\": " +
+		std::string(mpg123_strerror(mh)));
+    close();
+    return false;
+  }
+
+  /* note: format is now fixed for the whole stream */
+  mpg123_format_none(mh);
+  mpg123_format(mh, srate, channels, encoding);
+
+  off_t length = mpg123_length(mh);
+  set_stream_info(channels, srate, length >= 0 ? length : -1);
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "libmpg123: " + fname + ", " + kvu_numtostr(channels) +
+	      " channel(s), " + kvu_numtostr(srate) + "Hz, " +
+	      kvu_numtostr(static_cast<long int>(length)) + " frames");
+
+  return true;
+}
+
+void ECA_AUDIO_DECODER_MPG123::close(void)
+{
+  if (impl_repp->handle_repp != 0) {
+    mpg123_close(impl_repp->handle_repp);
+    mpg123_delete(impl_repp->handle_repp);
+    impl_repp->handle_repp = 0;
+  }
+}
+
+long int ECA_AUDIO_DECODER_MPG123::read(float* target, long int frames)
+{
+  DBC_REQUIRE(impl_repp->handle_repp != 0);
+
+  const size_t frame_bytes = sizeof(float) * channels();
+  unsigned char* out = reinterpret_cast<unsigned char*>(target);
+  size_t total = 0, wanted = frame_bytes * frames;
+
+  while(total < wanted) {
+    size_t done = 0;
+    int res = mpg123_read(impl_repp->handle_repp, out + total, wanted - total, &done);
+    total += done;
+    if (res == MPG123_DONE) break;
+    if (res != MPG123_OK && res != MPG123_NEW_FORMAT) {
+      ECA_LOG_MSG(ECA_LOGGER::errors,
+		  "libmpg123 decoding error: " +
+		  std::string(mpg123_strerror(impl_repp->handle_repp)));
+      break;
+    }
+    if (done == 0 && res == MPG123_OK) break;
+  }
+
+  return total / frame_bytes;
+}
+
+bool ECA_AUDIO_DECODER_MPG123::seek(SAMPLE_SPECS::sample_pos_t pos)
+{
+  DBC_REQUIRE(impl_repp->handle_repp != 0);
+
+  off_t res = mpg123_seek(impl_repp->handle_repp, pos, SEEK_SET);
+  return res == pos;
+}
+
+#endif /* ECA_COMPILE_MPG123 */
@@ -0,0 +1,34 @@
+#ifndef INCLUDED_ECA_AUDIO_DECODER_MPG123_H
+#define INCLUDED_ECA_AUDIO_DECODER_MPG123_H
+
+#include <string>
+
+#include "eca-audio-decoder.h"
+
+class ECA_AUDIO_DECODER_MPG123_impl;
+
+/**
+ * MPEG audio (mp3, mp2) decoder using libmpg123.
+ *
+ * The stream is scanned when opened, so that length
+ * and seek positions are exact, and encoder delay and
+ * padding are removed (gapless decoding).
+ */
+class ECA_AUDIO_DECODER_MPG123 : public ECA_AUDIO_DECODER {
+
+ public:
+
+  ECA_AUDIO_DECODER_MPG123(void);
+  virtual ~ECA_AUDIO_DECODER_MPG123(void);
+
+  virtual bool open(const std::string& fname);
+  virtual void close(void);
+  virtual long int read(float* target, long int frames);
+  virtual bool seek(SAMPLE_SPECS::sample_pos_t pos);
+
+ private:
+
+  ECA_AUDIO_DECODER_MPG123_impl* impl_repp;
+};
+
+#endif
@@ -0,0 +1,149 @@
+// ------------------------------------------------------------------------
+// eca-audio-decoder-vorbis.cpp: Ogg Vorbis decoder using libvorbisfile
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// References:
+//     https://xiph.org/vorbis/doc/vorbisfile/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ECA_COMPILE_VORBISFILE
+
+#include <string>
+
+#include <vorbis/vorbisfile.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "eca-audio-decoder-vorbis.h"
+#include "eca-logger.h"
+
+class ECA_AUDIO_DECODER_VORBIS_impl {
+public:
+  OggVorbis_File file_rep;
+  bool open_rep;
+};
+
+ECA_AUDIO_DECODER_VORBIS::ECA_AUDIO_DECODER_VORBIS(void)
+{
+  impl_repp = new ECA_AUDIO_DECODER_VORBIS_impl;
+  impl_repp->open_rep = false;
+}
+
+ECA_AUDIO_DECODER_VORBIS::~ECA_AUDIO_DECODER_VORBIS(void)
+{
+  close();
+  delete impl_repp;
+}
+
+bool ECA_AUDIO_DECODER_VORBIS::open(const std::string& fname)
+{
+  DBC_REQUIRE(impl_repp->open_rep != true);
+
+  int res = ov_fopen(fname.c_str(), &impl_repp->file_rep);
+  if (res != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: libvorbisfile can't decode \"" + fname +
+		"\" (error " + kvu_numtostr(res) + ").");
+    return false;
+  }
+  impl_repp->open_rep = true;
+
+  vorbis_info* vi = ov_info(&impl_repp->file_rep, -1);
+  if (vi == 0 || vi->channels < 1) {
+    close();
+    return false;
+  }
+
+  ogg_int64_t length = -1;
+  if (ov_seekable(&impl_repp->file_rep) != 0) {
+    length = ov_pcm_total(&impl_repp->file_rep, -1);
+    if (length < 0) length = -1;
+  }
+  set_stream_info(vi->channels, vi->rate, length);
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "libvorbisfile: " + fname + ", " + kvu_numtostr(vi->channels) +
+	      " channel(s), " + kvu_numtostr(vi->rate) + "Hz, " +
+	      kvu_numtostr(static_cast<long int>(length)) + " frames");
+
+  return true;
+}
+
+void ECA_AUDIO_DECODER_VORBIS::close(void)
+{
+  if (impl_repp->open_rep == true) {
+    ov_clear(&impl_repp->file_rep);
+    impl_repp->open_rep = false;
+  }
+}
+
+long int ECA_AUDIO_DECODER_VORBIS::read(float* target, long int frames)
+{
+  DBC_REQUIRE(impl_repp->open_rep == true);
+
+  const int ch = channels();
+  long int total = 0;
+
+  while(total < frames) {
+    float** pcm = 0;
+    int bitstream = 0;
+    long int res = ov_read_float(&impl_repp->file_rep, &pcm,
+				 static_cast<int>(frames - total), &bitstream);
+    if (res == OV_HOLE) continue;
+    if (res <= 0) {
+      if (res < 0) {
+	ECA_LOG_MSG(ECA_LOGGER::errors,
+		    "libvorbisfile decoding error " + kvu_numtostr(res) + ".");
+      }
+      break;
+    }
+    vorbis_info* vi = ov_info(&impl_repp->file_rep, bitstream);
+    if (vi == 0 || vi->channels != ch) {
+      ECA_LOG_MSG(ECA_LOGGER::errors,
+		  "libvorbisfile: channel count changed, stopping decoding.");
+      break;
+    }
+
+    /* note: libvorbisfile returns non-interleaved data */
+    float* out = target + total * ch;
+    for(long int i = 0; i < res; i++) {
+      for(int c = 0; c < ch; c++) {
+	*out++ = pcm[c][i];
+      }
+    }
+    total += res;
+  }
+
+  return total;
+}
+
+bool ECA_AUDIO_DECODER_VORBIS::seek(SAMPLE_SPECS::sample_pos_t pos)
+{
+  DBC_REQUIRE(impl_repp->open_rep == true);
+
+  return ov_pcm_seek(&impl_repp->file_rep, pos) == 0;
+}
+
+#endif /* ECA_COMPILE_VORBISFILE */
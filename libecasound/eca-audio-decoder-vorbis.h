@@ -0,0 +1,34 @@
+#ifndef INCLUDED_ECA_AUDIO_DECODER_VORBIS_H
+#define INCLUDED_ECA_AUDIO_DECODER_VORBIS_H
+
+#include <string>
+
+#include "eca-audio-decoder.h"
+
+class ECA_AUDIO_DECODER_VORBIS_impl;
+
+/**
+ * Ogg Vorbis decoder using libvorbisfile.
+ *
+ * Channel count and sample rate are taken from the
+ * first logical bitstream. Chained streams with
+ * different parameters are not supported.
+ */
+class ECA_AUDIO_DECODER_VORBIS : public ECA_AUDIO_DECODER {
+
+ public:
+
+  ECA_AUDIO_DECODER_VORBIS(void);
+  virtual ~ECA_AUDIO_DECODER_VORBIS(void);
+
+  virtual bool open(const std::string& fname);
+  virtual void close(void);
+  virtual long int read(float* target, long int frames);
+  virtual bool seek(SAMPLE_SPECS::sample_pos_t pos);
+
+ private:
+
+  ECA_AUDIO_DECODER_VORBIS_impl* impl_repp;
+};
+
+#endif
@@ -0,0 +1,104 @@
+// ------------------------------------------------------------------------
+// eca-audio-decoder.cpp: Interface to in-process audio decoders
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+
+#include "eca-audio-decoder.h"
+#include "eca-audio-decoder-flac.h"
+#include "eca-audio-decoder-mpg123.h"
+#include "eca-audio-decoder-vorbis.h"
+
+#ifdef WORDS_BIGENDIAN
+const ECA_AUDIO_FORMAT::Sample_format ECA_AUDIO_DECODER::sample_format = ECA_AUDIO_FORMAT::sfmt_f32_be;
+#else
+const ECA_AUDIO_FORMAT::Sample_format ECA_AUDIO_DECODER::sample_format = ECA_AUDIO_FORMAT::sfmt_f32_le;
+#endif
+
+bool ECA_AUDIO_DECODER::enabled_rep = true;
+
+/**
+ * Creates a decoder for 'codec' ("mp3", "vorbis" or "flac").
+ *
+ * @return new decoder object, or 0 if no decoder is
+ *         available for 'codec', or decoders have been
+ *         disabled with set_enabled()
+ */
+ECA_AUDIO_DECODER* ECA_AUDIO_DECODER::create(const std::string& codec)
+{
+  if (enabled_rep != true) return 0;
+
+#ifdef ECA_COMPILE_MPG123
+  if (codec == "mp3") return new ECA_AUDIO_DECODER_MPG123();
+#endif
+#ifdef ECA_COMPILE_VORBISFILE
+  if (codec == "vorbis") return new ECA_AUDIO_DECODER_VORBIS();
+#endif
+#ifdef ECA_COMPILE_LIBFLAC
+  if (codec == "flac") return new ECA_AUDIO_DECODER_FLAC();
+#endif
+
+  return 0;
+}
+
+/**
+ * Whether create() returns in-process decoders. If
+ * disabled, external decoder programs are used instead.
+ */
+void ECA_AUDIO_DECODER::set_enabled(bool value)
+{
+  enabled_rep = value;
+}
+
+/**
+ * Seeks to sample frame 'pos'. If that fails, seeks
+ * back to the start of the stream.
+ *
+ * @return the new position; 'pos' on success, 0 if
+ *         the stream was rewound, or -1 if the
+ *         decoder could not be repositioned at all
+ */
+SAMPLE_SPECS::sample_pos_t ECA_AUDIO_DECODER::seek_or_rewind(SAMPLE_SPECS::sample_pos_t pos)
+{
+  if (seek(pos) == true)
+    return pos;
+  if (pos != 0 && seek(0) == true)
+    return 0;
+  return -1;
+}
+
+ECA_AUDIO_DECODER::ECA_AUDIO_DECODER(void)
+  : channels_rep(0),
+    srate_rep(0),
+    length_rep(-1)
+{
+}
+
+void ECA_AUDIO_DECODER::set_stream_info(int channels, long int srate, SAMPLE_SPECS::sample_pos_t length)
+{
+  channels_rep = channels;
+  srate_rep = srate;
+  length_rep = length;
+}
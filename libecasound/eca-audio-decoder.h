@@ -0,0 +1,86 @@
+#ifndef INCLUDED_ECA_AUDIO_DECODER_H
+#define INCLUDED_ECA_AUDIO_DECODER_H
+
+#include <string>
+
+#include "eca-audio-format.h"
+#include "sample-specs.h"
+
+/**
+ * Interface to in-process audio decoders.
+ *
+ * Decoders read compressed audio files directly using
+ * the codec libraries, instead of running an external
+ * decoder program. Samples are returned as interleaved
+ * floats in native byte order, see sample_format.
+ *
+ * Decoders are created with create(). Implementations
+ * are only available if the matching codec library was
+ * found at build time.
+ */
+class ECA_AUDIO_DECODER {
+
+ public:
+
+  static const ECA_AUDIO_FORMAT::Sample_format sample_format;
+
+  static ECA_AUDIO_DECODER* create(const std::string& codec);
+  static void set_enabled(bool value);
+  static bool is_enabled(void) { return enabled_rep; }
+
+  virtual ~ECA_AUDIO_DECODER(void) { }
+
+  /**
+   * Opens file 'fname' and reads its stream parameters.
+   *
+   * @return true on success
+   */
+  virtual bool open(const std::string& fname) = 0;
+  virtual void close(void) = 0;
+
+  /**
+   * Decodes up to 'frames' sample frames to 'target'.
+   *
+   * @return number of frames decoded; less than 'frames'
+   *         at end of stream or on error
+   */
+  virtual long int read(float* target, long int frames) = 0;
+
+  /**
+   * Seeks to sample frame 'pos'. The next read() returns
+   * data starting exactly at 'pos'.
+   *
+   * @return true on success
+   */
+  virtual bool seek(SAMPLE_SPECS::sample_pos_t pos) = 0;
+
+  SAMPLE_SPECS::sample_pos_t seek_or_rewind(SAMPLE_SPECS::sample_pos_t pos);
+
+  int channels(void) const { return channels_rep; }
+  long int samples_per_second(void) const { return srate_rep; }
+
+  /**
+   * Length of the stream in sample frames, or -1 if not
+   * known.
+   */
+  SAMPLE_SPECS::sample_pos_t length_in_samples(void) const { return length_rep; }
+
+ protected:
+
+  ECA_AUDIO_DECODER(void);
+
+  void set_stream_info(int channels, long int srate, SAMPLE_SPECS::sample_pos_t length);
+
+ private:
+
+  static bool enabled_rep;
+
+  int channels_rep;
+  long int srate_rep;
+  SAMPLE_SPECS::sample_pos_t length_rep;
+
+  ECA_AUDIO_DECODER(const ECA_AUDIO_DECODER& x) { }
+  ECA_AUDIO_DECODER& operator=(const ECA_AUDIO_DECODER& x) { return *this; }
+};
+
+#endif
@@ -0,0 +1,587 @@
+// ------------------------------------------------------------------------
+// eca-audio-decoder_test.h: Unit test for ECA_AUDIO_DECODER
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib> /* mkdtemp */
+
+#include <unistd.h>
+
+#ifdef ECA_COMPILE_LIBFLAC
+#include <FLAC/stream_encoder.h>
+#endif
+
+#if defined(ECA_COMPILE_MPG123) && defined(ECA_COMPILE_TEST_LAME)
+#define ECA_AUDIO_DECODER_TEST_MP3
+#include <lame/lame.h>
+#endif
+
+#if defined(ECA_COMPILE_VORBISFILE) && defined(ECA_COMPILE_TEST_VORBISENC)
+#define ECA_AUDIO_DECODER_TEST_VORBIS
+#include <vorbis/vorbisenc.h>
+#endif
+
+#include "kvu_numtostr.h"
+
+#include "eca-audio-decoder.h"
+#include "eca-object-factory.h"
+#include "audioio.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_AUDIO_DECODER
+ *
+ * Test files are created with the codec's own encoder
+ * library. FLAC decoding is checked sample by sample.
+ * For the lossy codecs (mp3 and Ogg Vorbis), the decoded
+ * signal is compared to the original by correlation, and
+ * data read after a seek is compared to the same span of
+ * the sequentially decoded stream. Each codec is skipped
+ * if either its decoder or encoder library is missing.
+ */
+class ECA_AUDIO_DECODER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_AUDIO_DECODER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_AUDIO_DECODER_TEST(void) { }
+
+private:
+
+  void test_create(void);
+
+#ifdef ECA_COMPILE_LIBFLAC
+  bool write_flac(const string& fname, int frames);
+  void test_flac_decoder(const string& fname, int frames);
+  void test_flac_object(const string& fname, int frames);
+#endif
+
+#ifdef ECA_AUDIO_DECODER_TEST_MP3
+  bool write_mp3(const string& fname, int frames);
+#endif
+
+#ifdef ECA_AUDIO_DECODER_TEST_VORBIS
+  bool write_vorbis(const string& fname, int frames);
+#endif
+
+#if defined(ECA_AUDIO_DECODER_TEST_MP3) || defined(ECA_AUDIO_DECODER_TEST_VORBIS)
+  void test_lossy_decoder(const string& codec, const string& fname, int frames,
+			  int max_delay, float tolerance);
+#endif
+
+};
+
+/**
+ * Test signal value of sample frame 'frame',
+ * channel 'ch', as a 16bit integer.
+ */
+static int eca_audio_decoder_test_value(int frame, int ch)
+{
+  return ((frame * 37 + ch * 1001) % 4000) - 2000;
+}
+
+void ECA_AUDIO_DECODER_TEST::test_create(void)
+{
+  ECA_AUDIO_DECODER* dec = ECA_AUDIO_DECODER::create("flac");
+#ifdef ECA_COMPILE_LIBFLAC
+  if (dec == 0) {
+    ECA_TEST_FAILURE("create flac");
+  }
+#else
+  if (dec != 0) {
+    ECA_TEST_FAILURE("create flac without libFLAC");
+  }
+#endif
+  delete dec;
+
+  if (ECA_AUDIO_DECODER::create("foo") != 0) {
+    ECA_TEST_FAILURE("create unknown codec");
+  }
+
+  ECA_AUDIO_DECODER::set_enabled(false);
+  if (ECA_AUDIO_DECODER::create("flac") != 0) {
+    ECA_TEST_FAILURE("create when disabled");
+  }
+  ECA_AUDIO_DECODER::set_enabled(true);
+}
+
+#ifdef ECA_COMPILE_LIBFLAC
+
+/**
+ * Writes 'frames' frames of 16bit stereo test signal
+ * to FLAC file 'fname'.
+ */
+bool ECA_AUDIO_DECODER_TEST::write_flac(const string& fname, int frames)
+{
+  FLAC__StreamEncoder* enc = FLAC__stream_encoder_new();
+  if (enc == 0) return false;
+
+  FLAC__stream_encoder_set_channels(enc, 2);
+  FLAC__stream_encoder_set_bits_per_sample(enc, 16);
+  FLAC__stream_encoder_set_sample_rate(enc, 44100);
+  FLAC__stream_encoder_set_total_samples_estimate(enc, frames);
+
+  bool res = false;
+  if (FLAC__stream_encoder_init_file(enc, fname.c_str(), 0, 0) ==
+      FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+    vector<FLAC__int32> data (frames * 2);
+    for(int n = 0; n < frames; n++) {
+      data[n * 2] = eca_audio_decoder_test_value(n, 0);
+      data[n * 2 + 1] = eca_audio_decoder_test_value(n, 1);
+    }
+    res = FLAC__stream_encoder_process_interleaved(enc, &data[0], frames);
+    res = (FLAC__stream_encoder_finish(enc) && res);
+  }
+  FLAC__stream_encoder_delete(enc);
+
+  return res;
+}
+
+void ECA_AUDIO_DECODER_TEST::test_flac_decoder(const string& fname, int frames)
+{
+  ECA_AUDIO_DECODER* dec = ECA_AUDIO_DECODER::create("flac");
+  if (dec == 0 || dec->open(fname) != true) {
+    ECA_TEST_FAILURE("decoder open");
+    delete dec;
+    return;
+  }
+
+  if (dec->channels() != 2 ||
+      dec->samples_per_second() != 44100 ||
+      dec->length_in_samples() != frames) {
+    ECA_TEST_FAILURE("decoder stream info");
+  }
+
+  /* case: decode the whole stream */
+  vector<float> buf ((frames + 100) * 2);
+  long int res = dec->read(&buf[0], frames + 100);
+  if (res != frames) {
+    ECA_TEST_FAILURE("decoder read " + kvu_numtostr(res));
+  }
+  for(long int n = 0; n < res; n++) {
+    if (buf[n * 2] != eca_audio_decoder_test_value(n, 0) / 32768.0f ||
+	buf[n * 2 + 1] != eca_audio_decoder_test_value(n, 1) / 32768.0f) {
+      ECA_TEST_FAILURE("decoder data at " + kvu_numtostr(n));
+      break;
+    }
+  }
+
+  /* case: sample accurate seek, also to the middle of
+   *       a FLAC frame (blocksize is 4096 by default) */
+  const long int positions[] = { 5000, 1, 4095, 4097, 0 };
+  for(size_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+    long int pos = positions[p];
+    if (dec->seek(pos) != true) {
+      ECA_TEST_FAILURE("decoder seek to " + kvu_numtostr(pos));
+      continue;
+    }
+    res = dec->read(&buf[0], 64);
+    if (res != 64 ||
+	buf[0] != eca_audio_decoder_test_value(pos, 0) / 32768.0f ||
+	buf[63 * 2 + 1] != eca_audio_decoder_test_value(pos + 63, 1) / 32768.0f) {
+      ECA_TEST_FAILURE("decoder data after seek to " + kvu_numtostr(pos));
+    }
+  }
+
+  /* case: failed seek rewinds to the start */
+  if (dec->seek_or_rewind(frames + 1000) != 0) {
+    ECA_TEST_FAILURE("decoder seek past end");
+  }
+  else {
+    res = dec->read(&buf[0], 1);
+    if (res != 1 || buf[0] != eca_audio_decoder_test_value(0, 0) / 32768.0f) {
+      ECA_TEST_FAILURE("decoder data after failed seek");
+    }
+  }
+
+  dec->close();
+  delete dec;
+}
+
+void ECA_AUDIO_DECODER_TEST::test_flac_object(const string& fname, int frames)
+{
+  AUDIO_IO* obj = ECA_OBJECT_FACTORY::create_audio_object(fname);
+  if (obj == 0) {
+    ECA_TEST_FAILURE("create " + fname);
+    return;
+  }
+  obj->set_io_mode(AUDIO_IO::io_read);
+  obj->set_buffersize(256);
+  try {
+    obj->open();
+  }
+  catch(AUDIO_IO::SETUP_ERROR& e) {
+    ECA_TEST_FAILURE("object open: " + e.message());
+    delete obj;
+    return;
+  }
+
+  if (obj->supports_seeking_sample_accurate() != true ||
+      obj->length_in_samples() != frames) {
+    ECA_TEST_FAILURE("object stream info");
+  }
+
+  SAMPLE_BUFFER sbuf (256, 2);
+
+  /* case: sample accurate seek through the audio object */
+  obj->seek_position_in_samples(1234);
+  obj->read_buffer(&sbuf);
+  if (obj->position_in_samples() != 1234 + 256 ||
+      sbuf.length_in_samples() != 256 ||
+      sbuf.buffer[0][0] != eca_audio_decoder_test_value(1234, 0) / 32768.0f ||
+      sbuf.buffer[1][255] != eca_audio_decoder_test_value(1234 + 255, 1) / 32768.0f) {
+    ECA_TEST_FAILURE("object data after seek");
+  }
+
+  /* case: failed seek reports the real position */
+  obj->seek_position_in_samples(frames + 1000);
+  if (obj->position_in_samples() != 0) {
+    ECA_TEST_FAILURE("object position after failed seek " +
+		     kvu_numtostr(obj->position_in_samples()));
+  }
+  obj->read_buffer(&sbuf);
+  if (sbuf.length_in_samples() != 256 ||
+      sbuf.buffer[0][0] != eca_audio_decoder_test_value(0, 0) / 32768.0f) {
+    ECA_TEST_FAILURE("object data after failed seek");
+  }
+
+  obj->close();
+  delete obj;
+}
+
+#endif /* ECA_COMPILE_LIBFLAC */
+
+#ifdef ECA_AUDIO_DECODER_TEST_MP3
+
+/**
+ * Writes 'frames' frames of 16bit stereo test signal
+ * to mp3 file 'fname'.
+ */
+bool ECA_AUDIO_DECODER_TEST::write_mp3(const string& fname, int frames)
+{
+  lame_global_flags* gfp = lame_init();
+  if (gfp == 0) return false;
+
+  lame_set_num_channels(gfp, 2);
+  lame_set_in_samplerate(gfp, 44100);
+  lame_set_out_samplerate(gfp, 44100);
+  lame_set_brate(gfp, 192);
+  lame_set_bWriteVbrTag(gfp, 1);
+
+  bool res = false;
+  FILE* f = 0;
+  if (lame_init_params(gfp) >= 0 &&
+      (f = std::fopen(fname.c_str(), "wb")) != 0) {
+    vector<short int> data (frames * 2);
+    for(int n = 0; n < frames; n++) {
+      data[n * 2] = eca_audio_decoder_test_value(n, 0);
+      data[n * 2 + 1] = eca_audio_decoder_test_value(n, 1);
+    }
+
+    /* note: worst case output size, see lame.h */
+    vector<unsigned char> out (frames * 5 / 4 + 7200);
+    int len = lame_encode_buffer_interleaved(gfp, &data[0], frames,
+					     &out[0], out.size());
+    res = (len >= 0 &&
+	   std::fwrite(&out[0], 1, len, f) == static_cast<size_t>(len));
+    len = lame_encode_flush(gfp, &out[0], out.size());
+    res = (res && len >= 0 &&
+	   std::fwrite(&out[0], 1, len, f) == static_cast<size_t>(len));
+
+    /* note: the info tag written at the start of the file
+     *       stores encoder delay and padding, so that
+     *       the stream can be decoded gaplessly */
+    size_t tag = lame_get_lametag_frame(gfp, &out[0], out.size());
+    if (res == true && tag > 0 && tag <= out.size()) {
+      res = (std::fseek(f, 0, SEEK_SET) == 0 &&
+	     std::fwrite(&out[0], 1, tag, f) == tag);
+    }
+    res = (std::fclose(f) == 0 && res);
+  }
+  lame_close(gfp);
+
+  return res;
+}
+
+#endif /* ECA_AUDIO_DECODER_TEST_MP3 */
+
+#ifdef ECA_AUDIO_DECODER_TEST_VORBIS
+
+static bool eca_audio_decoder_test_write_page(FILE* f, const ogg_page* og)
+{
+  return (std::fwrite(og->header, 1, og->header_len, f) == static_cast<size_t>(og->header_len) &&
+	  std::fwrite(og->body, 1, og->body_len, f) == static_cast<size_t>(og->body_len));
+}
+
+/**
+ * Writes 'frames' frames of stereo test signal
+ * to Ogg Vorbis file 'fname'.
+ */
+bool ECA_AUDIO_DECODER_TEST::write_vorbis(const string& fname, int frames)
+{
+  vorbis_info vi;
+  vorbis_info_init(&vi);
+  if (vorbis_encode_init_vbr(&vi, 2, 44100, 0.6f) != 0) {
+    vorbis_info_clear(&vi);
+    return false;
+  }
+
+  FILE* f = std::fopen(fname.c_str(), "wb");
+  if (f == 0) {
+    vorbis_info_clear(&vi);
+    return false;
+  }
+
+  vorbis_comment vc;
+  vorbis_dsp_state vd;
+  vorbis_block vb;
+  ogg_stream_state os;
+  ogg_page og;
+  ogg_packet op, header, header_comm, header_code;
+
+  vorbis_comment_init(&vc);
+  vorbis_analysis_init(&vd, &vi);
+  vorbis_block_init(&vd, &vb);
+  ogg_stream_init(&os, 1);
+
+  vorbis_analysis_headerout(&vd, &vc, &header, &header_comm, &header_code);
+  ogg_stream_packetin(&os, &header);
+  ogg_stream_packetin(&os, &header_comm);
+  ogg_stream_packetin(&os, &header_code);
+
+  /* note: audio data must start on a new page */
+  bool res = true;
+  while(ogg_stream_flush(&os, &og) != 0)
+    res = (eca_audio_decoder_test_write_page(f, &og) && res);
+
+  bool done = false;
+  for(int pos = 0; done != true;) {
+    int len = frames - pos;
+    if (len > 1024) len = 1024;
+    if (len > 0) {
+      float** in = vorbis_analysis_buffer(&vd, len);
+      for(int n = 0; n < len; n++) {
+	in[0][n] = eca_audio_decoder_test_value(pos + n, 0) / 32768.0f;
+	in[1][n] = eca_audio_decoder_test_value(pos + n, 1) / 32768.0f;
+      }
+      pos += len;
+    }
+    else {
+      done = true;
+    }
+    /* note: writing zero frames marks the end of stream */
+    vorbis_analysis_wrote(&vd, len);
+
+    while(vorbis_analysis_blockout(&vd, &vb) == 1) {
+      vorbis_analysis(&vb, 0);
+      vorbis_bitrate_addblock(&vb);
+      while(vorbis_bitrate_flushpacket(&vd, &op) != 0) {
+	ogg_stream_packetin(&os, &op);
+	while(ogg_stream_pageout(&os, &og) != 0)
+	  res = (eca_audio_decoder_test_write_page(f, &og) && res);
+      }
+    }
+  }
+  while(ogg_stream_flush(&os, &og) != 0)
+    res = (eca_audio_decoder_test_write_page(f, &og) && res);
+
+  ogg_stream_clear(&os);
+  vorbis_block_clear(&vb);
+  vorbis_dsp_clear(&vd);
+  vorbis_comment_clear(&vc);
+  vorbis_info_clear(&vi);
+
+  return (std::fclose(f) == 0 && res);
+}
+
+#endif /* ECA_AUDIO_DECODER_TEST_VORBIS */
+
+#if defined(ECA_AUDIO_DECODER_TEST_MP3) || defined(ECA_AUDIO_DECODER_TEST_VORBIS)
+
+/**
+ * Decodes lossy 'codec' file 'fname', written from
+ * 'frames' frames of test signal.
+ *
+ * @param max_delay maximum number of extra frames
+ *        the codec may add to the start of the stream
+ * @param tolerance maximum difference between data
+ *        read after a seek and the same frames decoded
+ *        sequentially
+ */
+void ECA_AUDIO_DECODER_TEST::test_lossy_decoder(const string& codec, const string& fname, int frames,
+						int max_delay, float tolerance)
+{
+  ECA_AUDIO_DECODER* dec = ECA_AUDIO_DECODER::create(codec);
+  if (dec == 0 || dec->open(fname) != true) {
+    ECA_TEST_FAILURE(codec + ": decoder open");
+    delete dec;
+    return;
+  }
+
+  long int length = dec->length_in_samples();
+  if (dec->channels() != 2 ||
+      dec->samples_per_second() != 44100 ||
+      length < frames ||
+      length > frames + max_delay * 2) {
+    ECA_TEST_FAILURE(codec + ": decoder stream info, length " +
+		     kvu_numtostr(length));
+    dec->close();
+    delete dec;
+    return;
+  }
+
+  /* case: decode the whole stream */
+  vector<float> stream ((length + 100) * 2);
+  long int res = dec->read(&stream[0], length + 100);
+  if (res != length) {
+    ECA_TEST_FAILURE(codec + ": decoder read " + kvu_numtostr(res));
+  }
+
+  /* case: decoded signal matches the original, allowing
+   *       for codec delay of up to 'max_delay' frames */
+  double best = 0.0;
+  for(int delay = 0; delay <= max_delay && delay + frames <= res; delay++) {
+    double cross = 0.0, orig = 0.0, decoded = 0.0;
+    for(int n = 0; n < frames; n++) {
+      for(int ch = 0; ch < 2; ch++) {
+	double a = eca_audio_decoder_test_value(n, ch) / 32768.0;
+	double b = stream[(n + delay) * 2 + ch];
+	cross += a * b;
+	orig += a * a;
+	decoded += b * b;
+      }
+    }
+    if (orig > 0.0 && decoded > 0.0) {
+      double corr = cross / std::sqrt(orig * decoded);
+      if (corr > best) best = corr;
+    }
+  }
+  if (best < 0.9) {
+    ECA_TEST_FAILURE(codec + ": decoded signal differs from original, correlation " +
+		     kvu_numtostr(best));
+  }
+
+  /* case: data after seek matches sequential decoding,
+   *       also within and at the edges of codec frames */
+  vector<float> buf (64 * 2);
+  const long int positions[] = { 5000, 1, 1151, 1152, 1153, 4097, 0 };
+  for(size_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+    long int pos = positions[p];
+    if (dec->seek(pos) != true) {
+      ECA_TEST_FAILURE(codec + ": decoder seek to " + kvu_numtostr(pos));
+      continue;
+    }
+    long int got = dec->read(&buf[0], 64);
+    if (got != 64) {
+      ECA_TEST_FAILURE(codec + ": decoder read after seek to " + kvu_numtostr(pos));
+      continue;
+    }
+    for(int n = 0; n < 64 * 2; n++) {
+      if (std::fabs(buf[n] - stream[pos * 2 + n]) > tolerance) {
+	ECA_TEST_FAILURE(codec + ": decoder data after seek to " + kvu_numtostr(pos));
+	break;
+      }
+    }
+  }
+
+  /* case: failed seek rewinds to the start */
+  if (dec->seek_or_rewind(length + 1000) != 0) {
+    ECA_TEST_FAILURE(codec + ": decoder seek past end");
+  }
+  else {
+    res = dec->read(&buf[0], 1);
+    if (res != 1 || std::fabs(buf[0] - stream[0]) > tolerance) {
+      ECA_TEST_FAILURE(codec + ": decoder data after failed seek");
+    }
+  }
+
+  dec->close();
+  delete dec;
+}
+
+#endif
+
+void ECA_AUDIO_DECODER_TEST::do_run(void)
+{
+  test_create();
+
+  char dirname[] = "/tmp/eca-audio-decoder-test-XXXXXX";
+  if (::mkdtemp(dirname) == 0) {
+    ECA_TEST_FAILURE("mkdtemp");
+    return;
+  }
+  const int frames = 10000;
+  string fname;
+
+#ifdef ECA_COMPILE_LIBFLAC
+  fname = string(dirname) + "/test.flac";
+  if (write_flac(fname, frames) != true) {
+    ECA_TEST_FAILURE("write " + fname);
+  }
+  else {
+    test_flac_decoder(fname, frames);
+    test_flac_object(fname, frames);
+  }
+  std::remove(fname.c_str());
+#else
+  std::fprintf(stdout, "%s: flac not tested, libFLAC missing\n",
+	       name().c_str());
+#endif
+
+#ifdef ECA_AUDIO_DECODER_TEST_MP3
+  /* note: encoder delay is skipped if the decoder reads
+   *       the info tag, otherwise up to two mp3 frames */
+  fname = string(dirname) + "/test.mp3";
+  if (write_mp3(fname, frames) != true) {
+    ECA_TEST_FAILURE("write " + fname);
+  }
+  else {
+    test_lossy_decoder("mp3", fname, frames, 1152 * 2, 2e-3f);
+  }
+  std::remove(fname.c_str());
+#else
+  std::fprintf(stdout, "%s: mp3 not tested, libmpg123 or libmp3lame missing\n",
+	       name().c_str());
+#endif
+
+#ifdef ECA_AUDIO_DECODER_TEST_VORBIS
+  fname = string(dirname) + "/test.ogg";
+  if (write_vorbis(fname, frames) != true) {
+    ECA_TEST_FAILURE("write " + fname);
+  }
+  else {
+    test_lossy_decoder("vorbis", fname, frames, 0, 1e-4f);
+  }
+  std::remove(fname.c_str());
+#else
+  std::fprintf(stdout, "%s: vorbis not tested, libvorbisfile or libvorbisenc missing\n",
+	       name().c_str());
+#endif
+
+  ::rmdir(dirname);
+}
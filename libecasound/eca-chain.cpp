@@ -26,6 +26,7 @@
 
 #include <cassert>
 #include <cctype>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -76,6 +77,13 @@ CHAIN::CHAIN (void)
   selected_controller_number_rep = 0;
   selected_chainop_parameter_rep = 0;
   selected_controller_parameter_rep = 0;
+
+  ctrl_resolution_rep = 0;
+  ctrl_segments_rep = false;
+  segment_repp = 0;
+  worker_pool_repp = 0;
+
+  profiling_rep = false;
 }
 
 CHAIN::~CHAIN (void)
@@ -100,6 +108,8 @@ CHAIN::~CHAIN (void)
 	gcontrollers_rep.end(); p++) {
     delete *p;
   }
+
+  delete segment_repp;
 }
 
 /**
@@ -189,6 +199,7 @@ void CHAIN::add_chain_operator(CHAIN_OPERATOR* chainop)
   CHAIN::COP_CONTAINER container;
   container.cop = chainop;
   container.bypassed = false;
+  container.profile_time = 0;
   chainops_rep.push_back(container);
   selected_chainop_number_rep = chainops_rep.size();
   initialized_rep = false;
@@ -203,11 +214,14 @@ void CHAIN::add_chain_operator(CHAIN_OPERATOR* chainop)
  * Removes the selected chain operator
  *
  * @param op_index operator index (1...N), or -1 to use the selected op
+ * @param delete_objects if false, the chain operator and its 
+ *        controllers are only removed from the chain, but 
+ *        not deleted (see share_objects())
  *
  * ensure:
  *  is_initialized() != true
  */
-void CHAIN::remove_chain_operator(int op_index)
+void CHAIN::remove_chain_operator(int op_index, bool delete_objects)
 {
   if (op_index < 0)
     op_index = selected_chainop_number_rep;
@@ -233,7 +247,8 @@ void CHAIN::remove_chain_operator(int op_index)
 	      selected_controller_repp = 0;
 	    
 	    /* step: remove the related controller */
-	    delete *q;
+	    if (delete_objects == true)
+	      delete *q;
 	    gcontrollers_rep.erase(q);
 
 	    /* step: in case there are multiple controllers per chainop */
@@ -244,7 +259,8 @@ void CHAIN::remove_chain_operator(int op_index)
 	}
 
 	/* step: delete and remove from the list */
-	delete (*p).cop;
+	if (delete_objects == true)
+	  delete (*p).cop;
 	chainops_rep.erase(p);
 
 	/* step: invalidate selection if the selected cop
@@ -398,6 +414,32 @@ void CHAIN::set_parameter(int op_index, int param_index, CHAIN_OPERATOR::paramet
     cop->set_parameter(param_index, value);
 }
 
+/**
+ * Whether setting the parameter value requires the
+ * chain operator to be initialized again.
+ *
+ * @see CHAIN_OPERATOR::parameter_needs_init()
+ * @see set_parameter()
+ */
+bool CHAIN::parameter_needs_init(int op_index, int param_index, CHAIN_OPERATOR::parameter_t value) const
+{
+  const CHAIN_OPERATOR *cop = 0;
+
+  if (op_index < 0) {
+    if (selected_chainop_number_rep > 0 &&
+	selected_chainop_number_rep <= static_cast<int>(chainops_rep.size()))
+      cop = chainops_rep[selected_chainop_number_rep - 1].cop;
+  }
+  else if (op_index > 0 &&
+	   op_index <= static_cast<int>(chainops_rep.size()))
+    cop = chainops_rep[op_index - 1].cop;
+
+  if (param_index < 0)
+    param_index = selected_chainop_parameter_rep;
+
+  return (cop != 0 && cop->parameter_needs_init(param_index, value) == true);
+}
+
 /**
  * Returns true if op_index is valid.
  */
@@ -525,11 +567,15 @@ const CHAIN_OPERATOR* CHAIN::get_selected_chain_operator(void) const
 /**
  * Removes the selected controller
  *
+ * @param delete_objects if false, the controller is only 
+ *        removed from the chain, but not deleted 
+ *        (see share_objects())
+ *
  * require:
  *  selected_controller() <= number_of_controllers();
  *  selected_controller() > 0
  */
-void CHAIN::remove_controller(void)
+void CHAIN::remove_controller(bool delete_objects)
 {
   // --------
   DBC_REQUIRE(selected_controller() > 0);
@@ -541,7 +587,8 @@ void CHAIN::remove_controller(void)
       q != gcontrollers_rep.end(); 
       q++) {
     if ((n + 1) == selected_controller()) {
-      delete *q;
+      if (delete_objects == true)
+	delete *q;
       gcontrollers_rep.erase(q);
       select_controller(-1);
       break;
@@ -550,6 +597,96 @@ void CHAIN::remove_controller(void)
   }
 }
 
+/**
+ * Adds the chain operators and controllers of 'orig' to 
+ * this chain, without creating new instances. Bypass 
+ * states of the operators are copied.
+ *
+ * The objects are shared by the two chains until
+ * detach_objects() is called for one of them, and
+ * must not be processed by both chains at the same
+ * time.
+ *
+ * @see init_in_place_of()
+ */
+void CHAIN::share_objects(const CHAIN* orig)
+{
+  for(size_t p = 0; p != orig->chainops_rep.size(); p++) {
+    CHAIN::COP_CONTAINER container;
+    container.cop = orig->chainops_rep[p].cop;
+    container.bypassed = orig->chainops_rep[p].bypassed;
+    container.profile_time = 0;
+    chainops_rep.push_back(container);
+  }
+  for(size_t p = 0; p != orig->gcontrollers_rep.size(); p++) {
+    gcontrollers_rep.push_back(orig->gcontrollers_rep[p]);
+  }
+  selected_chainop_number_rep = chainops_rep.size();
+  initialized_rep = false;
+}
+
+/**
+ * Whether some chain operator or controller of this 
+ * chain is also used by chain 'other'?
+ */
+bool CHAIN::shares_objects_with(const CHAIN* other) const
+{
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    if (other->uses_object(chainops_rep[p].cop) == true)
+      return true;
+  }
+  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+    if (other->uses_object(gcontrollers_rep[p]) == true)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Removes, without deleting, all chain operators and
+ * controllers that are also used by chain 'other'.
+ *
+ * @see share_objects()
+ */
+void CHAIN::detach_objects(const CHAIN* other)
+{
+  for(size_t p = 0; p != chainops_rep.size();) {
+    if (other->uses_object(chainops_rep[p].cop) == true)
+      chainops_rep.erase(chainops_rep.begin() + p);
+    else
+      ++p;
+  }
+  for(size_t p = 0; p != gcontrollers_rep.size();) {
+    if (other->uses_object(gcontrollers_rep[p]) == true) {
+      if (selected_controller_repp == gcontrollers_rep[p])
+	selected_controller_repp = 0;
+      gcontrollers_rep.erase(gcontrollers_rep.begin() + p);
+    }
+    else
+      ++p;
+  }
+  selected_dynobj_repp = 0;
+  selected_chainop_number_rep = 0;
+  selected_controller_number_rep = 0;
+}
+
+/**
+ * Whether 'obj' is a chain operator or controller 
+ * of this chain?
+ */
+bool CHAIN::uses_object(const OPERATOR* obj) const
+{
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    if (chainops_rep[p].cop == obj)
+      return true;
+  }
+  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+    if (gcontrollers_rep[p] == obj)
+      return true;
+  }
+  return false;
+}
+
 /**
  * Clears chain (removes all chain operators and controllers)
  */
@@ -765,7 +902,25 @@ void CHAIN::init(SAMPLE_BUFFER* sbuf, int in_channels, int out_channels)
   if (in_channels != 0) in_channels_rep = in_channels;
   if (out_channels != 0) out_channels_rep = out_channels;
 
+  init_controller_ramps();
+  SAMPLE_BUFFER* opbuf = 
+    (ctrl_segments_rep == true) ? segment_repp : audioslot_repp;
+
+  /* note: reserve room for the widest chainop before
+   *       any init(), as plugins keep pointers to channel
+   *       data and growing the buffer moves all channels */
   int channels_next = in_channels_rep;
+  int channels_max = channels_next;
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    int out_ch = chainops_rep[p].cop->output_channels(channels_next);
+    if (out_ch > channels_max)
+      channels_max = out_ch;
+    channels_next = out_ch;
+  }
+  audioslot_repp->reserve_channels(channels_max);
+  opbuf->reserve_channels(channels_max);
+
+  channels_next = in_channels_rep;
   for(size_t p = 0; p != chainops_rep.size(); p++) {
     /* note: buffer must have room to store both input and 
      *       output channels (processing in-place) */
@@ -773,8 +928,10 @@ void CHAIN::init(SAMPLE_BUFFER* sbuf, int in_channels, int out_channels)
     if (out_ch > channels_next)
       channels_next = out_ch;
     audioslot_repp->number_of_channels(channels_next);
+    opbuf->number_of_channels(channels_next);
 
-    chainops_rep[p].cop->init(audioslot_repp);
+    chainops_rep[p].cop->set_worker_pool(worker_pool_repp);
+    chainops_rep[p].cop->init(opbuf);
 
     /* note: for the next plugin, only 'out_ch' channels contain 
      *        valid audio */
@@ -803,6 +960,91 @@ void CHAIN::init(SAMPLE_BUFFER* sbuf, int in_channels, int out_channels)
   // --------
 }
 
+/**
+ * Whether this chain can be initialized with 
+ * init_in_place_of() to replace the running chain 
+ * 'orig'?
+ *
+ * This requires that 'orig' is initialized, and that
+ * neither chain changes the channel count or is processed
+ * in segments, so that the chain buffer of 'orig' keeps 
+ * a constant layout while 'orig' is being processed.
+ */
+bool CHAIN::can_init_in_place_of(const CHAIN* orig) const
+{
+  if (orig->is_initialized() != true ||
+      orig->ctrl_segments_rep == true ||
+      orig->audioslot_repp == 0)
+    return false;
+
+  if (needs_segments(orig->audioslot_repp->length_in_samples()) == true)
+    return false;
+
+  int ch = orig->in_channels_rep;
+  for(size_t p = 0; p != orig->chainops_rep.size(); p++) {
+    if (orig->chainops_rep[p].cop->output_channels(ch) != ch)
+      return false;
+  }
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    if (chainops_rep[p].cop->output_channels(ch) != ch)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Prepares chain for processing in place of the running
+ * chain 'orig', using the buffer of 'orig'. Chain operators
+ * and controllers shared with 'orig' (see share_objects())
+ * are already initialized, and they are left untouched, 
+ * so they keep their internal state. Only objects that 
+ * are not used by 'orig' are initialized.
+ *
+ * Execution note: can be called while 'orig' is being 
+ *                 processed, does not modify the buffer
+ *
+ * require:
+ *  can_init_in_place_of(orig) == true
+ *
+ * ensure:
+ *  is_initialized() == true
+ */
+void CHAIN::init_in_place_of(const CHAIN* orig)
+{
+  // --------
+  DBC_REQUIRE(can_init_in_place_of(orig) == true);
+  // --------
+
+  audioslot_repp = orig->audioslot_repp;
+  in_channels_rep = orig->in_channels_rep;
+  out_channels_rep = orig->out_channels_rep;
+
+  init_controller_ramps();
+  DBC_CHECK(ctrl_segments_rep != true);
+
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    CHAIN_OPERATOR* cop = chainops_rep[p].cop;
+    if (orig->uses_object(cop) == true)
+      continue;
+    cop->set_worker_pool(worker_pool_repp);
+    cop->init(audioslot_repp);
+    for(int n = 0; n < cop->number_of_params(); n++) {
+      cop->set_parameter(n + 1, cop->get_parameter(n + 1));
+    }
+  }
+
+  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+    if (orig->uses_object(gcontrollers_rep[p]) != true)
+      gcontrollers_rep[p]->init();
+  }
+
+  initialized_rep = true;
+
+  // --------
+  DBC_ENSURE(is_initialized() == true);
+  // --------
+}
+
 /** 
  * Releases all buffers assigned to chain operators.
  */
@@ -830,25 +1072,39 @@ void CHAIN::process(void)
   DBC_REQUIRE(is_initialized() == true);
   // --------
 
+  long long int profile_start = 0;
+  if (profiling_rep == true)
+    profile_start = ECA_PROFILE_HISTOGRAM::timestamp();
+
+  bool ramps = 
+    (muted_rep != true && bypass_rep != true &&
+     ctrl_ramps_rep.size() > 0 &&
+     ctrl_ramps_rep.size() == gcontrollers_rep.size() &&
+     audioslot_repp->length_in_samples() <= static_cast<long int>(ctrl_ramps_rep[0].size()));
+
   /* step: update operator parameters */
-  controller_update();
+  if (ramps == true)
+    controller_update_ramps();
+  else
+    controller_update();
 
   /* step: run processing components */
   if (muted_rep != true) {
     /* note: if muted, don't bother running the chainops */
     if (bypass_rep != true) {
       /* note: processing enabled (no bypass) */
-      for(int p = 0; p != static_cast<int>(chainops_rep.size()); p++) {
-
-	if (chainops_rep[p].bypassed == true)
-	  continue;
-
-	/* note: increase channel count if chainop needs the space */
-	int out_ch = chainops_rep[p].cop->output_channels(audioslot_repp->number_of_channels());
-	if (out_ch > audioslot_repp->number_of_channels())
-	  audioslot_repp->number_of_channels(out_ch);
-	
-	chainops_rep[p].cop->process();
+      if (ctrl_segments_rep == true) {
+	/* note: chainops are bound to 'segment_repp' */
+	process_segments(ramps);
+      }
+      else {
+	if (ramps == true) {
+	  for(size_t n = 0; n < gcontrollers_rep.size(); n++) {
+	    if (gcontrollers_rep[n]->controls_chain_operator() == true)
+	      gcontrollers_rep[n]->apply_ramp(&ctrl_ramps_rep[n][0]);
+	  }
+	}
+	process_chainops(audioslot_repp);
       }
     }
   }
@@ -858,6 +1114,115 @@ void CHAIN::process(void)
 
   /* step: update chain position */
   change_position_in_samples(audioslot_repp->length_in_samples());
+
+  if (profiling_rep == true) {
+    profile_rep.record(ECA_PROFILE_HISTOGRAM::timestamp() - profile_start);
+    if (muted_rep != true && bypass_rep != true) {
+      for(size_t p = 0; p != chainops_rep.size(); p++) {
+	if (chainops_rep[p].bypassed == true)
+	  continue;
+	chainops_rep[p].profile.record(chainops_rep[p].profile_time);
+	chainops_rep[p].profile_time = 0;
+      }
+    }
+  }
+}
+
+/**
+ * Runs all chain operators that are not bypassed. Chain
+ * operators must have been initialized with 'sbuf'.
+ */
+void CHAIN::process_chainops(SAMPLE_BUFFER* sbuf)
+{
+  for(int p = 0; p != static_cast<int>(chainops_rep.size()); p++) {
+
+    if (chainops_rep[p].bypassed == true)
+      continue;
+
+    /* note: increase channel count if chainop needs the space */
+    int out_ch = chainops_rep[p].cop->output_channels(sbuf->number_of_channels());
+    if (out_ch > sbuf->number_of_channels())
+      sbuf->number_of_channels(out_ch);
+
+    if (profiling_rep == true) {
+      long long int start = ECA_PROFILE_HISTOGRAM::timestamp();
+      chainops_rep[p].cop->process();
+      chainops_rep[p].profile_time += ECA_PROFILE_HISTOGRAM::timestamp() - start;
+    }
+    else
+      chainops_rep[p].cop->process();
+  }
+}
+
+/**
+ * Runs chain operators on consecutive segments of the
+ * chain buffer, one controller resolution period at a time.
+ * If 'ramps' is true, controller values are applied at the 
+ * start of each segment. Used when some controlled chain 
+ * operator can't follow per-sample parameter values.
+ */
+void CHAIN::process_segments(bool ramps)
+{
+  long int len = audioslot_repp->length_in_samples();
+  int in_ch = audioslot_repp->number_of_channels();
+
+  segment_repp->event_tags_set(*audioslot_repp);
+
+  for(long int offset = 0; offset < len; offset += ctrl_resolution_rep) {
+    long int seglen = len - offset;
+    if (seglen > ctrl_resolution_rep) seglen = ctrl_resolution_rep;
+
+    segment_repp->number_of_channels(in_ch);
+    segment_repp->length_in_samples(seglen);
+    for(int c = 0; c < in_ch; c++)
+      std::memcpy(segment_repp->buffer[c], 
+		  audioslot_repp->buffer[c] + offset,
+		  seglen * sizeof(SAMPLE_SPECS::sample_t));
+
+    for(size_t n = 0; ramps == true && n < gcontrollers_rep.size(); n++) {
+      if (gcontrollers_rep[n]->controls_chain_operator() == true)
+	gcontrollers_rep[n]->apply_ramp(&ctrl_ramps_rep[n][offset]);
+    }
+
+    process_chainops(segment_repp);
+
+    int out_ch = segment_repp->number_of_channels();
+    if (out_ch > audioslot_repp->number_of_channels())
+      audioslot_repp->number_of_channels(out_ch);
+    for(int c = 0; c < out_ch; c++)
+      std::memcpy(audioslot_repp->buffer[c] + offset, 
+		  segment_repp->buffer[c],
+		  seglen * sizeof(SAMPLE_SPECS::sample_t));
+  }
+}
+
+/**
+ * Clears the processing time statistics of the chain 
+ * and its chain operators.
+ *
+ * Must not be called while the chain is being processed.
+ */
+void CHAIN::reset_profile(void)
+{
+  profile_rep.reset();
+  for(size_t p = 0; p != chainops_rep.size(); p++) {
+    chainops_rep[p].profile.reset();
+    chainops_rep[p].profile_time = 0;
+  }
+}
+
+/**
+ * Returns processing time statistics of chain operator
+ * 'op_index' (1...N), or 0 if index is not valid.
+ * Each sample covers all process() calls of the 
+ * operator during one CHAIN::process() call.
+ */
+const ECA_PROFILE_HISTOGRAM* CHAIN::chain_operator_profile(int op_index) const
+{
+  if (is_valid_op_index(op_index) != true)
+    return 0;
+
+  return &chainops_rep[op_index - 1].profile;
 }
 
 /**
@@ -875,6 +1240,88 @@ void CHAIN::controller_update(void)
   }
 }
 
+/**
+ * Calculates per-sample values for all controllers, 
+ * covering the current chain buffer. Controllers that
+ * control other controllers are updated immediately, 
+ * while values for chain operators are applied just 
+ * before processing.
+ */
+void CHAIN::controller_update_ramps(void)
+{
+  long int len = audioslot_repp->length_in_samples();
+  if (len == 0) {
+    controller_update();
+    return;
+  }
+
+  for(size_t n = 0; n < gcontrollers_rep.size(); n++) {
+    CHAIN_OPERATOR::parameter_t* ramp = &ctrl_ramps_rep[n][0];
+    gcontrollers_rep[n]->value_ramp(position_in_seconds_exact(),
+				    samples_per_second(),
+				    len,
+				    ctrl_resolution_rep,
+				    ramp);
+    if (gcontrollers_rep[n]->controls_chain_operator() != true)
+      gcontrollers_rep[n]->apply_ramp(ramp);
+  }
+}
+
+/**
+ * Whether some controller needs the chain buffer of
+ * length 'buflen' to be processed in segments? See 
+ * process_segments().
+ */
+bool CHAIN::needs_segments(long int buflen) const
+{
+  if (ctrl_resolution_rep <= 0 || ctrl_resolution_rep >= buflen)
+    return false;
+
+  for(size_t n = 0; n < gcontrollers_rep.size(); n++) {
+    if (gcontrollers_rep[n]->controls_chain_operator() == true &&
+	gcontrollers_rep[n]->target_follows_ramps() != true)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Prepares buffers for sample-accurate controller
+ * updates. See set_controller_resolution().
+ */
+void CHAIN::init_controller_ramps(void)
+{
+  long int buflen = audioslot_repp->length_in_samples();
+  long int res = ctrl_resolution_rep;
+
+  ctrl_ramps_rep.clear();
+  ctrl_segments_rep = false;
+  delete segment_repp;
+  segment_repp = 0;
+
+  if (res <= 0 || res >= buflen || gcontrollers_rep.size() == 0)
+    return;
+
+  ctrl_segments_rep = needs_segments(buflen);
+
+  if (ctrl_segments_rep == true) {
+    for(size_t p = 0; p != chainops_rep.size(); p++) {
+      if (chainops_rep[p].cop->max_output_samples(res) != res) {
+	ECA_LOG_MSG(ECA_LOGGER::info,
+		    "Chain \"" + name() + "\": chain operator \"" +
+		    chainops_rep[p].cop->name() + 
+		    "\" changes buffer length, controllers are updated once per buffer.");
+	ctrl_segments_rep = false;
+	return;
+      }
+    }
+    segment_repp = new SAMPLE_BUFFER(res, in_channels_rep);
+  }
+
+  ctrl_ramps_rep.resize(gcontrollers_rep.size(), 
+			std::vector<CHAIN_OPERATOR::parameter_t> (buflen));
+}
+
 /**
  * Re-initializes all effect parameters.
  */
@@ -895,33 +1342,10 @@ string CHAIN::to_string(void) const
 {
   MESSAGE_ITEM t; 
 
-  FILE_PRESET* fpreset;
-  GLOBAL_PRESET* gpreset;
-
   int q = 0;
   while (q < static_cast<int>(chainops_rep.size())) {
 #ifndef ECA_DISABLE_EFFECTS
-    fpreset = 0;
-    fpreset = dynamic_cast<FILE_PRESET*>(chainops_rep[q].cop);
-    if (fpreset != 0) {
-      t << "-pf:" << fpreset->filename();
-      if (fpreset->number_of_params() > 0) t << ",";
-      t << ECA_OBJECT_FACTORY::operator_parameters_to_eos(fpreset);
-      t << " ";
-    }
-    else {
-      gpreset = 0;
-      gpreset = dynamic_cast<GLOBAL_PRESET*>(chainops_rep[q].cop);
-      if (gpreset != 0) {
-	t << "-pn:" << gpreset->name();
-	if (gpreset->number_of_params() > 0) t << ",";
-	t << ECA_OBJECT_FACTORY::operator_parameters_to_eos(gpreset);
-	t << " ";
-      }
-      else {
-        t << ECA_OBJECT_FACTORY::chain_operator_to_eos(chainops_rep[q].cop) << " ";
-      }
-    }
+    t << chain_operator_to_string(q) << " ";
     
     /* check if the chainop is controlled by a gcontroller */
     std::vector<GENERIC_CONTROLLER*>::size_type p = 0;
@@ -948,6 +1372,41 @@ string CHAIN::to_string(void) const
   return t.to_string();
 }
 
+/**
+ * Converts chain operator 'index' (0...N-1, see
+ * get_chain_operator()) to a formatted string. Presets 
+ * are described by name, not by their contents.
+ */
+string CHAIN::chain_operator_to_string(int index) const
+{
+  // --------
+  DBC_REQUIRE(index >= 0 && index < number_of_chain_operators());
+  // --------
+
+  MESSAGE_ITEM t; 
+
+#ifndef ECA_DISABLE_EFFECTS
+  const CHAIN_OPERATOR* cop = chainops_rep[index].cop;
+  const FILE_PRESET* fpreset = dynamic_cast<const FILE_PRESET*>(cop);
+  const GLOBAL_PRESET* gpreset = dynamic_cast<const GLOBAL_PRESET*>(cop);
+  if (fpreset != 0) {
+    t << "-pf:" << fpreset->filename();
+    if (fpreset->number_of_params() > 0) t << ",";
+    t << ECA_OBJECT_FACTORY::operator_parameters_to_eos(fpreset);
+  }
+  else if (gpreset != 0) {
+    t << "-pn:" << gpreset->name();
+    if (gpreset->number_of_params() > 0) t << ",";
+    t << ECA_OBJECT_FACTORY::operator_parameters_to_eos(gpreset);
+  }
+  else {
+    t << ECA_OBJECT_FACTORY::chain_operator_to_eos(cop);
+  }
+#endif
+
+  return t.to_string();
+}
+
 /**
  * Reimplemented from ECA_SAMPLERATE_AWARE
  */
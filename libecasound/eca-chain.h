@@ -28,7 +28,9 @@
 
 #include "eca-chainop.h"
 #include "eca-audio-position.h"
+#include "eca-profile-histogram.h"
 
+class ECA_WORKER_POOL;
 class GENERIC_CONTROLLER;
 class OPERATOR;
 class SAMPLE_BUFFER;
@@ -82,12 +84,52 @@ class CHAIN : public ECA_AUDIO_POSITION {
   bool is_valid(void) const;
 
   void init(SAMPLE_BUFFER* sbuf = 0, int in_channels = 0, int out_channels = 0);
+  bool can_init_in_place_of(const CHAIN* orig) const;
+  void init_in_place_of(const CHAIN* orig);
+
+  /**
+   * Continues from the current position of 'orig'. 
+   * Used when this chain replaces 'orig'.
+   */
+  void take_position_of(const CHAIN* orig) { set_position_in_samples(orig->position_in_samples()); }
   void release(void);
   void process(void);
   void controller_update(void);
   void refresh_parameters(void);
 
+  /**
+   * Sets the interval, in sample frames, at which controllers
+   * are evaluated. Values in between are interpolated. If zero,
+   * or not smaller than the buffer length, controllers are 
+   * evaluated once per buffer. Takes effect on the next call 
+   * to init().
+   */
+  void set_controller_resolution(long int frames) { ctrl_resolution_rep = frames; }
+  long int controller_resolution(void) const { return ctrl_resolution_rep; }
+
+  /**
+   * Sets the worker pool passed to chain operators
+   * (see CHAIN_OPERATOR::set_worker_pool()). Takes
+   * effect on the next call to init().
+   */
+  void set_worker_pool(ECA_WORKER_POOL* pool) { worker_pool_repp = pool; }
+
+  /**
+   * Enables or disables collecting processing time
+   * statistics of the chain and its chain operators.
+   */
+  void toggle_profiling(bool v) { profiling_rep = v; }
+  bool is_profiling(void) const { return profiling_rep; }
+  void reset_profile(void);
+
+  /**
+   * Processing times of process() calls.
+   */
+  const ECA_PROFILE_HISTOGRAM& profile(void) const { return profile_rep; }
+  const ECA_PROFILE_HISTOGRAM* chain_operator_profile(int op_index) const;
+
   std::string to_string(void) const;
+  std::string chain_operator_to_string(int index) const;
 
   /*@}*/
 
@@ -128,11 +170,16 @@ class CHAIN : public ECA_AUDIO_POSITION {
 
   void add_chain_operator(CHAIN_OPERATOR* chainop);
   void add_controller(GENERIC_CONTROLLER* gcontroller);
-  void remove_chain_operator(int op_index);
+  void remove_chain_operator(int op_index, bool delete_objects = true);
+
+  void share_objects(const CHAIN* orig);
+  bool shares_objects_with(const CHAIN* other) const;
+  void detach_objects(const CHAIN* other);
 
   void bypass_operator(int op_index, int bypassed);
 
   void set_parameter(int op_index, int param_index, CHAIN_OPERATOR::parameter_t value);
+  bool parameter_needs_init(int op_index, int param_index, CHAIN_OPERATOR::parameter_t value) const;
 
   int number_of_chain_operators(void) const { return chainops_rep.size(); }
   int number_of_chain_operator_parameters(int index) const;
@@ -165,7 +212,7 @@ class CHAIN : public ECA_AUDIO_POSITION {
 
   const CHAIN_OPERATOR* get_selected_chain_operator(void) const;
 
-  void remove_controller(void);
+  void remove_controller(bool delete_objects = true);
   void select_controller(int index);
   void select_controller_parameter(int index);
 
@@ -215,11 +262,19 @@ class CHAIN : public ECA_AUDIO_POSITION {
  private:
 
   bool is_valid_op_index(int op_index) const;
+  bool uses_object(const OPERATOR* obj) const;
+  bool needs_segments(long int buflen) const;
+  void init_controller_ramps(void);
+  void controller_update_ramps(void);
+  void process_chainops(SAMPLE_BUFFER* sbuf);
+  void process_segments(bool ramps);
 
   class COP_CONTAINER {
   public:
     CHAIN_OPERATOR* cop;
     bool bypassed;
+    long long int profile_time;
+    ECA_PROFILE_HISTOGRAM profile;
   };
 
   bool initialized_rep;
@@ -245,6 +300,15 @@ class CHAIN : public ECA_AUDIO_POSITION {
 
   SAMPLE_BUFFER* audioslot_repp;
 
+  long int ctrl_resolution_rep;
+  bool ctrl_segments_rep;
+  std::vector<std::vector<CHAIN_OPERATOR::parameter_t> > ctrl_ramps_rep;
+  SAMPLE_BUFFER* segment_repp;
+  ECA_WORKER_POOL* worker_pool_repp;
+
+  bool profiling_rep;
+  ECA_PROFILE_HISTOGRAM profile_rep;
+
 };
 
 #endif
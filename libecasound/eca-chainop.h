@@ -9,6 +9,7 @@
 #include "sample-specs.h"
 
 class SAMPLE_BUFFER;
+class ECA_WORKER_POOL;
 
 /**
  * Virtual base class for chain operators. 
@@ -96,6 +97,55 @@ class CHAIN_OPERATOR : public OPERATOR {
    * @see process()
    */
   virtual int output_channels(int i_channels) const { return(i_channels); }
+
+  /**
+   * Whether parameter 'param' can follow per-sample values
+   * given with set_parameter_ramp().
+   *
+   * Chain operator types that can change the parameter
+   * smoothly during one call to process() should
+   * reimplement this function and set_parameter_ramp().
+   *
+   * @see set_parameter_ramp()
+   */
+  virtual bool supports_parameter_ramp(int param) const { return(false); }
+
+  /**
+   * Sets per-sample values of parameter 'param' for the next
+   * call to process(). 'values' holds one value for each
+   * sample frame processed, and stays valid until process()
+   * returns. Afterwards the parameter should keep the last
+   * value of the ramp.
+   *
+   * Only called if supports_parameter_ramp(param) is true.
+   */
+  virtual void set_parameter_ramp(int param, const parameter_t* values) { }
+
+  /**
+   * Whether setting parameter 'param' to 'value' requires
+   * the chain operator to be initialized again, for example
+   * because it needs to allocate more memory. Such changes
+   * are not made in the engine thread. Instead the chain
+   * is replaced with an initialized copy.
+   *
+   * Chain operators that only allocate memory in init()
+   * should reimplement this function.
+   *
+   * @see ECA_CONTROL::execute_edit_on_connected()
+   */
+  virtual bool parameter_needs_init(int param, parameter_t value) const { return(false); }
+
+  /**
+   * Sets a worker pool that the chain operator may use
+   * to process independent parts of its work (for example
+   * separate channels) in parallel. The pool may be shared
+   * with other chain operators, so it must be used with 
+   * ECA_WORKER_POOL::try_execute(). A null 'pool' disables
+   * parallel processing.
+   *
+   * Called before init().
+   */
+  virtual void set_worker_pool(ECA_WORKER_POOL* pool) { }
 };
 
 #endif
@@ -36,6 +36,8 @@ namespace ECA {
     edit_cop_set_param,
     edit_ctrl_add,
     edit_ctrl_set_param,
+    edit_cop_remove,
+    edit_ctrl_remove,
   };
 
   /*
@@ -48,6 +50,12 @@ namespace ECA {
    * Using edit objects avoids duplicated code to describe
    * and parse the needed actions in both ECA_ENGINE and 
    * ECA_CONTROL.
+   *
+   * Edits that change the structure of a chain (adding
+   * or removing operators and controllers) are applied 
+   * to a running chainsetup by building an edited copy
+   * of the chain, and replacing the original in the
+   * engine (see ECA_CHAINSETUP::create_edited_chain()).
    */
 
   struct chainsetup_edit {
@@ -58,7 +66,7 @@ namespace ECA {
     /* FIXME: should a version tag be added as way to invalidate
      *        edit objects in case chainsetup is modified */
 
-    union {
+    union params {
       struct {
 	int chain;     /**< @see ECA_CHAINSETUP::get_chain_index() */
 	int val;
@@ -92,6 +100,16 @@ namespace ECA {
 	int param;     /**< @see CHAIN::set_controller_parameter() */
 	double value;  /**< @see CHAIN::set_controller_parameter() */
       } ctrl_set_param;
+
+      struct {
+	int chain;     /**< @see ECA_CHAINSETUP::get_chain_index() */
+	int op;        /**< @see CHAIN::remove_chain_operator() */
+      } cop_remove;
+
+      struct {
+	int chain;     /**< @see ECA_CHAINSETUP::get_chain_index() */
+	int ctrl;      /**< @see CHAIN::select_controller() */
+      } ctrl_remove;
     } m;
 
     bool need_chain_reinit;
@@ -447,6 +447,59 @@ void ECA_CHAINSETUP_PARSER::interpret_general_option (const string& argu)
 	  csetup_repp->set_mix_mode(ECA_CHAINSETUP::cs_mmode_avg);
 	}
       }
+      else if (first_arg == "threads") {
+	int threads = atoi(kvu_get_argument_number(2, argu).c_str());
+	if (threads < 1) threads = 1;
+	csetup_repp->set_worker_threads(threads);
+	if (threads > 1)
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Processing chains with " + 
+		      kvu_numtostr(threads) + " threads.");
+	else
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Processing chains in the engine thread only.");
+      }
+      else if (first_arg == "nothreads") {
+	ECA_LOG_MSG(ECA_LOGGER::info, "Processing chains in the engine thread only.");
+	csetup_repp->set_worker_threads(1);
+      }
+      else if (first_arg == "dbthreads") {
+	int threads = atoi(kvu_get_argument_number(2, argu).c_str());
+	if (threads < 1) threads = 1;
+	csetup_repp->set_db_threads(threads);
+	ECA_LOG_MSG(ECA_LOGGER::info, "Servicing double-buffered objects with " + 
+		    kvu_numtostr(threads) + " i/o threads.");
+      }
+      else if (first_arg == "dbrealtime") {
+	ECA_LOG_MSG(ECA_LOGGER::info, "Using realtime scheduling for double-buffer i/o threads.");
+	csetup_repp->toggle_db_realtime(true);
+      }
+      else if (first_arg == "nodbrealtime") {
+	csetup_repp->toggle_db_realtime(false);
+      }
+      else if (first_arg == "opthreads") {
+	int threads = atoi(kvu_get_argument_number(2, argu).c_str());
+	if (threads < 1) threads = 1;
+	csetup_repp->set_operator_threads(threads);
+	if (threads > 1)
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Running per-channel plugin instances with " + 
+		      kvu_numtostr(threads) + " threads.");
+      }
+      else if (first_arg == "ctrlres") {
+	long int frames = atol(kvu_get_argument_number(2, argu).c_str());
+	if (frames < 0) frames = 0;
+	csetup_repp->set_controller_resolution(frames);
+	if (frames > 0)
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Updating controllers every " + 
+		      kvu_numtostr(frames) + " sample frames.");
+	else
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Updating controllers once per buffer.");
+      }
+      else if (first_arg == "profile") {
+	ECA_LOG_MSG(ECA_LOGGER::info, "Collecting chain and chain operator processing times.");
+	csetup_repp->toggle_profiling(true);
+      }
+      else if (first_arg == "noprofile") {
+	csetup_repp->toggle_profiling(false);
+      }
       break;
     }
   default: { match = false; }
@@ -1134,6 +1187,24 @@ string ECA_CHAINSETUP_PARSER::general_options_to_string(void) const
   else
     t << " -z:mixmode,sum";
 
+  if (csetup_repp->worker_threads() > 1)
+    t << " -z:threads," << csetup_repp->worker_threads();
+
+  if (csetup_repp->db_threads() > 1)
+    t << " -z:dbthreads," << csetup_repp->db_threads();
+
+  if (csetup_repp->db_realtime() == true)
+    t << " -z:dbrealtime";
+
+  if (csetup_repp->operator_threads() > 1)
+    t << " -z:opthreads," << csetup_repp->operator_threads();
+
+  if (csetup_repp->controller_resolution() > 0)
+    t << " -z:ctrlres," << csetup_repp->controller_resolution();
+
+  if (csetup_repp->profiling() == true)
+    t << " -z:profile";
+
   t.setprecision(3);
   if (csetup_repp->max_length_set()) {
     t << " -t:" << csetup_repp->max_length_in_seconds_exact();
@@ -270,6 +270,12 @@ void ECA_CHAINSETUP::set_defaults(void)
 
   precise_sample_rates_rep = false;
   ignore_xruns_rep = true;
+  worker_threads_rep = 1;
+  db_threads_rep = 1;
+  db_realtime_rep = false;
+  operator_threads_rep = 1;
+  controller_resolution_rep = 0;
+  profiling_rep = false;
 
   pserver_repp = &impl_repp->pserver_rep;
   midi_server_repp = &impl_repp->midi_server_rep;
@@ -288,6 +294,7 @@ void ECA_CHAINSETUP::set_defaults(void)
   memory_locked_rep = false;
   midi_server_needed_rep = false;
   is_locked_rep = false;
+  edit_chain_repp = 0;
   selected_chain_index_rep = 0;
   selected_ctrl_index_rep = 0;
   selected_ctrl_param_index_rep = 0;
@@ -601,6 +608,12 @@ void ECA_CHAINSETUP::enable_active_buffering_mode(void)
     if (buffersize() != 0) {
       impl_repp->pserver_rep.set_buffer_defaults(double_buffer_size() / buffersize(), 
 						 buffersize());
+      impl_repp->pserver_rep.set_io_threads(db_threads());
+      /* note: if enabled with -z:dbrealtime, i/o threads run
+       *       just below the engine thread */
+      impl_repp->pserver_rep.set_schedrealtime(raised_priority() == true &&
+					       db_realtime() == true);
+      impl_repp->pserver_rep.set_schedpriority(get_sched_priority() > 1 ? get_sched_priority() - 1 : 1);
     }
     else {
       ECA_LOG_MSG(ECA_LOGGER::info,
@@ -2015,11 +2028,35 @@ bool ECA_CHAINSETUP::execute_edit(const chainsetup_edit_t& edit)
 	break;
       }
 
-#if NOT_YET_IMPLEMENTED
     case edit_cop_remove:
+      {
+	if (edit.m.cop_remove.chain < 1 ||
+	    edit.m.cop_remove.chain > static_cast<int>(chains.size())) {
+	  retval = false;
+	  break;
+	}
+	CHAIN *ch = chains[edit.m.cop_remove.chain - 1];
+	ch->remove_chain_operator(edit.m.cop_remove.op);
+	break;
+      }
+
     case edit_ctrl_remove:
-      // pass through on purpose
-#endif
+      {
+	if (edit.m.ctrl_remove.chain < 1 ||
+	    edit.m.ctrl_remove.chain > static_cast<int>(chains.size())) {
+	  retval = false;
+	  break;
+	}
+	CHAIN *ch = chains[edit.m.ctrl_remove.chain - 1];
+	if (edit.m.ctrl_remove.ctrl < 1 ||
+	    edit.m.ctrl_remove.ctrl > ch->number_of_controllers()) {
+	  retval = false;
+	  break;
+	}
+	ch->select_controller(edit.m.ctrl_remove.ctrl);
+	ch->remove_controller();
+	break;
+      }
 
     case edit_cop_add:
     case edit_ctrl_add:
@@ -2100,6 +2137,333 @@ bool ECA_CHAINSETUP::execute_edit(const chainsetup_edit_t& edit)
   return retval;
 }
 
+/**
+ * Selects the copy of 'target' in 'copy' as the target 
+ * for new controllers. 'target' is a chain operator or 
+ * controller of 'orig'.
+ *
+ * @see ECA_CHAINSETUP::create_edited_chain()
+ */
+static bool eca_chainsetup_select_copied_target(const CHAIN* orig, CHAIN* copy, const OPERATOR* target)
+{
+  for(int n = 0; n < orig->number_of_chain_operators(); n++) {
+    if (orig->get_chain_operator(n) == target) {
+      copy->select_chain_operator(n + 1);
+      return true;
+    }
+  }
+  for(int n = 0; n < orig->number_of_controllers() && n < copy->number_of_controllers(); n++) {
+    if (orig->get_controller(n) == target) {
+      copy->select_controller(n + 1);
+      copy->selected_controller_as_target();
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Copies the chain operator and controller selections
+ * of 'orig' to 'copy', which has the same objects, or
+ * copies of them, in the same order.
+ *
+ * @see ECA_CHAINSETUP::create_edited_chain()
+ */
+static void eca_chainsetup_copy_selections(const CHAIN* orig, CHAIN* copy)
+{
+  copy->select_chain_operator(orig->selected_chain_operator());
+  if (orig->selected_chain_operator_parameter() > 0)
+    copy->select_chain_operator_parameter(orig->selected_chain_operator_parameter());
+  if (orig->selected_controller() > 0) {
+    copy->select_controller(orig->selected_controller());
+    copy->select_controller_parameter(orig->selected_controller_parameter());
+    if (orig->selected_target() != 0 &&
+	orig->selected_target() == orig->get_selected_controller())
+      copy->selected_controller_as_target();
+  }
+}
+
+/**
+ * Creates a copy of the chain that is modified by 'edit',
+ * and applies the edit to the copy. The original chain
+ * is not modified.
+ *
+ * If the original chain is initialized, and the edited
+ * chain can be taken into use without reinitializing
+ * the existing objects (see CHAIN::can_init_in_place_of()),
+ * the copy shares the chain operators and controllers of 
+ * the original chain, so they keep their internal state,
+ * e.g. filter history. Otherwise the copy has new instances
+ * of all chain operators and controllers, with the same 
+ * parameter values, bypass states and selections as the 
+ * original, but without their internal state.
+ *
+ * This is used to perform structural edits on a running
+ * chainsetup: the copy is initialized outside the engine
+ * thread, and then swapped in place of the original
+ * chain (see ECA_ENGINE::replace_chain()).
+ *
+ * Supported edit types are edit_cop_add, edit_cop_remove,
+ * edit_ctrl_add, edit_ctrl_remove and edit_cop_set_param.
+ * The last one is only needed if edit_needs_init() is true,
+ * and always creates new instances, as the edited chain
+ * operator must be initialized again.
+ *
+ * @return the new chain, owned by the caller, or 0 if 
+ *         the edit cannot be performed
+ */
+CHAIN* ECA_CHAINSETUP::create_edited_chain(const chainsetup_edit_t& edit)
+{
+  if (edit.cs_ptr != this) {
+    ECA_LOG_MSG(ECA_LOGGER::errors, 
+		"ERROR: chainsetup edit executed on wrong object");
+    return 0;
+  }
+
+  int c = -1;
+  switch(edit.type)
+    {
+    case edit_cop_add:
+    case edit_ctrl_add: { c = edit.m.c_generic_param.chain; break; }
+    case edit_cop_remove: { c = edit.m.cop_remove.chain; break; }
+    case edit_ctrl_remove: { c = edit.m.ctrl_remove.chain; break; }
+    case edit_cop_set_param: { c = edit.m.cop_set_param.chain; break; }
+    default: { break; }
+    }
+  if (c < 1 || c > static_cast<int>(chains.size()))
+    return 0;
+
+  const CHAIN* orig = chains[c - 1];
+
+  /* step: direct parsed objects to the copy */
+  vector<string> saved_chainids = selected_chainids;
+  selected_chainids = vector<string> (1, orig->name());
+  bool locked = is_locked_rep;
+  is_locked_rep = false;
+
+  CHAIN* copy = 0;
+  bool failed = false;
+  if (orig->is_initialized() == true &&
+      edit.type != edit_cop_set_param) {
+    copy = create_chain_copy(orig, true);
+    failed = (apply_chain_edit(edit, copy, true) != true);
+    if (failed == true ||
+	copy->can_init_in_place_of(orig) != true) {
+      copy->detach_objects(orig);
+      delete copy;
+      copy = 0;
+    }
+  }
+
+  if (copy == 0 && failed != true) {
+    copy = create_chain_copy(orig, false);
+    if (copy != 0 && apply_chain_edit(edit, copy, false) != true) {
+      delete copy;
+      copy = 0;
+    }
+  }
+
+  edit_chain_repp = 0;
+  is_locked_rep = locked;
+  selected_chainids = saved_chainids;
+
+  return copy;
+}
+
+/**
+ * Whether 'edit' changes a chain operator parameter in a
+ * way that requires initializing the operator again (see
+ * CHAIN_OPERATOR::parameter_needs_init()). Such edits
+ * must not be executed by the engine thread. Instead the
+ * chain is replaced with an edited copy.
+ *
+ * @see create_edited_chain()
+ */
+bool ECA_CHAINSETUP::edit_needs_init(const chainsetup_edit_t& edit) const
+{
+  if (edit.type != edit_cop_set_param ||
+      edit.m.cop_set_param.chain < 1 ||
+      edit.m.cop_set_param.chain > static_cast<int>(chains.size()))
+    return false;
+
+  const CHAIN *ch = chains[edit.m.cop_set_param.chain - 1];
+  return ch->parameter_needs_init(edit.m.cop_set_param.op,
+				  edit.m.cop_set_param.param,
+				  edit.m.cop_set_param.value);
+}
+
+/**
+ * Whether 'edit' adds chains or audio objects, or changes
+ * the input or output a chain is connected to. Such edits
+ * cannot be done by replacing a chain of a connected
+ * chainsetup (see ECA_ENGINE::can_replace_chain()).
+ */
+bool ECA_CHAINSETUP::edit_changes_routing(const chainsetup_edit_t& edit) const
+{
+  if (edit.type != edit_cop_add &&
+      edit.type != edit_ctrl_add)
+    return false;
+
+  string params = edit.param;
+  if (params.size() > 0 && params[0] == '-')
+    params.erase(0, 1);
+  if (params.size() < 1)
+    return false;
+
+  /* note: see ECA_CHAINSETUP_PARSER::interpret_chains()
+   *       and interpret_audioio_device() */
+  if ((params[0] == 'a' || params[0] == 'i' || params[0] == 'o') &&
+      (params.size() == 1 || params[1] == ':'))
+    return true;
+
+  return false;
+}
+
+/**
+ * Creates a copy of chain 'orig' with the same settings,
+ * chain operators and controllers. If 'share' is true, 
+ * the copy uses the objects of 'orig' (see 
+ * CHAIN::share_objects()), otherwise new instances 
+ * are created. 
+ *
+ * Sets 'edit_chain_repp' to the copy.
+ *
+ * @see create_edited_chain()
+ * @return the new chain, or 0 on error
+ */
+CHAIN* ECA_CHAINSETUP::create_chain_copy(const CHAIN* orig, bool share)
+{
+  CHAIN* copy = new CHAIN();
+  copy->name(orig->name());
+  copy->set_samples_per_second(samples_per_second());
+  copy->seek_position_in_samples(orig->position_in_samples());
+  copy->set_mute(orig->is_muted());
+  copy->set_bypass(orig->is_bypassed());
+  copy->set_controller_resolution(controller_resolution());
+  if (orig->connected_input() >= 0)
+    copy->connect_input(orig->connected_input());
+  if (orig->connected_output() >= 0)
+    copy->connect_output(orig->connected_output());
+
+  edit_chain_repp = copy;
+
+  if (share == true) {
+    copy->share_objects(orig);
+    eca_chainsetup_copy_selections(orig, copy);
+    return copy;
+  }
+
+  bool ok = true;
+
+  /* step: recreate chain operators */
+  for(int n = 0; n < orig->number_of_chain_operators() && ok == true; n++) {
+    cparser_rep.interpret_object_option(orig->chain_operator_to_string(n));
+    if (interpret_result() != true ||
+	copy->number_of_chain_operators() != n + 1) {
+      ok = false;
+      break;
+    }
+    const CHAIN_OPERATOR* src = orig->get_chain_operator(n);
+    const CHAIN_OPERATOR* dst = copy->get_chain_operator(n);
+    for(int p = 1; p <= src->number_of_params() && p <= dst->number_of_params(); p++) {
+      copy->set_parameter(n + 1, p, src->get_parameter(p));
+    }
+    copy->bypass_operator(n + 1, orig->is_operator_bypassed(n + 1) == true ? 1 : 0);
+  }
+
+  /* step: recreate controllers in original order */
+  for(int n = 0; n < orig->number_of_controllers() && ok == true; n++) {
+    const GENERIC_CONTROLLER* src = orig->get_controller(n);
+    if (eca_chainsetup_select_copied_target(orig, copy, src->target_pointer()) != true) {
+      ok = false;
+      break;
+    }
+    cparser_rep.interpret_object_option(ECA_OBJECT_FACTORY::controller_to_eos(src));
+    if (interpret_result() != true ||
+	copy->number_of_controllers() != n + 1) {
+      ok = false;
+      break;
+    }
+    const GENERIC_CONTROLLER* dst = copy->get_controller(n);
+    for(int p = 1; p <= src->number_of_params() && p <= dst->number_of_params(); p++) {
+      copy->set_controller_parameter(n + 1, p, src->get_parameter(p));
+    }
+  }
+
+  if (ok != true) {
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"ERROR: unable to copy chain \"" + orig->name() + "\"");
+    edit_chain_repp = 0;
+    delete copy;
+    return 0;
+  }
+
+  eca_chainsetup_copy_selections(orig, copy);
+  return copy;
+}
+
+/**
+ * Applies 'edit' to chain copy 'copy'. If 'shared' is 
+ * true, objects removed from the copy are not deleted, 
+ * as they are owned by the original chain.
+ *
+ * @see create_edited_chain()
+ */
+bool ECA_CHAINSETUP::apply_chain_edit(const chainsetup_edit_t& edit, CHAIN* copy, bool shared)
+{
+  bool ok = true;
+
+  switch(edit.type)
+    {
+    case edit_cop_add:
+    case edit_ctrl_add:
+      {
+	const string& params = edit.param;
+	if (params.size() > 0 && params[0] == '-')
+	  cparser_rep.interpret_object_option(params);
+	else
+	  cparser_rep.interpret_object_option(string("-") + edit.param);
+	if (interpret_result() != true) {
+	  ECA_LOG_MSG(ECA_LOGGER::errors,
+		      "cop-add error " + 
+		      interpret_result_verbose());
+	  ok = false;
+	}
+	break;
+      }
+
+    case edit_cop_remove:
+      {
+	copy->remove_chain_operator(edit.m.cop_remove.op, shared != true);
+	break;
+      }
+
+    case edit_ctrl_remove:
+      {
+	if (edit.m.ctrl_remove.ctrl < 1 ||
+	    edit.m.ctrl_remove.ctrl > copy->number_of_controllers()) {
+	  ok = false;
+	  break;
+	}
+	copy->select_controller(edit.m.ctrl_remove.ctrl);
+	copy->remove_controller(shared != true);
+	break;
+      }
+
+    case edit_cop_set_param:
+      {
+	copy->set_parameter(edit.m.cop_set_param.op,
+			    edit.m.cop_set_param.param,
+			    edit.m.cop_set_param.value);
+	break;
+      }
+
+    default: { ok = false; break; }
+    }
+
+  return ok;
+}
+
 /**
  * Updates the chainsetup processing length based on 
  * 1) requested length, 2) lengths of individual 
@@ -2432,15 +2796,9 @@ const ECA_AUDIO_FORMAT& ECA_CHAINSETUP::default_audio_format(void) const
  * Select controllers as targets for parameter control
  */
 void ECA_CHAINSETUP::set_target_to_controller(void) {
-  vector<string> schains = selected_chains();
-  for(vector<string>::const_iterator a = schains.begin(); a != schains.end(); a++) {
-    for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
-      if (*a == (*q)->name()) {
-	(*q)->selected_controller_as_target();
-	return;
-      }
-    }
-  }
+  CHAIN* q = edit_target_chain();
+  if (q != 0)
+    q->selected_controller_as_target();
 }
 
 /**
@@ -2468,16 +2826,9 @@ void ECA_CHAINSETUP::add_controller(GENERIC_CONTROLLER* csrc)
   DBC_CHECK(buffersize() != 0);
   DBC_CHECK(samples_per_second() != 0);
 
-  vector<string> schains = selected_chains();
-  for(vector<string>::const_iterator a = schains.begin(); a != schains.end(); a++) {
-    for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
-      if (*a == (*q)->name()) {
-	if ((*q)->selected_target() == 0) return;
-	(*q)->add_controller(csrc);
-	return;
-      }
-    }
-  }
+  CHAIN* q = edit_target_chain();
+  if (q != 0 && q->selected_target() != 0)
+    q->add_controller(csrc);
 }
 
 /**
@@ -2496,23 +2847,83 @@ void ECA_CHAINSETUP::add_chain_operator(CHAIN_OPERATOR* cotmp)
   // --------
   
 #ifndef ECA_DISABLE_EFFECTS
+  /* note: stamps of an edited chain copy are registered 
+   *       only when the copy is taken into use, see 
+   *       create_audio_stamp_table() */
   AUDIO_STAMP* p = dynamic_cast<AUDIO_STAMP*>(cotmp);
-  if (p != 0) {
+  if (p != 0 && edit_chain_repp == 0) {
     impl_repp->stamp_server_rep.register_stamp(p);
   }
 #endif
 
+  CHAIN* q = edit_target_chain();
+  if (q != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, "Adding chainop to chain " + q->name() + ".");
+    q->add_chain_operator(cotmp);
+    q->selected_chain_operator_as_target();
+  }
+}
+
+/**
+ * Returns the chain that add_chain_operator() and 
+ * add_controller() modify: the first selected chain,
+ * or the chain copy being built by create_edited_chain().
+ * If no chain is found, 0 is returned.
+ */
+CHAIN* ECA_CHAINSETUP::edit_target_chain(void)
+{
+  if (edit_chain_repp != 0)
+    return edit_chain_repp;
+
   vector<string> schains = selected_chains();
   for(vector<string>::const_iterator p = schains.begin(); p != schains.end(); p++) {
     for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
       if (*p == (*q)->name()) {
-	ECA_LOG_MSG(ECA_LOGGER::system_objects, "Adding chainop to chain " + (*q)->name() + ".");
-	(*q)->add_chain_operator(cotmp);
-	(*q)->selected_chain_operator_as_target();
-	return;
+	return *q;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Creates a new table of the audio stamps of all chains,
+ * with 'new_chain' in place of chain 'chain' (0...N-1).
+ * The table is taken into use with swap_audio_stamp_table().
+ *
+ * @see ECA_ENGINE::replace_chain()
+ */
+AUDIO_STAMP_SERVER* ECA_CHAINSETUP::create_audio_stamp_table(int chain, const CHAIN* new_chain) const
+{
+  AUDIO_STAMP_SERVER* table = new AUDIO_STAMP_SERVER();
+#ifndef ECA_DISABLE_EFFECTS
+  for(int c = 0; c < static_cast<int>(chains.size()); c++) {
+    const CHAIN* ch = (c == chain) ? new_chain : chains[c];
+    for(int n = 0; n < ch->number_of_chain_operators(); n++) {
+      const AUDIO_STAMP* p = dynamic_cast<const AUDIO_STAMP*>(ch->get_chain_operator(n));
+      if (p != 0) {
+	table->register_stamp(const_cast<AUDIO_STAMP*>(p));
       }
     }
   }
+#endif
+  return table;
+}
+
+/**
+ * Takes audio stamp table 'table' into use, and 
+ * stores the previous table to 'table'.
+ *
+ * Execution note: does not allocate memory; when called 
+ *                 for a running chainsetup, must be called 
+ *                 from the engine thread
+ *
+ * @see create_audio_stamp_table()
+ */
+void ECA_CHAINSETUP::swap_audio_stamp_table(AUDIO_STAMP_SERVER* table)
+{
+  impl_repp->stamp_server_rep.swap(table);
 }
 
 /**
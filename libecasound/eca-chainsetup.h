@@ -36,6 +36,7 @@
 class AUDIO_IO;
 class AUDIO_IO_MANAGER;
 class AUDIO_IO_DB_SERVER;
+class AUDIO_STAMP_SERVER;
 class CHAIN;
 class CHAIN_OPERATOR;
 class CONTROLLER_SOURCE;
@@ -189,6 +190,12 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   void set_buffering_mode(Buffering_mode_t value);
   void set_audio_io_manager_option(const string& mgrname, const string& optionstr);
   void set_mix_mode(Mix_mode_t value) { mix_mode_rep = value; }
+  void set_worker_threads(int value) { worker_threads_rep = value; }
+  void set_db_threads(int value) { db_threads_rep = value; }
+  void toggle_db_realtime(bool value) { db_realtime_rep = value; }
+  void set_operator_threads(int value) { operator_threads_rep = value; }
+  void set_controller_resolution(long int frames) { controller_resolution_rep = frames; }
+  void toggle_profiling(bool value) { profiling_rep = value; }
 
   bool precise_sample_rates(void) const { return precise_sample_rates_rep; }
   bool ignore_xruns(void) const { return ignore_xruns_rep; }
@@ -200,6 +207,12 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   bool multitrack_mode(void) const { return multitrack_mode_rep; }
   long int multitrack_mode_offset(void) const { return multitrack_mode_offset_rep; } 
   Mix_mode_t mix_mode(void) const { return mix_mode_rep; }
+  int worker_threads(void) const { return worker_threads_rep; }
+  int db_threads(void) const { return db_threads_rep; }
+  bool db_realtime(void) const { return db_realtime_rep; }
+  int operator_threads(void) const { return operator_threads_rep; }
+  long int controller_resolution(void) const { return controller_resolution_rep; }
+  bool profiling(void) const { return profiling_rep; }
 
   /*@}*/
 
@@ -238,6 +251,9 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   const string& filename(void) const { return setup_filename_rep; }
 
   bool execute_edit(const ECA::chainsetup_edit_t& edit);
+  CHAIN* create_edited_chain(const ECA::chainsetup_edit_t& edit);
+  bool edit_needs_init(const ECA::chainsetup_edit_t& edit) const;
+  bool edit_changes_routing(const ECA::chainsetup_edit_t& edit) const;
 
   /*@}*/
 
@@ -329,6 +345,12 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   bool rtcaps_rep;
   int output_openmode_rep;
   long int double_buffer_size_rep;
+  int worker_threads_rep;
+  int db_threads_rep;
+  bool db_realtime_rep;
+  int operator_threads_rep;
+  long int controller_resolution_rep;
+  bool profiling_rep;
   string default_midi_device_rep;
 
   /*@}*/
@@ -344,6 +366,7 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   bool multitrack_mode_override_rep;
   bool memory_locked_rep;
   bool midi_server_needed_rep;
+  CHAIN* edit_chain_repp;
 
   /* FIXME: only needed by ECA_ENGINE */
   int selected_chain_index_rep;
@@ -442,6 +465,11 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   int number_of_attached_chains_to_input(AUDIO_IO* aiod) const;
   int number_of_attached_chains_to_output(AUDIO_IO* aiod) const;
   void add_chain_helper(const string& name);
+  CHAIN* edit_target_chain(void);
+  CHAIN* create_chain_copy(const CHAIN* orig, bool share);
+  bool apply_chain_edit(const ECA::chainsetup_edit_t& edit, CHAIN* copy, bool shared);
+  AUDIO_STAMP_SERVER* create_audio_stamp_table(int chain, const CHAIN* new_chain) const;
+  void swap_audio_stamp_table(AUDIO_STAMP_SERVER* table);
   void enable_audio_object_helper(AUDIO_IO* aobj) const;
   void calculate_processing_length(void);
 
@@ -22,7 +22,12 @@
 
 #include <string>
 
+#include "eca-chain.h"
+#include "eca-chainop.h"
 #include "eca-chainsetup.h"
+#include "eca-chainsetup-edit.h"
+#include "generic-controller.h"
+#include "samplebuffer.h"
 #include "kvu_numtostr.h"
 
 #include "eca-logger.h"
@@ -49,12 +54,159 @@ public:
 private:
 
   void do_run_save_and_restore(void);
+  void do_run_edited_chain(void);
 
 };
 
 void ECA_CHAINSETUP_TEST::do_run(void)
 {
   do_run_save_and_restore();
+  do_run_edited_chain();
+}
+
+void ECA_CHAINSETUP_TEST::do_run_edited_chain(void)
+{
+  ECA_CHAINSETUP csetup;
+  csetup.interpret_option("-a:1");
+  csetup.interpret_option("-ea:150");
+  csetup.interpret_option("-efl:800");
+  csetup.interpret_option("-kos:1,0,100,1,0");
+  const CHAIN* orig = csetup.get_chain_with_name("1");
+  if (orig == 0 || 
+      orig->number_of_chain_operators() != 2 ||
+      orig->number_of_controllers() != 1) {
+    ECA_TEST_FAILURE("chain setup");
+    return;
+  }
+  const_cast<CHAIN*>(orig)->bypass_operator(1, 1);
+
+  ECA::chainsetup_edit_t edit;
+  edit.cs_ptr = &csetup;
+  edit.need_chain_reinit = true;
+
+  /* case: add chain operator */
+  edit.type = ECA::edit_cop_add;
+  edit.m.c_generic_param.chain = 1;
+  edit.param = "-ea:50";
+  CHAIN* copy = csetup.create_edited_chain(edit);
+  if (copy == 0) {
+    ECA_TEST_FAILURE("cop-add");
+  }
+  else {
+    if (copy == orig ||
+	copy->name() != "1" ||
+	copy->number_of_chain_operators() != 3 ||
+	copy->number_of_controllers() != 1) {
+      ECA_TEST_FAILURE("cop-add structure");
+    }
+    else {
+      if (copy->get_chain_operator(0) == orig->get_chain_operator(0) ||
+	  copy->get_chain_operator(0)->get_parameter(1) != 150 ||
+	  copy->get_chain_operator(1)->get_parameter(1) != 800 ||
+	  copy->get_chain_operator(2)->get_parameter(1) != 50) {
+	ECA_TEST_FAILURE("cop-add parameters");
+      }
+      if (copy->is_operator_bypassed(1) != true ||
+	  copy->is_operator_bypassed(2) != false) {
+	ECA_TEST_FAILURE("cop-add bypass");
+      }
+      if (copy->get_controller(0)->target_pointer() != copy->get_chain_operator(1)) {
+	ECA_TEST_FAILURE("cop-add controller target");
+      }
+    }
+    delete copy;
+  }
+  if (orig->number_of_chain_operators() != 2) {
+    ECA_TEST_FAILURE("original modified");
+  }
+
+  /* case: remove chain operator and its controller */
+  edit.type = ECA::edit_cop_remove;
+  edit.m.cop_remove.chain = 1;
+  edit.m.cop_remove.op = 2;
+  copy = csetup.create_edited_chain(edit);
+  if (copy == 0 ||
+      copy->number_of_chain_operators() != 1 ||
+      copy->number_of_controllers() != 0) {
+    ECA_TEST_FAILURE("cop-remove");
+  }
+  delete copy;
+
+  /* case: remove controller */
+  edit.type = ECA::edit_ctrl_remove;
+  edit.m.ctrl_remove.chain = 1;
+  edit.m.ctrl_remove.ctrl = 1;
+  copy = csetup.create_edited_chain(edit);
+  if (copy == 0 ||
+      copy->number_of_chain_operators() != 2 ||
+      copy->number_of_controllers() != 0) {
+    ECA_TEST_FAILURE("ctrl-remove");
+  }
+  delete copy;
+
+  /* case: an initialized chain shares its objects with 
+   *       the copy, and the copy is initialized in place */
+  SAMPLE_BUFFER sbuf (256, 1);
+  const_cast<CHAIN*>(orig)->init(&sbuf, 1, 1);
+  edit.type = ECA::edit_cop_add;
+  edit.m.c_generic_param.chain = 1;
+  edit.param = "-ea:50";
+  copy = csetup.create_edited_chain(edit);
+  if (copy == 0 ||
+      copy->number_of_chain_operators() != 3 ||
+      copy->get_chain_operator(0) != orig->get_chain_operator(0) ||
+      copy->get_controller(0) != orig->get_controller(0) ||
+      copy->is_operator_bypassed(1) != true ||
+      copy->can_init_in_place_of(orig) != true) {
+    ECA_TEST_FAILURE("shared cop-add");
+  }
+  else {
+    copy->init_in_place_of(orig);
+    if (copy->is_initialized() != true ||
+	orig->is_initialized() != true) {
+      ECA_TEST_FAILURE("init in place");
+    }
+    copy->detach_objects(orig);
+    if (copy->number_of_chain_operators() != 1 ||
+	orig->number_of_chain_operators() != 2) {
+      ECA_TEST_FAILURE("detach objects");
+    }
+  }
+  delete copy;
+
+  edit.type = ECA::edit_cop_remove;
+  edit.m.cop_remove.chain = 1;
+  edit.m.cop_remove.op = 2;
+  copy = csetup.create_edited_chain(edit);
+  if (copy == 0 ||
+      copy->number_of_chain_operators() != 1 ||
+      copy->number_of_controllers() != 0 ||
+      copy->get_chain_operator(0) != orig->get_chain_operator(0) ||
+      orig->number_of_chain_operators() != 2 ||
+      orig->number_of_controllers() != 1) {
+    ECA_TEST_FAILURE("shared cop-remove");
+  }
+  if (copy != 0)
+    copy->detach_objects(orig);
+  delete copy;
+  const_cast<CHAIN*>(orig)->release();
+
+  /* case: invalid edits */
+  edit.type = ECA::edit_ctrl_remove;
+  edit.m.ctrl_remove.chain = 1;
+  edit.m.ctrl_remove.ctrl = 2;
+  if (csetup.create_edited_chain(edit) != 0) {
+    ECA_TEST_FAILURE("invalid controller");
+  }
+  edit.m.ctrl_remove.chain = 2;
+  if (csetup.create_edited_chain(edit) != 0) {
+    ECA_TEST_FAILURE("invalid chain");
+  }
+  edit.type = ECA::edit_c_muting;
+  edit.m.c_muting.chain = 1;
+  if (csetup.create_edited_chain(edit) != 0) {
+    ECA_TEST_FAILURE("unsupported edit");
+  }
 }
 
 void ECA_CHAINSETUP_TEST::do_run_save_and_restore(void)
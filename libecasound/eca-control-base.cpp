@@ -50,6 +50,8 @@ using std::list;
 using std::string;
 using std::vector;
 
+static string eca_control_engine_status_to_string(ECA_ENGINE::Engine_status_t status);
+
 /**
  * Definitions for member functions
  */
@@ -418,6 +420,210 @@ void ECA_CONTROL::close_engine(void)
   // ---
 }
 
+/**
+ * Helper function for starting a background engine thread.
+ */
+void* ECA_CONTROL::start_background_thread(void *ptr)
+{
+  background_job_t* job = static_cast<background_job_t*>(ptr);
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+	      "Background engine thread started for chainsetup \"" +
+	      job->csetup_repp->name() + "\".");
+
+  job->exec_res_rep = job->engine_repp->exec(true);
+  job->exited_rep.set(1);
+
+  return 0;
+}
+
+/**
+ * Starts processing the selected chainsetup in the background. 
+ * The chainsetup is enabled, removed from the session and 
+ * processed with a new engine, in a thread of its own, until 
+ * it finishes or is stopped with stop_background_chainsetup().
+ *
+ * @pre is_selected() == true
+ * @pre is_valid() == true
+ * @pre connected_chainsetup() != selected_chainsetup()
+ *
+ * @return negative on error, zero on success
+ */
+int ECA_CONTROL::start_background_chainsetup(void)
+{
+  // --------
+  DBC_REQUIRE(is_selected() == true);
+  DBC_REQUIRE(is_valid() == true);
+  DBC_REQUIRE(connected_chainsetup() != selected_chainsetup());
+  // --------
+
+  ECA_CHAINSETUP* csetup = selected_chainsetup_repp;
+
+  try {
+    csetup->enable();
+  }
+  catch(ECA_ERROR& e) {
+    set_last_error("Starting chainsetup in background failed: \"" + 
+		   e.error_message() + "\"");
+    return -1;
+  }
+
+  session_repp->detach_selected_chainsetup();
+  selected_chainsetup_repp = 0;
+  selected_audio_object_repp = 0;
+  selected_audio_input_repp = 0;
+  selected_audio_output_repp = 0;
+
+  background_job_t* job = new background_job_t;
+  job->csetup_repp = csetup;
+  job->engine_repp = new ECA_ENGINE(csetup);
+  job->exited_rep.set(0);
+  job->exec_res_rep = 0;
+
+  pthread_attr_t th_attr;
+  pthread_attr_init(&th_attr);
+  int res = pthread_create(&job->thread_rep,
+			   &th_attr,
+			   start_background_thread,
+			   static_cast<void *>(job));
+  if (res != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info, "WARNING: Unable to create a new thread for engine.");
+    delete job->engine_repp;
+    delete job;
+    csetup->disable();
+    session_repp->attach_chainsetup(csetup);
+    return -1;
+  }
+
+  job->engine_repp->command(ECA_ENGINE::ep_start, 0.0);
+  bg_jobs_rep.push_back(job);
+
+  ECA_LOG_MSG(ECA_LOGGER::info, 
+	      "Processing chainsetup \"" + csetup->name() + "\" in background.");
+
+  return 0;
+}
+
+/**
+ * Stops the background chainsetup 'name' and returns it
+ * to the session. Call will block until the engine 
+ * thread has terminated.
+ */
+void ECA_CONTROL::stop_background_chainsetup(const string& name)
+{
+  vector<background_job_t*>::iterator p = bg_jobs_rep.begin();
+  while(p != bg_jobs_rep.end()) {
+    if ((*p)->csetup_repp->name() == name) {
+      background_job_t* job = *p;
+      bg_jobs_rep.erase(p);
+      close_background_job(job, true);
+      return;
+    }
+    ++p;
+  }
+
+  set_last_error("No background chainsetup named \"" + name + "\".");
+}
+
+/**
+ * Returns the names of chainsetups processed in the 
+ * background, including ones that have finished but 
+ * have not been stopped yet.
+ */
+vector<string> ECA_CONTROL::background_chainsetup_names(void) const
+{
+  vector<string> result;
+  for(size_t n = 0; n < bg_jobs_rep.size(); n++) {
+    result.push_back(bg_jobs_rep[n]->csetup_repp->name());
+  }
+  return result;
+}
+
+/**
+ * Returns one line per background chainsetup, formatted as
+ * "name status=S position=N length=N".
+ */
+string ECA_CONTROL::background_chainsetup_status(void) const
+{
+  string result;
+  for(size_t n = 0; n < bg_jobs_rep.size(); n++) {
+    const background_job_t* job = bg_jobs_rep[n];
+    string status;
+    if (job->exited_rep.get() == 1) {
+      status = (job->exec_res_rep < 0) ? "error" : "finished";
+    }
+    else {
+      status = eca_control_engine_status_to_string(job->engine_repp->status());
+    }
+    if (n > 0) result += "\n";
+    result += job->csetup_repp->name() + 
+      " status=" + status +
+      " position=" + float_to_string(job->csetup_repp->position_in_seconds_exact()) +
+      " length=" + float_to_string(job->csetup_repp->length_in_seconds_exact());
+  }
+  return result;
+}
+
+/**
+ * Returns the background job processing the selected
+ * chainsetup, or 0 if the selected chainsetup is not
+ * processed in the background.
+ */
+ECA_CONTROL::background_job_t* ECA_CONTROL::selected_background_job(void) const
+{
+  for(size_t n = 0;
+      selected_chainsetup_repp != 0 && n < bg_jobs_rep.size();
+      n++) {
+    if (bg_jobs_rep[n]->csetup_repp == selected_chainsetup_repp)
+      return bg_jobs_rep[n];
+  }
+  return 0;
+}
+
+/**
+ * Terminates the engine thread of a background job and
+ * releases the job. If 'reattach' is true, the chainsetup
+ * is returned to the session, otherwise it is deleted.
+ */
+void ECA_CONTROL::close_background_job(background_job_t* job, bool reattach)
+{
+  ECA_CHAINSETUP* csetup = job->csetup_repp;
+
+  job->engine_repp->command(ECA_ENGINE::ep_exit, 0.0);
+  int res = pthread_join(job->thread_rep, NULL);
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+	      "pthread_join returned: " 
+	      + kvu_numtostr(res));
+
+  delete job->engine_repp;
+  delete job;
+
+  csetup->disable();
+
+  bool selected = (selected_chainsetup_repp == csetup);
+  if (selected == true) {
+    selected_chainsetup_repp = 0;
+    selected_audio_object_repp = 0;
+    selected_audio_input_repp = 0;
+    selected_audio_output_repp = 0;
+  }
+
+  if (reattach == true) {
+    if (session_repp->attach_chainsetup(csetup) == true) {
+      ECA_LOG_MSG(ECA_LOGGER::info, 
+		  "Background chainsetup \"" + csetup->name() + "\" stopped.");
+      if (selected == true)
+	select_chainsetup(csetup->name());
+      return;
+    }
+    ECA_LOG_MSG(ECA_LOGGER::info, 
+		"WARNING: Chainsetup \"" + csetup->name() + 
+		"\" already exists, discarding the background chainsetup.");
+  }
+
+  delete csetup;
+}
+
 /**
  * Is currently selected chainsetup valid?
  *
@@ -587,42 +793,67 @@ bool ECA_CONTROL::is_engine_ready_for_commands(void) const
   return true;
 }
 
+static string eca_control_engine_status_to_string(ECA_ENGINE::Engine_status_t status)
+{
+  switch(status) {
+  case ECA_ENGINE::engine_status_running: 
+    {
+      return "running"; 
+    }
+  case ECA_ENGINE::engine_status_stopped: 
+    {
+      return "stopped"; 
+    }
+  case ECA_ENGINE::engine_status_finished:
+    {
+      return "finished"; 
+    }
+  case ECA_ENGINE::engine_status_error:
+    {
+      return "error"; 
+    }
+  case ECA_ENGINE::engine_status_notready: 
+    {
+      return "not ready"; 
+    }
+  default: 
+    {
+      return "unknown status"; 
+    }
+  }
+}
+
 /**
  * Return info about engine status.
  */
 string ECA_CONTROL::engine_status(void) const
 {
   if (is_engine_created() == true) {
-    switch(engine_repp->status()) {
-    case ECA_ENGINE::engine_status_running: 
-      {
-	return "running"; 
-      }
-    case ECA_ENGINE::engine_status_stopped: 
-      {
-	return "stopped"; 
-      }
-    case ECA_ENGINE::engine_status_finished:
-      {
-	return "finished"; 
-      }
-    case ECA_ENGINE::engine_status_error:
-      {
-	return "error"; 
-      }
-    case ECA_ENGINE::engine_status_notready: 
-      {
-	return "not ready"; 
-      }
-    default: 
-      {
-	return "unknown status"; 
-      }
-    }
+    return eca_control_engine_status_to_string(engine_repp->status());
   }
   return "not started";
 }
 
+/**
+ * Returns the command queue counters of the engine,
+ * formatted as "coalesced=N overflows=N dropped=N".
+ * All counters are zero if engine is not running.
+ */
+string ECA_CONTROL::engine_queue_status(void) const
+{
+  int coalesced = 0, overflows = 0, dropped = 0;
+
+  if (is_engine_created() == true) {
+    coalesced = engine_repp->commands_coalesced();
+    overflows = engine_repp->command_queue_overflows();
+    dropped = engine_repp->commands_dropped();
+  }
+
+  return "coalesced=" + kvu_numtostr(coalesced) +
+    " overflows=" + kvu_numtostr(overflows) +
+    " dropped=" + kvu_numtostr(dropped);
+}
+
 void ECA_CONTROL::set_last_string(const list<string>& s)
 {
   string s_rep;
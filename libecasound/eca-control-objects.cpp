@@ -173,7 +173,8 @@ void ECA_CONTROL::save_chainsetup(const string& filename)
 }
 
 /**
- * Selects chainsetup
+ * Selects chainsetup. If no chainsetup in the session
+ * is named 'name', a background chainsetup is selected.
  *
  * @param name chainsetup name 
  *
@@ -192,6 +193,12 @@ void ECA_CONTROL::select_chainsetup(const string& name)
 
   session_repp->select_chainsetup(name);
   selected_chainsetup_repp = session_repp->selected_chainsetup_repp;
+  for(size_t n = 0;
+      selected_chainsetup_repp == 0 && n < bg_jobs_rep.size();
+      n++) {
+    if (bg_jobs_rep[n]->csetup_repp->name() == name)
+      selected_chainsetup_repp = bg_jobs_rep[n]->csetup_repp;
+  }
   if (selected_chainsetup_repp == 0) {
     ECA_LOG_MSG(ECA_LOGGER::info, "Chainsetup \"" + name + "\" doesn't exist!");
     set_last_error("Chainsetup \"" + name + "\" doesn't exist!");
@@ -1907,20 +1914,25 @@ int ECA_CONTROL::selected_chain_operator(void) const
  *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
  *  selected_chains().size() == 1
  */
 void ECA_CONTROL::remove_chain_operator(void)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup());
   DBC_REQUIRE(selected_chains().size() == 1);
   // --------
 
   unsigned int p = selected_chainsetup_repp->first_selected_chain();
-  if (p < selected_chainsetup_repp->chains.size())
-    selected_chainsetup_repp->chains[p]->remove_chain_operator(-1);
+  if (p < selected_chainsetup_repp->chains.size()) {
+    ECA::chainsetup_edit_t edit;
+    edit.type = ECA::edit_cop_remove;
+    edit.cs_ptr = selected_chainsetup_repp;
+    edit.m.cop_remove.chain = p + 1;
+    edit.m.cop_remove.op = selected_chainsetup_repp->chains[p]->selected_chain_operator();
+    edit.need_chain_reinit = true;
+    execute_edit_on_selected(edit);
+  }
 }
 
 /**
@@ -2327,7 +2339,6 @@ void ECA_CONTROL::select_controller(int controller_id)
  *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
  *  selected_chains().size() == 1
  *  get_controller() != 0
  */
@@ -2335,14 +2346,19 @@ void ECA_CONTROL::remove_controller(void)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup());
   DBC_REQUIRE(selected_chains().size() == 1);
   DBC_REQUIRE(get_controller() != 0);
   // --------
 
   unsigned int p = selected_chainsetup_repp->first_selected_chain();
   if (p < selected_chainsetup_repp->chains.size()) {
-    selected_chainsetup_repp->chains[p]->remove_controller();
+    ECA::chainsetup_edit_t edit;
+    edit.type = ECA::edit_ctrl_remove;
+    edit.cs_ptr = selected_chainsetup_repp;
+    edit.m.ctrl_remove.chain = p + 1;
+    edit.m.ctrl_remove.ctrl = selected_chainsetup_repp->chains[p]->selected_controller();
+    edit.need_chain_reinit = true;
+    execute_edit_on_selected(edit);
   }
 }
 
@@ -112,6 +112,13 @@ ECA_CONTROL::~ECA_CONTROL(void)
 {
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "ECA_CONTROL destructor");
   close_engine();
+
+  /* note: chainsetups still processed in the background are
+   *       not returned to the session */
+  for(size_t n = 0; n < bg_jobs_rep.size(); n++) {
+    close_background_job(bg_jobs_rep[n], false);
+  }
+  bg_jobs_rep.clear();
 }
 
 void ECA_CONTROL::fill_command_retval(struct eci_return_value *retval) const
@@ -327,7 +334,15 @@ void ECA_CONTROL::check_action_preconditions(int action_id)
     set_last_error("Can't perform requested action; no audio output selected.");
     action_ok = false;
   }
-  /* case 4: action requires a select chainsetup, but none selected */
+  /* case 4: action can't be performed on a background chainsetup,
+   *         but the selected chainsetup is processed in background */
+  else if (selected_background_job() != 0 &&
+	   action_requires_selected_not_background(action_id)) {
+    set_last_error("Can't perform requested action; chainsetup \"" +
+		   selected_chainsetup() + "\" is processed in background.");
+    action_ok = false;
+  }
+  /* case 5: action requires a select chainsetup, but none selected */
   else if (is_selected() == false &&
 	   action_requires_selected(action_id)) {
     if (!is_connected()) {
@@ -339,7 +354,7 @@ void ECA_CONTROL::check_action_preconditions(int action_id)
       select_chainsetup(connected_chainsetup());
     }
   }
-  /* case 5: action requires a connected chainsetup, but none connected */
+  /* case 6: action requires a connected chainsetup, but none connected */
   else if (is_connected() == false &&
 	   action_requires_connected(action_id)) {
     if (!is_selected()) {
@@ -361,7 +376,7 @@ void ECA_CONTROL::check_action_preconditions(int action_id)
       }
     }
   }
-  /* case 6: action can't be performed on a connected setup, 
+  /* case 7: action can't be performed on a connected setup,
    *         but selected chainsetup is also connected */
   else if (selected_chainsetup() == connected_chainsetup() &&
 	   action_requires_selected_not_connected(action_id)) {
@@ -527,6 +542,22 @@ void ECA_CONTROL::action(int action_id)
       break;
     }
   case ec_cs_toggle_loop: { toggle_chainsetup_looping(); break; } 
+  case ec_cs_bg_start:
+    {
+      if (selected_chainsetup() == connected_chainsetup()) {
+	set_last_error("Can't start in background; chainsetup is connected!");
+      }
+      else if (is_valid() != true) {
+	set_last_error("Can't start in background; chainsetup not valid!");
+      }
+      else {
+	start_background_chainsetup();
+      }
+      break;
+    }
+  case ec_cs_bg_stop: { stop_background_chainsetup(first_action_argument_as_string()); break; }
+  case ec_cs_bg_list: { set_last_string_list(background_chainsetup_names()); break; }
+  case ec_cs_bg_status: { set_last_string(background_chainsetup_status()); break; }
   case ec_cs_option: 
     {
       selected_chainsetup_repp->interpret_options(action_arguments_as_vector());
@@ -734,6 +765,15 @@ void ECA_CONTROL::action(int action_id)
       set_last_string(chain_operator_status()); 
       break; 
     }
+  case ec_cop_profile: 
+    { 
+      if (selected_chains().size() != 1 || get_chain_operator() == 0) {
+	set_last_error("No chain operator selected.");
+	break;
+      }
+      set_last_string(chain_operator_profile()); 
+      break; 
+    }
 
     // ---
     // Chain operator parameters
@@ -805,6 +845,8 @@ void ECA_CONTROL::action(int action_id)
     break; 
   }
   case ec_engine_status: { set_last_string(engine_status()); break; }
+  case ec_engine_queue_status: { set_last_string(engine_queue_status()); break; }
+  case ec_engine_profile: { set_last_string(engine_profile()); break; }
 
   // ---
   // Internal commands
@@ -904,6 +946,18 @@ void ECA_CONTROL::action(int action_id)
 
 /**
  * Executes chainsetup edit on connect chainsetup.
+ *
+ * Edits that add or remove chain operators or 
+ * controllers, or that change a parameter so that
+ * the chain operator must be initialized again,
+ * are not executed in the engine thread.
+ * Instead an edited copy of the chain is created
+ * and initialized in the calling thread, and the
+ * engine is asked to replace the original chain
+ * with it.
+ *
+ * Edits that change the routing of chains are
+ * done by reconnecting the chainsetup.
  * 
  * @pre is_connected()
  */
@@ -913,17 +967,94 @@ bool ECA_CONTROL::execute_edit_on_connected(const chainsetup_edit_t& edit)
 
   bool retval = false;
   
-  if (is_engine_ready_for_commands() == true) {
+  ECA_CHAINSETUP* csetup = session_repp->connected_chainsetup_repp;
+  if (is_engine_ready_for_commands() == true &&
+      csetup->edit_changes_routing(edit) == true) {
+    retval = execute_edit_with_reconnect(edit);
+  }
+  else if (is_engine_ready_for_commands() == true) {
+    retval = execute_edit_on_engine(engine_repp, csetup, edit);
+  }
+  else {
+    /* note: engine not yet running, execute edit directly */
+    retval = session_repp->connected_chainsetup_repp->execute_edit(edit);
+  }
+
+  return retval;
+}
+
+/**
+ * Executes chainsetup edit on 'csetup', which is
+ * processed by 'engine'. Edits that add or remove
+ * objects, or need the chain operator to be initialized
+ * again, replace the edited chain. Other edits are
+ * executed by the engine thread.
+ *
+ * @pre csetup->edit_changes_routing(edit) != true
+ */
+bool ECA_CONTROL::execute_edit_on_engine(ECA_ENGINE* engine, ECA_CHAINSETUP* csetup, const chainsetup_edit_t& edit)
+{
+  bool retval = false;
+
+  if (edit.type == ECA::edit_cop_add ||
+      edit.type == ECA::edit_cop_remove ||
+      edit.type == ECA::edit_ctrl_add ||
+      edit.type == ECA::edit_ctrl_remove ||
+      csetup->edit_needs_init(edit) == true) {
+    CHAIN* new_chain = csetup->create_edited_chain(edit);
+    if (new_chain != 0) {
+      int c = csetup->get_chain_index(new_chain->name());
+      retval = engine->replace_chain(c - 1, new_chain);
+    }
+  }
+  else {
     ECA_ENGINE::complex_command_t engine_cmd;
     engine_cmd.type = ECA_ENGINE::ep_exec_edit;
     engine_cmd.cs = edit;
-    engine_repp->command(engine_cmd);
+    engine->command(engine_cmd);
     retval = true;
   }
-  else {
-    /* note: engine not yet running, execute edit directly */
-    retval = session_repp->connected_chainsetup_repp->execute_edit(edit);
+
+  return retval;
+}
+
+/**
+ * Executes chainsetup edit on connected chainsetup
+ * by disconnecting it, executing the edit, and
+ * connecting it again. If the engine was running,
+ * it is restarted.
+ *
+ * @pre is_connected()
+ */
+bool ECA_CONTROL::execute_edit_with_reconnect(const chainsetup_edit_t& edit)
+{
+  DBC_REQUIRE(is_connected() == true);
+
+  ECA_CHAINSETUP* csetup = session_repp->connected_chainsetup_repp;
+  string saved_selection = is_selected() == true ? selected_chainsetup() : "";
+  bool restart = is_running();
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "Edit changes chain routing, reconnecting chainsetup \"" +
+	      csetup->name() + "\".");
+
+  disconnect_chainsetup();
+  bool retval = csetup->execute_edit(edit);
+
+  select_chainsetup(csetup->name());
+  if (is_valid() == true)
+    connect_chainsetup(0);
+  if (is_connected() != true ||
+      connected_chainsetup() != csetup->name()) {
+    set_last_error("Can't reconnect chainsetup.");
+    retval = false;
   }
+  else if (restart == true) {
+    start();
+  }
+
+  if (saved_selection.size() > 0)
+    select_chainsetup(saved_selection);
 
   return retval;
 }
@@ -954,7 +1085,20 @@ bool ECA_CONTROL::execute_edit_on_selected(const chainsetup_edit_t& edit, int in
    *       in use by the engine, the edit is performed 
    *       by the engine thread! 
    */
-  if (csetup != 0) {
+  background_job_t* job = (index < 0) ? selected_background_job() : 0;
+  if (job != 0) {
+    if (job->exited_rep.get() == 1) {
+      retval = csetup->execute_edit(edit);
+    }
+    else if (csetup->edit_changes_routing(edit) == true) {
+      set_last_error("Can't change chain routing of chainsetup \"" +
+		     csetup->name() + "\", it is processed in background.");
+    }
+    else {
+      retval = execute_edit_on_engine(job->engine_repp, csetup, edit);
+    }
+  }
+  else if (csetup != 0) {
     if (csetup->is_enabled() == true &&
 	is_engine_ready_for_commands() == true) {
       execute_edit_on_connected(edit);
@@ -1151,6 +1295,67 @@ string ECA_CONTROL::chain_operator_status(void) const
   return msg.to_string();
 }
 
+string ECA_CONTROL::engine_profile(void) const
+{
+  // --------
+  DBC_REQUIRE(is_selected() == true);
+  // --------
+
+  MESSAGE_ITEM msg;
+  vector<CHAIN*>::const_iterator chain_citer = selected_chainsetup_repp->chains.begin();
+
+  msg << "### Chain profile (chainsetup '" 
+      << selected_chainsetup() 
+      << "') ###\n";
+
+  if (selected_chainsetup_repp->profiling() != true)
+    msg << "Profiling not enabled, see '-z:profile'.\n";
+
+  while(chain_citer != selected_chainsetup_repp->chains.end()) {
+    msg << "Chain \"" << (*chain_citer)->name() << "\": ";
+    msg << profile_to_string((*chain_citer)->profile());
+    ++chain_citer;
+    if (chain_citer != selected_chainsetup_repp->chains.end()) msg << "\n";
+  }
+  return msg.to_string();
+}
+
+string ECA_CONTROL::chain_operator_profile(void) const
+{
+  // --------
+  DBC_REQUIRE(is_selected() == true);
+  DBC_REQUIRE(selected_chains().size() == 1);
+  // --------
+
+  CHAIN* c = get_chain_priv();
+  if (c != 0) {
+    const ECA_PROFILE_HISTOGRAM* profile = 
+      c->chain_operator_profile(c->selected_chain_operator());
+    if (profile != 0)
+      return profile_to_string(*profile);
+  }
+  return "";
+}
+
+/**
+ * Formats processing time percentiles as fractions
+ * of the engine buffer period (selected chainsetup).
+ */
+string ECA_CONTROL::profile_to_string(const ECA_PROFILE_HISTOGRAM& profile) const
+{
+  double period = 
+    static_cast<double>(selected_chainsetup_repp->buffersize()) / 
+    selected_chainsetup_repp->samples_per_second();
+
+  string res = "n=" + kvu_numtostr(profile.count());
+  res += " p50=" + kvu_numtostr(profile.percentile(0.5) / period, 4);
+  res += " p90=" + kvu_numtostr(profile.percentile(0.9) / period, 4);
+  res += " p99=" + kvu_numtostr(profile.percentile(0.99) / period, 4);
+  res += " max=" + kvu_numtostr(profile.max_seconds() / period, 4);
+
+  return res;
+}
+
 string ECA_CONTROL::controller_status(void) const
 {
   // --------
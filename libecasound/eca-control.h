@@ -43,6 +43,7 @@ class GENERIC_CONTROLLER;
 class ECA_CHAINSETUP;
 class ECA_ENGINE;
 class ECA_OBJECT_MAP;
+class ECA_PROFILE_HISTOGRAM;
 class ECA_SESSION;
 
 /**
@@ -109,6 +110,7 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
   /*@{*/
 
   std::string engine_status(void) const;
+  std::string engine_queue_status(void) const;
 
   SAMPLE_SPECS::sample_pos_t length_in_samples(void) const;
   double length_in_seconds_exact(void) const;
@@ -119,6 +121,29 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
 
   // -------------------------------------------------------------------
 
+  /** @name Public functions for background chainsetups
+   * (note: implemented in eca-control-base.cpp)
+   *
+   * A background chainsetup is processed by an engine of its 
+   * own, in parallel to the connected chainsetup and to other 
+   * background chainsetups. It is removed from the session 
+   * list while processing, and returned to it when stopped.
+   *
+   * A background chainsetup can be selected by name. Chain,
+   * chain operator and controller edits on it are passed
+   * to its engine, but other changes are not allowed.
+   */
+  /*@{*/
+
+  int start_background_chainsetup(void);
+  void stop_background_chainsetup(const std::string& name);
+  std::vector<std::string> background_chainsetup_names(void) const;
+  std::string background_chainsetup_status(void) const;
+
+  /*@}*/
+
+  // -------------------------------------------------------------------
+
   /** @name Public functions for resource file access */
   /*@{*/
 
@@ -337,6 +362,25 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
    */
   std::string controller_status(void) const;
 
+  /**
+   * Return processing time statistics of chains 
+   * (selected chainsetup)
+   *
+   * require:
+   *  is_selected() == true
+   */
+  std::string engine_profile(void) const;
+
+  /**
+   * Return processing time statistics of the selected
+   * chain operator
+   *
+   * require:
+   *  is_selected() == true
+   *  selected_chains().size() == 1
+   */
+  std::string chain_operator_profile(void) const;
+
   void aio_register(void); 
   void cop_register(void);
   void preset_register(void); 
@@ -380,13 +424,26 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
   void set_last_error(const std::string& s);
   void clear_last_values(void);
 
+  struct background_job_t {
+    ECA_CHAINSETUP* csetup_repp;
+    ECA_ENGINE* engine_repp;
+    pthread_t thread_rep;
+    ATOMIC_INTEGER exited_rep;
+    int exec_res_rep;
+  };
+
   static void* start_normal_thread(void *ptr);
+  static void* start_background_thread(void *ptr);
+  void close_background_job(background_job_t* job, bool reattach);
+  background_job_t* selected_background_job(void) const;
+  bool execute_edit_on_engine(ECA_ENGINE* engine, ECA_CHAINSETUP* csetup, const ECA::chainsetup_edit_t& edit);
 
   void start_engine_sub(bool batchmode);
   void close_engine(void);
   void run_engine(void);
 
   std::string chainsetup_details_to_string(const ECA_CHAINSETUP* cs) const;
+  std::string profile_to_string(const ECA_PROFILE_HISTOGRAM& profile) const;
 
   void audio_input_as_selected(void);
   void audio_output_as_selected(void);
@@ -413,6 +470,7 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
   const std::vector<std::string>& action_arguments_as_vector(void) const;
   void fill_command_retval(struct eci_return_value *retval) const;
   bool action_helper_check_cop_op_args(int copid, int coppid);
+  bool execute_edit_with_reconnect(const ECA::chainsetup_edit_t& edit);
 
   ECA_ENGINE* engine_repp;
   ECA_SESSION* session_repp;
@@ -425,6 +483,7 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
   int engine_pid_rep;
   int last_exec_res_rep;
   bool joining_rep;
+  std::vector<background_job_t*> bg_jobs_rep;
 
   int float_to_string_precision_rep;
 
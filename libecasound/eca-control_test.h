@@ -46,6 +46,8 @@ public:
 private:
 
   void do_run_chainsetup_creation(void);
+  void do_run_background_chainsetups(void);
+  void do_run_background_edits(void);
 
 };
 
@@ -53,6 +55,9 @@ void ECA_CONTROL_TEST::do_run(void)
 {
   cout << "libecasound_tester: eca-control - chainsetup creation stress test" << endl;
   do_run_chainsetup_creation();
+  cout << "libecasound_tester: eca-control - background chainsetups" << endl;
+  do_run_background_chainsetups();
+  do_run_background_edits();
 }
 
 void ECA_CONTROL_TEST::do_run_chainsetup_creation(void)
@@ -92,3 +97,110 @@ void ECA_CONTROL_TEST::do_run_chainsetup_creation(void)
   delete ectrl;
   delete esession;
 }
+
+void ECA_CONTROL_TEST::do_run_background_chainsetups(void)
+{
+  ECA_SESSION *esession = new ECA_SESSION();
+  ECA_CONTROL *ectrl = new ECA_CONTROL(esession);
+
+  const char* names[] = { "bg1", "bg2", "fg" };
+  for(int n = 0; n < 3; n++) {
+    ectrl->add_chainsetup(names[n]);
+    ectrl->add_chain("default");
+    ectrl->add_audio_input("null");
+    ectrl->add_audio_output("null");
+    ectrl->add_chain_operator("-ea:100");
+    ectrl->set_chainsetup_processing_length_in_seconds(0.5);
+    if (n < 2) {
+      if (ectrl->start_background_chainsetup() != 0) 
+	ECA_TEST_FAILURE("Background chainsetup start failed.");
+      if (ectrl->is_selected() == true) 
+	ECA_TEST_FAILURE("Background chainsetup still selected.");
+    }
+  }
+
+  if (ectrl->background_chainsetup_names().size() != 2 ||
+      ectrl->chainsetup_names().size() != 1) 
+    ECA_TEST_FAILURE("Background chainsetups not detached from session.");
+
+  /* note: process the remaining chainsetup at the same time */
+  ectrl->connect_chainsetup(0);
+  if (ectrl->is_connected() != true) ECA_TEST_FAILURE("Chainsetup connection failed.");
+  ectrl->run(true);
+
+  for(int i = 0; i < 50; i++) {
+    string status = ectrl->background_chainsetup_status();
+    if (status.find("bg1 status=finished") != string::npos &&
+	status.find("bg2 status=finished") != string::npos)
+      break;
+    kvu_sleep(0, 100000000); /* 100ms */
+  }
+  string status = ectrl->background_chainsetup_status();
+  if (status.find("bg1 status=finished") == string::npos ||
+      status.find("bg2 status=finished") == string::npos)
+    ECA_TEST_FAILURE("Background chainsetups did not finish: " + status);
+
+  ectrl->stop_background_chainsetup("bg1");
+  ectrl->stop_background_chainsetup("bg2");
+  if (ectrl->background_chainsetup_names().size() != 0 ||
+      ectrl->chainsetup_names().size() != 3) 
+    ECA_TEST_FAILURE("Background chainsetups not returned to session.");
+
+  ectrl->disconnect_chainsetup();
+
+  delete ectrl;
+  delete esession;
+}
+
+void ECA_CONTROL_TEST::do_run_background_edits(void)
+{
+  ECA_SESSION *esession = new ECA_SESSION();
+  ECA_CONTROL *ectrl = new ECA_CONTROL(esession);
+  struct eci_return_value retval;
+
+  ectrl->add_chainsetup("bg");
+  ectrl->add_chain("default");
+  ectrl->add_audio_input("null");
+  ectrl->add_audio_output("null");
+  ectrl->add_chain_operator("-ea:100");
+  if (ectrl->start_background_chainsetup() != 0)
+    ECA_TEST_FAILURE("Background chainsetup start failed.");
+
+  ectrl->command("cs-select bg", &retval);
+  if (ectrl->selected_chainsetup() != "bg")
+    ECA_TEST_FAILURE("Background chainsetup not selected.");
+  ectrl->command("c-select default", &retval);
+
+  /* case: parameter changes are done by the background engine */
+  ectrl->command("cop-set 1,1,50", &retval);
+  if (retval.type == eci_return_value::retval_error)
+    ECA_TEST_FAILURE("cop-set failed: " + retval.string_val);
+  double value = 0.0;
+  for(int i = 0; i < 50 && value != 50.0; i++) {
+    kvu_sleep(0, 10000000); /* 10ms */
+    ectrl->command("cop-get 1,1", &retval);
+    value = retval.m.float_val;
+  }
+  if (value != 50.0)
+    ECA_TEST_FAILURE("Parameter change not done by background engine.");
+
+  /* case: chain operators are added by replacing the chain */
+  ectrl->command("cop-add -ea:200", &retval);
+  ectrl->command("cop-list", &retval);
+  if (retval.string_list_val.size() != 2)
+    ECA_TEST_FAILURE("Chain operator not added to background chainsetup.");
+
+  /* case: other changes are refused */
+  ectrl->command("c-add other", &retval);
+  if (retval.type != eci_return_value::retval_error ||
+      ectrl->chain_names().size() != 1)
+    ECA_TEST_FAILURE("Chain added to background chainsetup.");
+
+  ectrl->stop_background_chainsetup("bg");
+  if (ectrl->selected_chainsetup() != "bg" ||
+      ectrl->chainsetup_names().size() != 1)
+    ECA_TEST_FAILURE("Stopped chainsetup not selected.");
+
+  delete ectrl;
+  delete esession;
+}
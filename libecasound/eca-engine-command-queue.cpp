@@ -0,0 +1,438 @@
+// ------------------------------------------------------------------------
+// eca-engine-command-queue.cpp: Lock-free command queue for ECA_ENGINE
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+
+#include <errno.h>
+#include <sys/time.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+#include <kvu_timestamp.h>
+#include <kvu_utils.h>
+
+#include "eca-engine-command-queue.h"
+#include "eca-logger.h"
+
+/**
+ * How long push() waits for space in a full queue
+ * before discarding the command, in milliseconds.
+ */
+static const int eca_command_queue_full_wait_ms = 1000;
+const size_t ECA_ENGINE_COMMAND_QUEUE::max_param_length;
+
+ECA_ENGINE_COMMAND_QUEUE::ECA_ENGINE_COMMAND_QUEUE(size_t capacity, int parameter_slots)
+  : records_rep(capacity),
+    slots_rep(parameter_slots),
+    has_held_rep(false)
+{
+  for(size_t n = 0; n < slots_rep.size(); n++)
+    slots_rep[n].state = slot_free;
+
+  pthread_mutex_init(&wait_lock_rep, NULL);
+  pthread_cond_init(&wait_cond_rep, NULL);
+}
+
+ECA_ENGINE_COMMAND_QUEUE::~ECA_ENGINE_COMMAND_QUEUE(void)
+{
+  clear();
+
+  pthread_cond_destroy(&wait_cond_rep);
+  pthread_mutex_destroy(&wait_lock_rep);
+}
+
+bool ECA_ENGINE_COMMAND_QUEUE::is_parameter_change(const ECA_ENGINE::complex_command_t& cmd)
+{
+  return (cmd.type == ECA_ENGINE::ep_exec_edit &&
+	  (cmd.cs.type == ECA::edit_cop_set_param ||
+	   cmd.cs.type == ECA::edit_ctrl_set_param));
+}
+
+void ECA_ENGINE_COMMAND_QUEUE::parameter_key(const ECA_ENGINE::complex_command_t& cmd, int* chain, int* op, int* param, double* value)
+{
+  if (cmd.cs.type == ECA::edit_cop_set_param) {
+    *chain = cmd.cs.m.cop_set_param.chain;
+    *op = cmd.cs.m.cop_set_param.op;
+    *param = cmd.cs.m.cop_set_param.param;
+    *value = cmd.cs.m.cop_set_param.value;
+  }
+  else {
+    *chain = cmd.cs.m.ctrl_set_param.chain;
+    *op = cmd.cs.m.ctrl_set_param.op;
+    *param = cmd.cs.m.ctrl_set_param.param;
+    *value = cmd.cs.m.ctrl_set_param.value;
+  }
+}
+
+bool ECA_ENGINE_COMMAND_QUEUE::slot_matches(const PARAM_SLOT& slot, const ECA_ENGINE::complex_command_t& cmd) const
+{
+  int chain, op, param;
+  double value;
+  parameter_key(cmd, &chain, &op, &param, &value);
+
+  return (slot.type == cmd.cs.type &&
+	  slot.cs_ptr == cmd.cs.cs_ptr &&
+	  slot.chain == chain &&
+	  slot.op == op &&
+	  slot.param == param);
+}
+
+/**
+ * Returns the table index where search for the
+ * parameter of 'cmd' starts.
+ */
+int ECA_ENGINE_COMMAND_QUEUE::start_slot(const ECA_ENGINE::complex_command_t& cmd) const
+{
+  int chain, op, param;
+  double value;
+  parameter_key(cmd, &chain, &op, &param, &value);
+
+  unsigned int hash = chain * 131u + op * 31u + param;
+  return hash % slots_rep.size();
+}
+
+/**
+ * Replaces the value of a queued change to the same
+ * parameter as 'cmd'.
+ *
+ * Only changes queued after the last other command are
+ * considered, as commands like 'cop-add', 'cop-remove' or
+ * selection changes may alter which operator the change
+ * applies to.
+ *
+ * @return true if a queued change was found
+ */
+bool ECA_ENGINE_COMMAND_QUEUE::coalesce(const ECA_ENGINE::complex_command_t& cmd)
+{
+  int chain, op, param;
+  double value;
+  parameter_key(cmd, &chain, &op, &param, &value);
+
+  int size = static_cast<int>(slots_rep.size());
+  int start = start_slot(cmd);
+  for(int n = 0; n < size; n++) {
+    PARAM_SLOT& slot = slots_rep[(start + n) % size];
+    if (slot.state != slot_pending)
+      continue;
+
+    /* note: take exclusive access, and only then check the
+     *       key, as the slot may have been reused meanwhile */
+    if (__sync_bool_compare_and_swap(&slot.state, slot_pending, slot_writing) != true)
+      continue;
+
+    bool match = (slot_matches(slot, cmd) == true &&
+		  slot.generation == generation_rep.get());
+    if (match == true)
+      slot.value = value;
+    __sync_synchronize();
+    if (__sync_bool_compare_and_swap(&slot.state, slot_writing, slot_pending) != true) {
+      /* note: clear() discarded the record meanwhile */
+      DBC_CHECK(slot.state == slot_cancelled);
+      slot.state = slot_free;
+      continue;
+    }
+
+    if (match == true)
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * Stores the parameter change 'cmd' to a free slot.
+ *
+ * @return slot index, or -1 if table is full
+ */
+int ECA_ENGINE_COMMAND_QUEUE::claim_slot(const ECA_ENGINE::complex_command_t& cmd)
+{
+  int size = static_cast<int>(slots_rep.size());
+  int start = start_slot(cmd);
+  for(int n = 0; n < size; n++) {
+    int index = (start + n) % size;
+    PARAM_SLOT& slot = slots_rep[index];
+    if (slot.state == slot_free &&
+	__sync_bool_compare_and_swap(&slot.state, slot_free, slot_claimed) == true) {
+      slot.type = cmd.cs.type;
+      slot.cs_ptr = cmd.cs.cs_ptr;
+      slot.generation = generation_rep.get();
+      parameter_key(cmd, &slot.chain, &slot.op, &slot.param, &slot.value);
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * Releases slot 'index' of a discarded record. If
+ * the sender is still writing to the slot, the slot
+ * is marked cancelled, and the sender frees it.
+ */
+void ECA_ENGINE_COMMAND_QUEUE::cancel_slot(int index)
+{
+  PARAM_SLOT& slot = slots_rep[index];
+  while(true) {
+    int state = slot.state;
+    if (state == slot_pending) {
+      if (__sync_bool_compare_and_swap(&slot.state, slot_pending, slot_free) == true)
+	break;
+    }
+    else if (state == slot_claimed || state == slot_writing) {
+      if (__sync_bool_compare_and_swap(&slot.state, state, slot_cancelled) == true)
+	break;
+    }
+    else {
+      DBC_CHECK(state != slot_pending);
+      break;
+    }
+  }
+}
+
+/**
+ * Sends 'cmd' to the queue.
+ *
+ * If the queue is full, waits for up to one second
+ * for the receiver to catch up. After that, the command
+ * is discarded.
+ *
+ * Execution note: does not block the receiver, may
+ *                 sleep, may allocate memory
+ *
+ * @return true if command was queued
+ */
+bool ECA_ENGINE_COMMAND_QUEUE::push(const ECA_ENGINE::complex_command_t& cmd)
+{
+  return push_helper(cmd, true);
+}
+
+/**
+ * Sends 'cmd' to the queue. If the queue is full,
+ * the command is discarded immediately.
+ *
+ * Execution note: does not sleep, block or allocate
+ *                 memory, so can be used from real-time
+ *                 threads
+ *
+ * @return true if command was queued
+ */
+bool ECA_ENGINE_COMMAND_QUEUE::try_push(const ECA_ENGINE::complex_command_t& cmd)
+{
+  return push_helper(cmd, false);
+}
+
+bool ECA_ENGINE_COMMAND_QUEUE::push_helper(const ECA_ENGINE::complex_command_t& cmd, bool wait)
+{
+  RECORD rec;
+  rec.slot = -1;
+
+  if (cmd.type == ECA_ENGINE::ep_exec_edit &&
+      cmd.cs.param.size() > max_param_length) {
+    ECA_LOG_MSG_RT(ECA_LOGGER::errors,
+		   "Engine command parameter too long (%d chars), command %d dropped.",
+		   static_cast<int>(cmd.cs.param.size()),
+		   static_cast<int>(cmd.type));
+    return false;
+  }
+
+  if (is_parameter_change(cmd) != true) {
+    /* note: ends coalescing to already queued changes */
+    generation_rep.add(1);
+  }
+  else {
+    if (coalesce(cmd) == true) {
+      coalesced_rep.add(1);
+      return true;
+    }
+    rec.slot = claim_slot(cmd);
+    if (rec.slot < 0) {
+      /* note: table full, queue the change as a
+       *       separate record */
+      overflows_rep.add(1);
+    }
+  }
+
+  rec.type = cmd.type;
+  rec.m = cmd.m;
+  rec.edit_type = cmd.cs.type;
+  rec.edit_cs_ptr = cmd.cs.cs_ptr;
+  rec.edit_m = cmd.cs.m;
+  rec.need_chain_reinit = cmd.cs.need_chain_reinit;
+  rec.edit_param_length = 0;
+  if (cmd.type == ECA_ENGINE::ep_exec_edit) {
+    rec.edit_param_length = cmd.cs.param.size();
+    cmd.cs.param.copy(rec.edit_param_rep, rec.edit_param_length);
+  }
+
+  bool queued = records_rep.push(rec);
+  if (queued != true) {
+    overflows_rep.add(1);
+    for(int n = 0;
+	wait == true && n < eca_command_queue_full_wait_ms && queued != true;
+	n++) {
+      kvu_sleep(0, 1000000);
+      queued = records_rep.push(rec);
+    }
+  }
+
+  if (queued != true) {
+    dropped_rep.add(1);
+    if (rec.slot >= 0)
+      slots_rep[rec.slot].state = slot_free;
+    ECA_LOG_MSG_RT(ECA_LOGGER::errors,
+		   "Engine command queue full, command %d dropped.",
+		   static_cast<int>(cmd.type));
+    return false;
+  }
+
+  if (rec.slot >= 0) {
+    __sync_synchronize();
+    if (__sync_bool_compare_and_swap(&slots_rep[rec.slot].state, slot_claimed, slot_pending) != true) {
+      /* note: clear() discarded the record meanwhile */
+      DBC_CHECK(slots_rep[rec.slot].state == slot_cancelled);
+      slots_rep[rec.slot].state = slot_free;
+    }
+  }
+
+  if (wait == true) {
+    pthread_mutex_lock(&wait_lock_rep);
+    pthread_cond_broadcast(&wait_cond_rep);
+    pthread_mutex_unlock(&wait_lock_rep);
+  }
+  else if (pthread_mutex_trylock(&wait_lock_rep) == 0) {
+    /* note: if the lock is busy, the receiver is not 
+     *       waiting or will recheck the queue */
+    pthread_cond_broadcast(&wait_cond_rep);
+    pthread_mutex_unlock(&wait_lock_rep);
+  }
+
+  return true;
+}
+
+/**
+ * Fetches, and removes, the front command in the queue.
+ *
+ * Execution note: rt-safe, does not block; does not
+ *                 allocate memory as long as the capacity
+ *                 of 'cmd->cs.param' is at least
+ *                 max_param_length characters
+ *
+ * @return true on success, false if the queue is empty,
+ *         or the front command is still being written
+ */
+bool ECA_ENGINE_COMMAND_QUEUE::pop(ECA_ENGINE::complex_command_t* cmd)
+{
+  RECORD rec;
+  if (has_held_rep == true)
+    rec = held_rep;
+  else if (records_rep.pop(&rec) != true)
+    return false;
+
+  has_held_rep = false;
+  cmd->type = rec.type;
+  cmd->m = rec.m;
+  cmd->cs.type = rec.edit_type;
+  cmd->cs.cs_ptr = rec.edit_cs_ptr;
+  cmd->cs.m = rec.edit_m;
+  cmd->cs.need_chain_reinit = rec.need_chain_reinit;
+
+  if (rec.slot >= 0) {
+    PARAM_SLOT& slot = slots_rep[rec.slot];
+    if (__sync_bool_compare_and_swap(&slot.state, slot_pending, slot_taken) != true) {
+      /* note: sender is still writing to the slot, keep
+       *       the record and try again on next call */
+      held_rep = rec;
+      has_held_rep = true;
+      return false;
+    }
+    if (rec.edit_type == ECA::edit_cop_set_param)
+      cmd->cs.m.cop_set_param.value = slot.value;
+    else
+      cmd->cs.m.ctrl_set_param.value = slot.value;
+    __sync_synchronize();
+    slot.state = slot_free;
+  }
+
+  if (rec.edit_param_length > 0)
+    cmd->cs.param.assign(rec.edit_param_rep, rec.edit_param_length);
+  else if (cmd->cs.param.size() > 0)
+    cmd->cs.param.clear();
+
+  return true;
+}
+
+/**
+ * Discards all queued commands.
+ *
+ * Execution note: must be called from the receiving thread
+ */
+void ECA_ENGINE_COMMAND_QUEUE::clear(void)
+{
+  if (has_held_rep == true) {
+    if (held_rep.slot >= 0)
+      cancel_slot(held_rep.slot);
+    has_held_rep = false;
+  }
+
+  RECORD rec;
+  while(records_rep.pop(&rec) == true) {
+    if (rec.slot >= 0)
+      cancel_slot(rec.slot);
+  }
+}
+
+/**
+ * Is queue empty?
+ *
+ * Execution note: rt-safe, does not block
+ */
+bool ECA_ENGINE_COMMAND_QUEUE::is_empty(void) const
+{
+  return (has_held_rep != true && records_rep.is_empty() == true);
+}
+
+/**
+ * Blocks until 'is_empty() != true'. 'timeout_sec' and
+ * 'timeout_usec' specify the upper time limit for blocking.
+ *
+ * Execution note: may block
+ */
+void ECA_ENGINE_COMMAND_QUEUE::poll(int timeout_sec, long int timeout_usec)
+{
+  struct timeval nowtmp;
+  struct timespec now, timeout;
+  int retcode = 0;
+
+  gettimeofday(&nowtmp, NULL);
+
+  now.tv_sec = nowtmp.tv_sec;
+  now.tv_nsec = nowtmp.tv_usec * 1000;
+  timeout.tv_sec = timeout_sec;
+  timeout.tv_nsec = timeout_usec * 1000;
+  kvu_timespec_add(&now, &timeout, &timeout);
+
+  pthread_mutex_lock(&wait_lock_rep);
+  while (is_empty() == true && retcode != ETIMEDOUT) {
+    retcode = pthread_cond_timedwait(&wait_cond_rep, &wait_lock_rep, &timeout);
+  }
+  pthread_mutex_unlock(&wait_lock_rep);
+}
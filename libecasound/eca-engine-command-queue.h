@@ -0,0 +1,165 @@
+#ifndef INCLUDED_ECA_ENGINE_COMMAND_QUEUE_H
+#define INCLUDED_ECA_ENGINE_COMMAND_QUEUE_H
+
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include <kvu_locks.h>
+#include <kvu_mpsc_queue.h>
+
+#include "eca-engine.h"
+
+/**
+ * Queue for passing commands from control threads
+ * to ECA_ENGINE.
+ *
+ * Commands are stored as fixed-size records in a
+ * lock-free ring (see MPSC_QUEUE_RT_C), so any number
+ * of threads can send commands without ever blocking
+ * the engine. String parameters are copied into the
+ * records as well, so the engine does not allocate or
+ * free memory when fetching commands. Parameters longer
+ * than max_param_length characters are rejected.
+ *
+ * Chain operator and controller parameter changes
+ * (ECA::edit_cop_set_param and ECA::edit_ctrl_set_param)
+ * are kept in a fixed-size table. If a change to the same
+ * parameter is already waiting in the queue, and no other
+ * command has been queued after it, a new change just 
+ * replaces the queued value. Bursts of updates to one 
+ * parameter thus take only one queue record.
+ *
+ * @see ECA_ENGINE
+ */
+class ECA_ENGINE_COMMAND_QUEUE {
+
+ public:
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  ECA_ENGINE_COMMAND_QUEUE(size_t capacity = 1024, int parameter_slots = 256);
+  ~ECA_ENGINE_COMMAND_QUEUE(void);
+
+  /*@}*/
+
+  /**
+   * Maximum length of a string parameter (chainsetup_edit_t::param).
+   * The receiver should reserve this much capacity in the
+   * command it pops to, see pop().
+   */
+  static const size_t max_param_length = 255;
+
+  /** @name Public functions for sending commands (any thread) */
+  /*@{*/
+
+  bool push(const ECA_ENGINE::complex_command_t& cmd);
+  bool try_push(const ECA_ENGINE::complex_command_t& cmd);
+
+  /*@}*/
+
+  /** @name Public functions for receiving commands (one thread) */
+  /*@{*/
+
+  bool pop(ECA_ENGINE::complex_command_t* cmd);
+  void clear(void);
+  bool is_empty(void) const;
+  void poll(int timeout_sec, long int timeout_usec);
+
+  /*@}*/
+
+  /** @name Public functions for observing queue status */
+  /*@{*/
+
+  /**
+   * Number of parameter changes merged into
+   * an already queued change.
+   */
+  int coalesced(void) const { return coalesced_rep.get(); }
+
+  /**
+   * Number of times the queue or the parameter table
+   * has been full when a command was sent.
+   */
+  int overflows(void) const { return overflows_rep.get(); }
+
+  /**
+   * Number of commands discarded because the
+   * queue stayed full.
+   */
+  int dropped(void) const { return dropped_rep.get(); }
+
+  /*@}*/
+
+ private:
+
+  enum Slot_state {
+    slot_free = 0,
+    slot_claimed,
+    slot_pending,
+    slot_writing,
+    slot_taken,
+    slot_cancelled
+  };
+
+  /**
+   * Queued parameter change. 'state' is modified only
+   * with atomic operations.
+   */
+  struct PARAM_SLOT {
+    volatile int state;
+    ECA::Chainsetup_edit_type type;
+    const ECA_CHAINSETUP* cs_ptr;
+    int chain;
+    int op;
+    int param;
+    double value;
+    int generation;
+  };
+
+  /**
+   * Queue record. The string parameter is stored
+   * in a fixed-size buffer.
+   */
+  struct RECORD {
+    ECA_ENGINE::Engine_command_t type;
+    ECA_ENGINE::complex_command_t::params m;
+    ECA::Chainsetup_edit_type edit_type;
+    const ECA_CHAINSETUP* edit_cs_ptr;
+    ECA::chainsetup_edit_t::params edit_m;
+    bool need_chain_reinit;
+    char edit_param_rep[max_param_length];
+    size_t edit_param_length;
+    int slot;
+  };
+
+  static bool is_parameter_change(const ECA_ENGINE::complex_command_t& cmd);
+  static void parameter_key(const ECA_ENGINE::complex_command_t& cmd, int* chain, int* op, int* param, double* value);
+  bool slot_matches(const PARAM_SLOT& slot, const ECA_ENGINE::complex_command_t& cmd) const;
+  int start_slot(const ECA_ENGINE::complex_command_t& cmd) const;
+  bool coalesce(const ECA_ENGINE::complex_command_t& cmd);
+  int claim_slot(const ECA_ENGINE::complex_command_t& cmd);
+  void cancel_slot(int index);
+  bool push_helper(const ECA_ENGINE::complex_command_t& cmd, bool wait);
+
+  ECA_ENGINE_COMMAND_QUEUE(const ECA_ENGINE_COMMAND_QUEUE&) {}
+  ECA_ENGINE_COMMAND_QUEUE& operator=(const ECA_ENGINE_COMMAND_QUEUE&) { return *this; }
+
+  MPSC_QUEUE_RT_C<RECORD> records_rep;
+  std::vector<PARAM_SLOT> slots_rep;
+
+  RECORD held_rep;
+  bool has_held_rep;
+
+  ATOMIC_INTEGER generation_rep;
+  ATOMIC_INTEGER coalesced_rep;
+  ATOMIC_INTEGER overflows_rep;
+  ATOMIC_INTEGER dropped_rep;
+
+  pthread_mutex_t wait_lock_rep;
+  pthread_cond_t wait_cond_rep;
+};
+
+#endif /* INCLUDED_ECA_ENGINE_COMMAND_QUEUE_H */
@@ -0,0 +1,196 @@
+// ------------------------------------------------------------------------
+// eca-engine-command-queue_test.h: Unit test for ECA_ENGINE_COMMAND_QUEUE
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <cstdio>
+
+#include "kvu_numtostr.h"
+
+#include "eca-engine-command-queue.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_ENGINE_COMMAND_QUEUE
+ */
+class ECA_ENGINE_COMMAND_QUEUE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_ENGINE_COMMAND_QUEUE"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_ENGINE_COMMAND_QUEUE_TEST(void) { }
+
+private:
+
+  static ECA_ENGINE::complex_command_t cop_set(int op, int param, double value);
+
+};
+
+ECA_ENGINE::complex_command_t ECA_ENGINE_COMMAND_QUEUE_TEST::cop_set(int op, int param, double value)
+{
+  ECA_ENGINE::complex_command_t cmd;
+  cmd.type = ECA_ENGINE::ep_exec_edit;
+  cmd.cs.type = ECA::edit_cop_set_param;
+  cmd.cs.cs_ptr = 0;
+  cmd.cs.need_chain_reinit = false;
+  cmd.cs.m.cop_set_param.chain = 1;
+  cmd.cs.m.cop_set_param.op = op;
+  cmd.cs.m.cop_set_param.param = param;
+  cmd.cs.m.cop_set_param.value = value;
+  return cmd;
+}
+
+void ECA_ENGINE_COMMAND_QUEUE_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for ECA_ENGINE_COMMAND_QUEUE class\n",
+	       __FILE__);
+
+  ECA_ENGINE_COMMAND_QUEUE queue (16, 4);
+  ECA_ENGINE::complex_command_t cmd;
+
+  if (queue.is_empty() != true || queue.pop(&cmd) == true) {
+    ECA_TEST_FAILURE("new queue not empty");
+  }
+
+  /* case: changes to a queued parameter are coalesced, 
+   *       but not across other commands, and commands 
+   *       keep their order */
+  queue.push(cop_set(1, 1, 10.0));
+  queue.push(cop_set(1, 2, 20.0));
+  queue.push(cop_set(1, 1, 11.0));
+
+  ECA_ENGINE::complex_command_t add;
+  add.type = ECA_ENGINE::ep_exec_edit;
+  add.cs.type = ECA::edit_cop_add;
+  add.cs.cs_ptr = 0;
+  add.cs.need_chain_reinit = true;
+  add.cs.m.c_generic_param.chain = 1;
+  add.cs.param = "-ea:100";
+  queue.push(add);
+
+  queue.push(cop_set(1, 1, 12.0));
+
+  ECA_ENGINE::complex_command_t stop;
+  stop.type = ECA_ENGINE::ep_stop;
+  stop.m.legacy.value = 0.0;
+  queue.push(stop);
+
+  if (queue.coalesced() != 1) {
+    ECA_TEST_FAILURE("coalesced count " + kvu_numtostr(queue.coalesced()));
+  }
+
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.type != ECA::edit_cop_set_param ||
+      cmd.cs.m.cop_set_param.param != 1 ||
+      cmd.cs.m.cop_set_param.value != 11.0) {
+    ECA_TEST_FAILURE("first parameter change");
+  }
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.type != ECA::edit_cop_set_param ||
+      cmd.cs.m.cop_set_param.param != 2 ||
+      cmd.cs.m.cop_set_param.value != 20.0) {
+    ECA_TEST_FAILURE("second parameter change");
+  }
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.type != ECA::edit_cop_add ||
+      cmd.cs.need_chain_reinit != true ||
+      cmd.cs.param != "-ea:100") {
+    ECA_TEST_FAILURE("cop-add");
+  }
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.type != ECA::edit_cop_set_param ||
+      cmd.cs.m.cop_set_param.param != 1 ||
+      cmd.cs.m.cop_set_param.value != 12.0) {
+    ECA_TEST_FAILURE("parameter change after cop-add");
+  }
+  if (queue.pop(&cmd) != true ||
+      cmd.type != ECA_ENGINE::ep_stop) {
+    ECA_TEST_FAILURE("stop");
+  }
+  if (queue.is_empty() != true) {
+    ECA_TEST_FAILURE("queue not empty");
+  }
+
+  /* case: string parameters up to max_param_length are
+   *       passed intact, longer ones are rejected */
+  add.cs.param = "-el:" + std::string(ECA_ENGINE_COMMAND_QUEUE::max_param_length - 4, 'x');
+  if (queue.push(add) != true ||
+      queue.pop(&cmd) != true ||
+      cmd.cs.param != add.cs.param) {
+    ECA_TEST_FAILURE("cop-add with max length parameter");
+  }
+  add.cs.param += "x";
+  if (queue.push(add) == true || queue.is_empty() != true) {
+    ECA_TEST_FAILURE("cop-add with too long parameter");
+  }
+
+  /* case: a change popped from the queue is not coalesced */
+  queue.push(cop_set(1, 1, 13.0));
+  queue.pop(&cmd);
+  queue.push(cop_set(1, 1, 14.0));
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.m.cop_set_param.value != 14.0) {
+    ECA_TEST_FAILURE("change after pop");
+  }
+
+  /* case: when the parameter table is full, changes
+   *       are queued as separate records */
+  for(int n = 0; n < 6; n++)
+    queue.push(cop_set(2, n + 1, n));
+  if (queue.overflows() != 2) {
+    ECA_TEST_FAILURE("overflow count " + kvu_numtostr(queue.overflows()));
+  }
+  for(int n = 0; n < 6; n++) {
+    if (queue.pop(&cmd) != true ||
+	cmd.cs.m.cop_set_param.param != n + 1 ||
+	cmd.cs.m.cop_set_param.value != n) {
+      ECA_TEST_FAILURE("table full, change " + kvu_numtostr(n));
+      break;
+    }
+  }
+
+  if (queue.dropped() != 0) {
+    ECA_TEST_FAILURE("dropped commands");
+  }
+
+  /* case: try_push() fails immediately on a full queue, 
+   *       and clear() releases the parameter table */
+  int n = 0;
+  while(queue.try_push(cop_set(3, n + 1, n)) == true && n < 64)
+    n++;
+  if (n == 64 || queue.dropped() != 1) {
+    ECA_TEST_FAILURE("try_push to a full queue");
+  }
+  queue.clear();
+  if (queue.is_empty() != true) {
+    ECA_TEST_FAILURE("queue not empty after clear");
+  }
+  queue.push(cop_set(1, 1, 15.0));
+  queue.push(cop_set(1, 1, 16.0));
+  if (queue.pop(&cmd) != true ||
+      cmd.cs.m.cop_set_param.value != 16.0 ||
+      queue.is_empty() != true) {
+    ECA_TEST_FAILURE("coalescing after clear");
+  }
+}
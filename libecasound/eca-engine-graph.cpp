@@ -0,0 +1,199 @@
+// ------------------------------------------------------------------------
+// eca-engine-graph.cpp: Dependency graph of engine processing steps
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+
+
+#include <kvu_dbc.h>
+
+#include "eca-engine.h"
+#include "eca-engine-graph.h"
+
+ECA_ENGINE_GRAPH::ECA_ENGINE_GRAPH(void)
+  : engine_repp(0),
+    pending_repp(0),
+    ready_repp(0)
+{
+  pthread_mutex_init(&ready_lock_rep, NULL);
+  pthread_cond_init(&ready_cond_rep, NULL);
+}
+
+ECA_ENGINE_GRAPH::~ECA_ENGINE_GRAPH(void)
+{
+  release_counters();
+  pthread_cond_destroy(&ready_cond_rep);
+  pthread_mutex_destroy(&ready_lock_rep);
+}
+
+void ECA_ENGINE_GRAPH::release_counters(void)
+{
+  delete[] pending_repp;
+  pending_repp = 0;
+  delete[] ready_repp;
+  ready_repp = 0;
+}
+
+/**
+ * Removes all nodes.
+ */
+void ECA_ENGINE_GRAPH::clear(void)
+{
+  nodes_rep.clear();
+  release_counters();
+}
+
+/**
+ * Adds a new node and returns its index.
+ */
+int ECA_ENGINE_GRAPH::add_node(Node_type type, int index)
+{
+  NODE node;
+  node.type = type;
+  node.index = index;
+  node.dependencies = 0;
+  nodes_rep.push_back(node);
+  return nodes_rep.size() - 1;
+}
+
+/**
+ * Makes node 'to' depend on node 'from'.
+ *
+ * @pre from != to
+ */
+void ECA_ENGINE_GRAPH::add_dependency(int from, int to)
+{
+  // --
+  DBC_REQUIRE(from != to);
+  // --
+
+  nodes_rep[from].successors.push_back(to);
+  ++nodes_rep[to].dependencies;
+}
+
+/**
+ * Allocates the per-node counters. Must be called
+ * after the graph has been modified and before
+ * it is executed.
+ */
+void ECA_ENGINE_GRAPH::finalize(void)
+{
+  release_counters();
+  if (nodes_rep.size() > 0) {
+    pending_repp = new ATOMIC_INTEGER [nodes_rep.size()];
+    ready_repp = new ATOMIC_INTEGER [nodes_rep.size()];
+  }
+}
+
+/**
+ * Resets the dependency counters and queues all nodes
+ * that have no dependencies. Must be called before
+ * each execution of the graph.
+ */
+void ECA_ENGINE_GRAPH::prepare_iteration(void)
+{
+  ready_count_rep.set(0);
+  next_slot_rep.set(0);
+  waiters_rep.set(0);
+  for(size_t n = 0; n < nodes_rep.size(); n++) {
+    pending_repp[n].set(nodes_rep[n].dependencies);
+    ready_repp[n].set(-1);
+  }
+  for(size_t n = 0; n < nodes_rep.size(); n++) {
+    if (nodes_rep[n].dependencies == 0)
+      push_ready(n);
+  }
+}
+
+/**
+ * Appends 'node' to the ready queue. Each node is
+ * queued exactly once per iteration, so the queue
+ * never holds more than number_of_nodes() items.
+ */
+void ECA_ENGINE_GRAPH::push_ready(int node)
+{
+  int slot = ready_count_rep.add(1);
+  DBC_CHECK(slot < static_cast<int>(nodes_rep.size()));
+  ready_repp[slot].add(node + 1);
+
+  /* note: both the add above and the one in wait_ready() 
+   *       are full barriers, so either we see the waiter 
+   *       here, or the waiter sees the filled slot */
+  if (waiters_rep.add(0) > 0) {
+    pthread_mutex_lock(&ready_lock_rep);
+    pthread_cond_broadcast(&ready_cond_rep);
+    pthread_mutex_unlock(&ready_lock_rep);
+  }
+}
+
+/**
+ * Waits until ready queue slot 'slot' is filled and
+ * returns the queued node. Spins for a short while, 
+ * and then sleeps until push_ready() wakes us up.
+ */
+int ECA_ENGINE_GRAPH::wait_ready(int slot)
+{
+  int node = ready_repp[slot].add(0);
+  for(int n = 0; n < ready_spin_count && node < 0; n++)
+    node = ready_repp[slot].add(0);
+
+  if (node < 0) {
+    pthread_mutex_lock(&ready_lock_rep);
+    waiters_rep.add(1);
+    node = ready_repp[slot].add(0);
+    while(node < 0) {
+      pthread_cond_wait(&ready_cond_rep, &ready_lock_rep);
+      node = ready_repp[slot].add(0);
+    }
+    waiters_rep.add(-1);
+    pthread_mutex_unlock(&ready_lock_rep);
+  }
+
+  return node;
+}
+
+/**
+ * Runs nodes from the ready queue until all nodes
+ * have been claimed. When the next queue slot is not
+ * yet filled, waits until a node completing in some
+ * other thread makes a new node ready.
+ *
+ * @see wait_ready()
+ */
+void ECA_ENGINE_GRAPH::run_item(int index)
+{
+  int nodes = nodes_rep.size();
+  while(true) {
+    int slot = next_slot_rep.add(1);
+    if (slot >= nodes)
+      break;
+
+    int node = wait_ready(slot);
+
+    engine_repp->process_graph_node(node);
+
+    const std::vector<int>& succ = nodes_rep[node].successors;
+    for(size_t n = 0; n < succ.size(); n++) {
+      if (pending_repp[succ[n]].add(-1) == 1)
+	push_ready(succ[n]);
+    }
+  }
+}
@@ -0,0 +1,113 @@
+#ifndef INCLUDED_ECA_ENGINE_GRAPH_H
+#define INCLUDED_ECA_ENGINE_GRAPH_H
+
+#include <vector>
+#include <pthread.h>
+
+#include <kvu_locks.h>
+
+#include "eca-worker-pool.h"
+
+class ECA_ENGINE;
+
+/**
+ * Dependency graph of the processing steps of one
+ * engine iteration.
+ *
+ * Each input read, chain run and output write is a
+ * node of the graph. A node is run as soon as all
+ * nodes it depends on have been completed, so for
+ * example chains fed by a fast input do not have to
+ * wait for a slow input to be read.
+ *
+ * The graph is executed as a ECA_WORKER_POOL job.
+ * Each work item of the job runs nodes from a shared
+ * ready queue until all nodes have been claimed, so
+ * execute() should be called with one item per thread.
+ * A thread that finds no ready node spins for a short
+ * while and then sleeps until another thread queues
+ * one. No memory is allocated while the graph is 
+ * executed.
+ *
+ * @see ECA_ENGINE
+ */
+class ECA_ENGINE_GRAPH : public ECA_WORKER_POOL_JOB {
+
+ public:
+
+  /** @name Public type definitions and constants */
+  /*@{*/
+
+  enum Node_type { node_input, node_chain, node_output };
+
+  struct NODE {
+    /* type of the processing step */
+    Node_type type;
+    /* index of the input, chain or output object */
+    int index;
+    /* chains fed by an input node, or feeding an output node */
+    std::vector<int> chains;
+    /* nodes that depend on this node */
+    std::vector<int> successors;
+    /* number of nodes this node depends on */
+    int dependencies;
+  };
+
+  /*@}*/
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  ECA_ENGINE_GRAPH(void);
+  virtual ~ECA_ENGINE_GRAPH(void);
+
+  /*@}*/
+
+  /** @name Public functions for building the graph */
+  /*@{*/
+
+  void set_engine(ECA_ENGINE* engine) { engine_repp = engine; }
+  void clear(void);
+  int add_node(Node_type type, int index);
+  void add_dependency(int from, int to);
+  void add_chain(int node, int chain) { nodes_rep[node].chains.push_back(chain); }
+  void finalize(void);
+
+  int number_of_nodes(void) const { return nodes_rep.size(); }
+  const NODE& node(int n) const { return nodes_rep[n]; }
+
+  /*@}*/
+
+  /** @name Public functions for executing the graph */
+  /*@{*/
+
+  void prepare_iteration(void);
+  virtual void run_item(int index);
+
+  /*@}*/
+
+ private:
+
+  ECA_ENGINE* engine_repp;
+  std::vector<NODE> nodes_rep;
+
+  ATOMIC_INTEGER* pending_repp;
+  ATOMIC_INTEGER* ready_repp;
+  ATOMIC_INTEGER ready_count_rep;
+  ATOMIC_INTEGER next_slot_rep;
+  ATOMIC_INTEGER waiters_rep;
+
+  pthread_mutex_t ready_lock_rep;
+  pthread_cond_t ready_cond_rep;
+
+  static const int ready_spin_count = 256;
+
+  void push_ready(int node);
+  int wait_ready(int slot);
+  void release_counters(void);
+
+  ECA_ENGINE_GRAPH& operator=(const ECA_ENGINE_GRAPH& x) { return *this; }
+  ECA_ENGINE_GRAPH (const ECA_ENGINE_GRAPH& x) { }
+};
+
+#endif
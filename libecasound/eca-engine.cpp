@@ -39,6 +39,7 @@
 #include <kvu_procedure_timer.h>
 #include <kvu_rtcaps.h>
 #include <kvu_threads.h>
+#include <kvu_utils.h>
 
 #include "samplebuffer.h"
 #include "audioio.h"
@@ -48,6 +49,7 @@
 #include "audioio-loop.h"
 #include "audioio-barrier.h"
 #include "audioio-mp3.h"
+#include "audio-stamp.h"
 #include "midi-server.h"
 #include "eca-chain.h"
 #include "eca-chainop.h"
@@ -78,12 +80,17 @@ using std::vector;
 #define PROFILE_ENGINE_STATEMENT(x) ((void)0)
 #endif
 
+/**
+ * How long replace_chain() waits for the engine
+ * to take the new chain into use, in seconds.
+ */
+static const int eca_engine_replace_chain_timeout = 5;
+
 /**
  * Prototypes of static functions
  */
 
-static void mix_to_outputs_divide_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, int divide_by, bool first_time);
-static void mix_to_outputs_sum_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, bool first_time);
+static void mix_to_outputs_helper(SAMPLE_BUFFER* const* from, size_t count, SAMPLE_BUFFER *to, bool average);
 
 /**
  * Implementations of non-static functions
@@ -199,6 +206,10 @@ ECA_ENGINE::ECA_ENGINE(ECA_CHAINSETUP* csetup)
 
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "ECA_ENGINE constructor");
 
+  /* note: messages from the engine loop are passed to
+   *       the logger via a lock-free queue */
+  ECA_LOGGER::enable_rt_mode();
+
   csetup_repp->toggle_locked_state(true);
 
   impl_repp = new ECA_ENGINE_impl;
@@ -238,13 +249,23 @@ ECA_ENGINE::~ECA_ENGINE(void)
     driver_repp = 0;
   }
 
+  delete_retired_chains();
+
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     delete cslots_rep[n];
   }
+  for(size_t n = 0; n < islots_rep.size(); n++) {
+    delete islots_rep[n];
+  }
+  for(size_t n = 0; n < oslots_rep.size(); n++) {
+    delete oslots_rep[n];
+  }
 
   delete mixslot_repp;
   delete impl_repp;
 
+  ECA_LOGGER::disable_rt_mode();
+
   ECA_LOG_MSG(ECA_LOGGER::subsystems, "Engine exiting");
 }
 
@@ -337,7 +358,7 @@ void ECA_ENGINE::command(Engine_command_t cmd, double arg)
   ECA_ENGINE::complex_command_t item;
   item.type = cmd;
   item.m.legacy.value = arg;
-  impl_repp->command_queue_rep.push_back(item);
+  impl_repp->command_queue_rep.push(item);
 }
 
 /**
@@ -352,7 +373,23 @@ void ECA_ENGINE::command(Engine_command_t cmd, double arg)
  */
 void ECA_ENGINE::command(complex_command_t ccmd)
 {
-  impl_repp->command_queue_rep.push_back(ccmd);
+  impl_repp->command_queue_rep.push(ccmd);
+}
+
+/**
+ * Sends 'cmd' to engines command queue without waiting
+ * for free queue space. Used by the engine to post 
+ * commands to itself.
+ *
+ * context: J-level-0
+ *          can be called from exec() context
+ */
+void ECA_ENGINE::command_rt(Engine_command_t cmd)
+{
+  ECA_ENGINE::complex_command_t item;
+  item.type = cmd;
+  item.m.legacy.value = 0.0f;
+  impl_repp->command_queue_rep.try_push(item);
 }
 
 /**
@@ -404,6 +441,169 @@ void ECA_ENGINE::wait_for_exit(int timeout)
               kvu_pthread_timed_wait_result(ret, "(eca_main) wait_for_exit"));
 }
 
+/**
+ * Whether 'new_chain' can be swapped in place of chain
+ * 'chain' (0...N-1) with replace_chain(). This is not
+ * possible if the new chain is connected to a different
+ * input or output, or if audio objects have been added
+ * or removed, as the engine's routing tables are only
+ * rebuilt when the chainsetup is connected. Such edits
+ * need to be done by reconnecting the chainsetup.
+ *
+ * context: C-level-0
+ */
+bool ECA_ENGINE::can_replace_chain(int chain, const CHAIN* new_chain) const
+{
+  if (chain < 0 || chain >= static_cast<int>(chains_repp->size()))
+    return false;
+
+  const CHAIN* old_chain = (*chains_repp)[chain];
+  if (new_chain->connected_input() != old_chain->connected_input() ||
+      new_chain->connected_output() != old_chain->connected_output())
+    return false;
+
+  if (input_route_offsets_rep.size() != inputs_repp->size() + 1 ||
+      output_route_offsets_rep.size() != outputs_repp->size() + 1)
+    return false;
+
+  return true;
+}
+
+/**
+ * Replaces chain 'chain' (0...N-1) of the connected
+ * chainsetup with 'new_chain', without stopping 
+ * the engine. 
+ *
+ * The new chain is initialized in the calling
+ * thread. The engine swaps it in between two 
+ * processing iterations, after which the old
+ * chain is deleted, also in the calling thread.
+ * Function blocks until the swap is done, or
+ * a timeout occurs. In the latter case, the old
+ * chain is deleted by a later call, or when the
+ * engine is destroyed.
+ *
+ * Ownership of 'new_chain' is passed to the engine
+ * (and the connected chainsetup), also when the 
+ * function fails.
+ *
+ * context: C-level-0
+ *          must no be called from exec() context
+ *
+ * @see ECA_CHAINSETUP::create_edited_chain()
+ * @see can_replace_chain()
+ * @return true if the swap was queued
+ */
+bool ECA_ENGINE::replace_chain(int chain, CHAIN* new_chain)
+{
+  // --------
+  DBC_REQUIRE(new_chain != 0);
+  DBC_REQUIRE(chain >= 0 && chain < static_cast<int>(chains_repp->size()));
+  // --------
+
+  if (can_replace_chain(chain, new_chain) != true) {
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+                "ERROR: routing of chain \"" + new_chain->name() +
+                "\" has changed, unable to replace it while connected.");
+    new_chain->detach_objects((*chains_repp)[chain]);
+    delete new_chain;
+    return false;
+  }
+
+  /* step: make sure earlier replacements have been done, 
+   *       so that (*chains_repp) is up-to-date */
+  if (wait_for_replaced_chains() != true) {
+    ECA_LOG_MSG(ECA_LOGGER::errors, 
+                "ERROR: engine has not replaced earlier chains, unable to replace chain \"" +
+                new_chain->name() + "\".");
+    new_chain->detach_objects((*chains_repp)[chain]);
+    delete new_chain;
+    return false;
+  }
+
+  /* step: initialize the new chain outside the engine thread */
+  CHAIN* old_chain = (*chains_repp)[chain];
+  new_chain->set_controller_resolution(csetup_repp->controller_resolution());
+  new_chain->toggle_profiling(csetup_repp->profiling());
+  new_chain->set_worker_pool(csetup_repp->operator_threads() > 1 ?
+                             &impl_repp->operator_pool_rep : 0);
+  new_chain->reset_profile();
+
+  SAMPLE_BUFFER* slot = 0;
+  if (new_chain->can_init_in_place_of(old_chain) == true) {
+    /* note: objects shared with 'old_chain' keep their state */
+    new_chain->init_in_place_of(old_chain);
+  }
+  else {
+    DBC_CHECK(new_chain->shares_objects_with(old_chain) != true);
+    slot = new SAMPLE_BUFFER(buffersize(), max_channels());
+    slot->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
+
+    int inch = (*inputs_repp)[new_chain->connected_input()]->channels();
+    int outch = (*outputs_repp)[new_chain->connected_output()]->channels();
+    new_chain->init(slot, inch, outch);
+  }
+
+  ECA_ENGINE::complex_command_t item;
+  item.type = ep_replace_chain;
+  item.m.replace.chain = chain;
+  item.m.replace.chain_repp = new_chain;
+  item.m.replace.slot_repp = slot;
+  item.m.replace.stamps_repp = csetup_repp->create_audio_stamp_table(chain, new_chain);
+  impl_repp->replace_pending_rep.add(1);
+  if (impl_repp->command_queue_rep.push(item) != true) {
+    impl_repp->replace_pending_rep.add(-1);
+    new_chain->detach_objects(old_chain);
+    delete new_chain;
+    delete slot;
+    delete item.m.replace.stamps_repp;
+    return false;
+  }
+
+  /* step: wait for the engine to take the new chain into use */
+  if (wait_for_replaced_chains() != true) {
+    ECA_LOG_MSG(ECA_LOGGER::info, 
+                "WARNING: engine has not yet replaced chain \"" +
+                new_chain->name() + "\".");
+  }
+
+  return true;
+}
+
+/**
+ * Waits until the engine has taken into use all chains
+ * passed to replace_chain(), and deletes the retired chains.
+ * Blocks for at most eca_engine_replace_chain_timeout
+ * seconds.
+ *
+ * context: C-level-0
+ *          must no be called from exec() context
+ *
+ * @return true if no replacements are pending
+ */
+bool ECA_ENGINE::wait_for_replaced_chains(void)
+{
+  if (impl_repp->replace_pending_rep.get() > 0) {
+    struct timespec timeoutspec;
+    int ret = kvu_pthread_cond_timeout(eca_engine_replace_chain_timeout, &timeoutspec, false);
+    DBC_CHECK(ret == 0);
+
+    pthread_mutex_lock(&impl_repp->replace_mutex_repp);
+    while(impl_repp->replace_pending_rep.get() > 0) {
+      ret = pthread_cond_timedwait(&impl_repp->replace_cond_repp, 
+                                   &impl_repp->replace_mutex_repp,
+                                   &timeoutspec);
+      if (ret == ETIMEDOUT)
+        break;
+    }
+    pthread_mutex_unlock(&impl_repp->replace_mutex_repp);
+  }
+
+  delete_retired_chains();
+
+  return impl_repp->replace_pending_rep.get() == 0;
+}
+
 /**********************************************************************
  * Engine implementation - Public functions for observing engine 
  *                         status information
@@ -479,6 +679,45 @@ ECA_ENGINE::Engine_status_t ECA_ENGINE::status(void) const
   return ECA_ENGINE::engine_status_stopped;
 }
 
+/**
+ * Returns the number of parameter changes that were
+ * merged into an already queued change to the same
+ * parameter.
+ *
+ * context: C-level-0
+ *          no limitations
+ *
+ * @see command()
+ */
+int ECA_ENGINE::commands_coalesced(void) const
+{
+  return impl_repp->command_queue_rep.coalesced();
+}
+
+/**
+ * Returns the number of times the command queue
+ * has been full when a command was sent.
+ *
+ * context: C-level-0
+ *          no limitations
+ */
+int ECA_ENGINE::command_queue_overflows(void) const
+{
+  return impl_repp->command_queue_rep.overflows();
+}
+
+/**
+ * Returns the number of commands discarded
+ * because the command queue stayed full.
+ *
+ * context: C-level-0
+ *          no limitations
+ */
+int ECA_ENGINE::commands_dropped(void) const
+{
+  return impl_repp->command_queue_rep.dropped();
+}
+
 /**********************************************************************
  * Engine implementation - API for engine driver objects
  **********************************************************************/
@@ -495,13 +734,14 @@ ECA_ENGINE::Engine_status_t ECA_ENGINE::status(void) const
  */
 void ECA_ENGINE::check_command_queue(void)
 {
-  while(impl_repp->command_queue_rep.is_empty() != true) {
-    ECA_ENGINE::complex_command_t item;
-    int popres = impl_repp->command_queue_rep.pop_front(&item);
+  if (impl_repp->replace_signal_deferred_rep == true)
+    signal_replaced_chains();
 
-    if (popres <= 0) {
-      /* queue is empty or temporarily unavailable, unable to continue 
-       * processing messages without blocking */
+  while(impl_repp->command_queue_rep.is_empty() != true) {
+    ECA_ENGINE::complex_command_t& item = impl_repp->command_rep;
+    if (impl_repp->command_queue_rep.pop(&item) != true) {
+      /* queue is empty or front command is not yet complete, 
+       * unable to continue processing messages without blocking */
       break;
     }
 
@@ -531,6 +771,14 @@ void ECA_ENGINE::check_command_queue(void)
           }
           break;
         }
+      case ep_replace_chain:
+        {
+          swap_chain(item.m.replace.chain, 
+                     item.m.replace.chain_repp,
+                     item.m.replace.slot_repp,
+                     item.m.replace.stamps_repp);
+          break;
+        }
       case ep_prepare:
         {
           if (is_prepared() != true)
@@ -584,6 +832,15 @@ void ECA_ENGINE::check_command_queue(void)
  */
 void ECA_ENGINE::wait_for_commands(void)
 {
+  if (impl_repp->replace_signal_deferred_rep == true) {
+    signal_replaced_chains();
+    /* note: retry the deferred signal soon */
+    if (impl_repp->replace_signal_deferred_rep == true) {
+      impl_repp->command_queue_rep.poll(0, 1000);
+      return;
+    }
+  }
+
   impl_repp->command_queue_rep.poll(5, 0);
 }
 
@@ -605,6 +862,10 @@ void ECA_ENGINE::init_engine_state(void)
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     cslots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream, false);
   }
+  for(size_t n = 0; n < oslots_rep.size(); n++) {
+    if (oslots_rep[n] != 0)
+      oslots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream, false);
+  }
 }
 
 /**
@@ -630,10 +891,9 @@ void ECA_ENGINE::update_engine_state(void)
       outputs_finished_rep == 0 && 
       finished_rep != true) {
     if (is_running() == true) {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"all inputs finished - stop");
-      // FIXME: this is still wrong, command() is not fully rt-safe
-      // we are not allowed to call request_stop here
-      command(ECA_ENGINE::ep_stop_with_drain, 0.0f);
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "all inputs finished - stop");
+      // note: we are not allowed to call request_stop here
+      command_rt(ECA_ENGINE::ep_stop_with_drain);
     }
 
     state_change_to_finished();
@@ -644,10 +904,9 @@ void ECA_ENGINE::update_engine_state(void)
 
   if (status() == ECA_ENGINE::engine_status_error) {
     if (is_running() == true) {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"output error - stop");
-      // FIXME: this is still wrong, command() is not fully rt-safe
-      // we are not allowed to call request_stop here
-      command(ECA_ENGINE::ep_stop, 0.0f);
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "output error - stop");
+      // note: we are not allowed to call request_stop here
+      command_rt(ECA_ENGINE::ep_stop);
     }
   }
 }
@@ -669,18 +928,26 @@ void ECA_ENGINE::engine_iteration(void)
   
   inputs_not_finished_rep = 0;
   prehandle_control_position();
-  inputs_to_chains();
-  process_chains();
+
   // FIXME: add support for sub-buffersize offsets
-  if (preroll_samples_rep >= recording_offset_rep) {
-    /* record material to non-real-time outputs */
-    mix_to_outputs(false);
+  /* note: during preroll, slave targets are skipped and
+   *       material is recorded only to non-real-time outputs */
+  bool preroll = (preroll_samples_rep < recording_offset_rep);
+
+  if (impl_repp->worker_pool_rep.is_running() == true) {
+    /* run input reads, chains and output writes in 
+     * dependency order using the worker threads */
+    process_graph(preroll);
   }
   else {
-    /* skip slave targets */
-    mix_to_outputs(true);
-    preroll_samples_rep += buffersize();
+    inputs_to_chains();
+    process_chains();
+    mix_to_outputs(preroll);
   }
+
+  if (preroll == true)
+    preroll_samples_rep += buffersize();
+
   posthandle_control_position();
   
   PROFILE_ENGINE_STATEMENT(impl_repp->looptimer_rep.stop(); impl_repp->looptimer_range_rep.stop());
@@ -706,6 +973,105 @@ void ECA_ENGINE::reinit_chains(bool force)
   }
 }
 
+/**
+ * Takes 'new_chain', initialized to use 'slot', into
+ * use in place of chain 'chain' (0...N-1). If 'slot' is
+ * zero, the new chain uses the slot of the old chain.
+ * The audio stamps of the chainsetup are replaced with
+ * 'stamps'. The old chain, its slot and the old stamps 
+ * are passed back to the control thread for deletion.
+ *
+ * context: E-level-1
+ *          called with engine lock held
+ *
+ * @see replace_chain()
+ */
+void ECA_ENGINE::swap_chain(int chain, CHAIN* new_chain, SAMPLE_BUFFER* slot, AUDIO_STAMP_SERVER* stamps)
+{
+  CHAIN* old_chain = (*chains_repp)[chain];
+  SAMPLE_BUFFER* old_slot = 0;
+
+  csetup_repp->swap_audio_stamp_table(stamps);
+  new_chain->take_position_of(old_chain);
+  (*chains_repp)[chain] = new_chain;
+
+  if (slot != 0) {
+    old_slot = cslots_rep[chain];
+    slot->set_rt_lock(prepared_rep);
+    cslots_rep[chain] = slot;
+    for(size_t n = 0; n < input_route_slots_rep.size(); n++) {
+      if (input_route_slots_rep[n] == old_slot)
+        input_route_slots_rep[n] = slot;
+    }
+    for(size_t n = 0; n < output_route_slots_rep.size(); n++) {
+      if (output_route_slots_rep[n] == old_slot)
+        output_route_slots_rep[n] = slot;
+    }
+  }
+
+  ECA_ENGINE_impl::RETIRED_CHAIN retired;
+  retired.chain_repp = old_chain;
+  retired.slot_repp = old_slot;
+  retired.successor_repp = new_chain;
+  retired.stamps_repp = stamps;
+  bool queued = impl_repp->retired_chains_rep.push(retired);
+  DBC_CHECK(queued == true);
+
+  ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, 
+                 "replaced chain %d", chain + 1);
+
+  impl_repp->replace_pending_rep.add(-1);
+  signal_replaced_chains();
+}
+
+/**
+ * Wakes up threads waiting in wait_for_replaced_chains().
+ * If the lock is busy, the signal is deferred and
+ * retried on the next call to check_command_queue()
+ * or wait_for_commands(). Never blocks the engine
+ * thread.
+ *
+ * context: E-level-1
+ */
+void ECA_ENGINE::signal_replaced_chains(void)
+{
+  if (pthread_mutex_trylock(&impl_repp->replace_mutex_repp) == 0) {
+    pthread_cond_broadcast(&impl_repp->replace_cond_repp);
+    pthread_mutex_unlock(&impl_repp->replace_mutex_repp);
+    impl_repp->replace_signal_deferred_rep = false;
+  impl_repp->command_rep.cs.param.reserve(ECA_ENGINE_COMMAND_QUEUE::max_param_length);
+  }
+  else {
+    impl_repp->replace_signal_deferred_rep = true;
+  }
+}
+
+/**
+ * Deletes chains retired by swap_chain(). Objects 
+ * that the retired chain shares with its successor
+ * are not deleted.
+ *
+ * context: C-level-0
+ *
+ * @return number of deleted chains
+ */
+int ECA_ENGINE::delete_retired_chains(void)
+{
+  int count = 0;
+  ECA_ENGINE_impl::RETIRED_CHAIN retired;
+  while(impl_repp->retired_chains_rep.pop(&retired) == true) {
+    retired.chain_repp->detach_objects(retired.successor_repp);
+    delete retired.chain_repp;
+    if (retired.slot_repp != 0) {
+      retired.slot_repp->set_rt_lock(false);
+      delete retired.slot_repp;
+    }
+    delete retired.stamps_repp;
+    ++count;
+  }
+  return count;
+}
+
 /**
  * Prepares engine for operation. Prepares all 
  * realtime devices and starts servers.
@@ -736,6 +1102,12 @@ void ECA_ENGINE::prepare_operation(void)
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     cslots_rep[n]->set_rt_lock(true);
   }
+  for(size_t n = 0; n < islots_rep.size(); n++) {
+    if (islots_rep[n] != 0) islots_rep[n]->set_rt_lock(true);
+  }
+  for(size_t n = 0; n < oslots_rep.size(); n++) {
+    if (oslots_rep[n] != 0) oslots_rep[n]->set_rt_lock(true);
+  }
   mixslot_repp->set_rt_lock(true);
 
   /* 2. reinitialize chains if necessary */
@@ -763,7 +1135,10 @@ void ECA_ENGINE::prepare_operation(void)
                   + kvu_numtostr(csetup_repp->get_sched_priority()) + ").");
   }
 
-  /* 7. change engine to active and running */
+  /* 7. start worker threads for parallel chain processing */
+  start_workers();
+
+  /* 8. change engine to active and running */
   prepared_rep = true;
   init_engine_state();
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "engine prepared");
@@ -846,10 +1221,17 @@ void ECA_ENGINE::stop_operation(bool drain)
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     cslots_rep[n]->set_rt_lock(false);
   }
+  for(size_t n = 0; n < islots_rep.size(); n++) {
+    if (islots_rep[n] != 0) islots_rep[n]->set_rt_lock(false);
+  }
+  for(size_t n = 0; n < oslots_rep.size(); n++) {
+    if (oslots_rep[n] != 0) oslots_rep[n]->set_rt_lock(false);
+  }
   mixslot_repp->set_rt_lock(false);
 
   stop_servers();
   stop_forked_objects();
+  stop_workers();
 
   /* lower priority back to normal */
   if (csetup_repp->raised_priority() == true) {
@@ -1029,7 +1411,7 @@ void ECA_ENGINE::conditional_start(void)
 void ECA_ENGINE::conditional_stop(void)
 {
   if (status() == ECA_ENGINE::engine_status_running) {
-    ECA_LOG_MSG(ECA_LOGGER::system_objects,"conditional stop");
+    ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "conditional stop");
     was_running_rep = true;
     // don't call request_stop(), as it would signal that we are 
     // stopping completely (JACK transport stop will be sent  to all)
@@ -1085,6 +1467,47 @@ static void priv_toggle_forked_objects(bool start, std::vector<AUDIO_IO*>* vec)
   }
 }
 
+/**
+ * Starts the worker threads used for running the 
+ * processing graph. The engine thread takes part
+ * in processing, so one thread less than 
+ * ECA_CHAINSETUP::worker_threads() is started.
+ *
+ * Also starts the pool shared by chain operators
+ * (ECA_CHAINSETUP::operator_threads()). The thread
+ * running the chain takes part in its jobs, so the
+ * workers are not pinned to specific CPUs.
+ */
+void ECA_ENGINE::start_workers(void)
+{
+  if (csetup_repp->operator_threads() > 1) {
+    impl_repp->operator_pool_rep.set_schedrealtime(csetup_repp->raised_priority());
+    impl_repp->operator_pool_rep.set_schedpriority(csetup_repp->get_sched_priority());
+    impl_repp->operator_pool_rep.toggle_cpu_affinity(false);
+    impl_repp->operator_pool_rep.start(csetup_repp->operator_threads() - 1);
+  }
+
+
+  int threads = csetup_repp->worker_threads();
+  if (threads > impl_repp->graph_rep.number_of_nodes())
+    threads = impl_repp->graph_rep.number_of_nodes();
+
+  if (threads > 1) {
+    impl_repp->worker_pool_rep.set_schedrealtime(csetup_repp->raised_priority());
+    impl_repp->worker_pool_rep.set_schedpriority(csetup_repp->get_sched_priority());
+    impl_repp->worker_pool_rep.start(threads - 1);
+  }
+}
+
+void ECA_ENGINE::stop_workers(void)
+{
+  if (impl_repp->worker_pool_rep.is_running() == true)
+    impl_repp->worker_pool_rep.stop();
+
+  if (impl_repp->operator_pool_rep.is_running() == true)
+    impl_repp->operator_pool_rep.stop();
+}
+
 void ECA_ENGINE::start_forked_objects(void)
 {
   priv_toggle_forked_objects(true, inputs_repp);
@@ -1292,7 +1715,7 @@ void ECA_ENGINE::posthandle_control_position(void)
   if (csetup_repp->max_length_set() == true &&
       csetup_repp->is_over_max_length() == true) {
     if (csetup_repp->looping_enabled() == true) {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"loop point reached");
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "loop point reached");
       inputs_not_finished_rep = 1;
       csetup_repp->seek_position_in_samples(0);
       for(unsigned int adev_sizet = 0; adev_sizet < non_realtime_inputs_rep.size(); adev_sizet++) {
@@ -1300,10 +1723,10 @@ void ECA_ENGINE::posthandle_control_position(void)
       }
     }
     else {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"posthandle_c_p over_max - stop");
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects, "posthandle_c_p over_max - stop");
       if (status() == ECA_ENGINE::engine_status_running ||
           status() == ECA_ENGINE::engine_status_finished) {
-        command(ECA_ENGINE::ep_stop_with_drain, 0.0f);
+        command_rt(ECA_ENGINE::ep_stop_with_drain);
       }
       state_change_to_finished();
     }
@@ -1327,6 +1750,9 @@ void ECA_ENGINE::init_variables(void)
   pthread_mutex_init(&impl_repp->ecasound_stop_mutex_repp, NULL);
   pthread_cond_init(&impl_repp->ecasound_exit_cond_repp, NULL);
   pthread_mutex_init(&impl_repp->ecasound_exit_mutex_repp, NULL);
+  pthread_cond_init(&impl_repp->replace_cond_repp, NULL);
+  pthread_mutex_init(&impl_repp->replace_mutex_repp, NULL);
+  impl_repp->replace_signal_deferred_rep = false;
 }
 
 /**
@@ -1346,6 +1772,7 @@ void ECA_ENGINE::init_connection_to_chainsetup(void)
   create_cache_object_lists();
   update_cache_chain_connections();
   update_cache_latency_values();
+  init_graph();
 }
 
 /**
@@ -1415,10 +1842,89 @@ void ECA_ENGINE::init_chains(void)
   for (unsigned int c = 0; c != chains_repp->size(); c++) {
     int inch = (*inputs_repp)[(*chains_repp)[c]->connected_input()]->channels();
     int outch = (*outputs_repp)[(*chains_repp)[c]->connected_output()]->channels();
+    (*chains_repp)[c]->set_controller_resolution(csetup_repp->controller_resolution());
+    (*chains_repp)[c]->toggle_profiling(csetup_repp->profiling());
+    (*chains_repp)[c]->set_worker_pool(csetup_repp->operator_threads() > 1 ?
+                                       &impl_repp->operator_pool_rep : 0);
+    (*chains_repp)[c]->reset_profile();
     (*chains_repp)[c]->init(cslots_rep[c], inch, outch);
   }
 }
 
+/**
+ * Builds the dependency graph used when chainsetup
+ * is processed with multiple threads (see 
+ * process_graph()). Inputs connected to multiple
+ * chains get private buffers so that they can be 
+ * processed concurrently. Outputs connected to 
+ * multiple chains use the mix slots allocated in 
+ * update_cache_chain_connections().
+ *
+ * Called only from init_connection_to_chainsetup().
+ */
+void ECA_ENGINE::init_graph(void)
+{
+  ECA_ENGINE_GRAPH& graph = impl_repp->graph_rep;
+  graph.set_engine(this);
+  graph.clear();
+
+  for(size_t n = 0; n < islots_rep.size(); n++) 
+    delete islots_rep[n];
+  islots_rep.clear();
+
+  if (csetup_repp->worker_threads() < 2)
+    return;
+
+  vector<int> input_nodes (inputs_repp->size(), -1);
+  islots_rep.assign(inputs_repp->size(), 0);
+  for(size_t n = 0; n < inputs_repp->size(); n++) {
+    if (input_chain_count_rep[n] > 0) 
+      input_nodes[n] = graph.add_node(ECA_ENGINE_GRAPH::node_input, n);
+    if (input_chain_count_rep[n] > 1) {
+      islots_rep[n] = new SAMPLE_BUFFER(buffersize(), max_channels());
+      islots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
+    }
+  }
+
+  vector<int> chain_nodes (chains_repp->size(), -1);
+  for(size_t c = 0; c < chains_repp->size(); c++) {
+    chain_nodes[c] = graph.add_node(ECA_ENGINE_GRAPH::node_chain, c);
+    int inputnum = (*chains_repp)[c]->connected_input();
+    if (inputnum >= 0 && input_nodes[inputnum] >= 0) {
+      graph.add_dependency(input_nodes[inputnum], chain_nodes[c]);
+      graph.add_chain(input_nodes[inputnum], c);
+    }
+  }
+
+  for(size_t n = 0; n < outputs_repp->size(); n++) {
+    if (output_chain_count_rep[n] == 0) 
+      continue;
+
+    int node = graph.add_node(ECA_ENGINE_GRAPH::node_output, n);
+    for(size_t c = 0; c < chains_repp->size(); c++) {
+      if ((*chains_repp)[c]->connected_output() == static_cast<int>(n)) {
+        graph.add_dependency(chain_nodes[c], node);
+        graph.add_chain(node, c);
+      }
+    }
+
+    /* note: objects used both as input and output (loop devices), 
+     *       must be read before they are written to */
+    for(size_t m = 0; m < inputs_repp->size(); m++) {
+      if ((*inputs_repp)[m] == (*outputs_repp)[n] && 
+          input_nodes[m] >= 0)
+        graph.add_dependency(input_nodes[m], node);
+    }
+  }
+
+  graph.finalize();
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+              "Processing graph has " +
+              kvu_numtostr(graph.number_of_nodes()) + 
+              " nodes.");
+}
+
 /**
  * Frees all reserved resources.
  *
@@ -1449,20 +1955,78 @@ void ECA_ENGINE::cleanup(void)
 
 /**
  * Updates 'input_chain_count_rep' and
- * 'output_chain_count_rep'.
+ * 'output_chain_count_rep', and compiles the chain
+ * connections into the routing tables used by 
+ * inputs_to_chains() and mix_to_outputs(). Outputs
+ * connected to multiple chains get a mix slot 
+ * with matching channel count in 'oslots_rep'.
+ *
+ * Runs in time linear to the number of chains and 
+ * audio objects.
  */
 void ECA_ENGINE::update_cache_chain_connections(void)
 {
-  input_chain_count_rep.resize(inputs_repp->size());
-  for(unsigned int n = 0; n < inputs_repp->size(); n++) {
-    input_chain_count_rep[n] =
-      csetup_repp->number_of_attached_chains_to_input(csetup_repp->inputs[n]);
+  size_t inputs = inputs_repp->size();
+  size_t outputs = outputs_repp->size();
+  size_t chains = chains_repp->size();
+
+  input_chain_count_rep.assign(inputs, 0);
+  output_chain_count_rep.assign(outputs, 0);
+  output_route_flags_rep.assign(outputs, route_rt_target);
+  for(size_t c = 0; c < chains; c++) {
+    int inputnum = (*chains_repp)[c]->connected_input();
+    int outputnum = (*chains_repp)[c]->connected_output();
+    if (inputnum >= 0)
+      ++input_chain_count_rep[inputnum];
+    if (outputnum >= 0) {
+      ++output_chain_count_rep[outputnum];
+      /* note: see ECA_CHAINSETUP::is_realtime_target_output() */
+      if (inputnum < 0 ||
+          dynamic_cast<AUDIO_IO_DEVICE*>((*inputs_repp)[inputnum]) == 0)
+        output_route_flags_rep[outputnum] &= ~route_rt_target;
+    }
   }
-  
-  output_chain_count_rep.resize(outputs_repp->size());
-  for(unsigned int n = 0; n < outputs_repp->size(); n++) {
-    output_chain_count_rep[n] =
-      csetup_repp->number_of_attached_chains_to_output(csetup_repp->outputs[n]);
+
+  /* step: compute offsets of each object's entries */
+  input_route_offsets_rep.resize(inputs + 1);
+  input_route_offsets_rep[0] = 0;
+  for(size_t n = 0; n < inputs; n++) 
+    input_route_offsets_rep[n + 1] = input_route_offsets_rep[n] + input_chain_count_rep[n];
+
+  output_route_offsets_rep.resize(outputs + 1);
+  output_route_offsets_rep[0] = 0;
+  for(size_t n = 0; n < outputs; n++) {
+    output_route_offsets_rep[n + 1] = output_route_offsets_rep[n] + output_chain_count_rep[n];
+    if (output_chain_count_rep[n] == 0) 
+      output_route_flags_rep[n] &= ~route_rt_target;
+    if (dynamic_cast<LOOP_DEVICE*>((*outputs_repp)[n]) != 0)
+      output_route_flags_rep[n] |= route_loop_device;
+  }
+
+  /* step: fill in chain slots, in chain order */
+  input_route_slots_rep.resize(input_route_offsets_rep[inputs]);
+  output_route_slots_rep.resize(output_route_offsets_rep[outputs]);
+  vector<size_t> ipos (input_route_offsets_rep.begin(), input_route_offsets_rep.end() - 1);
+  vector<size_t> opos (output_route_offsets_rep.begin(), output_route_offsets_rep.end() - 1);
+  for(size_t c = 0; c < chains; c++) {
+    int inputnum = (*chains_repp)[c]->connected_input();
+    int outputnum = (*chains_repp)[c]->connected_output();
+    if (inputnum >= 0)
+      input_route_slots_rep[ipos[inputnum]++] = cslots_rep[c];
+    if (outputnum >= 0)
+      output_route_slots_rep[opos[outputnum]++] = cslots_rep[c];
+  }
+
+  /* step: preallocate mix slots */
+  for(size_t n = 0; n < oslots_rep.size(); n++) 
+    delete oslots_rep[n];
+  oslots_rep.assign(outputs, 0);
+  for(size_t n = 0; n < outputs; n++) {
+    if (output_chain_count_rep[n] > 1) {
+      oslots_rep[n] = new SAMPLE_BUFFER(buffersize(), (*outputs_repp)[n]->channels());
+      oslots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_mixed_content);
+      oslots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
+    }
   }
 }
 
@@ -1637,52 +2201,33 @@ void ECA_ENGINE::inputs_to_chains(void)
    */
 
   for(size_t inputnum = 0; inputnum < inputs_repp->size(); inputnum++) {
-
-    if (input_chain_count_rep[inputnum] > 1) {
-      /* case-1a: read buffer from input 'inputnum' to 'mixslot';
-       *          later (1b) the data is copied to each per-chain slow
-       *          to which input is connected to */
-
-      mixslot_repp->length_in_samples(buffersize());
-
-      if ((*inputs_repp)[inputnum]->finished() != true) {
-        (*inputs_repp)[inputnum]->read_buffer(mixslot_repp);
-        if ((*inputs_repp)[inputnum]->finished() != true) {
-          inputs_not_finished_rep++;
-        }
-      }
-      else {
-        /* note: no more input data for this change (N:1 input-chain case) */
-        mixslot_repp->make_empty();
+    size_t first = input_route_offsets_rep[inputnum];
+    size_t last = input_route_offsets_rep[inputnum + 1];
+    if (first == last)
+      continue;
+
+    /* case-1: input connected to only one chain, read buffer
+     *         directly to the chain slot
+     * case-2: read buffer to 'mixslot' and copy the data to 
+     *         each per-chain slot */
+    SAMPLE_BUFFER* slot = (last - first == 1 ? input_route_slots_rep[first] : mixslot_repp);
+    AUDIO_IO* input = (*inputs_repp)[inputnum];
+
+    slot->length_in_samples(buffersize());
+    if (input->finished() != true) {
+      input->read_buffer(slot);
+      if (input->finished() != true) {
+        inputs_not_finished_rep++;
       }
     }
-    for (size_t c = 0; c != chains_repp->size(); c++) {
-      if ((*chains_repp)[c]->connected_input() == static_cast<int>(inputnum)) {
-        if (input_chain_count_rep[inputnum] == 1) {
-          /* case-2: read buffer from input 'inputnum' to chain 'c' */
-          cslots_rep[c]->length_in_samples(buffersize());
-
-          if ((*inputs_repp)[inputnum]->finished() != true) {
-            (*inputs_repp)[inputnum]->read_buffer(cslots_rep[c]);
-            if ((*inputs_repp)[inputnum]->finished() != true) {
-              inputs_not_finished_rep++;
-            }
-          }
-          else {
-            /* note: no more input data for this change (1:1 input-chain case) */
-            cslots_rep[c]->make_empty();
-          }
+    else {
+      /* note: no more input data for this chain */
+      slot->make_empty();
+    }
 
-          /* note: input connected to only one chain, so no need to
-             iterate through the other chains */
-          break; 
-        }
-        else {
-          /* case-1b: input connected to chain 'n', copy 'mixslot' to 
-           *          the matching per-chain slot */
-          cslots_rep[c]->copy_all_content(*mixslot_repp);
-        }
-      }
+    if (slot == mixslot_repp) {
+      for(size_t n = first; n < last; n++) 
+        input_route_slots_rep[n]->copy_all_content(*mixslot_repp);
     }
   }
 }
@@ -1699,33 +2244,19 @@ void ECA_ENGINE::process_chains(void)
   }
 }
 
-void mix_to_outputs_divide_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, int divide_by, bool first_time)
+/**
+ * Mixes chain buffers 'from' to 'to'. In averaging 
+ * mode, the 1/N weight is applied while summing.
+ */
+void mix_to_outputs_helper(SAMPLE_BUFFER* const* from, size_t count, SAMPLE_BUFFER *to, bool average)
 {
-  if (first_time == true) {
-    // this is the first output connected to this chain
-    if (from->number_of_channels() < to->number_of_channels()) {
-      to->make_silent();
-    }
-    to->copy_matching_channels(*from);
-    to->divide_by(divide_by);
-  }
-  else {
-    to->add_with_weight(*from, divide_by);
-  }
-}
+  SAMPLE_BUFFER::sample_t weight = 1.0f;
+  if (average == true)
+    weight = 1.0 / count;
 
-void mix_to_outputs_sum_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, bool first_time)
-{
-  if (first_time == true) {
-    // this is the first output connected to this chain
-    if (from->number_of_channels() < to->number_of_channels()) {
-      to->make_silent();
-    }
-    to->copy_matching_channels(*from);
-  }
-  else {
-    to->add_matching_channels(*from);
-  }
+  to->mix_matching_channels(from, count, weight);
+  for(size_t n = 0; n < count; n++) 
+    to->event_tags_add(*from[n]);
 }
 
 /**
@@ -1733,73 +2264,142 @@ void mix_to_outputs_sum_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, boo
  */
 void ECA_ENGINE::mix_to_outputs(bool skip_realtime_target_outputs)
 {
+  bool average = (csetup_repp->mix_mode() == ECA_CHAINSETUP::cs_mmode_avg);
+
   for(size_t outputnum = 0; outputnum < outputs_repp->size(); outputnum++) {
-    if (skip_realtime_target_outputs == true) {
-      if (csetup_repp->is_realtime_target_output(outputnum) == true) {
-        ECA_LOG_MSG(ECA_LOGGER::system_objects,
-                    "Skipping rt-target output " +
-                    (*outputs_repp)[outputnum]->label() + ".");
-        continue;
-      }
+    size_t first = output_route_offsets_rep[outputnum];
+    size_t count = output_route_offsets_rep[outputnum + 1] - first;
+    if (count == 0)
+      continue;
+
+    AUDIO_IO* output = (*outputs_repp)[outputnum];
+    int flags = output_route_flags_rep[outputnum];
+
+    if (skip_realtime_target_outputs == true &&
+        (flags & route_rt_target) != 0) {
+      ECA_LOG_MSG_RT(ECA_LOGGER::system_objects,
+                     "Skipping rt-target output %s.",
+                     output->label().c_str());
+      continue;
     }
 
-    int count = 0;
-
-    /* FIXME: number_of_channels() may end up allocating memory! */
-    mixslot_repp->number_of_channels((*outputs_repp)[outputnum]->channels());
-    
-    for(size_t n = 0; n != chains_repp->size(); n++) {
+    if (count == 1) {
       // --
-      // if chain is already released, skip
+      // there's only one chain connected to this output,
+      // so we don't need to mix anything
       // --
-      if ((*chains_repp)[n]->connected_output() == -1) {
-        // --
-        // skip, if chain is not connected
-        // --
-        continue;
+      output->write_buffer(output_route_slots_rep[first]);
+    }
+    else {
+      mix_to_outputs_helper(&output_route_slots_rep[first], count, 
+                            oslots_rep[outputnum], average);
+      output->write_buffer(oslots_rep[outputnum]);
+    }
+
+    /* note: loop devices always connected both as inputs as
+     *       outputs, so their finished status must not be
+     *       counted as an error (like for other output types) */
+    if (output->finished() == true &&
+        (flags & route_loop_device) == 0)
+      outputs_finished_rep++;
+  } 
+}
+
+/**
+ * Executes one iteration of the processing graph
+ * with the worker threads. Replaces the serial
+ * inputs_to_chains(), process_chains() and 
+ * mix_to_outputs() sequence.
+ *
+ * context: J-level-1
+ */
+void ECA_ENGINE::process_graph(bool skip_realtime_target_outputs)
+{
+  impl_repp->graph_skip_rt_targets_rep = skip_realtime_target_outputs;
+  impl_repp->graph_inputs_not_finished_rep.set(0);
+  impl_repp->graph_outputs_finished_rep.set(0);
+
+  impl_repp->graph_rep.prepare_iteration();
+  impl_repp->worker_pool_rep.execute(&impl_repp->graph_rep, 
+                                     impl_repp->worker_pool_rep.number_of_threads() + 1);
+
+  inputs_not_finished_rep += impl_repp->graph_inputs_not_finished_rep.get();
+  outputs_finished_rep += impl_repp->graph_outputs_finished_rep.get();
+}
+
+/**
+ * Runs one node of the processing graph. Called
+ * by ECA_ENGINE_GRAPH once all nodes it depends 
+ * on have been completed.
+ *
+ * context: J-level-2, called from engine or worker threads
+ */
+void ECA_ENGINE::process_graph_node(int n)
+{
+  const ECA_ENGINE_GRAPH::NODE& node = impl_repp->graph_rep.node(n);
+
+  switch(node.type) 
+    {
+    case ECA_ENGINE_GRAPH::node_input:
+      {
+        /* note: if input is connected to multiple chains, data
+         *       is copied to per-chain slots in the chain nodes */
+        AUDIO_IO* input = (*inputs_repp)[node.index];
+        SAMPLE_BUFFER* slot = islots_rep[node.index];
+        if (slot == 0) 
+          slot = cslots_rep[node.chains[0]];
+
+        slot->length_in_samples(buffersize());
+        if (input->finished() != true) {
+          input->read_buffer(slot);
+          if (input->finished() != true) 
+            impl_repp->graph_inputs_not_finished_rep.add(1);
+        }
+        else {
+          slot->make_empty();
+        }
+        break;
+      }
+
+    case ECA_ENGINE_GRAPH::node_chain:
+      {
+        CHAIN* chain = (*chains_repp)[node.index];
+        int inputnum = chain->connected_input();
+        if (inputnum >= 0 && islots_rep[inputnum] != 0) 
+          cslots_rep[node.index]->copy_all_content(*islots_rep[inputnum]);
+        chain->process();
+        break;
       }
 
-      if ((*chains_repp)[n]->connected_output() == static_cast<int>(outputnum)) {
-        // --
-        // output is connected to this chain
-        // --
-        if (output_chain_count_rep[outputnum] == 1) {
-          // --
-          // there's only one output connected to this chain,
-          // so we don't need to mix anything
-          // --
-          (*outputs_repp)[outputnum]->write_buffer(cslots_rep[n]);
-          if ((*outputs_repp)[outputnum]->finished() == true) 
-            /* note: loop devices always connected both as inputs as
-             *       outputs, so their finished status must not be
-             *       counted as an error (like for other output types) */
-            if (dynamic_cast<LOOP_DEVICE*>((*outputs_repp)[outputnum]) == 0)
-              outputs_finished_rep++;
+    case ECA_ENGINE_GRAPH::node_output:
+      {
+        int flags = output_route_flags_rep[node.index];
+        if (impl_repp->graph_skip_rt_targets_rep == true &&
+            (flags & route_rt_target) != 0) 
           break;
+
+        AUDIO_IO* output = (*outputs_repp)[node.index];
+        SAMPLE_BUFFER* slot = oslots_rep[node.index];
+        if (slot == 0) {
+          /* one chain, no need to mix */
+          output->write_buffer(cslots_rep[node.chains[0]]);
         }
         else {
-          ++count;
-
-          if (csetup_repp->mix_mode() == ECA_CHAINSETUP::cs_mmode_avg)
-            mix_to_outputs_divide_helper(cslots_rep[n], mixslot_repp, output_chain_count_rep[outputnum], (count == 1));
-          else
-            mix_to_outputs_sum_helper(cslots_rep[n], mixslot_repp, (count == 1));
-
-          mixslot_repp->event_tags_add(*cslots_rep[n]);
-
-          if (count == output_chain_count_rep[outputnum]) {
-            (*outputs_repp)[outputnum]->write_buffer(mixslot_repp);
-            if ((*outputs_repp)[outputnum]->finished() == true) 
-              /* note: loop devices always connected both as inputs as
-               *       outputs, so their finished status must not be
-               *       counted as an error (like for other output types) */
-              if (dynamic_cast<LOOP_DEVICE*>((*outputs_repp)[outputnum]) == 0)
-                outputs_finished_rep++;
-          }
+          size_t first = output_route_offsets_rep[node.index];
+          mix_to_outputs_helper(&output_route_slots_rep[first], 
+                                output_route_offsets_rep[node.index + 1] - first,
+                                slot,
+                                csetup_repp->mix_mode() == ECA_CHAINSETUP::cs_mmode_avg);
+          output->write_buffer(slot);
         }
+
+        /* note: see mix_to_outputs() for loop devices */
+        if (output->finished() == true &&
+            (flags & route_loop_device) == 0)
+          impl_repp->graph_outputs_finished_rep.add(1);
+        break;
       }
     }
-  } 
 }
 
 /**********************************************************************
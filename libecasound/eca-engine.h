@@ -9,10 +9,12 @@
 class AUDIO_IO;
 class AUDIO_IO_DB_CLIENT;
 class AUDIO_IO_DEVICE;
+class AUDIO_STAMP_SERVER;
 class CHAIN;
 class CHAIN_OPERATOR;
 class ECA_CHAINSETUP;
 class ECA_ENGINE;
+class ECA_ENGINE_GRAPH;
 class ECA_ENGINE_impl;
 class SAMPLE_BUFFER;
 
@@ -66,6 +68,8 @@ class ECA_ENGINE_DEFAULT_DRIVER : public ECA_ENGINE_DRIVER {
  */
 class ECA_ENGINE {
 
+  friend class ECA_ENGINE_GRAPH;
+
  public:
 
   /** @name Public type definitions and constants */
@@ -93,6 +97,7 @@ class ECA_ENGINE {
     ep_exit,
     // --
     ep_exec_edit,
+    ep_replace_chain,
     // --
     ep_rewind,
     ep_forward,
@@ -104,7 +109,7 @@ class ECA_ENGINE {
 
   struct complex_command {
     Engine_command_t type;
-    union {
+    union params {
       struct {
 	double value;
       } engine;
@@ -116,6 +121,13 @@ class ECA_ENGINE {
 	double value;
       } legacy;
 
+      struct {
+	int chain;               /**< index of the replaced chain, 0...N-1 */
+	CHAIN* chain_repp;       /**< @see replace_chain() */
+	SAMPLE_BUFFER* slot_repp; /**< 0 if chain is initialized in place */
+	AUDIO_STAMP_SERVER* stamps_repp;
+      } replace;
+
     } m;
 
     ECA::chainsetup_edit_t cs;
@@ -135,6 +147,8 @@ class ECA_ENGINE {
   void command(complex_command_t ccmd);
   void wait_for_stop(int timeout);
   void wait_for_exit(int timeout);
+  bool can_replace_chain(int chain, const CHAIN* new_chain) const;
+  bool replace_chain(int chain, CHAIN* new_chain);
 
   /*@}*/
 
@@ -144,6 +158,9 @@ class ECA_ENGINE {
   bool is_valid(void) const;
   bool is_finite_length(void) const;
   Engine_status_t status(void) const;
+  int commands_coalesced(void) const;
+  int command_queue_overflows(void) const;
+  int commands_dropped(void) const;
 
   /*@}*/
 
@@ -226,6 +243,32 @@ private:
 
   SAMPLE_BUFFER* mixslot_repp;
   std::vector<SAMPLE_BUFFER*> cslots_rep;
+  std::vector<SAMPLE_BUFFER*> islots_rep;
+  std::vector<SAMPLE_BUFFER*> oslots_rep;
+
+  /*@}*/
+
+  /** 
+   * @name Signal routing tables
+   *
+   * Chain connections compiled by update_cache_chain_connections().
+   * Slots of the chains connected to input 'n' are 
+   * input_route_slots_rep[input_route_offsets_rep[n]] ... 
+   * input_route_slots_rep[input_route_offsets_rep[n + 1] - 1],
+   * and similarly for outputs.
+   */
+  /*@{*/
+
+  enum Route_flags {
+    route_loop_device = 1,
+    route_rt_target = 2
+  };
+
+  std::vector<size_t> input_route_offsets_rep;
+  std::vector<SAMPLE_BUFFER*> input_route_slots_rep;
+  std::vector<size_t> output_route_offsets_rep;
+  std::vector<SAMPLE_BUFFER*> output_route_slots_rep;
+  std::vector<int> output_route_flags_rep;
 
   /*@}*/
 
@@ -283,6 +326,9 @@ private:
   void start_forked_objects(void);
   void stop_forked_objects(void);
 
+  void start_workers(void);
+  void stop_workers(void);
+
   void state_change_to_finished(void);
 
   /*@}*/
@@ -305,6 +351,11 @@ private:
   /*@{*/
 
   void interpret_queue(void);
+  void command_rt(Engine_command_t cmd);
+  void swap_chain(int chain, CHAIN* new_chain, SAMPLE_BUFFER* slot, AUDIO_STAMP_SERVER* stamps);
+  void signal_replaced_chains(void);
+  bool wait_for_replaced_chains(void);
+  int delete_retired_chains(void);
 
   /*@}*/
 
@@ -317,6 +368,7 @@ private:
   void init_prefill(void);
   void init_servers(void);
   void init_chains(void);
+  void init_graph(void);
   void cleanup(void);
 
   void reinit_chains(bool force = false);
@@ -335,6 +387,9 @@ private:
   void process_chains(void);
   void mix_to_outputs(bool skip_realtime_target_outputs);
 
+  void process_graph(bool skip_realtime_target_outputs);
+  void process_graph_node(int node);
+
   /*@}*/
 
   /** @name Hidden/unimplemented functions */
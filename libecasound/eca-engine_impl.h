@@ -6,10 +6,12 @@
 #include <unistd.h>
 #include <sys/time.h>
 
-#include <kvu_message_queue.h>
 #include <kvu_procedure_timer.h>
 
 #include "eca-chainsetup.h"
+#include "eca-engine-command-queue.h"
+#include "eca-engine-graph.h"
+#include "eca-worker-pool.h"
 
 /**
  * Private class used in ECA_ENGINE 
@@ -28,7 +30,37 @@ class ECA_ENGINE_impl {
   double looptimer_mid_rep;
   double looptimer_high_rep;
 
-  MESSAGE_QUEUE_RT_C<ECA_ENGINE::complex_command_t> command_queue_rep;
+  ECA_ENGINE_COMMAND_QUEUE command_queue_rep;
+
+  /**
+   * Command popped from the queue. Kept here, with room
+   * reserved for string parameters, so that fetching
+   * commands does not allocate memory.
+   */
+  ECA_ENGINE::complex_command_t command_rep;
+
+  /**
+   * Chains replaced in the engine thread, waiting 
+   * to be deleted, see ECA_ENGINE::replace_chain()
+   */
+  struct RETIRED_CHAIN {
+    CHAIN* chain_repp;
+    SAMPLE_BUFFER* slot_repp;
+    CHAIN* successor_repp;
+    AUDIO_STAMP_SERVER* stamps_repp;
+  };
+  MPSC_QUEUE_RT_C<RETIRED_CHAIN> retired_chains_rep;
+  ATOMIC_INTEGER replace_pending_rep;
+  pthread_cond_t replace_cond_repp;
+  pthread_mutex_t replace_mutex_repp;
+  bool replace_signal_deferred_rep;
+
+  ECA_WORKER_POOL worker_pool_rep;
+  ECA_WORKER_POOL operator_pool_rep;
+  ECA_ENGINE_GRAPH graph_rep;
+  bool graph_skip_rt_targets_rep;
+  ATOMIC_INTEGER graph_inputs_not_finished_rep;
+  ATOMIC_INTEGER graph_outputs_finished_rep;
 
   pthread_cond_t editlock_cond_repp;
   pthread_mutex_t editlock_mutex_repp;
@@ -35,7 +35,24 @@
 #include "eca-fileio.h"
 #include "eca-fileio-mmap.h"
 
-ECA_FILE_IO_MMAP::ECA_FILE_IO_MMAP(void) { }
+/**
+ * Size of the region the kernel is asked to read ahead
+ * after opening the file and after seeks.
+ */
+static const off_t eca_fileio_mmap_readahead = 1024 * 1024;
+
+ECA_FILE_IO_MMAP::ECA_FILE_IO_MMAP(void)
+  : fd_rep(-1),
+    buffer_repp(0),
+    bytes_rep(0),
+    fposition_rep(0),
+    flength_rep(0),
+    mapped_length_rep(0),
+    file_ready_rep(false),
+    file_ended_rep(false)
+{
+}
+
 ECA_FILE_IO_MMAP::~ECA_FILE_IO_MMAP(void) { }
 
 void ECA_FILE_IO_MMAP::open_file(const std::string& fname, 
@@ -56,7 +73,7 @@ void ECA_FILE_IO_MMAP::open_file(const std::string& fname,
   }
 
   fd_rep = ::open(fname.c_str(), openflags);
-  if (!fd_rep) {
+  if (fd_rep < 0) {
     file_ready_rep = false;
     mode_rep = "";
   }
@@ -66,19 +83,33 @@ void ECA_FILE_IO_MMAP::open_file(const std::string& fname,
     mode_rep = fmode;
     fposition_rep = 0;
     flength_rep = get_file_length();
-//      cerr << fname_rep << ": mmaping region from 0 to " <<
-//        flength_rep << "." << endl;
-    buffer_repp = (caddr_t)::mmap(0,
-				  flength_rep,
-				  mmapflags,
-				  MAP_SHARED,
-				  fd_rep,
-				  0);
+    mapped_length_rep = static_cast<size_t>(flength_rep);
+
+    /* note: zero-length mappings are not allowed */
+    if (mapped_length_rep > 0) 
+      buffer_repp = (caddr_t)::mmap(0,
+				    mapped_length_rep,
+				    mmapflags,
+				    MAP_SHARED,
+				    fd_rep,
+				    0);
+    else
+      buffer_repp = (caddr_t)MAP_FAILED;
     
     if (buffer_repp == MAP_FAILED) {
+      ::close(fd_rep);
+      fd_rep = -1;
+      buffer_repp = 0;
+      mapped_length_rep = 0;
       file_ready_rep = false;
       mode_rep = "";
     }
+    else if (fmode == "rb") {
+#ifdef MADV_SEQUENTIAL
+      ::madvise(buffer_repp, mapped_length_rep, MADV_SEQUENTIAL);
+#endif
+      advise_readahead(0);
+    }
   }
 #else /* HAVE_MMAP */
   file_ready_rep = false;
@@ -87,11 +118,66 @@ void ECA_FILE_IO_MMAP::open_file(const std::string& fname,
 }
 
 void ECA_FILE_IO_MMAP::close_file(void) {
-//    cerr << fname_rep << ": munmaping region." << endl;
 #ifdef HAVE_MMAP
-  ::munmap(buffer_repp, flength_rep);
-  ::close(fd_rep);
+  if (buffer_repp != 0)
+    ::munmap(buffer_repp, mapped_length_rep);
+  if (fd_rep >= 0)
+    ::close(fd_rep);
 #endif
+  buffer_repp = 0;
+  mapped_length_rep = 0;
+  fd_rep = -1;
+}
+
+/**
+ * Asks the kernel to start reading the file from
+ * 'pos' onwards, so that the following accesses to
+ * the mapping don't block on disk I/O.
+ */
+void ECA_FILE_IO_MMAP::advise_readahead(off_t pos)
+{
+#if defined(HAVE_MMAP) && defined(MADV_WILLNEED)
+  if (buffer_repp == 0 || pos >= flength_rep)
+    return;
+
+  long int pagesize = ::sysconf(_SC_PAGESIZE);
+  off_t start = pos - (pos % pagesize);
+  off_t len = eca_fileio_mmap_readahead;
+  if (start + len > flength_rep)
+    len = flength_rep - start;
+
+  ::madvise(buffer_repp + start, len, MADV_WILLNEED);
+#endif
+}
+
+/**
+ * Returns a pointer to the next 'bytes' bytes of file
+ * data and advances the file position. No data is 
+ * copied. The number of bytes available at the 
+ * returned address, which may be less than 'bytes'
+ * at the end of the file, is returned by 
+ * file_bytes_processed(). The data stays valid 
+ * until the file is closed.
+ *
+ * Returns 0 if file is not ready for reading.
+ */
+const unsigned char* ECA_FILE_IO_MMAP::read_in_place(off_t bytes)
+{
+  if (is_file_ready() == false || buffer_repp == 0) {
+    bytes_rep = 0;
+    file_ended_rep = true;
+    return 0;
+  }
+
+  if (fposition_rep + bytes > flength_rep)
+    bytes = flength_rep - fposition_rep;
+
+  const unsigned char* data = 
+    reinterpret_cast<const unsigned char*>(buffer_repp + fposition_rep);
+  set_file_position(fposition_rep + bytes, false);
+  bytes_rep = bytes;
+
+  return data;
 }
 
 void ECA_FILE_IO_MMAP::read_to_buffer(void* obuf, off_t bytes) {
@@ -141,6 +227,8 @@ void ECA_FILE_IO_MMAP::set_file_position(off_t newpos, bool seek) {
   else {
     file_ready_rep = true;
     file_ended_rep = false;
+    if (seek == true && mode_rep == "rb")
+      advise_readahead(fposition_rep);
   }
 }
 
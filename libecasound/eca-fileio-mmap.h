@@ -16,6 +16,10 @@ typedef char* caddr_t;
 
 /**
  * File-io and buffering using mmap for data transfers.
+ *
+ * In read mode, the kernel is advised to read the file 
+ * ahead sequentially, and data can be accessed directly 
+ * from the mapping with read_in_place().
  */
 class ECA_FILE_IO_MMAP : public ECA_FILE_IO {
 
@@ -39,6 +43,8 @@ class ECA_FILE_IO_MMAP : public ECA_FILE_IO {
   virtual void read_to_buffer(void* obuf, off_t bytes);
   virtual void write_from_buffer(void* obuf, off_t bytes);
 
+  const unsigned char* read_in_place(off_t bytes);
+
   virtual void set_file_position(off_t newpos) { set_file_position(newpos,true); }
   virtual void set_file_position(off_t newpos, bool seek);
   virtual void set_file_position_advance(off_t fw);
@@ -62,11 +68,14 @@ class ECA_FILE_IO_MMAP : public ECA_FILE_IO {
   off_t bytes_rep;
   off_t fposition_rep;
   off_t flength_rep;
+  size_t mapped_length_rep;
 
   bool file_ready_rep;
   bool file_ended_rep;
   std::string mode_rep;
   std::string fname_rep;
+
+  void advise_readahead(off_t pos);
 };
 
 #endif
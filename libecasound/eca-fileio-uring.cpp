@@ -0,0 +1,793 @@
+// ------------------------------------------------------------------------
+// eca-fileio-uring.cpp: io_uring based asynchronous file-I/O
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstdlib> /* posix_memalign */
+#include <cstring> /* memcpy, memset */
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h> /* struct iovec */
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define ECA_FILEIO_URING_ENABLED
+#endif
+#endif
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "eca-logger.h"
+#include "eca-fileio.h"
+#include "eca-fileio-uring.h"
+
+/**
+ * Alignment of file offsets and buffers (required
+ * by O_DIRECT).
+ */
+static const long int eca_fileio_uring_alignment = 4096;
+
+const int ECA_FILE_IO_URING::queue_depth_default = 4;
+const long int ECA_FILE_IO_URING::block_size_default = 128 * 1024;
+int ECA_FILE_IO_URING::queue_depth_rep = ECA_FILE_IO_URING::queue_depth_default;
+
+void ECA_FILE_IO_URING::set_default_queue_depth(int value)
+{
+  if (value < 1) value = 1;
+  queue_depth_rep = value;
+}
+
+/**
+ * One block of file data. While a request is in
+ * flight, 'data' is owned by the kernel.
+ */
+struct eca_fileio_uring_block {
+  unsigned char* data;
+  off_t offset;
+  long int length;
+  long int result;
+  bool in_flight;
+};
+
+/**
+ * Submission and completion queues shared with
+ * the kernel, and the block buffers.
+ */
+class ECA_FILE_IO_URING_impl {
+
+ public:
+
+  ECA_FILE_IO_URING_impl(void);
+  ~ECA_FILE_IO_URING_impl(void);
+
+  bool setup(int depth);
+  void release(void);
+
+  void queue(int opcode, int fd, int index, off_t offset, long int length);
+  int enter(int min_complete);
+  void reap(void);
+
+  std::vector<struct eca_fileio_uring_block> blocks_rep;
+  std::vector<struct iovec> iovecs_rep;
+  bool fixed_rep;
+
+#ifdef ECA_FILEIO_URING_ENABLED
+  int ring_fd_rep;
+  unsigned int to_submit_rep;
+
+  void* sq_ptr_rep;
+  size_t sq_len_rep;
+  void* cq_ptr_rep;
+  size_t cq_len_rep;
+  struct io_uring_sqe* sqes_repp;
+  size_t sqes_len_rep;
+
+  unsigned int* sq_head_repp;
+  unsigned int* sq_tail_repp;
+  unsigned int* sq_mask_repp;
+  unsigned int* sq_array_repp;
+  unsigned int* cq_head_repp;
+  unsigned int* cq_tail_repp;
+  unsigned int* cq_mask_repp;
+  struct io_uring_cqe* cqes_repp;
+#endif
+};
+
+ECA_FILE_IO_URING_impl::ECA_FILE_IO_URING_impl(void)
+  : fixed_rep(false)
+{
+#ifdef ECA_FILEIO_URING_ENABLED
+  ring_fd_rep = -1;
+  to_submit_rep = 0;
+  sq_ptr_rep = MAP_FAILED;
+  cq_ptr_rep = MAP_FAILED;
+  sqes_repp = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+  sq_len_rep = cq_len_rep = sqes_len_rep = 0;
+#endif
+}
+
+ECA_FILE_IO_URING_impl::~ECA_FILE_IO_URING_impl(void)
+{
+  release();
+}
+
+#ifdef ECA_FILEIO_URING_ENABLED
+
+/**
+ * Creates the rings and allocates 'depth' blocks.
+ *
+ * @return false if io_uring is not available
+ */
+bool ECA_FILE_IO_URING_impl::setup(int depth)
+{
+  struct io_uring_params p;
+  std::memset(&p, 0, sizeof(p));
+
+  ring_fd_rep = syscall(__NR_io_uring_setup, depth, &p);
+  if (ring_fd_rep < 0) {
+    ring_fd_rep = -1;
+    return false;
+  }
+
+  sq_len_rep = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+  cq_len_rep = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (cq_len_rep > sq_len_rep) sq_len_rep = cq_len_rep;
+    cq_len_rep = sq_len_rep;
+  }
+
+  sq_ptr_rep = mmap(0, sq_len_rep, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_POPULATE, ring_fd_rep, IORING_OFF_SQ_RING);
+  if (sq_ptr_rep == MAP_FAILED) {
+    release();
+    return false;
+  }
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ptr_rep = sq_ptr_rep;
+  }
+  else {
+    cq_ptr_rep = mmap(0, cq_len_rep, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, ring_fd_rep, IORING_OFF_CQ_RING);
+    if (cq_ptr_rep == MAP_FAILED) {
+      release();
+      return false;
+    }
+  }
+
+  sqes_len_rep = p.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_repp = static_cast<struct io_uring_sqe*>(mmap(0, sqes_len_rep, PROT_READ | PROT_WRITE,
+						     MAP_SHARED | MAP_POPULATE,
+						     ring_fd_rep, IORING_OFF_SQES));
+  if (sqes_repp == MAP_FAILED) {
+    release();
+    return false;
+  }
+
+  unsigned char* sq = static_cast<unsigned char*>(sq_ptr_rep);
+  sq_head_repp = reinterpret_cast<unsigned int*>(sq + p.sq_off.head);
+  sq_tail_repp = reinterpret_cast<unsigned int*>(sq + p.sq_off.tail);
+  sq_mask_repp = reinterpret_cast<unsigned int*>(sq + p.sq_off.ring_mask);
+  sq_array_repp = reinterpret_cast<unsigned int*>(sq + p.sq_off.array);
+
+  unsigned char* cq = static_cast<unsigned char*>(cq_ptr_rep);
+  cq_head_repp = reinterpret_cast<unsigned int*>(cq + p.cq_off.head);
+  cq_tail_repp = reinterpret_cast<unsigned int*>(cq + p.cq_off.tail);
+  cq_mask_repp = reinterpret_cast<unsigned int*>(cq + p.cq_off.ring_mask);
+  cqes_repp = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+
+  blocks_rep.resize(depth);
+  iovecs_rep.resize(depth);
+  for(int n = 0; n < depth; n++) {
+    void* ptr = 0;
+    if (posix_memalign(&ptr, eca_fileio_uring_alignment,
+		       ECA_FILE_IO_URING::block_size_default) != 0) {
+      blocks_rep.resize(n);
+      release();
+      return false;
+    }
+    blocks_rep[n].data = static_cast<unsigned char*>(ptr);
+    blocks_rep[n].offset = 0;
+    blocks_rep[n].length = 0;
+    blocks_rep[n].result = 0;
+    blocks_rep[n].in_flight = false;
+    iovecs_rep[n].iov_base = ptr;
+    iovecs_rep[n].iov_len = ECA_FILE_IO_URING::block_size_default;
+  }
+
+  /* note: registering buffers can fail due to RLIMIT_MEMLOCK;
+   *       vectored requests are used in that case */
+  fixed_rep = (syscall(__NR_io_uring_register, ring_fd_rep, IORING_REGISTER_BUFFERS,
+		       &iovecs_rep[0], depth) == 0);
+
+  return true;
+}
+
+void ECA_FILE_IO_URING_impl::release(void)
+{
+  if (sqes_repp != MAP_FAILED) munmap(sqes_repp, sqes_len_rep);
+  if (cq_ptr_rep != MAP_FAILED && cq_ptr_rep != sq_ptr_rep) munmap(cq_ptr_rep, cq_len_rep);
+  if (sq_ptr_rep != MAP_FAILED) munmap(sq_ptr_rep, sq_len_rep);
+  sqes_repp = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+  cq_ptr_rep = sq_ptr_rep = MAP_FAILED;
+
+  if (ring_fd_rep >= 0) ::close(ring_fd_rep);
+  ring_fd_rep = -1;
+  to_submit_rep = 0;
+
+  /* note: buffers are freed only after the ring has 
+   *       been closed; buffers of requests that could not
+   *       be waited for may still be written to by the 
+   *       kernel, so they are leaked instead */
+  for(size_t n = 0; n < blocks_rep.size(); n++) {
+    if (blocks_rep[n].in_flight != true)
+      std::free(blocks_rep[n].data);
+  }
+  blocks_rep.clear();
+  iovecs_rep.clear();
+  fixed_rep = false;
+}
+
+/**
+ * Adds a request for block 'index' to the submission
+ * queue. The request is passed to the kernel on the
+ * next call to enter().
+ */
+void ECA_FILE_IO_URING_impl::queue(int opcode, int fd, int index, off_t offset, long int length)
+{
+  unsigned int tail = *sq_tail_repp;
+  unsigned int slot = tail & *sq_mask_repp;
+  struct io_uring_sqe* sqe = &sqes_repp[slot];
+
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->user_data = index;
+
+  if (fixed_rep == true) {
+    sqe->opcode = (opcode == IORING_OP_WRITEV) ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+    sqe->addr = reinterpret_cast<unsigned long>(blocks_rep[index].data);
+    sqe->len = length;
+    sqe->buf_index = index;
+  }
+  else {
+    iovecs_rep[index].iov_len = length;
+    sqe->opcode = opcode;
+    sqe->addr = reinterpret_cast<unsigned long>(&iovecs_rep[index]);
+    sqe->len = 1;
+  }
+
+  sq_array_repp[slot] = slot;
+  __atomic_store_n(sq_tail_repp, tail + 1, __ATOMIC_RELEASE);
+  ++to_submit_rep;
+}
+
+/**
+ * Submits queued requests and, if 'min_complete' is
+ * non-zero, waits for completions.
+ *
+ * @return 0 on success, -errno on error
+ */
+int ECA_FILE_IO_URING_impl::enter(int min_complete)
+{
+  while(true) {
+    int ret = syscall(__NR_io_uring_enter, ring_fd_rep, to_submit_rep, min_complete,
+		      (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0, 0, 0);
+    if (ret >= 0) {
+      to_submit_rep -= ret;
+      return 0;
+    }
+    if (errno != EINTR)
+      return -errno;
+  }
+}
+
+/**
+ * Marks all completed requests as done.
+ */
+void ECA_FILE_IO_URING_impl::reap(void)
+{
+  unsigned int head = *cq_head_repp;
+  unsigned int tail = __atomic_load_n(cq_tail_repp, __ATOMIC_ACQUIRE);
+
+  while(head != tail) {
+    struct io_uring_cqe* cqe = &cqes_repp[head & *cq_mask_repp];
+    struct eca_fileio_uring_block& b = blocks_rep[cqe->user_data];
+    b.result = cqe->res;
+    b.in_flight = false;
+    ++head;
+  }
+
+  __atomic_store_n(cq_head_repp, head, __ATOMIC_RELEASE);
+}
+
+#else /* ECA_FILEIO_URING_ENABLED */
+
+bool ECA_FILE_IO_URING_impl::setup(int depth) { return false; }
+void ECA_FILE_IO_URING_impl::release(void) { }
+void ECA_FILE_IO_URING_impl::queue(int opcode, int fd, int index, off_t offset, long int length) { }
+int ECA_FILE_IO_URING_impl::enter(int min_complete) { return -ENOSYS; }
+void ECA_FILE_IO_URING_impl::reap(void) { }
+
+#define IORING_OP_READV  1
+#define IORING_OP_WRITEV 2
+
+#endif /* ECA_FILEIO_URING_ENABLED */
+
+/**
+ * Opens 'fname' with io_uring if selected with 'fileio' 
+ * ("uring", or "uring-direct" for O_DIRECT access).
+ *
+ * @return an open file object, or 0 if io_uring was
+ *         not selected or could not be used
+ */
+ECA_FILE_IO* ECA_FILE_IO_URING::create(const std::string& fileio,
+				       const std::string& fname,
+				       const std::string& fmode)
+{
+  if (fileio != "uring" && fileio != "uring-direct")
+    return 0;
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects, "using io_uring mode for file access");
+  ECA_FILE_IO_URING* fio = new ECA_FILE_IO_URING(fileio == "uring-direct");
+  fio->open_file(fname, fmode);
+  if (fio->is_file_ready() != true) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects, "io_uring failed, using normal file access");
+    delete fio;
+    return 0;
+  }
+
+  return fio;
+}
+
+ECA_FILE_IO_URING::ECA_FILE_IO_URING(bool direct)
+  : impl_repp(new ECA_FILE_IO_URING_impl),
+    fd_rep(-1),
+    direct_rep(direct),
+    reading_rep(false),
+    readahead_rep(false),
+    error_rep(false),
+    ended_rep(false),
+    position_rep(0),
+    bytes_rep(0),
+    write_end_rep(0),
+    head_rep(0),
+    head_offset_rep(0),
+    write_fill_rep(0)
+{
+}
+
+ECA_FILE_IO_URING::~ECA_FILE_IO_URING(void)
+{
+  if (mode_rep != "") close_file();
+  delete impl_repp;
+}
+
+void ECA_FILE_IO_URING::open_file(const std::string& fname,
+				  const std::string& fmode)
+{
+  mode_rep = "";
+  error_rep = false;
+  ended_rep = false;
+  readahead_rep = false;
+  position_rep = 0;
+  bytes_rep = 0;
+  write_end_rep = 0;
+  head_rep = 0;
+  head_offset_rep = 0;
+  write_fill_rep = 0;
+
+  int flags;
+  if (fmode == "rb")
+    flags = O_RDONLY;
+  else if (fmode == "wb")
+    flags = O_WRONLY | O_CREAT | O_TRUNC;
+  else if (fmode == "w+b")
+    flags = O_RDWR | O_CREAT | O_TRUNC;
+  else if (fmode == "r+b")
+    flags = O_RDWR;
+  else
+    return;
+
+  reading_rep = (fmode == "rb");
+
+  if (impl_repp->setup(queue_depth_rep) != true) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects, "io_uring not available");
+    return;
+  }
+
+#ifdef O_DIRECT
+  if (direct_rep == true && reading_rep == true) {
+    fd_rep = ::open(fname.c_str(), flags | O_DIRECT);
+    if (fd_rep < 0)
+      ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		  "O_DIRECT not supported for \"" + fname + "\"");
+  }
+#endif
+  if (fd_rep < 0)
+    fd_rep = ::open(fname.c_str(), flags, 0666);
+
+  if (fd_rep < 0) {
+    impl_repp->release();
+    return;
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "io_uring opened \"" + fname + "\", queue depth " +
+	      kvu_numtostr(queue_depth_rep) +
+	      (impl_repp->fixed_rep == true ? ", fixed buffers" : ""));
+
+  mode_rep = fmode;
+}
+
+void ECA_FILE_IO_URING::close_file(void)
+{
+  if (mode_rep == "") return;
+
+  if (reading_rep == true)
+    stop_requests();
+  else
+    flush_writes();
+
+  ::close(fd_rep);
+  fd_rep = -1;
+  impl_repp->release();
+  mode_rep = "";
+}
+
+/**
+ * Queues a read or write request for block 'index'.
+ * The request is submitted on the next impl_repp->enter().
+ */
+void ECA_FILE_IO_URING::submit_block(int index, off_t offset, long int length, bool write)
+{
+  struct eca_fileio_uring_block& b = impl_repp->blocks_rep[index];
+  DBC_CHECK(b.in_flight != true);
+  b.offset = offset;
+  b.length = length;
+  b.result = 0;
+  b.in_flight = true;
+  impl_repp->queue(write == true ? IORING_OP_WRITEV : IORING_OP_READV,
+		   fd_rep, index, offset, length);
+}
+
+/**
+ * Blocks until the request for block 'index' has
+ * completed.
+ *
+ * @return false if waiting failed; the request may then
+ *         still be in flight, and the block must not be
+ *         reused
+ */
+bool ECA_FILE_IO_URING::wait_for_block(int index)
+{
+  struct eca_fileio_uring_block& b = impl_repp->blocks_rep[index];
+  while(true) {
+    impl_repp->reap();
+    if (b.in_flight != true) break;
+    /* note: -EBUSY means completions must be reaped first */
+    int ret = impl_repp->enter(1);
+    if (ret < 0 && ret != -EBUSY) {
+      ECA_LOG_MSG(ECA_LOGGER::info, "io_uring_enter() failed");
+      error_rep = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Checks the result of the completed write request for
+ * block 'index'. If only part of the block was written,
+ * the rest is written synchronously. The block can then
+ * be reused.
+ *
+ * @return false if writing failed
+ */
+bool ECA_FILE_IO_URING::finish_write(int index)
+{
+  struct eca_fileio_uring_block& b = impl_repp->blocks_rep[index];
+  if (b.result < 0)
+    return false;
+
+  long int done = b.result;
+  while(done < b.length) {
+    ssize_t res = ::pwrite(fd_rep, b.data + done, b.length - done, b.offset + done);
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info, "io_uring short write could not be completed");
+      return false;
+    }
+    done += res;
+  }
+
+  b.length = 0;
+  b.result = 0;
+  return true;
+}
+
+/**
+ * Issues reads for all blocks, starting at the
+ * current position.
+ */
+void ECA_FILE_IO_URING::start_readahead(void)
+{
+  int depth = impl_repp->blocks_rep.size();
+
+  head_rep = 0;
+  head_offset_rep = position_rep - (position_rep % eca_fileio_uring_alignment);
+  for(int n = 0; n < depth; n++) {
+    submit_block(n, head_offset_rep + n * block_size_default, block_size_default, false);
+  }
+  impl_repp->enter(0);
+  readahead_rep = true;
+}
+
+/**
+ * Moves the readahead window forward so that it starts
+ * at the block containing 'newpos'. Blocks before it are
+ * reused for reading further ahead, blocks from it 
+ * onwards are kept as is.
+ *
+ * @return false if 'newpos' is not within the window, or
+ *         waiting for a request failed
+ */
+bool ECA_FILE_IO_URING::move_readahead(off_t newpos)
+{
+  int depth = impl_repp->blocks_rep.size();
+
+  if (readahead_rep != true ||
+      newpos < head_offset_rep ||
+      newpos >= head_offset_rep + depth * block_size_default)
+    return false;
+
+  int skip = (newpos - head_offset_rep) / block_size_default;
+  for(int n = 0; n < skip; n++) {
+    if (wait_for_block(head_rep) != true)
+      return false;
+    advance_head_block();
+  }
+
+  return true;
+}
+
+/**
+ * Reuses the completed head block for reading ahead,
+ * and makes the next block the head.
+ */
+void ECA_FILE_IO_URING::advance_head_block(void)
+{
+  int depth = impl_repp->blocks_rep.size();
+
+  submit_block(head_rep, head_offset_rep + depth * block_size_default, block_size_default, false);
+  impl_repp->enter(0);
+  head_rep = (head_rep + 1) % depth;
+  head_offset_rep += block_size_default;
+}
+
+/**
+ * Waits until no requests are in flight.
+ */
+void ECA_FILE_IO_URING::stop_requests(void)
+{
+  for(size_t n = 0; n < impl_repp->blocks_rep.size(); n++) {
+    if (wait_for_block(n) != true)
+      break;
+  }
+  readahead_rep = false;
+}
+
+/**
+ * Submits the partially filled block, and waits until
+ * all writes have completed.
+ */
+void ECA_FILE_IO_URING::flush_writes(void)
+{
+  if (write_fill_rep > 0) {
+    submit_block(head_rep, head_offset_rep, write_fill_rep, true);
+    impl_repp->enter(0);
+    head_rep = (head_rep + 1) % impl_repp->blocks_rep.size();
+    write_fill_rep = 0;
+  }
+
+  for(size_t n = 0; n < impl_repp->blocks_rep.size(); n++) {
+    if (wait_for_block(n) != true)
+      break;
+    if (finish_write(n) != true)
+      error_rep = true;
+  }
+}
+
+void ECA_FILE_IO_URING::read_to_buffer(void* obuf, off_t bytes)
+{
+  bytes_rep = 0;
+  if (is_file_ready() != true)
+    return;
+
+  unsigned char* target = static_cast<unsigned char*>(obuf);
+
+  if (reading_rep != true) {
+    /* note: files opened for writing are read
+     *       synchronously (only used for headers) */
+    flush_writes();
+    while(bytes > 0) {
+      ssize_t res = ::pread(fd_rep, target, bytes, position_rep);
+      if (res < 0 && errno == EINTR) continue;
+      if (res < 0) { error_rep = true; break; }
+      if (res == 0) { ended_rep = true; break; }
+      target += res;
+      bytes -= res;
+      bytes_rep += res;
+      position_rep += res;
+    }
+    return;
+  }
+
+  if (readahead_rep != true)
+    start_readahead();
+
+  while(bytes > 0) {
+    if (wait_for_block(head_rep) != true)
+      break;
+    struct eca_fileio_uring_block& b = impl_repp->blocks_rep[head_rep];
+    if (b.result < 0) {
+      error_rep = true;
+      break;
+    }
+
+    off_t inblock = position_rep - head_offset_rep;
+    if (inblock >= b.result) {
+      ended_rep = true;
+      break;
+    }
+
+    off_t n = b.result - inblock;
+    if (n > bytes) n = bytes;
+    std::memcpy(target, b.data + inblock, n);
+    target += n;
+    bytes -= n;
+    bytes_rep += n;
+    position_rep += n;
+
+    if (position_rep - head_offset_rep >= block_size_default) {
+      /* block consumed, reuse it for reading ahead */
+      advance_head_block();
+    }
+  }
+}
+
+void ECA_FILE_IO_URING::write_from_buffer(void* obuf, off_t bytes)
+{
+  bytes_rep = 0;
+  if (mode_rep == "" || reading_rep == true || error_rep == true)
+    return;
+
+  unsigned char* source = static_cast<unsigned char*>(obuf);
+  int depth = impl_repp->blocks_rep.size();
+
+  while(bytes > 0) {
+    struct eca_fileio_uring_block& b = impl_repp->blocks_rep[head_rep];
+
+    if (write_fill_rep == 0) {
+      /* make sure the previous write of this block is complete */
+      if (wait_for_block(head_rep) != true)
+	break;
+      if (finish_write(head_rep) != true) {
+	error_rep = true;
+	break;
+      }
+      head_offset_rep = position_rep;
+    }
+
+    off_t n = block_size_default - write_fill_rep;
+    if (n > bytes) n = bytes;
+    std::memcpy(b.data + write_fill_rep, source, n);
+    source += n;
+    bytes -= n;
+    bytes_rep += n;
+    position_rep += n;
+    write_fill_rep += n;
+
+    if (write_fill_rep == block_size_default) {
+      submit_block(head_rep, head_offset_rep, block_size_default, true);
+      impl_repp->enter(0);
+      head_rep = (head_rep + 1) % depth;
+      write_fill_rep = 0;
+    }
+  }
+
+  if (position_rep > write_end_rep)
+    write_end_rep = position_rep;
+}
+
+void ECA_FILE_IO_URING::set_file_position(off_t newpos)
+{
+  if (mode_rep == "") return;
+
+  if (reading_rep == true) {
+    /* note: blocks that still cover 'newpos' are kept */
+    if (move_readahead(newpos) != true)
+      stop_requests();
+  }
+  else {
+    flush_writes();
+  }
+
+  position_rep = newpos;
+  ended_rep = false;
+}
+
+void ECA_FILE_IO_URING::set_file_position_advance(off_t fw)
+{
+  set_file_position(position_rep + fw);
+}
+
+void ECA_FILE_IO_URING::set_file_position_end(void)
+{
+  set_file_position(get_file_length());
+}
+
+off_t ECA_FILE_IO_URING::get_file_position(void) const
+{
+  return position_rep;
+}
+
+off_t ECA_FILE_IO_URING::get_file_length(void) const
+{
+  struct stat temp;
+  off_t len = 0;
+  if (fd_rep >= 0 && fstat(fd_rep, &temp) == 0)
+    len = temp.st_size;
+
+  /* note: data may still be in flight */
+  if (write_end_rep > len)
+    len = write_end_rep;
+
+  return len;
+}
+
+bool ECA_FILE_IO_URING::is_file_ready(void) const
+{
+  if (mode_rep == "" ||
+      error_rep == true ||
+      ended_rep == true) return false;
+  return true;
+}
+
+bool ECA_FILE_IO_URING::is_file_error(void) const
+{
+  return error_rep;
+}
+
+off_t ECA_FILE_IO_URING::file_bytes_processed(void) const
+{
+  return bytes_rep;
+}
@@ -0,0 +1,115 @@
+#ifndef INCLUDED_FILEIO_URING_H
+#define INCLUDED_FILEIO_URING_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "eca-fileio.h"
+
+class ECA_FILE_IO_URING_impl;
+
+/**
+ * File-io using asynchronous io_uring requests (Linux).
+ *
+ * In read mode, up to 'queue depth' blocks ahead of the
+ * current file position are kept in flight, so the data is
+ * usually already in memory when read_to_buffer() is called.
+ * In write mode, full blocks are submitted to the kernel
+ * and the caller only blocks if all blocks are still in
+ * flight. Block buffers are registered with the kernel
+ * (fixed buffers), if allowed by the memory locking limits.
+ *
+ * If 'direct' is enabled, files opened for reading bypass
+ * the page cache (O_DIRECT).
+ *
+ * Seeking within the blocks already read ahead keeps 
+ * them, so that small seeks (for instance while parsing
+ * file headers) do not restart the readahead.
+ *
+ * If io_uring is not supported by the system, open_file()
+ * fails and is_file_ready() returns false.
+ */
+class ECA_FILE_IO_URING : public ECA_FILE_IO {
+
+ public:
+
+  static const int queue_depth_default;
+  static const long int block_size_default;
+
+  static void set_default_queue_depth(int value);
+  static int default_queue_depth(void) { return queue_depth_rep; }
+  static ECA_FILE_IO* create(const std::string& fileio,
+			     const std::string& fname,
+			     const std::string& fmode);
+
+  ECA_FILE_IO_URING(bool direct = false);
+  virtual ~ECA_FILE_IO_URING(void);
+
+  // --
+  // Open/close routines
+  // ---
+  virtual void open_file(const std::string& fname, const std::string& fmode);
+  virtual void open_stdin(void) { }
+  virtual void open_stdout(void) { }
+  virtual void open_stderr(void) { }
+  virtual void close_file(void);
+
+  // --
+  // Normal file operations
+  // ---
+  virtual void read_to_buffer(void* obuf, off_t bytes);
+  virtual void write_from_buffer(void* obuf, off_t bytes);
+
+  virtual void set_file_position(off_t newpos);
+  virtual void set_file_position_advance(off_t fw);
+  virtual void set_file_position_end(void);
+  virtual off_t get_file_position(void) const;
+  virtual off_t get_file_length(void) const;
+
+  // --
+  // Status
+  // ---
+  virtual bool is_file_ready(void) const;
+  virtual bool is_file_error(void) const;
+  virtual off_t file_bytes_processed(void) const;
+  virtual const std::string& file_mode(void) const { return(mode_rep); }
+
+ private:
+
+  static int queue_depth_rep;
+
+  ECA_FILE_IO_URING_impl* impl_repp;
+
+  int fd_rep;
+  bool direct_rep;
+  bool reading_rep;
+  bool readahead_rep;
+  bool error_rep;
+  bool ended_rep;
+
+  off_t position_rep;
+  off_t bytes_rep;
+  off_t write_end_rep;
+
+  int head_rep;
+  off_t head_offset_rep;
+  long int write_fill_rep;
+
+  std::string mode_rep;
+
+  ECA_FILE_IO_URING(const ECA_FILE_IO_URING& x) { }
+  ECA_FILE_IO_URING& operator=(const ECA_FILE_IO_URING& x) { return *this; }
+
+  void start_readahead(void);
+  bool move_readahead(off_t newpos);
+  void advance_head_block(void);
+  void stop_requests(void);
+  void flush_writes(void);
+  bool finish_write(int index);
+  void submit_block(int index, off_t offset, long int length, bool write);
+  bool wait_for_block(int index);
+};
+
+#endif
@@ -111,6 +111,8 @@ void ECA_IAMODE_PARSER::register_commands_misc(void)
   (*cmd_map_repp)["engine-launch"] = ec_engine_launch;
   (*cmd_map_repp)["engine-halt"] = ec_engine_halt;
   (*cmd_map_repp)["engine-status"] = ec_engine_status;
+  (*cmd_map_repp)["engine-queue-status"] = ec_engine_queue_status;
+  (*cmd_map_repp)["engine-profile"] = ec_engine_profile;
 
   (*cmd_map_repp)["status"] = ec_cs_status;
   (*cmd_map_repp)["st"] = ec_cs_status;
@@ -184,6 +186,10 @@ void ECA_IAMODE_PARSER::register_commands_cs(void)
   (*cmd_map_repp)["cs-set-length-samples"] = ec_cs_set_length_samples;
   (*cmd_map_repp)["cs-toggle-loop"] = ec_cs_toggle_loop;
   (*cmd_map_repp)["cs-option"] = ec_cs_option;
+  (*cmd_map_repp)["cs-bg-start"] = ec_cs_bg_start;
+  (*cmd_map_repp)["cs-bg-stop"] = ec_cs_bg_stop;
+  (*cmd_map_repp)["cs-bg-list"] = ec_cs_bg_list;
+  (*cmd_map_repp)["cs-bg-status"] = ec_cs_bg_status;
 }
 
 void ECA_IAMODE_PARSER::register_commands_c(void)
@@ -284,6 +290,7 @@ void ECA_IAMODE_PARSER::register_commands_cop(void)
   (*cmd_map_repp)["cop-set"] = ec_cop_set;
   (*cmd_map_repp)["cop-get"] = ec_cop_get;
   (*cmd_map_repp)["cop-status"] = ec_cop_status;
+  (*cmd_map_repp)["cop-profile"] = ec_cop_profile;
 }
 
 void ECA_IAMODE_PARSER::register_commands_copp(void)
@@ -372,6 +379,7 @@ bool ECA_IAMODE_PARSER::action_requires_params(int id)
   case ec_cs_forward:
   case ec_cs_set_position:
   case ec_cs_option:
+  case ec_cs_bg_stop:
 
   case ec_c_add:
   case ec_c_select:
@@ -446,6 +454,8 @@ bool ECA_IAMODE_PARSER::action_requires_selected(int id)
 {
   switch(id) {
 
+  case ec_engine_profile:
+
   case ec_cs_remove: 
   case ec_cs_edit:
   case ec_cs_is_valid:
@@ -465,6 +475,7 @@ bool ECA_IAMODE_PARSER::action_requires_selected(int id)
   case ec_cs_set_length_samples:
   case ec_cs_toggle_loop:
   case ec_cs_option:
+  case ec_cs_bg_start:
 
   case ec_c_remove:
   case ec_c_clear:
@@ -524,6 +535,7 @@ bool ECA_IAMODE_PARSER::action_requires_selected(int id)
   case ec_cop_set:
   case ec_cop_get:
   case ec_cop_status:
+  case ec_cop_profile:
 
   case ec_copp_list:
   case ec_copp_select:
@@ -558,9 +570,6 @@ bool ECA_IAMODE_PARSER::action_requires_selected_not_connected(int id)
   case ec_c_rename:
   case ec_c_clear:
 
-  case ec_cop_remove:
-  case ec_ctrl_remove:
-
   case ec_ai_add:
   case ec_ai_remove:
   case ec_ai_attach:
@@ -589,6 +598,68 @@ bool ECA_IAMODE_PARSER::action_requires_selected_not_connected(int id)
 
 }
 
+/**
+ * Whether action can not be performed when the selected
+ * chainsetup is processed in the background? Actions that
+ * edit chains through chainsetup edits are passed to the
+ * background engine, but actions that change the chainsetup
+ * in other ways, or that control the connected engine,
+ * are not supported.
+ */
+bool ECA_IAMODE_PARSER::action_requires_selected_not_background(int id)
+{
+  switch(id) {
+  case ec_engine_profile:
+
+  case ec_cs_remove:
+  case ec_cs_edit:
+  case ec_cs_save:
+  case ec_cs_save_as:
+  case ec_cs_connect:
+  case ec_cs_set_param:
+  case ec_cs_set_audio_format:
+  case ec_cs_rewind:
+  case ec_cs_forward:
+  case ec_cs_set_position:
+  case ec_cs_set_position_samples:
+  case ec_cs_set_length:
+  case ec_cs_set_length_samples:
+  case ec_cs_toggle_loop:
+  case ec_cs_option:
+  case ec_cs_bg_start:
+
+  case ec_c_add:
+  case ec_c_remove:
+  case ec_c_rename:
+  case ec_c_clear:
+
+  case ec_ai_add:
+  case ec_ai_remove:
+  case ec_ai_attach:
+  case ec_ai_forward:
+  case ec_ai_rewind:
+  case ec_ai_set_position:
+  case ec_ai_set_position_samples:
+  case ec_ai_wave_edit:
+
+  case ec_ao_add:
+  case ec_ao_add_default:
+  case ec_ao_remove:
+  case ec_ao_attach:
+  case ec_ao_forward:
+  case ec_ao_rewind:
+  case ec_ao_set_position:
+  case ec_ao_set_position_samples:
+  case ec_ao_wave_edit:
+
+    return true;
+
+  default:
+    break;
+  }
+  return false;
+}
+
 bool ECA_IAMODE_PARSER::action_requires_selected_audio_input(int id)
 {
   switch(id) {
@@ -657,6 +728,8 @@ void show_controller_help(void)
   mitem << "\n'setpos time-in-seconds' - Sets the current position to 'time-in-seconds' seconds from the beginning.";
   mitem << "\n'engine-launch' - Initialize and start engine";
   mitem << "\n'engine-status' - Engine status";
+  mitem << "\n'engine-queue-status' - Engine command queue counters";
+  mitem << "\n'engine-profile' - Chain processing times";
   mitem << "\n'cs-status', 'st' - Chainsetup status";
   mitem << "\n'c-status', 'cs' - Chain status";
   mitem << "\n'cop-status', 'es' - Chain operator status";
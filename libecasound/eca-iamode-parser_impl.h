@@ -18,6 +18,8 @@ class ECA_IAMODE_PARSER_COMMANDS {
     ec_resource_file,
     // --
     ec_engine_status,
+    ec_engine_queue_status,
+    ec_engine_profile,
     ec_engine_launch,
     ec_engine_halt,
     // --
@@ -50,6 +52,10 @@ class ECA_IAMODE_PARSER_COMMANDS {
     ec_cs_set_length_samples,
     ec_cs_toggle_loop,
     ec_cs_option,
+    ec_cs_bg_start,
+    ec_cs_bg_stop,
+    ec_cs_bg_list,
+    ec_cs_bg_status,
     // --
     ec_c_add,
     ec_c_remove,
@@ -123,6 +129,7 @@ class ECA_IAMODE_PARSER_COMMANDS {
     ec_cop_set,
     ec_cop_get,
     ec_cop_status,
+    ec_cop_profile,
     ec_cop_register,
     ec_copp_list,
     ec_copp_select,
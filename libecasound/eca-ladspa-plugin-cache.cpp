@@ -0,0 +1,529 @@
+// ------------------------------------------------------------------------
+// eca-ladspa-plugin-cache.cpp: Persistent index of LADSPA plugin descriptors
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+
+#include "eca-ladspa-plugin-cache.h"
+#include "eca-logger.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * Copy of the metadata of one LADSPA plugin.
+ *
+ * 'desc' points to the other members of the record, and its
+ * 'ImplementationData' field points back to the record itself.
+ * 'real' is the descriptor provided by the plugin library,
+ * or null if the library has not been loaded.
+ */
+struct eca_ladspa_plugin_record {
+  LADSPA_Descriptor desc;
+  string library;
+  unsigned long index;
+  string label, name, maker, copyright;
+  vector<LADSPA_PortDescriptor> port_descs;
+  vector<string> port_names;
+  vector<const char*> port_name_ptrs;
+  vector<LADSPA_PortRangeHint> hints;
+  const LADSPA_Descriptor* real;
+};
+
+static const char* eca_ladspa_plugin_cache_header = "ecasound-ladspa-plugin-cache 1";
+
+static pthread_mutex_t eca_ladspa_plugin_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void eca_ladspa_plugin_record_finalize(struct eca_ladspa_plugin_record* rec);
+static struct eca_ladspa_plugin_record* eca_ladspa_plugin_record_copy(const string& library, unsigned long index, const LADSPA_Descriptor* d);
+static bool eca_ladspa_plugin_record_matches(const struct eca_ladspa_plugin_record* rec, const LADSPA_Descriptor* d);
+static string eca_ladspa_plugin_cache_escape(const char* str);
+static string eca_ladspa_plugin_cache_unescape(const string& str);
+static vector<string> eca_ladspa_plugin_cache_fields(const string& line);
+static string eca_ladspa_plugin_cache_float_to_str(LADSPA_Data value);
+static LADSPA_Data eca_ladspa_plugin_cache_str_to_float(const string& str);
+
+ECA_LADSPA_PLUGIN_CACHE::ECA_LADSPA_PLUGIN_CACHE(void)
+  : modified_rep(false)
+{
+}
+
+/**
+ * Destructor.
+ *
+ * Plugin records are not freed, as descriptors
+ * returned by descriptors() may still be in use
+ * (plugin libraries are not unloaded either).
+ */
+ECA_LADSPA_PLUGIN_CACHE::~ECA_LADSPA_PLUGIN_CACHE(void)
+{
+}
+
+/**
+ * Loads the index from file 'filename'.
+ *
+ * Returns false if the file does not exist, or if it
+ * is not a valid index file. In the latter case, the
+ * file contents are ignored and the index is rebuilt
+ * on the next save().
+ */
+bool ECA_LADSPA_PLUGIN_CACHE::load(const string& filename)
+{
+  std::ifstream fin (filename.c_str());
+  if (!fin)
+    return false;
+
+  string line;
+  if (!std::getline(fin, line) || line != eca_ladspa_plugin_cache_header) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Ignoring LADSPA plugin cache \"" + filename + "\" with unknown format.");
+    modified_rep = true;
+    return false;
+  }
+
+  std::map<string, struct file_entry> files;
+  struct file_entry* entry = 0;
+  struct eca_ladspa_plugin_record* rec = 0;
+  string library;
+  bool valid = true;
+
+  while(valid == true && std::getline(fin, line)) {
+    vector<string> fields = eca_ladspa_plugin_cache_fields(line);
+
+    if (fields.size() == 4 && fields[0] == "file") {
+      if (rec != 0) eca_ladspa_plugin_record_finalize(rec);
+      rec = 0;
+      library = fields[1];
+      entry = &files[library];
+      entry->mtime = std::atoll(fields[2].c_str());
+      entry->size = std::atoll(fields[3].c_str());
+      entry->seen = false;
+      entry->plugins.clear();
+    }
+    else if (fields.size() == 8 && fields[0] == "plugin" && entry != 0) {
+      if (rec != 0) eca_ladspa_plugin_record_finalize(rec);
+      rec = new struct eca_ladspa_plugin_record;
+      rec->library = library;
+      rec->index = std::strtoul(fields[1].c_str(), 0, 10);
+      std::memset(&rec->desc, 0, sizeof(rec->desc));
+      rec->desc.UniqueID = std::strtoul(fields[2].c_str(), 0, 10);
+      rec->desc.Properties = std::atoi(fields[3].c_str());
+      rec->label = fields[4];
+      rec->name = fields[5];
+      rec->maker = fields[6];
+      rec->copyright = fields[7];
+      rec->real = 0;
+      entry->plugins.push_back(rec);
+    }
+    else if (fields.size() == 6 && fields[0] == "port" && rec != 0) {
+      LADSPA_PortRangeHint hint;
+      rec->port_descs.push_back(std::atoi(fields[1].c_str()));
+      hint.HintDescriptor = std::atoi(fields[2].c_str());
+      hint.LowerBound = eca_ladspa_plugin_cache_str_to_float(fields[3]);
+      hint.UpperBound = eca_ladspa_plugin_cache_str_to_float(fields[4]);
+      rec->hints.push_back(hint);
+      rec->port_names.push_back(fields[5]);
+    }
+    else if (line.size() > 0) {
+      valid = false;
+    }
+  }
+  if (rec != 0) eca_ladspa_plugin_record_finalize(rec);
+
+  if (valid != true) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Ignoring corrupted LADSPA plugin cache \"" + filename + "\".");
+    modified_rep = true;
+    return false;
+  }
+
+  files_rep.swap(files);
+  modified_rep = false;
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "Loaded LADSPA plugin cache \"" + filename + "\" (" +
+	      kvu_numtostr(files_rep.size()) + " files).");
+
+  return true;
+}
+
+/**
+ * Writes the index to file 'filename'.
+ *
+ * Only files that have been looked up with descriptors()
+ * since the index was loaded are written, so entries of
+ * removed plugin files are dropped.
+ *
+ * The file is first written under a temporary name and
+ * then renamed, so concurrent readers never see a partially
+ * written index.
+ */
+bool ECA_LADSPA_PLUGIN_CACHE::save(const string& filename)
+{
+  string tmpname = filename + ".tmp" + kvu_numtostr(getpid());
+  FILE* f = std::fopen(tmpname.c_str(), "w");
+  if (f == 0) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Unable to write LADSPA plugin cache \"" + filename + "\".");
+    return false;
+  }
+
+  std::fprintf(f, "%s\n", eca_ladspa_plugin_cache_header);
+
+  std::map<string, struct file_entry>::iterator p = files_rep.begin();
+  while(p != files_rep.end()) {
+    if (p->second.seen != true) {
+      files_rep.erase(p++);
+      continue;
+    }
+
+    std::fprintf(f, "file\t%s\t%lld\t%lld\n",
+		 eca_ladspa_plugin_cache_escape(p->first.c_str()).c_str(),
+		 p->second.mtime, p->second.size);
+
+    for(size_t n = 0; n < p->second.plugins.size(); n++) {
+      const struct eca_ladspa_plugin_record* rec = p->second.plugins[n];
+      std::fprintf(f, "plugin\t%lu\t%lu\t%d\t%s\t%s\t%s\t%s\n",
+		   rec->index,
+		   rec->desc.UniqueID,
+		   static_cast<int>(rec->desc.Properties),
+		   eca_ladspa_plugin_cache_escape(rec->label.c_str()).c_str(),
+		   eca_ladspa_plugin_cache_escape(rec->name.c_str()).c_str(),
+		   eca_ladspa_plugin_cache_escape(rec->maker.c_str()).c_str(),
+		   eca_ladspa_plugin_cache_escape(rec->copyright.c_str()).c_str());
+
+      for(size_t m = 0; m < rec->port_descs.size(); m++) {
+	std::fprintf(f, "port\t%d\t%d\t%s\t%s\t%s\n",
+		     static_cast<int>(rec->port_descs[m]),
+		     static_cast<int>(rec->hints[m].HintDescriptor),
+		     eca_ladspa_plugin_cache_float_to_str(rec->hints[m].LowerBound).c_str(),
+		     eca_ladspa_plugin_cache_float_to_str(rec->hints[m].UpperBound).c_str(),
+		     eca_ladspa_plugin_cache_escape(rec->port_names[m].c_str()).c_str());
+      }
+    }
+    ++p;
+  }
+
+  bool ok = (std::ferror(f) == 0);
+  if (std::fclose(f) != 0) ok = false;
+
+  if (ok != true || std::rename(tmpname.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpname.c_str());
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Unable to write LADSPA plugin cache \"" + filename + "\".");
+    return false;
+  }
+
+  modified_rep = false;
+  return true;
+}
+
+bool ECA_LADSPA_PLUGIN_CACHE::is_modified(void) const
+{
+  if (modified_rep == true)
+    return true;
+
+  std::map<string, struct file_entry>::const_iterator p = files_rep.begin();
+  while(p != files_rep.end()) {
+    if (p->second.seen != true)
+      return true;
+    ++p;
+  }
+
+  return false;
+}
+
+/**
+ * Returns descriptors of all plugins in file 'library'.
+ *
+ * If the file has the same modification time and size
+ * as when it was indexed, the stored descriptors are
+ * returned. Otherwise the file is loaded and the index
+ * entry is updated.
+ *
+ * Returns an empty vector if 'library' can not be loaded,
+ * or if it contains no LADSPA plugins.
+ */
+vector<const LADSPA_Descriptor*> ECA_LADSPA_PLUGIN_CACHE::descriptors(const string& library)
+{
+  vector<const LADSPA_Descriptor*> result;
+
+  struct stat statbuf;
+  if (stat(library.c_str(), &statbuf) != 0)
+    return result;
+
+  std::map<string, struct file_entry>::iterator p = files_rep.find(library);
+  if (p != files_rep.end() &&
+      p->second.mtime == static_cast<long long int>(statbuf.st_mtime) &&
+      p->second.size == static_cast<long long int>(statbuf.st_size)) {
+    p->second.seen = true;
+  }
+  else {
+    if (p != files_rep.end()) {
+      files_rep.erase(p);
+      modified_rep = true;
+    }
+
+    void *plugin_handle = dlopen(library.c_str(), RTLD_NOW);
+    if (plugin_handle == 0) {
+      ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		  string("Unable to open plugin file \"") + library + "\".");
+      return result;
+    }
+
+    struct file_entry entry;
+    entry.mtime = statbuf.st_mtime;
+    entry.size = statbuf.st_size;
+    entry.seen = true;
+
+    LADSPA_Descriptor_Function desc_func =
+      (LADSPA_Descriptor_Function)dlsym(plugin_handle, "ladspa_descriptor");
+    if (desc_func != 0) {
+      for(unsigned long i = 0;; i++) {
+	const LADSPA_Descriptor* d = desc_func(i);
+	if (d == 0) break;
+	entry.plugins.push_back(eca_ladspa_plugin_record_copy(library, i, d));
+      }
+    }
+    else {
+      ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		  "Unable find plugin LADSPA-descriptor.");
+    }
+
+    p = files_rep.insert(std::make_pair(library, entry)).first;
+    modified_rep = true;
+  }
+
+  for(size_t n = 0; n < p->second.plugins.size(); n++)
+    result.push_back(&p->second.plugins[n]->desc);
+
+  return result;
+}
+
+/**
+ * Returns the real descriptor for plugin 'desc'.
+ *
+ * If 'desc' was returned by descriptors(), the plugin
+ * library is loaded (if not already loaded), and the
+ * descriptor with matching id, label and port layout
+ * is returned. Returns null if the library can not
+ * be loaded, or if the plugin is no longer found in it.
+ *
+ * Other descriptors are returned as such.
+ */
+const LADSPA_Descriptor* ECA_LADSPA_PLUGIN_CACHE::resolve(const LADSPA_Descriptor* desc)
+{
+  if (desc == 0 || desc->instantiate != 0)
+    return desc;
+
+  struct eca_ladspa_plugin_record* rec =
+    reinterpret_cast<struct eca_ladspa_plugin_record*>(desc->ImplementationData);
+  DBC_CHECK(rec != 0 && desc == &rec->desc);
+
+  pthread_mutex_lock(&eca_ladspa_plugin_cache_lock);
+
+  if (rec->real == 0) {
+    void *plugin_handle = dlopen(rec->library.c_str(), RTLD_NOW);
+    LADSPA_Descriptor_Function desc_func = 0;
+    if (plugin_handle != 0)
+      desc_func = (LADSPA_Descriptor_Function)dlsym(plugin_handle, "ladspa_descriptor");
+
+    if (desc_func != 0) {
+      const LADSPA_Descriptor* d = desc_func(rec->index);
+      if (d != 0 && eca_ladspa_plugin_record_matches(rec, d) == true) {
+	rec->real = d;
+      }
+      else {
+	/* plugin file has changed, search by id */
+	for(unsigned long i = 0;; i++) {
+	  d = desc_func(i);
+	  if (d == 0) break;
+	  if (eca_ladspa_plugin_record_matches(rec, d) == true) {
+	    rec->real = d;
+	    break;
+	  }
+	}
+      }
+    }
+
+    if (rec->real == 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Unable to load LADSPA plugin \"" + rec->label +
+		  "\" from \"" + rec->library + "\".");
+    }
+    else {
+      ECA_LOG_MSG(ECA_LOGGER::system_objects,
+		  "Loaded LADSPA plugin \"" + rec->label +
+		  "\" from \"" + rec->library + "\".");
+    }
+  }
+
+  const LADSPA_Descriptor* result = rec->real;
+
+  pthread_mutex_unlock(&eca_ladspa_plugin_cache_lock);
+
+  return result;
+}
+
+/**
+ * Points the descriptor fields of 'rec' to the
+ * other members of the record. Must be called
+ * after all ports have been added.
+ */
+static void eca_ladspa_plugin_record_finalize(struct eca_ladspa_plugin_record* rec)
+{
+  rec->port_name_ptrs.resize(rec->port_names.size());
+  for(size_t n = 0; n < rec->port_names.size(); n++)
+    rec->port_name_ptrs[n] = rec->port_names[n].c_str();
+
+  rec->desc.Label = rec->label.c_str();
+  rec->desc.Name = rec->name.c_str();
+  rec->desc.Maker = rec->maker.c_str();
+  rec->desc.Copyright = rec->copyright.c_str();
+  rec->desc.PortCount = rec->port_descs.size();
+  rec->desc.PortDescriptors = rec->port_descs.size() > 0 ? &rec->port_descs[0] : 0;
+  rec->desc.PortNames = rec->port_name_ptrs.size() > 0 ? &rec->port_name_ptrs[0] : 0;
+  rec->desc.PortRangeHints = rec->hints.size() > 0 ? &rec->hints[0] : 0;
+  rec->desc.ImplementationData = rec;
+}
+
+static struct eca_ladspa_plugin_record* eca_ladspa_plugin_record_copy(const string& library, unsigned long index, const LADSPA_Descriptor* d)
+{
+  struct eca_ladspa_plugin_record* rec = new struct eca_ladspa_plugin_record;
+
+  std::memset(&rec->desc, 0, sizeof(rec->desc));
+  rec->library = library;
+  rec->index = index;
+  rec->desc.UniqueID = d->UniqueID;
+  rec->desc.Properties = d->Properties;
+  rec->label = d->Label != 0 ? d->Label : "";
+  rec->name = d->Name != 0 ? d->Name : "";
+  rec->maker = d->Maker != 0 ? d->Maker : "";
+  rec->copyright = d->Copyright != 0 ? d->Copyright : "";
+  for(unsigned long m = 0; m < d->PortCount; m++) {
+    rec->port_descs.push_back(d->PortDescriptors[m]);
+    rec->port_names.push_back(d->PortNames[m] != 0 ? d->PortNames[m] : "");
+    rec->hints.push_back(d->PortRangeHints[m]);
+  }
+  rec->real = d;
+
+  eca_ladspa_plugin_record_finalize(rec);
+
+  return rec;
+}
+
+static bool eca_ladspa_plugin_record_matches(const struct eca_ladspa_plugin_record* rec, const LADSPA_Descriptor* d)
+{
+  if (d->UniqueID != rec->desc.UniqueID ||
+      d->Label == 0 || rec->label != d->Label ||
+      d->PortCount != rec->desc.PortCount)
+    return false;
+
+  for(unsigned long m = 0; m < d->PortCount; m++) {
+    if (d->PortDescriptors[m] != rec->port_descs[m])
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Escapes tabs, linefeeds and backslashes, so that
+ * fields can be stored as tab-separated lines.
+ */
+static string eca_ladspa_plugin_cache_escape(const char* str)
+{
+  string result;
+  for(; *str != 0; str++) {
+    if (*str == '\\') result += "\\\\";
+    else if (*str == '\t') result += "\\t";
+    else if (*str == '\n') result += "\\n";
+    else result += *str;
+  }
+  return result;
+}
+
+static string eca_ladspa_plugin_cache_unescape(const string& str)
+{
+  string result;
+  for(size_t n = 0; n < str.size(); n++) {
+    if (str[n] == '\\' && n + 1 < str.size()) {
+      ++n;
+      if (str[n] == 't') result += '\t';
+      else if (str[n] == 'n') result += '\n';
+      else result += str[n];
+    }
+    else
+      result += str[n];
+  }
+  return result;
+}
+
+static vector<string> eca_ladspa_plugin_cache_fields(const string& line)
+{
+  vector<string> fields;
+  size_t begin = 0;
+  for(;;) {
+    size_t end = line.find('\t', begin);
+    fields.push_back(eca_ladspa_plugin_cache_unescape(line.substr(begin, end - begin)));
+    if (end == string::npos) break;
+    begin = end + 1;
+  }
+  return fields;
+}
+
+/**
+ * Range hints are stored as raw bit patterns, so that
+ * values are restored exactly and independently of
+ * the locale.
+ */
+static string eca_ladspa_plugin_cache_float_to_str(LADSPA_Data value)
+{
+  unsigned int bits;
+  char buf[16];
+  DBC_CHECK(sizeof(bits) == sizeof(value));
+  std::memcpy(&bits, &value, sizeof(bits));
+  std::snprintf(buf, sizeof(buf), "%08x", bits);
+  return string(buf);
+}
+
+static LADSPA_Data eca_ladspa_plugin_cache_str_to_float(const string& str)
+{
+  unsigned int bits = static_cast<unsigned int>(std::strtoul(str.c_str(), 0, 16));
+  LADSPA_Data value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
@@ -0,0 +1,75 @@
+#ifndef INCLUDED_ECA_LADSPA_PLUGIN_CACHE_H
+#define INCLUDED_ECA_LADSPA_PLUGIN_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* prefer already installed LADSPA header over the
+ * version shipped with ecasound */
+#ifdef HAVE_LADSPA_H
+#include <ladspa.h>
+#else
+#include "ladspa.h"
+#endif
+
+struct eca_ladspa_plugin_record;
+
+/**
+ * Persistent index of LADSPA plugin descriptors.
+ *
+ * For every plugin file, the index stores the modification
+ * time and size of the file, and a copy of the metadata
+ * of all plugins in the file (labels, names, port layouts
+ * and range hints). As long as the file is not modified,
+ * descriptors() returns the stored copies without loading
+ * the file.
+ *
+ * The returned descriptors have no function pointers
+ * ('instantiate' is null). Before a plugin is instantiated,
+ * resolve() must be used to load the plugin file and
+ * to look up the real descriptor.
+ *
+ * Descriptors returned by descriptors() stay valid for the
+ * lifetime of the process.
+ *
+ * @author Kai Vehmanen
+ */
+class ECA_LADSPA_PLUGIN_CACHE {
+
+ public:
+
+  ECA_LADSPA_PLUGIN_CACHE(void);
+  ~ECA_LADSPA_PLUGIN_CACHE(void);
+
+  bool load(const std::string& filename);
+  bool save(const std::string& filename);
+
+  /**
+   * Whether the index has changed since it was loaded
+   * or saved, ie. whether plugin files have been added,
+   * modified or removed.
+   */
+  bool is_modified(void) const;
+
+  std::vector<const LADSPA_Descriptor*> descriptors(const std::string& library);
+
+  static const LADSPA_Descriptor* resolve(const LADSPA_Descriptor* desc);
+
+ private:
+
+  struct file_entry {
+    long long int mtime;
+    long long int size;
+    bool seen;
+    std::vector<struct eca_ladspa_plugin_record*> plugins;
+  };
+
+  std::map<std::string, struct file_entry> files_rep;
+  bool modified_rep;
+
+  ECA_LADSPA_PLUGIN_CACHE(const ECA_LADSPA_PLUGIN_CACHE& x) { }
+  ECA_LADSPA_PLUGIN_CACHE& operator=(const ECA_LADSPA_PLUGIN_CACHE& x) { return *this; }
+};
+
+#endif
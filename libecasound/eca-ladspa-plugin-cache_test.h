@@ -0,0 +1,186 @@
+// ------------------------------------------------------------------------
+// eca-ladspa-plugin-cache_test.h: Unit test for ECA_LADSPA_PLUGIN_CACHE
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "kvu_numtostr.h"
+
+#include "audiofx_ladspa.h"
+#include "eca-ladspa-plugin-cache.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_LADSPA_PLUGIN_CACHE
+ */
+class ECA_LADSPA_PLUGIN_CACHE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_LADSPA_PLUGIN_CACHE"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_LADSPA_PLUGIN_CACHE_TEST(void) { }
+
+private:
+
+  void check_descriptor(const LADSPA_Descriptor* desc, const string& test);
+
+};
+
+void ECA_LADSPA_PLUGIN_CACHE_TEST::check_descriptor(const LADSPA_Descriptor* desc, const string& test)
+{
+  if (desc->instantiate != 0) {
+    ECA_TEST_FAILURE(test + ": instantiate");
+  }
+  if (desc->UniqueID != 1234 ||
+      string(desc->Label) != "testamp" ||
+      string(desc->Name) != "Test Amplifier" ||
+      string(desc->Maker) != "Maker\\Name" ||
+      desc->Properties != LADSPA_PROPERTY_HARD_RT_CAPABLE) {
+    ECA_TEST_FAILURE(test + ": plugin metadata");
+  }
+  if (desc->PortCount != 2 ||
+      desc->PortDescriptors[0] != (LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL) ||
+      desc->PortDescriptors[1] != (LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO)) {
+    ECA_TEST_FAILURE(test + ": port layout");
+  }
+  if (string(desc->PortNames[0]) != "Gain\t(dB)" ||
+      string(desc->PortNames[1]) != "Input") {
+    ECA_TEST_FAILURE(test + ": port names");
+  }
+  if (desc->PortRangeHints[0].HintDescriptor !=
+      (LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE) ||
+      desc->PortRangeHints[0].LowerBound != -0.1f ||
+      desc->PortRangeHints[0].UpperBound != 24.0f) {
+    ECA_TEST_FAILURE(test + ": range hints");
+  }
+}
+
+void ECA_LADSPA_PLUGIN_CACHE_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for ECA_LADSPA_PLUGIN_CACHE class\n",
+	       __FILE__);
+
+  char libname[] = "/tmp/eca-ladspa-cache-test-XXXXXX";
+  int fd = mkstemp(libname);
+  if (fd < 0) {
+    ECA_TEST_FAILURE("mkstemp");
+    return;
+  }
+  if (write(fd, "not a library", 13) != 13) {
+    ECA_TEST_FAILURE("write");
+  }
+  close(fd);
+
+  struct stat statbuf;
+  stat(libname, &statbuf);
+
+  string cachename = string(libname) + ".cache";
+  string cachename2 = string(libname) + ".cache2";
+
+  /* hint bounds -0.1 and 24.0 as raw float bits */
+  FILE* f = std::fopen(cachename.c_str(), "w");
+  std::fprintf(f,
+	       "ecasound-ladspa-plugin-cache 1\n"
+	       "file\t%s\t%lld\t%lld\n"
+	       "plugin\t0\t1234\t%d\ttestamp\tTest Amplifier\tMaker\\\\Name\tNone\n"
+	       "port\t%d\t%d\tbdcccccd\t41c00000\tGain\\t(dB)\n"
+	       "port\t%d\t0\t00000000\t00000000\tInput\n",
+	       libname,
+	       static_cast<long long int>(statbuf.st_mtime),
+	       static_cast<long long int>(statbuf.st_size),
+	       LADSPA_PROPERTY_HARD_RT_CAPABLE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO);
+  std::fclose(f);
+
+  /* case: unchanged file is served from the index */
+  ECA_LADSPA_PLUGIN_CACHE cache;
+  if (cache.load(cachename) != true) {
+    ECA_TEST_FAILURE("load");
+  }
+  vector<const LADSPA_Descriptor*> descs = cache.descriptors(libname);
+  if (descs.size() != 1) {
+    ECA_TEST_FAILURE("descriptors " + kvu_numtostr(descs.size()));
+  }
+  else {
+    check_descriptor(descs[0], "load");
+  }
+  if (cache.is_modified() != false) {
+    ECA_TEST_FAILURE("modified after lookup");
+  }
+
+  /* case: save and reload */
+  if (cache.save(cachename2) != true) {
+    ECA_TEST_FAILURE("save");
+  }
+  ECA_LADSPA_PLUGIN_CACHE cache2;
+  if (cache2.load(cachename2) != true) {
+    ECA_TEST_FAILURE("reload");
+  }
+  descs = cache2.descriptors(libname);
+  if (descs.size() != 1) {
+    ECA_TEST_FAILURE("reload descriptors " + kvu_numtostr(descs.size()));
+  }
+  else {
+    check_descriptor(descs[0], "reload");
+
+    /* case: plugin can not be loaded from a non-library */
+    if (ECA_LADSPA_PLUGIN_CACHE::resolve(descs[0]) != 0) {
+      ECA_TEST_FAILURE("resolve");
+    }
+    EFFECT_LADSPA plugin (descs[0]);
+    if (plugin.load() != false) {
+      ECA_TEST_FAILURE("plugin load");
+    }
+  }
+
+  /* case: modified file is reindexed */
+  f = std::fopen(libname, "a");
+  std::fprintf(f, "!");
+  std::fclose(f);
+  descs = cache2.descriptors(libname);
+  if (descs.size() != 0 || cache2.is_modified() != true) {
+    ECA_TEST_FAILURE("invalidation");
+  }
+
+  /* case: unknown format */
+  f = std::fopen(cachename2.c_str(), "w");
+  std::fprintf(f, "ecasound-ladspa-plugin-cache 0\n");
+  std::fclose(f);
+  ECA_LADSPA_PLUGIN_CACHE cache3;
+  if (cache3.load(cachename2) != false) {
+    ECA_TEST_FAILURE("unknown format");
+  }
+
+  std::remove(cachename.c_str());
+  std::remove(cachename2.c_str());
+  std::remove(libname);
+}
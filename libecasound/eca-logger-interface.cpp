@@ -47,6 +47,7 @@ const static int eca_l_i_default_extlog_level = ECA_LOGGER::errors | ECA_LOGGER:
  */
 ECA_LOGGER_INTERFACE::ECA_LOGGER_INTERFACE(void) 
   : debug_value_rep(0),
+    capture_mask_rep(0),
     log_history_len_rep(eca_l_i_default_log_history_len),
     extlog_debug_level_rep(eca_l_i_default_extlog_level),
     extlog_file_repp(0)
@@ -73,6 +74,8 @@ ECA_LOGGER_INTERFACE::ECA_LOGGER_INTERFACE(void)
 		<< extlog_dest << "\". Check ECASOUND_LOGFILE and file permissions. ***\n";
     }
   }
+
+  update_capture_mask();
 }
 
 /**
@@ -132,6 +135,7 @@ void ECA_LOGGER_INTERFACE::msg(ECA_LOGGER::Msg_level_t level, const std::string&
 	std::cerr << "*** ERROR: Error in writing to ECASOUND_LOGFILE. Check free disk space. ***\n";
 	fclose(extlog_file_repp);
 	extlog_file_repp = 0;
+	update_capture_mask();
       }
       fflush(extlog_file_repp);
     }
@@ -149,6 +153,7 @@ void ECA_LOGGER_INTERFACE::set_log_level(ECA_LOGGER::Msg_level_t level, bool ena
   else {
     debug_value_rep &= ~level;
   }
+  update_capture_mask();
 }
 
 /**
@@ -168,6 +173,7 @@ void ECA_LOGGER_INTERFACE::flush(void)
 void ECA_LOGGER_INTERFACE::disable(void)
 {
   debug_value_rep = 0;
+  update_capture_mask();
 }
 
 /**
@@ -176,6 +182,28 @@ void ECA_LOGGER_INTERFACE::disable(void)
 void ECA_LOGGER_INTERFACE::set_log_history_length(int len)
 {
   log_history_len_rep = len;
+  update_capture_mask();
+}
+
+/**
+ * Updates the set of log levels for which messages are
+ * needed besides the current log level. All messages
+ * are stored to the log history, and messages matching
+ * the external logfile level are written to the logfile.
+ */
+void ECA_LOGGER_INTERFACE::update_capture_mask(void)
+{
+  int mask = 0;
+
+  if (log_history_len_rep > 0) {
+    mask |= ~ECA_LOGGER::eiam_return_values;
+  }
+
+  if (extlog_file_repp != 0) {
+    mask |= (extlog_debug_level_rep > 0 ? extlog_debug_level_rep : debug_value_rep);
+  }
+
+  capture_mask_rep = mask;
 }
 
 /**
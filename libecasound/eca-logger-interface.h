@@ -55,13 +55,24 @@ class ECA_LOGGER_INTERFACE {
   /**
    * Sets state of all logging types according to 'bitmask'.
    */
-  void set_log_level_bitmask(int level_bitmask) { debug_value_rep = static_cast<ECA_LOGGER::Msg_level_t>(level_bitmask); }
+  void set_log_level_bitmask(int level_bitmask) { debug_value_rep = static_cast<ECA_LOGGER::Msg_level_t>(level_bitmask); update_capture_mask(); }
  
   /**
    * Whether 'level' is set or not?
    */
   bool is_log_level_set(ECA_LOGGER::Msg_level_t level) const { return (level & debug_value_rep) > 0 ? true : false; }
 
+  /**
+   * Whether messages of 'level' are needed for output, 
+   * log history or the external logfile? If not, the
+   * message does not need to be built at all.
+   *
+   * The configured log level is checked first; levels
+   * captured only for the log history or the logfile
+   * are checked separately.
+   */
+  bool is_msg_wanted(ECA_LOGGER::Msg_level_t level) const { return (level & debug_value_rep) != 0 || (level & capture_mask_rep) != 0; }
+
   protected:
 
   virtual void do_msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message) = 0;
@@ -73,7 +84,10 @@ class ECA_LOGGER_INTERFACE {
 
   private:
 
+  void update_capture_mask(void);
+
   int debug_value_rep;
+  int capture_mask_rep;
   int log_history_len_rep;
   std::list<std::string> log_history_rep;
 
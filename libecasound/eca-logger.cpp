@@ -17,8 +17,23 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include <pthread.h>
+#include <semaphore.h>
+
 #include <kvu_dbc.h>
 #include <kvu_locks.h>
+#include <kvu_mpsc_queue.h>
 
 #include "eca-logger-interface.h"
 #include "eca-logger-default.h"
@@ -26,6 +41,60 @@
 
 ECA_LOGGER_INTERFACE* ECA_LOGGER::interface_impl_repp = 0;
 pthread_mutex_t ECA_LOGGER::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+volatile int ECA_LOGGER::rt_users_rep = 0;
+
+static const int eca_logger_rt_max_args = 6;
+static const int eca_logger_rt_strings_len = 96;
+static const size_t eca_logger_rt_ring_len = 256;
+static const int eca_logger_rt_max_rings = 32;
+
+/**
+ * A log message issued with rt_msg(), stored as the 
+ * unformatted format string and argument values.
+ * String arguments are copied to 'strings'.
+ */
+struct eca_logger_rt_record {
+  ECA_LOGGER::Msg_level_t level;
+  const char* module_name;
+  const char* format;
+  union {
+    long int i;
+    unsigned long int u;
+    double d;
+    int offset;
+  } args[eca_logger_rt_max_args];
+  char strings[eca_logger_rt_strings_len];
+};
+
+/**
+ * A parsed printf conversion specification.
+ */
+struct eca_logger_rt_spec {
+  const char* begin;
+  const char* end;
+  const char* conversion;
+  bool is_long;
+};
+
+/**
+ * Ring of records issued by one thread. A thread claims
+ * a free ring when it first calls rt_msg(), and releases
+ * it when the thread exits.
+ */
+struct eca_logger_rt_ring {
+  volatile int owned;
+  MPSC_QUEUE_RT_C<eca_logger_rt_record>* queue_repp;
+};
+
+static eca_logger_rt_ring eca_logger_rt_rings_rep[eca_logger_rt_max_rings];
+static bool eca_logger_rt_rings_ready_rep = false;
+static pthread_key_t eca_logger_rt_ring_key_rep;
+static sem_t eca_logger_rt_sem_rep;
+static volatile int eca_logger_rt_dropped_rep = 0;
+static volatile int eca_logger_rt_exit_rep = 0;
+static pthread_t eca_logger_rt_thread_rep;
+static pthread_mutex_t eca_logger_rt_flush_lock_rep = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t eca_logger_rt_mode_lock_rep = PTHREAD_MUTEX_INITIALIZER;
 
 static const char *level_descs[] = {
   "ERROR   ", /* 0 */
@@ -80,6 +149,9 @@ void ECA_LOGGER::attach_logger(ECA_LOGGER_INTERFACE* logger)
 void ECA_LOGGER::detach_logger(void)
 {
   if (ECA_LOGGER::interface_impl_repp != 0) {
+    /* note: do not delete the logger while queued 
+     *       real-time messages are being emitted */
+    KVU_GUARD_LOCK flushguard(&eca_logger_rt_flush_lock_rep);
     KVU_GUARD_LOCK guard(&ECA_LOGGER::lock_rep);
     if (ECA_LOGGER::interface_impl_repp != 0) {
       delete ECA_LOGGER::interface_impl_repp;
@@ -105,3 +177,308 @@ const char* ECA_LOGGER::level_to_string(ECA_LOGGER::Msg_level_t arg)
     default: return level_descs[9];
   }
 }
+
+/**
+ * Parses the conversion specification starting at 'p', 
+ * which points to a '%' character.
+ *
+ * @return false if the conversion is not supported
+ */
+static bool eca_logger_rt_parse_spec(const char* p, eca_logger_rt_spec* spec)
+{
+  spec->begin = p++;
+  while (*p != 0 && std::strchr("-+ #0", *p) != 0) ++p;
+  while (*p >= '0' && *p <= '9') ++p;
+  if (*p == '.') {
+    ++p;
+    while (*p >= '0' && *p <= '9') ++p;
+  }
+  spec->is_long = false;
+  if (*p == 'l') {
+    spec->is_long = true;
+    ++p;
+  }
+  if (*p == 0 || std::strchr("diuxXocfeEgGs%", *p) == 0)
+    return false;
+
+  spec->conversion = p;
+  spec->end = p + 1;
+  return true;
+}
+
+/**
+ * Stores the arguments of 'format' to 'record'.
+ *
+ * Execution note: rt-safe
+ */
+static void eca_logger_rt_store_args(eca_logger_rt_record* record, va_list ap)
+{
+  eca_logger_rt_spec spec;
+  int argc = 0, stroffset = 0;
+
+  for(const char* p = record->format; *p != 0; p++) {
+    if (*p != '%') continue;
+    if (argc == eca_logger_rt_max_args ||
+	eca_logger_rt_parse_spec(p, &spec) != true) break;
+    p = spec.conversion;
+
+    switch(*p) 
+      {
+      case '%':
+	break;
+
+      case 'd':
+      case 'i':
+      case 'c':
+	record->args[argc++].i = (spec.is_long == true ? va_arg(ap, long int) : va_arg(ap, int));
+	break;
+
+      case 's': {
+	const char* str = va_arg(ap, const char*);
+	if (str == 0) str = "(null)";
+	size_t len = std::strlen(str);
+	if (len > static_cast<size_t>(eca_logger_rt_strings_len - stroffset - 1))
+	  len = eca_logger_rt_strings_len - stroffset - 1;
+	std::memcpy(&record->strings[stroffset], str, len);
+	record->strings[stroffset + len] = 0;
+	record->args[argc++].offset = stroffset;
+	stroffset += len;
+	if (stroffset < eca_logger_rt_strings_len - 1) ++stroffset;
+	break;
+      }
+
+      case 'f':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+	record->args[argc++].d = va_arg(ap, double);
+	break;
+
+      default:
+	record->args[argc++].u = (spec.is_long == true ? va_arg(ap, unsigned long int) : va_arg(ap, unsigned int));
+	break;
+      }
+  }
+}
+
+/**
+ * Formats 'record' into a log message.
+ */
+static std::string eca_logger_rt_format(const eca_logger_rt_record& record)
+{
+  std::string result;
+  eca_logger_rt_spec spec;
+  char buf[128];
+  int argc = 0;
+  const char* p = record.format;
+
+  while(*p != 0) {
+    const char* next = std::strchr(p, '%');
+    if (next == 0) {
+      result += p;
+      break;
+    }
+    result.append(p, next - p);
+    if (argc == eca_logger_rt_max_args ||
+	eca_logger_rt_parse_spec(next, &spec) != true) {
+      /* note: unsupported conversions are printed as is */
+      result += next;
+      break;
+    }
+    p = spec.end;
+
+    if (*spec.conversion == '%') {
+      result += '%';
+      continue;
+    }
+
+    /* note: rebuild the specification so that integer
+     *       arguments are always passed as longs */
+    std::string fmt (spec.begin, spec.conversion - spec.begin - (spec.is_long == true ? 1 : 0));
+    switch(*spec.conversion) 
+      {
+      case 'd':
+      case 'i':
+	fmt += std::string("l") + *spec.conversion;
+	std::snprintf(buf, sizeof(buf), fmt.c_str(), record.args[argc].i);
+	break;
+
+      case 'c':
+	fmt += 'c';
+	std::snprintf(buf, sizeof(buf), fmt.c_str(), static_cast<int>(record.args[argc].i));
+	break;
+
+      case 's':
+	fmt += 's';
+	std::snprintf(buf, sizeof(buf), fmt.c_str(), &record.strings[record.args[argc].offset]);
+	break;
+
+      case 'f':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+	fmt += *spec.conversion;
+	std::snprintf(buf, sizeof(buf), fmt.c_str(), record.args[argc].d);
+	break;
+
+      default:
+	fmt += std::string("l") + *spec.conversion;
+	std::snprintf(buf, sizeof(buf), fmt.c_str(), record.args[argc].u);
+	break;
+      }
+    result += buf;
+    ++argc;
+  }
+
+  return result;
+}
+
+/**
+ * Releases the ring of an exiting thread. Records left
+ * in the ring are still emitted by flush_rt_messages().
+ */
+static void eca_logger_rt_release_ring(void* arg)
+{
+  eca_logger_rt_ring* ring = static_cast<eca_logger_rt_ring*>(arg);
+  __sync_synchronize();
+  ring->owned = 0;
+}
+
+/**
+ * Returns the ring of the calling thread, claiming a free
+ * ring on first use. Returns 0 if all rings are in use.
+ *
+ * Execution note: rt-safe
+ */
+static eca_logger_rt_ring* eca_logger_rt_thread_ring(void)
+{
+  eca_logger_rt_ring* ring =
+    static_cast<eca_logger_rt_ring*>(pthread_getspecific(eca_logger_rt_ring_key_rep));
+  if (ring != 0)
+    return ring;
+
+  for(int n = 0; n < eca_logger_rt_max_rings; n++) {
+    if (__sync_bool_compare_and_swap(&eca_logger_rt_rings_rep[n].owned, 0, 1) == true) {
+      ring = &eca_logger_rt_rings_rep[n];
+      /* note: the key is created first, so its value is
+       *       stored in the thread's static key block */
+      pthread_setspecific(eca_logger_rt_ring_key_rep, ring);
+      return ring;
+    }
+  }
+  return 0;
+}
+
+void ECA_LOGGER::rt_msg(Msg_level_t level, const char* module_name, const char* format, ...)
+{
+  eca_logger_rt_record record;
+  record.level = level;
+  record.module_name = module_name;
+  record.format = format;
+
+  va_list ap;
+  va_start(ap, format);
+  eca_logger_rt_store_args(&record, ap);
+  va_end(ap);
+
+  if (ECA_LOGGER::rt_users_rep > 0) {
+    eca_logger_rt_ring* ring = eca_logger_rt_thread_ring();
+    if (ring == 0 || ring->queue_repp->push(record) != true) {
+      __sync_fetch_and_add(&eca_logger_rt_dropped_rep, 1);
+    }
+    else {
+      sem_post(&eca_logger_rt_sem_rep);
+    }
+  }
+  else {
+    ECA_LOGGER::instance().msg(level, module_name, eca_logger_rt_format(record));
+  }
+}
+
+void ECA_LOGGER::flush_rt_messages(void)
+{
+  if (eca_logger_rt_rings_ready_rep != true)
+    return;
+
+  KVU_GUARD_LOCK guard(&eca_logger_rt_flush_lock_rep);
+
+  /* note: messages from one thread are emitted in order,
+   *       but messages from different threads may not be */
+  eca_logger_rt_record record;
+  for(int n = 0; n < eca_logger_rt_max_rings; n++) {
+    while(eca_logger_rt_rings_rep[n].queue_repp->pop(&record) == true) {
+      ECA_LOGGER::instance().msg(record.level,
+				 record.module_name,
+				 eca_logger_rt_format(record));
+    }
+  }
+
+  int dropped = __sync_fetch_and_and(&eca_logger_rt_dropped_rep, 0);
+  if (dropped > 0) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "WARNING: %d real-time log messages dropped", dropped);
+    ECA_LOGGER::instance().msg(ECA_LOGGER::info, __FILE__, buf);
+  }
+}
+
+/**
+ * Emits queued messages whenever rt_msg() signals
+ * that new records are available.
+ */
+void* ECA_LOGGER::rt_thread(void* arg)
+{
+  while(eca_logger_rt_exit_rep == 0) {
+    if (sem_wait(&eca_logger_rt_sem_rep) != 0 && errno == EINTR)
+      continue;
+    ECA_LOGGER::flush_rt_messages();
+  }
+  return 0;
+}
+
+void ECA_LOGGER::enable_rt_mode(void)
+{
+  KVU_GUARD_LOCK guard(&eca_logger_rt_mode_lock_rep);
+
+  if (ECA_LOGGER::rt_users_rep == 0) {
+    if (eca_logger_rt_rings_ready_rep != true) {
+      /* note: the rings are never freed, as rt_msg() may
+       *       still be running in other threads when the
+       *       mode is disabled */
+      if (pthread_key_create(&eca_logger_rt_ring_key_rep, eca_logger_rt_release_ring) != 0 ||
+	  sem_init(&eca_logger_rt_sem_rep, 0, 0) != 0) {
+	return;
+      }
+      for(int n = 0; n < eca_logger_rt_max_rings; n++) {
+	eca_logger_rt_rings_rep[n].owned = 0;
+	eca_logger_rt_rings_rep[n].queue_repp =
+	  new MPSC_QUEUE_RT_C<eca_logger_rt_record> (eca_logger_rt_ring_len);
+      }
+      eca_logger_rt_rings_ready_rep = true;
+    }
+    eca_logger_rt_exit_rep = 0;
+    if (pthread_create(&eca_logger_rt_thread_rep, 0, ECA_LOGGER::rt_thread, 0) != 0) {
+      /* note: messages are formatted immediately instead */
+      return;
+    }
+    __sync_synchronize();
+  }
+  ++ECA_LOGGER::rt_users_rep;
+}
+
+void ECA_LOGGER::disable_rt_mode(void)
+{
+  KVU_GUARD_LOCK guard(&eca_logger_rt_mode_lock_rep);
+
+  if (ECA_LOGGER::rt_users_rep == 1) {
+    ECA_LOGGER::rt_users_rep = 0;
+    eca_logger_rt_exit_rep = 1;
+    sem_post(&eca_logger_rt_sem_rep);
+    pthread_join(eca_logger_rt_thread_rep, 0);
+    ECA_LOGGER::flush_rt_messages();
+  }
+  else if (ECA_LOGGER::rt_users_rep > 1) {
+    --ECA_LOGGER::rt_users_rep;
+  }
+}
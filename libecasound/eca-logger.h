@@ -96,8 +96,67 @@ class ECA_LOGGER {
    */
   static const char* level_to_string(Msg_level_t arg);
 
+  /**
+   * Issues a log message from a real-time context. 
+   *
+   * Unlike msg(), the message is not built by the
+   * caller. Instead 'format' and the arguments are 
+   * stored as a fixed-size record to a lock-free ring
+   * owned by the calling thread, and formatted later by
+   * a background thread that is woken up for each
+   * record. Only simple printf-style conversions are
+   * supported (d, i, u, x, X, o, c, f, e, g, s and the
+   * 'l' modifier), with at most six arguments. String
+   * arguments are copied, and 'format' and 'module_name' 
+   * must be static strings.
+   *
+   * If real-time mode is not enabled, the message 
+   * is formatted and issued immediately. If the ring
+   * is full, or all rings are owned by other threads,
+   * the message is dropped and counted.
+   *
+   * Execution note: rt-safe when real-time mode is
+   *                 enabled
+   *
+   * @see ECA_LOG_MSG_RT()
+   */
+  static void rt_msg(Msg_level_t level, const char* module_name, const char* format, ...)
+#ifdef __GNUC__
+    __attribute__ ((format (printf, 3, 4)))
+#endif
+    ;
+
+  /**
+   * Enables real-time logging mode and starts the 
+   * background thread that emits queued messages. 
+   * Calls are reference counted, so each call must
+   * be matched with a call to disable_rt_mode().
+   */
+  static void enable_rt_mode(void);
+
+  /**
+   * Disables real-time logging mode. When the last user
+   * disables the mode, the background thread is stopped 
+   * and all queued messages are emitted.
+   */
+  static void disable_rt_mode(void);
+
+  /**
+   * Whether real-time logging mode is enabled?
+   */
+  static bool is_rt_mode_enabled(void) { return rt_users_rep > 0; }
+
+  /**
+   * Emits all messages queued with rt_msg().
+   */
+  static void flush_rt_messages(void);
+
   private:
 
+  static void* rt_thread(void* arg);
+
+  static volatile int rt_users_rep;
+
   static ECA_LOGGER_INTERFACE* interface_impl_repp;
   static pthread_mutex_t lock_rep;
 
@@ -122,20 +181,36 @@ class ECA_LOGGER {
  */
 
 /**
- * Issues a log message.
+ * Issues a log message. The message 'y' is only evaluated
+ * if the logger is interested in messages of level 'x'.
  *
  * @param x log level, type 'ECA_LOGGER::Msg_level_t'
  * @param y log message, type 'const std:string&'
  */
 #define ECA_LOG_MSG(x,y) \
-        do { ECA_LOGGER::instance().msg(x, __FILE__, y); } while(0)
+        do { ECA_LOGGER_INTERFACE& eca_logger_ref = ECA_LOGGER::instance(); \
+             if (eca_logger_ref.is_msg_wanted(x)) \
+               eca_logger_ref.msg(x, __FILE__, y); } while(0)
 
 /**
  * Issue a log message, but do not print out the module prefix.
  * A variant of ECA_LOG_MSG().
  */
 #define ECA_LOG_MSG_NOPREFIX(x,y) \
-        do { ECA_LOGGER::instance().msg(x, std::string(), y); } while(0)
+        do { ECA_LOGGER_INTERFACE& eca_logger_ref = ECA_LOGGER::instance(); \
+             if (eca_logger_ref.is_msg_wanted(x)) \
+               eca_logger_ref.msg(x, std::string(), y); } while(0)
+
+/**
+ * Issues a log message from a real-time context. The
+ * arguments are a printf-style format string followed by
+ * at most six arguments.
+ *
+ * @see ECA_LOGGER::rt_msg()
+ */
+#define ECA_LOG_MSG_RT(x,...) \
+        do { if (ECA_LOGGER::instance().is_msg_wanted(x)) \
+               ECA_LOGGER::rt_msg(x, __FILE__, __VA_ARGS__); } while(0)
 
 /**
  * To make ECA_LOG_MSG work we need to include the 
@@ -0,0 +1,179 @@
+// ------------------------------------------------------------------------
+// eca-logger_test.h: Unit test for ECA_LOGGER
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <list>
+#include <string>
+#include <cstdio>
+
+#include <pthread.h>
+
+#include "kvu_numtostr.h"
+
+#include "eca-logger.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_LOGGER
+ */
+class ECA_LOGGER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_LOGGER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_LOGGER_TEST(void) { }
+
+private:
+
+  int evaluations_rep;
+
+  string evaluate(void) { ++evaluations_rep; return "evaluated"; }
+  static void* rt_thread(void* arg);
+  void check_last(const string& expected, const string& test);
+
+};
+
+void ECA_LOGGER_TEST::check_last(const string& expected, const string& test)
+{
+  const list<string>& history = ECA_LOGGER::instance().log_history();
+  if (history.size() == 0) {
+    ECA_TEST_FAILURE(test + ": empty history");
+    return;
+  }
+  string msg = history.back();
+  size_t pos = msg.find(") ");
+  if (pos == string::npos || msg.substr(pos + 2) != expected) {
+    ECA_TEST_FAILURE(test + ": got \"" + msg + "\", expected \"" + expected + "\"");
+  }
+}
+
+void* ECA_LOGGER_TEST::rt_thread(void* arg)
+{
+  int id = *static_cast<int*>(arg);
+  ECA_LOG_MSG_RT(ECA_LOGGER::functions, "thread %d, message 1", id);
+  ECA_LOG_MSG_RT(ECA_LOGGER::functions, "thread %d, message 2", id);
+  return 0;
+}
+
+void ECA_LOGGER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for ECA_LOGGER class\n",
+	       __FILE__);
+
+  ECA_LOGGER_INTERFACE& logger = ECA_LOGGER::instance();
+
+  /* case: message is not built for unwanted levels */
+  evaluations_rep = 0;
+  logger.set_log_history_length(0);
+  if (logger.is_msg_wanted(ECA_LOGGER::functions) != true) {
+    ECA_LOG_MSG(ECA_LOGGER::functions, evaluate());
+    if (evaluations_rep != 0) {
+      ECA_TEST_FAILURE("unwanted message evaluated");
+    }
+  }
+
+  /* case: all messages are wanted for the log history */
+  logger.set_log_history_length(16);
+  if (logger.is_msg_wanted(ECA_LOGGER::functions) != true) {
+    ECA_TEST_FAILURE("history mask");
+  }
+  ECA_LOG_MSG(ECA_LOGGER::functions, evaluate());
+  if (evaluations_rep != 1) {
+    ECA_TEST_FAILURE("wanted message not evaluated");
+  }
+  check_last("evaluated", "ECA_LOG_MSG");
+
+  /* case: formatting, when real-time mode is not enabled */
+  if (ECA_LOGGER::is_rt_mode_enabled() != true) {
+    ECA_LOG_MSG_RT(ECA_LOGGER::functions, "%d/%ld %s [%5.2f] %lu%% %x",
+		   -1, 2L, "three", 4.0, 5UL, 255);
+    check_last("-1/2 three [ 4.00] 5% ff", "immediate format");
+
+    ECA_LOG_MSG_RT(ECA_LOGGER::functions, "%c%c%c%c%c%c%c", 'a', 'b', 'c', 'd', 'e', 'f', 'g');
+    check_last("abcdef%c", "too many arguments");
+
+    ECA_LOG_MSG_RT(ECA_LOGGER::functions, "%s %*d", "width", 3, 1);
+    check_last("width %*d", "unsupported conversion");
+  }
+
+  /* case: queued messages are emitted in order */
+  ECA_LOGGER::enable_rt_mode();
+  if (ECA_LOGGER::is_rt_mode_enabled() != true) {
+    ECA_TEST_FAILURE("enable_rt_mode");
+  }
+  string longstr (200, 'x');
+  for(int n = 0; n < 8; n++) {
+    ECA_LOG_MSG_RT(ECA_LOGGER::functions, "rt %d %s %g", n, longstr.c_str(), 0.5);
+  }
+  ECA_LOG_MSG_RT(ECA_LOGGER::functions, "%s-%s-%d", "a", "b", 9);
+  ECA_LOGGER::disable_rt_mode();
+
+  const list<string>& history = logger.log_history();
+  list<string>::const_reverse_iterator p = history.rbegin();
+  check_last("a-b-9", "queued message");
+  for(int n = 7; n >= 0 && ++p != history.rend(); n--) {
+    /* note: string arguments are truncated to the record size */
+    string expected = "rt " + kvu_numtostr(n) + " " + string(95, 'x') + " 0.5";
+    if (p->find(expected) == string::npos) {
+      ECA_TEST_FAILURE("queued message " + kvu_numtostr(n) + ": " + *p);
+    }
+  }
+
+  /* case: each thread logs to a ring of its own, and the
+   *       ring is released when the thread exits */
+  const int threads = 40;
+  logger.set_log_history_length(threads * 2);
+  ECA_LOGGER::enable_rt_mode();
+  for(int n = 0; n < threads; n++) {
+    pthread_t thread;
+    if (pthread_create(&thread, 0, ECA_LOGGER_TEST::rt_thread, &n) != 0) {
+      ECA_TEST_FAILURE("pthread_create");
+      break;
+    }
+    pthread_join(thread, 0);
+  }
+  ECA_LOGGER::disable_rt_mode();
+
+  int found = 0;
+  for(p = history.rbegin(); p != history.rend(); p++) {
+    size_t pos = p->find("thread ");
+    if (pos == string::npos)
+      continue;
+    string expected = p->substr(pos, p->find(',', pos) - pos) + ", message 1";
+    list<string>::const_reverse_iterator next = p;
+    if (p->find("message 2") == string::npos ||
+	++next == history.rend() ||
+	next->find(expected) == string::npos) {
+      ECA_TEST_FAILURE("thread message order: " + *p);
+      break;
+    }
+    ++found;
+    p = next;
+  }
+  if (found != threads) {
+    ECA_TEST_FAILURE("thread messages, " + kvu_numtostr(found) + " found");
+  }
+
+  logger.set_log_history_length(0);
+}
@@ -450,6 +450,17 @@ CHAIN_OPERATOR* ECA_OBJECT_FACTORY::create_ladspa_plugin (const string& argu)
     if (cop != 0) {
       new_cop = dynamic_cast<CHAIN_OPERATOR*>(cop->new_expr());
 
+      /* plugins created from the plugin cache are loaded here,
+       * so that a missing or broken plugin file is reported
+       * when the plugin is added, not when it is run */
+      EFFECT_LADSPA* ladspa = dynamic_cast<EFFECT_LADSPA*>(new_cop);
+      if (ladspa != 0 && ladspa->load() != true) {
+	ECA_LOG_MSG(ECA_LOGGER::errors,
+		    "ERROR: Unable to load LADSPA plugin \"" + unique + "\"");
+	delete new_cop;
+	return 0;
+      }
+
       ECA_LOG_MSG(ECA_LOGGER::user_objects, 
 		  "Creating LADSPA-plugin \"" + new_cop->name() + "\"");
 
@@ -1,6 +1,6 @@
 // ------------------------------------------------------------------------
 // eca-object-map: A virtual base for dynamic object maps 
-// Copyright (C) 2000-2004,2009 Kai Vehmanen
+// Copyright (C) 2000-2004,2009,2026 Kai Vehmanen
 //
 // Attributes:
 //     eca-style-version: 3
@@ -21,9 +21,12 @@
 // ------------------------------------------------------------------------
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <list>
 #include <string>
 #include <map>
+#include <set>
 #include <sys/types.h>
 #include <regex.h>
 
@@ -32,9 +35,19 @@
 
 using std::find;
 using std::map;
+using std::set;
 using std::string;
 using std::list;
 
+/**
+ * Compiled form of a registered expression.
+ */
+struct eca_object_map_regex {
+  regex_t preg;
+};
+
+static bool eca_object_map_parse_literal(const string& expr, string* literal);
+
 ECA_OBJECT_MAP::ECA_OBJECT_MAP(void)
   : expr_case_sensitive_rep(false)
 {
@@ -42,6 +55,13 @@ ECA_OBJECT_MAP::ECA_OBJECT_MAP(void)
 
 ECA_OBJECT_MAP::~ECA_OBJECT_MAP(void)
 { 
+  map<string, struct eca_object_map_regex*>::iterator r = expr_regex_rep.begin();
+  while(r != expr_regex_rep.end()) {
+    regfree(&r->second->preg);
+    delete r->second;
+    ++r;
+  }
+
   map<string, ECA_OBJECT*>::iterator p = object_map.begin();
   while(p != object_map.end()) {
     if (p->second != 0) {
@@ -66,7 +86,10 @@ ECA_OBJECT_MAP::~ECA_OBJECT_MAP(void)
 
 void ECA_OBJECT_MAP::toggle_case_sensitive_expressions(bool v)
 {
-  expr_case_sensitive_rep = v;
+  if (v != expr_case_sensitive_rep) {
+    expr_case_sensitive_rep = v;
+    rebuild_expr_index();
+  }
 }
 
 bool ECA_OBJECT_MAP::case_sensitive_expressions(void) const
@@ -87,10 +110,14 @@ bool ECA_OBJECT_MAP::case_sensitive_expressions(void) const
  */
 void ECA_OBJECT_MAP::register_object(const string& keyword, const string& expr, ECA_OBJECT* object)
 {
+  remove_expr_index(keyword);
+
   object_keywords_rep.push_back(keyword);
   object_map[keyword] = object;
   object_expr_map[keyword] = expr;
 
+  add_expr_index(keyword, expr);
+
   if (expr_to_keyword(keyword) != keyword &&
       object != 0) {
     ECA_LOG_MSG(ECA_LOGGER::info, 
@@ -108,9 +135,13 @@ void ECA_OBJECT_MAP::register_object(const string& keyword, const string& expr,
  */
 void ECA_OBJECT_MAP::unregister_object(const string& keyword)
 {
+  remove_expr_index(keyword);
+
   object_keywords_rep.remove(keyword);
   object_map[keyword] = 0;
   object_expr_map[keyword] = "";
+
+  add_expr_index(keyword, "");
 }
 
 /**
@@ -172,28 +203,43 @@ const ECA_OBJECT* ECA_OBJECT_MAP::object_expr(const string& input) const
  * 
  * If 'case_sensitive_expressions() != true', the pattern 
  * matching will be case insensitive.
+ *
+ * If several expressions match, the one registered with
+ * the alphabetically first keyword is selected. A literal
+ * match is found with one index lookup, so only regular
+ * expressions with a preceding keyword need to be executed.
  */
 string ECA_OBJECT_MAP::expr_to_keyword(const string& input) const
 {
-  map<string,string>::const_iterator p = object_expr_map.begin();
-  regex_t preg;
   string result;
-  while(p != object_expr_map.end()) {
-    int cflags = REG_EXTENDED | REG_NOSUB;
-    
-    if (case_sensitive_expressions() != true)
-      cflags |= REG_ICASE;
-
-    regcomp(&preg, p->second.c_str(), cflags);
-    if (regexec(&preg, input.c_str(), 0, 0, 0) == 0) {
-      ECA_LOG_MSG(ECA_LOGGER::functions, "match (1): " + input + " to regexp " + p->second);
+  bool literal_match = false;
+
+  map<string, set<string> >::const_iterator l = 
+    expr_literals_rep.find(literal_index_key(input));
+  if (l != expr_literals_rep.end()) {
+    result = *l->second.begin();
+    literal_match = true;
+  }
+
+  map<string, struct eca_object_map_regex*>::const_iterator p = expr_regex_rep.begin();
+  while(p != expr_regex_rep.end()) {
+    if (literal_match == true && p->first > result)
+      break;
+
+    if (regexec(&p->second->preg, input.c_str(), 0, 0, 0) == 0) {
       result = p->first;
-      regfree(&preg);
+      literal_match = false;
       break;
     }
-    regfree(&preg);
     ++p;
   }
+
+  if (result.size() > 0) {
+    ECA_LOG_MSG(ECA_LOGGER::functions, 
+		"match (1): " + input + " to regexp " + keyword_to_expr(result) +
+		(literal_match == true ? " (literal)" : ""));
+  }
+
   return result;
 }
 
@@ -222,3 +268,138 @@ string ECA_OBJECT_MAP::object_identifier(const ECA_OBJECT* object) const
   }
   return "";
 }
+
+/**
+ * Adds expression 'expr' of 'keyword' to the lookup index.
+ *
+ * Literal expressions are stored to 'expr_literals_rep',
+ * and all other expressions are compiled and stored to
+ * 'expr_regex_rep'.
+ */
+void ECA_OBJECT_MAP::add_expr_index(const string& keyword, const string& expr)
+{
+  string literal;
+  if (eca_object_map_parse_literal(expr, &literal) == true) {
+    bool ascii = true;
+    for(size_t n = 0; n < literal.size(); n++) {
+      if (static_cast<unsigned char>(literal[n]) > 127) ascii = false;
+    }
+
+    /* note: case-insensitive matching of non-ASCII 
+     *       characters is left to regexec() */
+    if (case_sensitive_expressions() == true || ascii == true) {
+      expr_literals_rep[literal_index_key(literal)].insert(keyword);
+      return;
+    }
+  }
+
+  int cflags = REG_EXTENDED | REG_NOSUB;
+  if (case_sensitive_expressions() != true)
+    cflags |= REG_ICASE;
+
+  struct eca_object_map_regex* regex = new struct eca_object_map_regex;
+  if (regcomp(&regex->preg, expr.c_str(), cflags) != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Invalid regex " + expr + 
+		" for keyword " + keyword + ".");
+    delete regex;
+    return;
+  }
+  expr_regex_rep[keyword] = regex;
+}
+
+/**
+ * Removes the current expression of 'keyword' from 
+ * the lookup index.
+ */
+void ECA_OBJECT_MAP::remove_expr_index(const string& keyword)
+{
+  map<string, struct eca_object_map_regex*>::iterator r = expr_regex_rep.find(keyword);
+  if (r != expr_regex_rep.end()) {
+    regfree(&r->second->preg);
+    delete r->second;
+    expr_regex_rep.erase(r);
+    return;
+  }
+
+  map<string,string>::const_iterator p = object_expr_map.find(keyword);
+  string literal;
+  if (p != object_expr_map.end() &&
+      eca_object_map_parse_literal(p->second, &literal) == true) {
+    map<string, set<string> >::iterator l = 
+      expr_literals_rep.find(literal_index_key(literal));
+    if (l != expr_literals_rep.end()) {
+      l->second.erase(keyword);
+      if (l->second.size() == 0)
+	expr_literals_rep.erase(l);
+    }
+  }
+}
+
+void ECA_OBJECT_MAP::rebuild_expr_index(void)
+{
+  map<string, struct eca_object_map_regex*>::iterator r = expr_regex_rep.begin();
+  while(r != expr_regex_rep.end()) {
+    regfree(&r->second->preg);
+    delete r->second;
+    ++r;
+  }
+  expr_regex_rep.clear();
+  expr_literals_rep.clear();
+
+  map<string,string>::const_iterator p = object_expr_map.begin();
+  while(p != object_expr_map.end()) {
+    add_expr_index(p->first, p->second);
+    ++p;
+  }
+}
+
+/**
+ * Returns the key used for 'str' in the literal index.
+ */
+string ECA_OBJECT_MAP::literal_index_key(const string& str) const
+{
+  if (case_sensitive_expressions() == true)
+    return str;
+
+  string result (str);
+  for(size_t n = 0; n < result.size(); n++)
+    result[n] = std::tolower(static_cast<unsigned char>(result[n]));
+  return result;
+}
+
+/**
+ * Checks whether 'expr' only matches one literal string,
+ * ie. it is of form "^text$", where 'text' contains no
+ * unescaped regex special characters. If so, the matched 
+ * string is stored to 'literal'.
+ */
+static bool eca_object_map_parse_literal(const string& expr, string* literal)
+{
+  if (expr.size() < 2 ||
+      expr[0] != '^' ||
+      expr[expr.size() - 1] != '$')
+    return false;
+
+  string result;
+  for(size_t n = 1; n < expr.size() - 1; n++) {
+    char c = expr[n];
+    if (c == '\\') {
+      ++n;
+      /* note: escapes such as '\w' are not literals */
+      if (n == expr.size() - 1 ||
+	  std::isalnum(static_cast<unsigned char>(expr[n])))
+	return false;
+      result += expr[n];
+    }
+    else if (std::strchr(".[]()*+?{}|^$", c) != 0) {
+      return false;
+    }
+    else {
+      result += c;
+    }
+  }
+
+  *literal = result;
+  return true;
+}
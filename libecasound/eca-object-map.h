@@ -4,9 +4,12 @@
 #include <string>
 #include <map>
 #include <list>
+#include <set>
 
 #include "eca-object.h"
 
+struct eca_object_map_regex;
+
 /**
  * A virtual base class representing generic object maps.
  *
@@ -20,6 +23,11 @@
  * object details. Object maps make it possible to 
  * hide these details completely, and in one place.
  *
+ * Expressions are compiled when objects are registered.
+ * Pure literal expressions of form "^keyword$" are 
+ * looked up from an index, so that only true regular
+ * expressions need to be matched one by one.
+ *
  * Related design patterns:
  *     - Prototype (GoF117)
  *     - Factory Method (GoF107)
@@ -79,9 +87,16 @@ class ECA_OBJECT_MAP {
   ECA_OBJECT_MAP(const ECA_OBJECT_MAP&);
   ECA_OBJECT_MAP& operator=(const ECA_OBJECT_MAP&);
 
+  void add_expr_index(const std::string& keyword, const std::string& expr);
+  void remove_expr_index(const std::string& keyword);
+  void rebuild_expr_index(void);
+  std::string literal_index_key(const std::string& str) const;
+
   std::list<std::string> object_keywords_rep;
   mutable std::map<std::string, ECA_OBJECT*> object_map;
   mutable std::map<std::string,std::string> object_expr_map;
+  std::map<std::string, struct eca_object_map_regex*> expr_regex_rep;
+  std::map<std::string, std::set<std::string> > expr_literals_rep;
 
   bool expr_case_sensitive_rep;
 };
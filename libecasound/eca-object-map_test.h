@@ -0,0 +1,102 @@
+// ------------------------------------------------------------------------
+// eca-object-map_test.h: Unit test for ECA_OBJECT_MAP
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <cstdio>
+
+#include "eca-object-map.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_OBJECT_MAP
+ */
+class ECA_OBJECT_MAP_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_OBJECT_MAP"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_OBJECT_MAP_TEST(void) { }
+
+private:
+
+  void check(const ECA_OBJECT_MAP& map, const string& input, const string& keyword);
+
+};
+
+void ECA_OBJECT_MAP_TEST::check(const ECA_OBJECT_MAP& map, const string& input, const string& keyword)
+{
+  string result = map.expr_to_keyword(input);
+  if (result != keyword) {
+    ECA_TEST_FAILURE("expr_to_keyword(\"" + input + "\") returned \"" +
+		     result + "\", expected \"" + keyword + "\"");
+  }
+}
+
+void ECA_OBJECT_MAP_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for ECA_OBJECT_MAP class\n",
+	       __FILE__);
+
+  ECA_OBJECT_MAP map;
+
+  /* note: objects are not needed for keyword lookups */
+  map.register_object("b-amp", "^ea$", 0);
+  map.register_object("c-wave", "wav$", 0);
+  map.register_object("d-dot", "^a\\.b$", 0);
+  map.register_object("a-any", "^e[a-c]$", 0);
+  map.register_object("e-word", "^\\w+x$", 0);
+
+  /* case: literal and regex matches, case insensitive */
+  check(map, "ea", "a-any");
+  check(map, "EB", "a-any");
+  check(map, "foo.WAV", "c-wave");
+  check(map, "a.b", "d-dot");
+  check(map, "axb", "");
+  check(map, "abcx", "e-word");
+  check(map, "", "");
+
+  /* case: the alphabetically first keyword wins */
+  map.register_object("z-lit", "^foo\\.wav$", 0);
+  check(map, "foo.wav", "c-wave");
+  map.register_object("0-lit", "^foo\\.wav$", 0);
+  check(map, "foo.wav", "0-lit");
+  check(map, "fooxwav", "c-wave");
+
+  /* case: re-registered keyword */
+  map.register_object("d-dot", "^a-b$", 0);
+  check(map, "a.b", "");
+  check(map, "a-b", "d-dot");
+
+  /* case: case sensitive matching */
+  ECA_OBJECT_MAP map2;
+  map2.toggle_case_sensitive_expressions(true);
+  map2.register_object("Amp", "^Amp$", 0);
+  map2.register_object("amp", "^amp$", 0);
+  check(map2, "Amp", "Amp");
+  check(map2, "amp", "amp");
+  check(map2, "AMP", "");
+  map2.toggle_case_sensitive_expressions(false);
+  check(map2, "AMP", "Amp");
+}
@@ -0,0 +1,135 @@
+// ------------------------------------------------------------------------
+// eca-profile-histogram.cpp: Histogram of processing times
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cmath>
+
+#include "eca-profile-histogram.h"
+
+ECA_PROFILE_HISTOGRAM::ECA_PROFILE_HISTOGRAM(void)
+{
+  reset();
+}
+
+/**
+ * Clears all recorded samples.
+ *
+ * Must not be called concurrently with record().
+ */
+void ECA_PROFILE_HISTOGRAM::reset(void)
+{
+  for(int n = 0; n < buckets_constant; n++)
+    buckets_rep[n] = 0;
+  count_rep = 0;
+  max_rep = 0;
+}
+
+/**
+ * Records one processing time sample.
+ *
+ * context: realtime-safe, single writer
+ */
+void ECA_PROFILE_HISTOGRAM::record(long long int nanoseconds)
+{
+  ++buckets_rep[bucket_index(nanoseconds)];
+  ++count_rep;
+  if (nanoseconds > max_rep)
+    max_rep = nanoseconds;
+}
+
+/**
+ * Returns the processing time, in seconds, that
+ * 'fraction' (0.0...1.0) of the recorded samples
+ * did not exceed. The value is the upper bound of
+ * the matching bucket. Returns 0.0 if no samples
+ * have been recorded.
+ */
+double ECA_PROFILE_HISTOGRAM::percentile(double fraction) const
+{
+  long int total = count_rep;
+  if (total <= 0)
+    return 0.0;
+
+  long int target = static_cast<long int>(std::ceil(fraction * total));
+  if (target < 1) target = 1;
+
+  long int sum = 0;
+  for(int n = 0; n < buckets_constant; n++) {
+    sum += buckets_rep[n];
+    if (sum >= target) {
+      if (n == buckets_constant - 1)
+	break;
+      double bound = bucket_upper_bound(n);
+      double max = max_seconds();
+      return (bound < max) ? bound : max;
+    }
+  }
+
+  return max_seconds();
+}
+
+/**
+ * Returns the longest recorded processing time in
+ * seconds.
+ */
+double ECA_PROFILE_HISTOGRAM::max_seconds(void) const
+{
+  return static_cast<double>(max_rep) / 1000000000.0;
+}
+
+/**
+ * Maps a duration to a bucket. Octave 'k' covers
+ * durations [2^k, 2^(k+1)) ns and is split linearly
+ * into 'subbuckets_constant' buckets.
+ */
+int ECA_PROFILE_HISTOGRAM::bucket_index(long long int nanoseconds)
+{
+  if (nanoseconds < 1)
+    return 0;
+
+  int exp;
+  double mant = std::frexp(static_cast<double>(nanoseconds), &exp);
+  /* note: ns = mant * 2^exp, mant in [0.5,1) */
+  int octave = exp - 1;
+  int sub = static_cast<int>((mant * 2.0 - 1.0) * subbuckets_constant);
+  int index = octave * subbuckets_constant + sub;
+
+  if (index >= buckets_constant)
+    index = buckets_constant - 1;
+
+  return index;
+}
+
+/**
+ * Returns the upper bound of bucket 'index' in seconds.
+ */
+double ECA_PROFILE_HISTOGRAM::bucket_upper_bound(int index)
+{
+  int octave = index / subbuckets_constant;
+  int sub = index % subbuckets_constant;
+  double ns = std::ldexp(1.0 + static_cast<double>(sub + 1) / subbuckets_constant,
+			 octave);
+  return ns / 1000000000.0;
+}
@@ -0,0 +1,80 @@
+#ifndef INCLUDED_ECA_PROFILE_HISTOGRAM_H
+#define INCLUDED_ECA_PROFILE_HISTOGRAM_H
+
+#include <time.h>
+
+#include <kvu_timestamp.h>
+
+/**
+ * Histogram of processing times, used for profiling
+ * chains and chain operators.
+ *
+ * Durations are counted into logarithmically spaced
+ * buckets, 'subbuckets_constant' per octave, so the
+ * relative precision of reported percentiles is
+ * roughly constant (about 9%) over the whole range.
+ *
+ * Recording a sample does not allocate memory, take
+ * locks or use atomic operations. Each histogram must
+ * have only a single writer at a time (for example the
+ * thread currently processing the chain that owns it).
+ * Readers in other threads may observe a slightly
+ * outdated state, which is acceptable for statistics.
+ */
+class ECA_PROFILE_HISTOGRAM {
+
+ public:
+
+  /** @name Public type definitions and constants */
+  /*@{*/
+
+  static const int subbuckets_constant = 8;
+  static const int octaves_constant = 40;
+  static const int buckets_constant = subbuckets_constant * octaves_constant;
+
+  /*@}*/
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  ECA_PROFILE_HISTOGRAM(void);
+
+  /*@}*/
+
+  /** @name Public functions for recording */
+  /*@{*/
+
+  /**
+   * Returns a monotonic timestamp in nanoseconds.
+   */
+  static inline long long int timestamp(void) {
+    struct timespec ts;
+    kvu_clock_gettime(&ts);
+    return static_cast<long long int>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+
+  void record(long long int nanoseconds);
+  void reset(void);
+
+  /*@}*/
+
+  /** @name Public functions for acquiring statistics */
+  /*@{*/
+
+  long int count(void) const { return count_rep; }
+  double percentile(double fraction) const;
+  double max_seconds(void) const;
+
+  /*@}*/
+
+ private:
+
+  static int bucket_index(long long int nanoseconds);
+  static double bucket_upper_bound(int index);
+
+  long int buckets_rep[buckets_constant];
+  long int count_rep;
+  long long int max_rep;
+};
+
+#endif
@@ -0,0 +1,112 @@
+// ------------------------------------------------------------------------
+// eca-profile-histogram_test.h: Unit test for ECA_PROFILE_HISTOGRAM
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <cstdio>
+
+#include "kvu_numtostr.h"
+
+#include "eca-profile-histogram.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_PROFILE_HISTOGRAM
+ */
+class ECA_PROFILE_HISTOGRAM_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_PROFILE_HISTOGRAM"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_PROFILE_HISTOGRAM_TEST(void) { }
+
+private:
+
+  static bool is_close(double value, double expected);
+
+};
+
+/**
+ * Buckets are 1/8 octave wide, so percentiles are
+ * accurate to within 12.5%.
+ */
+bool ECA_PROFILE_HISTOGRAM_TEST::is_close(double value, double expected)
+{
+  return value >= expected && value <= expected * 1.125;
+}
+
+void ECA_PROFILE_HISTOGRAM_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for ECA_PROFILE_HISTOGRAM class\n",
+	       __FILE__);
+
+  ECA_PROFILE_HISTOGRAM h;
+
+  /* case: empty histogram */
+  if (h.count() != 0 || h.percentile(0.5) != 0.0 || h.max_seconds() != 0.0) {
+    ECA_TEST_FAILURE("empty histogram");
+  }
+
+  /* case: 90 samples of 10us and 10 samples of 1ms */
+  for(int n = 0; n < 90; n++)
+    h.record(10000);
+  for(int n = 0; n < 10; n++)
+    h.record(1000000);
+
+  if (h.count() != 100) {
+    ECA_TEST_FAILURE("count " + kvu_numtostr(h.count()));
+  }
+  if (is_close(h.percentile(0.5), 0.00001) != true) {
+    ECA_TEST_FAILURE("p50 " + kvu_numtostr(h.percentile(0.5), 9));
+  }
+  if (is_close(h.percentile(0.9), 0.00001) != true) {
+    ECA_TEST_FAILURE("p90 " + kvu_numtostr(h.percentile(0.9), 9));
+  }
+  if (h.percentile(0.99) != 0.001) {
+    ECA_TEST_FAILURE("p99 " + kvu_numtostr(h.percentile(0.99), 9));
+  }
+  if (h.max_seconds() != 0.001) {
+    ECA_TEST_FAILURE("max " + kvu_numtostr(h.max_seconds(), 9));
+  }
+
+  /* case: out-of-range values are clamped */
+  h.record(-5);
+  h.record(1000000000000000LL);
+  if (h.count() != 102 || h.percentile(1.0) != h.max_seconds()) {
+    ECA_TEST_FAILURE("clamping");
+  }
+
+  /* case: reset */
+  h.reset();
+  if (h.count() != 0 || h.max_seconds() != 0.0) {
+    ECA_TEST_FAILURE("reset");
+  }
+
+  /* case: timestamps are monotonic */
+  long long int t1 = ECA_PROFILE_HISTOGRAM::timestamp();
+  long long int t2 = ECA_PROFILE_HISTOGRAM::timestamp();
+  if (t2 < t1) {
+    ECA_TEST_FAILURE("timestamp");
+  }
+}
@@ -17,12 +17,21 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
+
+#include <unistd.h>
 
 #include "eca-sample-conversion.h"
 #include "kvu_numtostr.h"
 
+#include "audioio-raw.h"
+#include "samplebuffer.h"
+#include "samplebuffer_convert.h"
+
 #include "eca-logger.h"
 #include "eca-test-case.h"
 
@@ -41,8 +50,166 @@ protected:
 public:
 
   virtual ~ECA_SAMPLE_CONVERSION_TEST(void) { }
+
+private:
+
+  void test_kernels(bool interleaved);
+  void test_direct_io(int channels, const std::string& fmt);
 };
 
+/**
+ * Checks that all conversion kernels supported by the
+ * CPU produce the same results as the scalar kernels.
+ */
+void ECA_SAMPLE_CONVERSION_TEST::test_kernels(bool interleaved)
+{
+  const int frames = 61;
+  const int channels = 3;
+  const ECA_AUDIO_FORMAT::Sample_format fmts[] = {
+    ECA_AUDIO_FORMAT::sfmt_s16_le, ECA_AUDIO_FORMAT::sfmt_s16_be,
+    ECA_AUDIO_FORMAT::sfmt_s24_le, ECA_AUDIO_FORMAT::sfmt_s24_be,
+    ECA_AUDIO_FORMAT::sfmt_s32_le, ECA_AUDIO_FORMAT::sfmt_s32_be,
+    ECA_AUDIO_FORMAT::sfmt_f32_le, ECA_AUDIO_FORMAT::sfmt_f32_be,
+    ECA_AUDIO_FORMAT::sfmt_f64_le, ECA_AUDIO_FORMAT::sfmt_f64_be };
+  const int nfmts = sizeof(fmts) / sizeof(fmts[0]);
+  const size_t rawsize = frames * channels * 8;
+
+  SAMPLE_BUFFER source (frames, channels);
+  std::srand(1);
+  for(int c = 0; c < channels; c++) {
+    for(int n = 0; n < frames; n++) {
+      source.buffer[c][n] = (std::rand() / (float)RAND_MAX) * 2.4f - 1.2f;
+    }
+  }
+  source.buffer[0][0] = 1.0f;
+  source.buffer[0][1] = -1.0f;
+  source.buffer[1][0] = ((float)0x7fff) / 0x8000;
+  source.buffer[1][1] = ((float)0x7fffff) / 0x800000;
+  source.buffer[2][0] = 0.0f;
+
+  for(int f = 0; f < nfmts; f++) {
+    ECA_AUDIO_FORMAT::Sample_coding coding = 
+      (f < 6) ? ECA_AUDIO_FORMAT::sc_signed : ECA_AUDIO_FORMAT::sc_float;
+    std::vector<unsigned char> rawref (rawsize, 0), raw (rawsize, 0);
+    SAMPLE_BUFFER importref (frames, channels), import (frames, channels);
+
+    SAMPLE_BUFFER_CONVERT::set_kernel_type(SAMPLE_BUFFER_CONVERT::kernel_scalar);
+    if (interleaved == true) {
+      source.export_interleaved(&rawref[0], fmts[f], coding, channels);
+      importref.import_interleaved(&rawref[0], frames, fmts[f], channels);
+    }
+    else {
+      source.export_noninterleaved(&rawref[0], fmts[f], coding, channels);
+      importref.import_noninterleaved(&rawref[0], frames, fmts[f], channels);
+    }
+
+    for(int t = SAMPLE_BUFFER_CONVERT::kernel_sse2; 
+	t <= SAMPLE_BUFFER_CONVERT::best_kernel_type(); t++) {
+      SAMPLE_BUFFER_CONVERT::Kernel_type type = 
+	static_cast<SAMPLE_BUFFER_CONVERT::Kernel_type>(t);
+      std::string casename = 
+	std::string(SAMPLE_BUFFER_CONVERT::kernel_type_name(type)) +
+	", format " + kvu_numtostr(f) + 
+	(interleaved == true ? ", interleaved" : ", non-interleaved");
+
+      SAMPLE_BUFFER_CONVERT::set_kernel_type(type);
+      if (interleaved == true) {
+	source.export_interleaved(&raw[0], fmts[f], coding, channels);
+	import.import_interleaved(&rawref[0], frames, fmts[f], channels);
+      }
+      else {
+	source.export_noninterleaved(&raw[0], fmts[f], coding, channels);
+	import.import_noninterleaved(&rawref[0], frames, fmts[f], channels);
+      }
+
+      if (raw != rawref)
+	ECA_TEST_FAILURE("export kernel mismatch: " + casename);
+      for(int c = 0; c < channels; c++) {
+	if (std::memcmp(import.buffer[c], importref.buffer[c], 
+			frames * sizeof(SAMPLE_BUFFER::sample_t)) != 0) {
+	  ECA_TEST_FAILURE("import kernel mismatch: " + casename);
+	  break;
+	}
+      }
+    }
+  }
+
+  SAMPLE_BUFFER_CONVERT::set_kernel_type(SAMPLE_BUFFER_CONVERT::best_kernel_type());
+}
+
+/**
+ * Writes and reads back a raw file, checking that the 
+ * data survives the round trip. Native float mono files
+ * are transferred directly to and from channel memory.
+ */
+void ECA_SAMPLE_CONVERSION_TEST::test_direct_io(int channels, const std::string& fmt)
+{
+  const int frames = 64;
+  const std::string casename = fmt + "/" + kvu_numtostr(channels);
+
+  char filename[] = "/tmp/eca-sample-conversion-test-XXXXXX";
+  int fd = mkstemp(filename);
+  if (fd < 0) {
+    ECA_TEST_FAILURE("mkstemp");
+    return;
+  }
+  close(fd);
+
+  SAMPLE_BUFFER source (frames, channels);
+  for(int c = 0; c < channels; c++) {
+    for(int n = 0; n < frames; n++) {
+      source.buffer[c][n] = (n + c * frames) / (float)(2 * frames) - 0.25f;
+    }
+  }
+
+  RAWFILE output (filename);
+  output.set_io_mode(AUDIO_IO::io_write);
+  output.set_samples_per_second(44100);
+  output.set_channels(channels);
+  output.set_sample_format_string(fmt);
+  output.set_buffersize(frames);
+  output.open();
+  output.write_buffer(&source);
+  source.length_in_samples(frames / 2);
+  output.write_buffer(&source);
+  output.close();
+
+  RAWFILE input (filename);
+  input.set_io_mode(AUDIO_IO::io_read);
+  input.set_samples_per_second(44100);
+  input.set_channels(channels);
+  input.set_sample_format_string(fmt);
+  input.set_buffersize(frames);
+  input.open();
+
+  SAMPLE_BUFFER target (frames, channels);
+  input.read_buffer(&target);
+  if (target.length_in_samples() != frames ||
+      target.number_of_channels() != channels ||
+      target.event_tag_test(SAMPLE_BUFFER::tag_end_of_stream) == true) {
+    ECA_TEST_FAILURE("first read: " + casename);
+  }
+  bool match = true;
+  for(int c = 0; c < channels; c++) {
+    for(int n = 0; n < frames; n++) {
+      if (target.buffer[c][n] != (n + c * frames) / (float)(2 * frames) - 0.25f)
+	match = false;
+    }
+  }
+  if (match != true)
+    ECA_TEST_FAILURE("data mismatch: " + casename);
+
+  target.event_tag_set(SAMPLE_BUFFER::tag_end_of_stream, false);
+  input.read_buffer(&target);
+  if (target.length_in_samples() != frames / 2 ||
+      target.event_tag_test(SAMPLE_BUFFER::tag_end_of_stream) != true) {
+    ECA_TEST_FAILURE("second read: " + casename);
+  }
+  input.close();
+
+  std::remove(filename);
+}
+
 void ECA_SAMPLE_CONVERSION_TEST::do_run(void)
 {
   double dmax = 1.0f;
@@ -200,4 +367,16 @@ void ECA_SAMPLE_CONVERSION_TEST::do_run(void)
   S32INTFLOATINT(-1 << 8);
   S32INTFLOATINT(-1 << 16);
   S32INTFLOATINT(-1 << 20);
+
+  test_kernels(true);
+  test_kernels(false);
+
+  if (SAMPLE_BUFFER_CONVERT::is_native_format(ECA_AUDIO_FORMAT::sfmt_f32_le) ==
+      SAMPLE_BUFFER_CONVERT::is_native_format(ECA_AUDIO_FORMAT::sfmt_f32_be) ||
+      SAMPLE_BUFFER_CONVERT::is_native_format(ECA_AUDIO_FORMAT::sfmt_s32_le) == true) {
+    ECA_TEST_FAILURE("is_native_format");
+  }
+  test_direct_io(1, "f32");
+  test_direct_io(2, "f32");
+  test_direct_io(1, "s16");
 }
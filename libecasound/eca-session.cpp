@@ -21,6 +21,7 @@
 // ------------------------------------------------------------------------
 
 #include <string>
+#include <cstdlib> /* atoi() */
 #include <cstring>
 #include <algorithm>
 #include <vector>
@@ -47,6 +48,9 @@
 #include "audioio-ogg.h"
 #include "audioio-flac.h"
 #include "audioio-aac.h"
+#include "audioio-cache.h"
+#include "eca-fileio-uring.h"
+#include "eca-audio-decoder.h"
 
 #include "osc-gen-file.h"
 
@@ -173,6 +177,17 @@ void ECA_SESSION::set_cs_param_defaults(void)
     v = ecaresources.resource("ext-cmd-aac-output");
     if (v.size() > 0)
       AAC_FORKED_INTERFACE::set_output_cmd(v);
+    v = ecaresources.resource("fileio-uring-queue-depth");
+    if (v.size() > 0)
+      ECA_FILE_IO_URING::set_default_queue_depth(atoi(v.c_str()));
+    v = ecaresources.resource("inprocess-decoders");
+    if (v.size() > 0)
+      ECA_AUDIO_DECODER::set_enabled(v != "false");
+    v = ecaresources.resource("audio-cache-directory");
+    if (v.size() == 0 &&
+	ecaresources.resource("user-resource-directory").size() > 0)
+      v = ecaresources.resource("user-resource-directory") + "/audio-cache";
+    AUDIO_IO_CACHE::set_cache_directory(v);
 
     cs_defaults_set_rep = true;
   }
@@ -444,6 +459,51 @@ void ECA_SESSION::create_chainsetup_options(COMMAND_LINE& cline,
   }
 }
 
+ECA_CHAINSETUP* ECA_SESSION::detach_selected_chainsetup(void)
+{
+  // --------
+  DBC_REQUIRE(selected_chainsetup_repp != 0);
+  DBC_REQUIRE(connected_chainsetup_repp != selected_chainsetup_repp);
+  // --------
+
+  ECA_CHAINSETUP* result = selected_chainsetup_repp;
+
+  std::vector<ECA_CHAINSETUP*>::iterator p = chainsetups_rep.begin();
+  while(p != chainsetups_rep.end()) {
+    if (*p == selected_chainsetup_repp) {
+      chainsetups_rep.erase(p);
+      break;
+    }
+    ++p;
+  }
+  selected_chainsetup_repp = 0;
+
+  // --------
+  DBC_ENSURE(selected_chainsetup_repp == 0);
+  // --------
+
+  return result;
+}
+
+bool ECA_SESSION::attach_chainsetup(ECA_CHAINSETUP* csetup)
+{
+  // --------
+  DBC_REQUIRE(csetup != 0);
+  // --------
+
+  std::vector<ECA_CHAINSETUP*>::const_iterator p = chainsetups_rep.begin();
+  while(p != chainsetups_rep.end()) {
+    if ((*p)->name() == csetup->name()) {
+      return false;
+    }
+    ++p;
+  }
+
+  chainsetups_rep.push_back(csetup);
+
+  return true;
+}
+
 /**
  * Tests whether the given argument is a session-level option.
  */
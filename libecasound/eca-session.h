@@ -82,6 +82,27 @@ class ECA_SESSION {
   void add_chainsetup(ECA_CHAINSETUP* comline_setup);
   void remove_chainsetup(void);
 
+  /**
+   * Removes the selected chainsetup from the session without
+   * deleting it. Ownership is passed to the caller.
+   *
+   * require:
+   *  selected_chainsetup != 0 &&
+   *  selected_chainsetup != connected_chainsetup
+   *
+   * ensure:
+   *  selected_chainsetup == 0
+   */
+  ECA_CHAINSETUP* detach_selected_chainsetup(void);
+
+  /**
+   * Returns a chainsetup earlier detached with 
+   * detach_selected_chainsetup() to the session. Fails
+   * if a chainsetup with the same name already exists,
+   * in which case ownership stays with the caller.
+   */
+  bool attach_chainsetup(ECA_CHAINSETUP* csetup);
+
   /**
    * Select chainsetup with name 'name'
    *
@@ -55,6 +55,7 @@
 #include "audiofx_lv2.h"
 #include "audiofx_lv2_world.h"
 #include "audiofx_ladspa.h"
+#include "eca-ladspa-plugin-cache.h"
 
 #include "generic-controller.h"
 #include "ctrl-source.h"
@@ -86,6 +87,7 @@
 #include "audioio-typeselect.h"
 #include "audioio-resample.h"
 #include "audioio-reverse.h"
+#include "audioio-cache.h"
 #include "audioio-tone.h"
 #include "audioio-acseq.h"
 
@@ -132,7 +134,7 @@ using std::vector;
  * Declarations for static private helper functions
  */
 
-static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname);
+static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(ECA_LADSPA_PLUGIN_CACHE* cache, const string& fname);
 static void eca_import_lv2_plugins(ECA_OBJECT_MAP* objmap);
 static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id);
 
@@ -309,6 +311,7 @@ void ECA_STATIC_OBJECT_MAPS::register_audio_io_nonrt_objects(ECA_OBJECT_MAP* obj
   objmap->register_object("resample-hq", "^resample-hq$", new AUDIO_IO_RESAMPLE());
   objmap->register_object("resample-lq", "^resample-lq$", new AUDIO_IO_RESAMPLE());
   objmap->register_object("reverse", "^reverse$", new AUDIO_IO_REVERSE());
+  objmap->register_object("cache", "^cache$", new AUDIO_IO_CACHE());
   objmap->register_object("tone", "^tone$", new AUDIO_IO_TONE());
   objmap->register_object("audioloop", "^(audioloop|select|playat)$", new AUDIO_CLIP_SEQUENCER());
 
@@ -539,6 +542,21 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
     ++di;
   }
 
+  /* plugin metadata is read from the cache file, and plugin
+   * files are only loaded if they have changed since the cache
+   * was last written */
+  static ECA_LADSPA_PLUGIN_CACHE cache;
+  static bool cache_loaded = false;
+  string cache_file;
+  if (ecarc.resource("ladspa-plugin-cache") != "false" &&
+      ecarc.resource("user-resource-directory").size() > 0) {
+    cache_file = ecarc.resource("user-resource-directory") + "/ladspa-plugin-cache";
+  }
+  if (cache_loaded != true && cache_file.size() > 0) {
+    cache.load(cache_file);
+  }
+  cache_loaded = true;
+
   /* go through all directories in the list and 
    * try to open all encountered files as LADSPA plugins */
   struct stat statbuf;
@@ -587,7 +605,7 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
 
 	try {
 	  if (entry->d_name[0] != '.')
-	    ladspa_plugins = eca_create_ladspa_plugins(full_path_str.c_str());
+	    ladspa_plugins = eca_create_ladspa_plugins(&cache, full_path_str);
 	}
 	catch(ECA_ERROR& e) {  }
 
@@ -607,38 +625,24 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
     }
     ++p;
   }
+
+  if (cache_file.size() > 0 && cache.is_modified() == true) {
+    mkdir(ecarc.resource("user-resource-directory").c_str(), 0755);
+    cache.save(cache_file);
+  }
 }
 
-static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname)
+static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(ECA_LADSPA_PLUGIN_CACHE* cache, const string& fname)
 {
   vector<EFFECT_LADSPA*> plugins;
 
 #ifndef ECA_DISABLE_EFFECTS
-  void *plugin_handle = dlopen(fname.c_str(), RTLD_NOW);
-  if (plugin_handle != 0) {
-    LADSPA_Descriptor_Function desc_func;
-    
-    desc_func = (LADSPA_Descriptor_Function)dlsym(plugin_handle, "ladspa_descriptor");
-    if (desc_func != 0) {
-      const LADSPA_Descriptor *plugin_desc = 0;
-      for (int i = 0;; i++) {
-	plugin_desc = desc_func(i);
-	if (plugin_desc == 0) break;
-	try {
-	  plugins.push_back(new EFFECT_LADSPA(plugin_desc));
-	}
-	catch (ECA_ERROR&) { }
-	plugin_desc = 0;
-      }
+  vector<const LADSPA_Descriptor*> descs = cache->descriptors(fname);
+  for(unsigned int n = 0; n < descs.size(); n++) {
+    try {
+      plugins.push_back(new EFFECT_LADSPA(descs[n]));
     }
-    else { 
-      ECA_LOG_MSG(ECA_LOGGER::user_objects,
-		  "Unable find plugin LADSPA-descriptor.");
-    }
-  }
-  else {
-    ECA_LOG_MSG(ECA_LOGGER::user_objects,
-		string("Unable to open plugin file \"") + fname + "\".");
+    catch (ECA_ERROR&) { }
   }
 #endif
   
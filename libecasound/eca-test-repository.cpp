@@ -52,11 +52,23 @@ ECA_TEST_REPOSITORY& ECA_TEST_REPOSITORY::instance(void)
  */
 
 #include "audiofx_amplitude_test.h"
+#include "audiofx_timebased_test.h"
+#include "eca-audio-decoder_test.h"
 #include "eca-audio-time_test.h"
 #include "eca-control_test.h"
 #include "eca-session_test.h"
 #include "eca-object-factory_test.h"
+#include "eca-object-map_test.h"
+#include "eca-logger_test.h"
 #include "eca-sample-conversion_test.h"
+#include "eca-worker-pool_test.h"
+#include "eca-engine-command-queue_test.h"
+#include "eca-profile-histogram_test.h"
+#include "eca-ladspa-plugin-cache_test.h"
+#include "audioio-cache_test.h"
+#include "audioio-db-server_test.h"
+#include "biquad-filter_test.h"
+#include "delay-line_test.h"
 #include "eca-chainsetup_test.h"
 #include "eca-chainsetup-parser_test.h"
 #include "generic-linear-envelope_test.h"
@@ -76,11 +88,23 @@ ECA_TEST_REPOSITORY::ECA_TEST_REPOSITORY(void)
   test_cases_rep.push_back(new ECA_SESSION_TEST());
   test_cases_rep.push_back(new ECA_CONTROL_TEST());
   test_cases_rep.push_back(new ECA_OBJECT_FACTORY_TEST());
+  test_cases_rep.push_back(new ECA_OBJECT_MAP_TEST());
+  test_cases_rep.push_back(new ECA_LOGGER_TEST());
   test_cases_rep.push_back(new ECA_SAMPLE_CONVERSION_TEST());
   test_cases_rep.push_back(new ECA_CHAINSETUP_TEST());
   test_cases_rep.push_back(new ECA_CHAINSETUP_PARSER_TEST());
   test_cases_rep.push_back(new GENERIC_LINEAR_ENVELOPE_TEST());
   test_cases_rep.push_back(new SAMPLE_BUFFER_TEST());
+  test_cases_rep.push_back(new ECA_WORKER_POOL_TEST());
+  test_cases_rep.push_back(new ECA_ENGINE_COMMAND_QUEUE_TEST());
+  test_cases_rep.push_back(new ECA_PROFILE_HISTOGRAM_TEST());
+  test_cases_rep.push_back(new ECA_LADSPA_PLUGIN_CACHE_TEST());
+  test_cases_rep.push_back(new AUDIO_IO_CACHE_TEST());
+  test_cases_rep.push_back(new AUDIO_IO_DB_SERVER_TEST());
+  test_cases_rep.push_back(new ECA_AUDIO_DECODER_TEST());
+  test_cases_rep.push_back(new BIQUAD_FILTER_TEST());
+  test_cases_rep.push_back(new DELAY_LINE_TEST());
+  test_cases_rep.push_back(new EFFECT_TIME_BASED_TEST());
 }
 
 /** 
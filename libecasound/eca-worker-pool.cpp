@@ -0,0 +1,274 @@
+// ------------------------------------------------------------------------
+// eca-worker-pool.cpp: Persistent pool of worker threads
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+#include <kvu_dbc.h>
+#include <kvu_numtostr.h>
+#include <kvu_rtcaps.h>
+
+#include "eca-logger.h"
+#include "eca-worker-pool.h"
+
+/**
+ * Helper function for starting the worker threads.
+ */
+void* start_worker_pool_thread(void *ptr)
+{
+  sigset_t sigset;
+  sigemptyset(&sigset);
+  sigaddset(&sigset, SIGINT);
+  sigprocmask(SIG_BLOCK, &sigset, 0);
+
+  ECA_WORKER_POOL::WORKER_ARGS* args =
+    static_cast<ECA_WORKER_POOL::WORKER_ARGS*>(ptr);
+  ECA_WORKER_POOL* pool = args->pool;
+
+  if (pool->schedrealtime_rep == true) {
+    if (kvu_set_thread_scheduling(SCHED_FIFO, pool->schedpriority_rep) != 0)
+      ECA_LOG_MSG(ECA_LOGGER::system_objects, "Unable to change scheduling policy!");
+    else
+      ECA_LOG_MSG(ECA_LOGGER::system_objects,
+		  std::string("Using realtime-scheduling (SCHED_FIFO:") + kvu_numtostr(pool->schedpriority_rep) + ").");
+  }
+
+  pool->worker_thread(args->index);
+
+  return 0;
+}
+
+ECA_WORKER_POOL::ECA_WORKER_POOL(void)
+  : job_repp(0),
+    job_items_rep(0),
+    job_generation_rep(0),
+    workers_active_rep(0),
+    exit_request_rep(false),
+    schedrealtime_rep(false),
+    schedpriority_rep(0),
+    cpu_affinity_rep(true)
+{
+  pthread_mutex_init(&job_mutex_rep, NULL);
+  pthread_cond_init(&job_cond_rep, NULL);
+  pthread_cond_init(&done_cond_rep, NULL);
+}
+
+ECA_WORKER_POOL::~ECA_WORKER_POOL(void)
+{
+  if (is_running() == true)
+    stop();
+
+  pthread_cond_destroy(&done_cond_rep);
+  pthread_cond_destroy(&job_cond_rep);
+  pthread_mutex_destroy(&job_mutex_rep);
+}
+
+/**
+ * Launches 'threads' worker threads. If CPU affinity is
+ * enabled, worker 'n' is pinned to CPU 'n+1', so that
+ * the thread calling execute() can run on the first
+ * CPU without competing with the workers.
+ *
+ * @pre is_running() != true
+ * @post is_running() == true || threads < 1
+ */
+void ECA_WORKER_POOL::start(int threads)
+{
+  // --
+  DBC_REQUIRE(is_running() != true);
+  // --
+
+  if (threads < 1) return;
+
+  exit_request_rep = false;
+  job_generation_rep = 0;
+  workers_active_rep = 0;
+
+  threads_rep.resize(threads);
+  thread_args_rep.resize(threads);
+
+  int cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+  cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1) cpus = 1;
+#endif
+
+  for(int n = 0; n < threads; n++) {
+    thread_args_rep[n].pool = this;
+    thread_args_rep[n].index = n;
+
+    int ret = pthread_create(&threads_rep[n],
+			     0,
+			     start_worker_pool_thread,
+			     static_cast<void *>(&thread_args_rep[n]));
+    if (ret != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info, "WARNING: Unable to create worker threads, only " +
+		  kvu_numtostr(n) + " started.");
+      threads_rep.resize(n);
+      break;
+    }
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    if (cpu_affinity_rep == true && cpus > 1) {
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET((n + 1) % cpus, &cpuset);
+      if (pthread_setaffinity_np(threads_rep[n], sizeof(cpu_set_t), &cpuset) != 0)
+	ECA_LOG_MSG(ECA_LOGGER::system_objects,
+		    "Unable to set CPU affinity for worker " + kvu_numtostr(n) + ".");
+    }
+#endif
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "Started " + kvu_numtostr(threads_rep.size()) + " worker threads.");
+}
+
+/**
+ * Stops and joins all worker threads.
+ *
+ * @post is_running() != true
+ */
+void ECA_WORKER_POOL::stop(void)
+{
+  pthread_mutex_lock(&job_mutex_rep);
+  exit_request_rep = true;
+  pthread_cond_broadcast(&job_cond_rep);
+  pthread_mutex_unlock(&job_mutex_rep);
+
+  for(size_t n = 0; n < threads_rep.size(); n++) {
+    pthread_join(threads_rep[n], 0);
+  }
+  threads_rep.resize(0);
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, "Worker threads stopped.");
+
+  // --
+  DBC_ENSURE(is_running() != true);
+  // --
+}
+
+/**
+ * Runs work items 0...'items'-1 of 'job' using the
+ * worker threads and the calling thread. Blocks until
+ * all items have been completed.
+ *
+ * If the pool is not running, items are run
+ * sequentially in the calling thread.
+ */
+void ECA_WORKER_POOL::execute(ECA_WORKER_POOL_JOB* job, int items)
+{
+  if (is_running() != true || items < 2) {
+    for(int n = 0; n < items; n++)
+      job->run_item(n);
+    return;
+  }
+
+  pthread_mutex_lock(&job_mutex_rep);
+  job_repp = job;
+  job_items_rep = items;
+  next_item_rep.set(0);
+  workers_active_rep = threads_rep.size();
+  ++job_generation_rep;
+  pthread_cond_broadcast(&job_cond_rep);
+  pthread_mutex_unlock(&job_mutex_rep);
+
+  run_items();
+
+  pthread_mutex_lock(&job_mutex_rep);
+  while(workers_active_rep > 0)
+    pthread_cond_wait(&done_cond_rep, &job_mutex_rep);
+  job_repp = 0;
+  pthread_mutex_unlock(&job_mutex_rep);
+}
+
+/**
+ * Like execute(), but returns false without running 
+ * any items if another thread is already executing
+ * a job with the pool. Allows multiple threads to 
+ * share one pool, falling back to sequential
+ * processing when the pool is busy.
+ */
+bool ECA_WORKER_POOL::try_execute(ECA_WORKER_POOL_JOB* job, int items)
+{
+  if (busy_rep.add(1) != 0) {
+    busy_rep.add(-1);
+    return false;
+  }
+
+  execute(job, items);
+
+  busy_rep.add(-1);
+  return true;
+}
+
+/**
+ * Runs work items of the current job until all items
+ * have been claimed.
+ */
+void ECA_WORKER_POOL::run_items(void)
+{
+  while(true) {
+    int item = next_item_rep.add(1);
+    if (item >= job_items_rep)
+      break;
+    job_repp->run_item(item);
+  }
+}
+
+/**
+ * Main loop of the worker threads.
+ */
+void ECA_WORKER_POOL::worker_thread(int index)
+{
+  long int seen_generation = 0;
+
+  pthread_mutex_lock(&job_mutex_rep);
+  while(true) {
+    while(job_generation_rep == seen_generation &&
+	  exit_request_rep != true)
+      pthread_cond_wait(&job_cond_rep, &job_mutex_rep);
+
+    if (exit_request_rep == true)
+      break;
+
+    seen_generation = job_generation_rep;
+    pthread_mutex_unlock(&job_mutex_rep);
+
+    run_items();
+
+    pthread_mutex_lock(&job_mutex_rep);
+    if (--workers_active_rep == 0)
+      pthread_cond_signal(&done_cond_rep);
+  }
+  pthread_mutex_unlock(&job_mutex_rep);
+}
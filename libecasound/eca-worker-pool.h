@@ -0,0 +1,123 @@
+#ifndef INCLUDED_ECA_WORKER_POOL_H
+#define INCLUDED_ECA_WORKER_POOL_H
+
+#include <vector>
+#include <pthread.h>
+
+#include <kvu_locks.h>
+
+/**
+ * Interface for jobs executed with ECA_WORKER_POOL.
+ *
+ * A job consists of a number of independent work
+ * items, identified by an index. The items may be
+ * run in any order and concurrently from multiple
+ * threads.
+ */
+class ECA_WORKER_POOL_JOB {
+
+ public:
+
+  /**
+   * Runs work item 'index'.
+   */
+  virtual void run_item(int index) = 0;
+
+  virtual ~ECA_WORKER_POOL_JOB(void) {}
+};
+
+/**
+ * A persistent pool of worker threads.
+ *
+ * The threads are created once in start() and they
+ * are kept waiting until a job is submitted with
+ * execute(). The calling thread takes part in
+ * processing the job and execute() returns only
+ * after all work items have been completed, so each
+ * call acts as a barrier.
+ *
+ * No memory is allocated in execute(), so it can be
+ * called from the engine's realtime context.
+ */
+class ECA_WORKER_POOL {
+
+ public:
+
+  /** @name Constructors and dtors */
+  /*@{*/
+
+  ECA_WORKER_POOL(void);
+  ~ECA_WORKER_POOL(void);
+
+  /*@}*/
+
+  /** @name Public functions for configuration */
+  /*@{*/
+
+  void set_schedrealtime(bool v) { schedrealtime_rep = v; }
+  void set_schedpriority(int v) { schedpriority_rep = v; }
+  void toggle_cpu_affinity(bool v) { cpu_affinity_rep = v; }
+
+  /*@}*/
+
+  /** @name Public functions for transport control */
+  /*@{*/
+
+  void start(int threads);
+  void stop(void);
+
+  /*@}*/
+
+  /** @name Public functions for executing jobs */
+  /*@{*/
+
+  void execute(ECA_WORKER_POOL_JOB* job, int items);
+  bool try_execute(ECA_WORKER_POOL_JOB* job, int items);
+
+  /*@}*/
+
+  /** @name Public functions for acquiring status information */
+  /*@{*/
+
+  bool is_running(void) const { return threads_rep.size() > 0; }
+  int number_of_threads(void) const { return threads_rep.size(); }
+
+  /*@}*/
+
+ private:
+
+  friend void* start_worker_pool_thread(void *ptr);
+
+  struct WORKER_ARGS {
+    ECA_WORKER_POOL* pool;
+    int index;
+  };
+
+  std::vector<pthread_t> threads_rep;
+  std::vector<WORKER_ARGS> thread_args_rep;
+
+  pthread_mutex_t job_mutex_rep;
+  pthread_cond_t job_cond_rep;
+  pthread_cond_t done_cond_rep;
+
+  ECA_WORKER_POOL_JOB* job_repp;
+  int job_items_rep;
+  long int job_generation_rep;
+  int workers_active_rep;
+  bool exit_request_rep;
+
+  ATOMIC_INTEGER next_item_rep;
+  ATOMIC_INTEGER busy_rep;
+
+  bool schedrealtime_rep;
+  int schedpriority_rep;
+  bool cpu_affinity_rep;
+
+  void worker_thread(int index);
+  void run_items(void);
+
+  ECA_WORKER_POOL& operator=(const ECA_WORKER_POOL& x) { return *this; }
+  ECA_WORKER_POOL (const ECA_WORKER_POOL& x) { }
+};
+
+#endif
@@ -0,0 +1,129 @@
+// ------------------------------------------------------------------------
+// eca-worker-pool_test.h: Unit test for ECA_WORKER_POOL
+// Copyright (C) 2026 Kai Vehmanen
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "kvu_numtostr.h"
+
+#include "eca-worker-pool.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Job that counts how many times each item is run.
+ */
+class ECA_WORKER_POOL_TEST_JOB : public ECA_WORKER_POOL_JOB {
+
+public:
+
+  vector<int> counts;
+
+  virtual void run_item(int index) { ++counts[index]; }
+};
+
+/**
+ * Job that tries to use the pool while it is busy.
+ */
+class ECA_WORKER_POOL_TEST_NESTED_JOB : public ECA_WORKER_POOL_JOB {
+
+public:
+
+  ECA_WORKER_POOL* pool;
+  ECA_WORKER_POOL_TEST_JOB* inner;
+  ATOMIC_INTEGER accepted;
+
+  virtual void run_item(int index) {
+    if (pool->try_execute(inner, 1) == true)
+      accepted.add(1);
+  }
+};
+
+/**
+ * Unit test for ECA_WORKER_POOL
+ */
+class ECA_WORKER_POOL_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_WORKER_POOL"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_WORKER_POOL_TEST(void) { }
+
+private:
+
+};
+
+void ECA_WORKER_POOL_TEST::do_run(void)
+{
+  const int items = 64;
+  const int rounds = 500;
+
+  std::fprintf(stdout, "%s: tests for ECA_WORKER_POOL class\n",
+	       __FILE__);
+
+  ECA_WORKER_POOL pool;
+  ECA_WORKER_POOL_TEST_JOB job;
+  job.counts.resize(items, 0);
+
+  /* case: sequential execution without threads */
+  pool.execute(&job, items);
+  for(int n = 0; n < items; n++) {
+    if (job.counts[n] != 1) {
+      ECA_TEST_FAILURE("sequential execute, item " + kvu_numtostr(n));
+      break;
+    }
+  }
+
+  /* case: each item is run exactly once per execute() */
+  pool.toggle_cpu_affinity(false);
+  pool.start(3);
+  if (pool.number_of_threads() != 3) 
+    ECA_TEST_FAILURE("start");
+
+  for(int r = 0; r < rounds; r++) {
+    pool.execute(&job, items);
+  }
+  for(int n = 0; n < items; n++) {
+    if (job.counts[n] != rounds + 1) {
+      ECA_TEST_FAILURE("parallel execute, item " + kvu_numtostr(n) + 
+		       " run " + kvu_numtostr(job.counts[n]) + " times");
+      break;
+    }
+  }
+
+  /* case: try_execute() fails while the pool is in use */
+  ECA_WORKER_POOL_TEST_NESTED_JOB nested;
+  nested.pool = &pool;
+  nested.inner = &job;
+  if (pool.try_execute(&nested, items) != true ||
+      nested.accepted.get() != 0 ||
+      job.counts[0] != rounds + 1) {
+    ECA_TEST_FAILURE("try_execute");
+  }
+
+  pool.stop();
+  if (pool.is_running() == true) 
+    ECA_TEST_FAILURE("stop");
+}
@@ -44,7 +44,9 @@
 GENERIC_CONTROLLER::GENERIC_CONTROLLER(CONTROLLER_SOURCE* src, OPERATOR* dobj, int par_id, double range_low, double range_high)
 {
   source = src;
-  target = dobj;
+  target = 0;
+  target_cop_repp = 0;
+  assign_target(dobj);
   init_called_rep = false;
   param_id_rep = par_id;
   rangelow_rep = range_low;
@@ -68,14 +70,22 @@ void GENERIC_CONTROLLER::init(void)
   last_value_pos_rep = -1;
 }
 
+/**
+ * Returns the source value at 'pos', scaled to the target
+ * parameter range.
+ */
+CONTROLLER_SOURCE::parameter_t GENERIC_CONTROLLER::scaled_value(double pos)
+{
+  return rangelow_rep + (source->value(pos) * (rangehigh_rep - rangelow_rep));
+}
+
 CONTROLLER_SOURCE::parameter_t GENERIC_CONTROLLER::value(double pos)
 {
   // --------
   DBC_REQUIRE(is_valid() == true);
   // --------
 
-  double new_value = rangelow_rep +
-    (source->value(pos) * (rangehigh_rep - rangelow_rep));
+  double new_value = scaled_value(pos);
 
   DEBUG_CTRL_STATEMENT(std::cerr << "generic-controller: type '"
 		       << source->name() << "', pos_sec " << pos 
@@ -89,6 +99,62 @@ CONTROLLER_SOURCE::parameter_t GENERIC_CONTROLLER::value(double pos)
   return new_value;
 }
 
+/**
+ * Computes target parameter values for 'frames' sample
+ * frames starting from 'pos_secs' and stores them to 'ramp'.
+ * The source is evaluated every 'step' frames and at the
+ * end of the range, and values in between are linearly
+ * interpolated. The target is not modified.
+ *
+ * @pre is_valid() == true
+ * @pre step > 0 && srate > 0
+ */
+void GENERIC_CONTROLLER::value_ramp(double pos_secs, SAMPLE_SPECS::sample_rate_t srate, long int frames, long int step, parameter_t* ramp)
+{
+  // --------
+  DBC_REQUIRE(is_valid() == true);
+  DBC_REQUIRE(step > 0);
+  DBC_REQUIRE(srate > 0);
+  // --------
+
+  parameter_t start = scaled_value(pos_secs);
+  for(long int n = 0; n < frames; n += step) {
+    long int len = frames - n;
+    if (len > step) len = step;
+    parameter_t end = scaled_value(pos_secs + static_cast<double>(n + len) / srate);
+    parameter_t delta = (end - start) / len;
+    for(long int k = 0; k < len; k++) {
+      ramp[n + k] = start + delta * k;
+    }
+    start = end;
+  }
+
+  last_value_pos_rep = pos_secs;
+}
+
+/**
+ * Applies values computed with value_ramp() to the target.
+ * If the target can follow per-sample values, the whole
+ * ramp is passed to it, otherwise the target parameter is
+ * set to the first value.
+ */
+void GENERIC_CONTROLLER::apply_ramp(const parameter_t* ramp)
+{
+  if (target_follows_ramps() == true)
+    target_cop_repp->set_parameter_ramp(param_id_rep, ramp);
+  else
+    target->set_parameter(param_id_rep, ramp[0]);
+}
+
+/**
+ * Whether the target is a chain operator that can follow
+ * per-sample values of the controlled parameter.
+ */
+bool GENERIC_CONTROLLER::target_follows_ramps(void) const
+{
+  return target_cop_repp != 0 && target_cop_repp->supports_parameter_ramp(param_id_rep);
+}
+
 string GENERIC_CONTROLLER::status(void) const
 {
   if (is_valid() == true) {
@@ -114,6 +180,7 @@ string GENERIC_CONTROLLER::status(void) const
 void GENERIC_CONTROLLER::assign_target(OPERATOR* obj)
 { 
   target  = obj; 
+  target_cop_repp = dynamic_cast<CHAIN_OPERATOR*>(obj);
 }
 
 void GENERIC_CONTROLLER::assign_source(CONTROLLER_SOURCE* obj)
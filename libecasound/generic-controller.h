@@ -3,6 +3,9 @@
 
 #include "ctrl-source.h"
 #include "eca-operator.h"
+#include "sample-specs.h"
+
+class CHAIN_OPERATOR;
 
 /**
  * Generic controller class that connects controller sources
@@ -77,10 +80,27 @@ class GENERIC_CONTROLLER : public CONTROLLER_SOURCE {
   OPERATOR* target_pointer(void) const { return(target); }
 
   /*@}*/
+
+  /** @name Public functions for sample-accurate control */
+  /*@{*/
+
+  void value_ramp(double pos_secs, SAMPLE_SPECS::sample_rate_t srate, long int frames, long int step, parameter_t* ramp);
+  void apply_ramp(const parameter_t* ramp);
+
+  /**
+   * Whether the target is a chain operator.
+   */
+  bool controls_chain_operator(void) const { return(target_cop_repp != 0); }
+  bool target_follows_ramps(void) const;
+
+  /*@}*/
  
 private:
 
+  parameter_t scaled_value(double pos);
+
   OPERATOR* target;
+  CHAIN_OPERATOR* target_cop_repp;
   CONTROLLER_SOURCE* source;
 
   bool init_called_rep;
@@ -382,6 +382,17 @@ void SNDFILE_INTERFACE::read_buffer(SAMPLE_BUFFER* sbuf)
 
   DBC_CHECK(interleaved_channels() == true);
 
+  if (is_direct_channel_format(audioio_sndfile_sfmt,
+			       ECA_AUDIO_FORMAT::sc_float) == true) {
+    /* note: libsndfile returns native floats, so mono
+     *       data can be read directly to channel memory */
+    sbuf->number_of_channels(1);
+    sbuf->length_in_samples(buffersize());
+    sbuf->length_in_samples(read_samples(sbuf->buffer[0], buffersize()));
+    change_position_in_samples(sbuf->length_in_samples());
+    return;
+  }
+
   /* in normal conditions this won't cause memory reallocs */
   reserve_buffer_space((sizeof(float) * channels()) * buffersize());
 
@@ -408,6 +419,17 @@ void SNDFILE_INTERFACE::write_buffer(SAMPLE_BUFFER* sbuf)
 
   set_buffersize(sbuf->length_in_samples());
 
+  if (sbuf->number_of_channels() > 0 &&
+      is_direct_channel_format(audioio_sndfile_sfmt,
+			       sample_coding()) == true) {
+    /* note: no clipping needed, write directly 
+     *       from channel memory */
+    write_samples(sbuf->buffer[0], sbuf->length_in_samples());
+    change_position_in_samples(sbuf->length_in_samples());
+    extend_position();
+    return;
+  }
+
   sbuf->export_interleaved(get_iobuf(),
                            audioio_sndfile_sfmt,
                            sample_coding(),
@@ -68,6 +68,8 @@ class SNDFILE_INTERFACE : public AUDIO_IO_BUFFERED {
 
   virtual void read_buffer(SAMPLE_BUFFER* sbuf);
   virtual void write_buffer(SAMPLE_BUFFER* sbuf);
+  virtual int read_buffers(SAMPLE_BUFFER** sbufs, int count) { return AUDIO_IO::read_buffers(sbufs, count); }
+  virtual void write_buffers(SAMPLE_BUFFER** sbufs, int count) { AUDIO_IO::write_buffers(sbufs, count); }
 
   /*@}*/
 
@@ -37,6 +37,7 @@
 #include <cmath>    /* ceil(), floor() */
 #include <cstring>  /* memcpy */
 #include <stdlib.h> /* not cstdlib we need e.g. posix_memalign() */
+#include <stdint.h> /* uintptr_t */
 
 #include <sys/types.h>
 
@@ -55,6 +56,7 @@ extern "C" {
 
 #include "eca-sample-conversion.h"
 #include "samplebuffer.h"
+#include "samplebuffer_convert.h"
 #include "samplebuffer_impl.h"
 #include "eca-logger.h"
 
@@ -75,6 +77,18 @@ static const bool is_system_littleendian = true;
 
 using namespace std;
 
+/**
+ * Returns the number of frames to convert at a time when
+ * (de)interleaving with conversion kernels. Each channel is
+ * converted separately, so the raw data of one chunk
+ * should fit into the L1 cache.
+ */
+static SAMPLE_BUFFER::buf_size_t priv_convert_chunk_frames(int frame_bytes)
+{
+  SAMPLE_BUFFER::buf_size_t frames = (16384 / frame_bytes) & ~7;
+  return (frames < 8) ? 8 : frames;
+}
+
 static void priv_alloc_sample_buf(SAMPLE_SPECS::sample_t **memptr, size_t size)
 {
 #ifdef HAVE_POSIX_MEMALIGN
@@ -86,6 +100,49 @@ static void priv_alloc_sample_buf(SAMPLE_SPECS::sample_t **memptr, size_t size)
 
 }
 
+/**
+ * Allocates 'size' bytes aligned to SAMPLE_BUFFER::channel_alignment.
+ * The aligned address is returned and '*memptr' is set to the
+ * block to be passed to free().
+ */
+static SAMPLE_SPECS::sample_t* priv_alloc_aligned_buf(void **memptr, size_t size)
+{
+  const size_t align = SAMPLE_BUFFER::channel_alignment;
+#ifdef HAVE_POSIX_MEMALIGN
+  if (posix_memalign(memptr, align, size) != 0)
+    *memptr = 0;
+  return reinterpret_cast<SAMPLE_SPECS::sample_t*>(*memptr);
+#else
+  *memptr = malloc(size + align);
+  if (*memptr == 0) 
+    return 0;
+  uintptr_t addr = reinterpret_cast<uintptr_t>(*memptr);
+  addr = (addr + align - 1) & ~static_cast<uintptr_t>(align - 1);
+  return reinterpret_cast<SAMPLE_SPECS::sample_t*>(addr);
+#endif
+}
+
+/**
+ * Returns the distance between starts of two adjacent 
+ * channels, for channels of 'samples' samples.
+ */
+static SAMPLE_BUFFER::buf_size_t priv_channel_stride(SAMPLE_BUFFER::buf_size_t samples)
+{
+  const SAMPLE_BUFFER::buf_size_t line = 
+    SAMPLE_BUFFER::channel_alignment / sizeof(SAMPLE_SPECS::sample_t);
+
+  SAMPLE_BUFFER::buf_size_t stride = (samples + line - 1) / line * line;
+  if (stride < line)
+    stride = line;
+
+  /* note: with strides that are multiples of 4kB, the same
+   *       position in all channels maps to the same cache set */
+  if ((stride * sizeof(SAMPLE_SPECS::sample_t)) % 4096 == 0)
+    stride += line;
+
+  return stride;
+}
+
 /**
  * Constructs a new sample buffer object.
  */
@@ -106,12 +163,9 @@ SAMPLE_BUFFER::SAMPLE_BUFFER (buf_size_t buffersize, channel_size_t channels)
 
   impl_repp = new SAMPLE_BUFFER_impl;
 
-  buffer.resize(channels);
-  for(size_t n = 0; n < buffer.size(); n++) {
-    priv_alloc_sample_buf(&buffer[n], 
-			  sizeof(sample_t) * reserved_samples_rep);
-  }
-  make_silent();
+  impl_repp->slab_repp = 0;
+  impl_repp->channel_stride_rep = 0;
+  reallocate_channels(channels, reserved_samples_rep);
 
   impl_repp->rt_lock_rep = false;
   impl_repp->lockref_rep = 0;
@@ -144,12 +198,11 @@ SAMPLE_BUFFER::~SAMPLE_BUFFER (void)
 {
   DBC_CHECK(impl_repp->lockref_rep == 0);
 
-  for(size_t n = 0; n < buffer.size(); n++) {
-    if (buffer[n] != 0) {
-      ::free(buffer[n]);
-      buffer[n] = 0;
-    }
+  if (impl_repp->slab_repp != 0) {
+    ::free(impl_repp->slab_repp);
+    impl_repp->slab_repp = 0;
   }
+  buffer.clear();
 
   if (impl_repp->old_buffer_repp != 0) {
     ::free(impl_repp->old_buffer_repp);
@@ -191,7 +244,15 @@ void SAMPLE_BUFFER::add_matching_channels(const SAMPLE_BUFFER& x)
 		x.length_in_samples());
   }
 #else
-  add_matching_channels_ref(x);
+  if (x.length_in_samples() > length_in_samples()) {
+    length_in_samples(x.length_in_samples());
+  }
+  SAMPLE_BUFFER_CONVERT::mix_kernel_t kernel = SAMPLE_BUFFER_CONVERT::mix_kernel();
+  int min_c_count = (channel_count_rep <= x.channel_count_rep) ? channel_count_rep : x.channel_count_rep;
+  for(channel_size_t q = 0; q < min_c_count; q++) {
+    const sample_t* src = x.buffer[q];
+    kernel(&src, 1, buffer[q], x.length_in_samples(), 1.0f, true);
+  }
 #endif
 }
 
@@ -205,8 +266,10 @@ void SAMPLE_BUFFER::add_matching_channels_ref(const SAMPLE_BUFFER& x)
   }
   int min_c_count = (channel_count_rep <= x.channel_count_rep) ? channel_count_rep : x.channel_count_rep;
   for(channel_size_t q = 0; q < min_c_count; q++) {
+    sample_t* dst = channel_data(q);
+    const sample_t* src = x.channel_data(q);
     for(buf_size_t t = 0; t < x.length_in_samples(); t++) {
-      buffer[q][t] += x.buffer[q][t];
+      dst[t] += src[t];
     }
   }
 }
@@ -228,16 +291,90 @@ void SAMPLE_BUFFER::add_with_weight(const SAMPLE_BUFFER& x, int weight)
   DBC_REQUIRE(weight != 0);
   // ---
 
-  /* note: gcc does a suprisingly good job for this function,
-   *       so additional optimizations don't seem worthwhile */
-
   if (x.length_in_samples() > length_in_samples()) {
     length_in_samples(x.length_in_samples());
   }
+  SAMPLE_BUFFER_CONVERT::mix_kernel_t kernel = SAMPLE_BUFFER_CONVERT::mix_kernel();
+  sample_t factor = 1.0 / weight;
   int min_c_count = (channel_count_rep <= x.channel_count_rep) ? channel_count_rep : x.channel_count_rep;
   for(channel_size_t q = 0; q < min_c_count; q++) {
-    for(buf_size_t t = 0; t < x.length_in_samples(); t++) {
-      buffer[q][t] += (x.buffer[q][t] / weight);
+    const sample_t* src = x.buffer[q];
+    kernel(&src, 1, buffer[q], x.length_in_samples(), factor, true);
+  }
+}
+
+/**
+ * Replaces contents with the sum of 'count' buffers 
+ * in 'sources', every sample multiplied by 'weight'. 
+ * Channels missing from a source, and samples past its 
+ * length, are treated as silent. Length is set to the 
+ * length of the longest source. Channel count is not 
+ * changed.
+ *
+ * Gives the same result, up to rounding, as 
+ * copy_matching_channels() from the first source and
+ * add_matching_channels() from the rest, followed by 
+ * multiply_by(weight), but in one pass. Channels are 
+ * processed in blocks that stay in the L1 cache while
+ * all sources are added, several sources per kernel
+ * call.
+ *
+ * Note: event tags are not copied!
+ * 
+ * @pre count > 0
+ */
+void SAMPLE_BUFFER::mix_matching_channels(SAMPLE_BUFFER* const* sources, int count, sample_t weight)
+{
+  // ---
+  DBC_REQUIRE(count > 0);
+  // ---
+
+  const buf_size_t tile = 1024;
+
+  buf_size_t len = 0;
+  for(int i = 0; i < count; i++) {
+    if (sources[i]->length_in_samples() > len)
+      len = sources[i]->length_in_samples();
+  }
+  length_in_samples(len);
+
+  SAMPLE_BUFFER_CONVERT::mix_kernel_t kernel = SAMPLE_BUFFER_CONVERT::mix_kernel();
+  const sample_t* group[SAMPLE_BUFFER_CONVERT::max_mix_sources];
+  for(channel_size_t c = 0; c < channel_count_rep; c++) {
+    sample_t* dst = buffer[c];
+    for(buf_size_t start = 0; start < len; start += tile) {
+      buf_size_t end = (start + tile < len) ? start + tile : len;
+      bool stored = false;
+      int grouped = 0;
+      for(int i = 0; i < count; i++) {
+	const SAMPLE_BUFFER* src = sources[i];
+	if (c >= src->channel_count_rep || 
+	    src->buffersize_rep <= start)
+	  continue;
+
+	if (src->buffersize_rep < end) {
+	  /* note: source ends within this block */
+	  const sample_t* part = src->buffer[c] + start;
+	  if (stored != true) 
+	    std::memset(dst + start, 0, sizeof(sample_t) * (end - start));
+	  kernel(&part, 1, dst + start, src->buffersize_rep - start, weight, true);
+	  stored = true;
+	  continue;
+	}
+
+	group[grouped++] = src->buffer[c] + start;
+	if (grouped == SAMPLE_BUFFER_CONVERT::max_mix_sources) {
+	  kernel(group, grouped, dst + start, end - start, weight, stored);
+	  stored = true;
+	  grouped = 0;
+	}
+      }
+      if (grouped > 0) {
+	kernel(group, grouped, dst + start, end - start, weight, stored);
+	stored = true;
+      }
+      if (stored != true)
+	std::memset(dst + start, 0, sizeof(sample_t) * (end - start));
     }
   }
 }
@@ -349,7 +486,8 @@ void SAMPLE_BUFFER::multiply_by(SAMPLE_BUFFER::sample_t factor, int channel)
 			    reinterpret_cast<const float*>(&factor), 
 			    buffersize_rep);
 #else
-  multiply_by_ref(factor, channel);
+  const sample_t* src = buffer[channel];
+  SAMPLE_BUFFER_CONVERT::mix_kernel()(&src, 1, buffer[channel], buffersize_rep, factor, false);
 #endif
 }
 
@@ -363,16 +501,18 @@ void SAMPLE_BUFFER::multiply_by(SAMPLE_BUFFER::sample_t factor)
 void SAMPLE_BUFFER::multiply_by_ref(SAMPLE_BUFFER::sample_t factor)
 {
   for(channel_size_t n = 0; n < channel_count_rep; n++) {
+    sample_t* data = channel_data(n);
     for(buf_size_t m = 0; m < buffersize_rep; m++) {
-      buffer[n][m] *= factor;
+      data[m] *= factor;
     }
   }
 }
 
 void SAMPLE_BUFFER::multiply_by_ref(SAMPLE_BUFFER::sample_t factor, int channel)
 {
+  sample_t* data = channel_data(channel);
   for(buf_size_t m = 0; m < buffersize_rep; m++) {
-    buffer[channel][m] *= factor;
+    data[m] *= factor;
   }
 }
 
@@ -483,11 +623,12 @@ void SAMPLE_BUFFER::make_silent_range_ref(buf_size_t start_pos,
 void SAMPLE_BUFFER::limit_values(void)
 {
   for(channel_size_t n = 0; n < channel_count_rep; n++) {
+    sample_t* data = channel_data(n);
     for(buf_size_t m = 0; m < buffersize_rep; m++) {
-      if (buffer[n][m] > SAMPLE_SPECS::impl_max_value) 
-	buffer[n][m] = SAMPLE_SPECS::impl_max_value;
-      else if (buffer[n][m] < SAMPLE_SPECS::impl_min_value) 
-	buffer[n][m] = SAMPLE_SPECS::impl_min_value;
+      if (data[m] > SAMPLE_SPECS::impl_max_value) 
+	data[m] = SAMPLE_SPECS::impl_max_value;
+      else if (data[m] < SAMPLE_SPECS::impl_min_value) 
+	data[m] = SAMPLE_SPECS::impl_min_value;
     }
   }
   
@@ -709,15 +850,32 @@ void SAMPLE_BUFFER::export_interleaved(unsigned char* target,
 
   if (chcount > channel_count_rep) number_of_channels(chcount);
 
-  buf_size_t osize = 0;
-  for(buf_size_t isize = 0; isize < buffersize_rep; isize++) {
-    for(channel_size_t c = 0; c < chcount; c++) {
-      sample_t stemp = buffer[c][isize];
-      if (coding != ECA_AUDIO_FORMAT::sc_float) {
-        if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
-        else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+  SAMPLE_BUFFER_CONVERT::export_kernel_t kernel = 
+    SAMPLE_BUFFER_CONVERT::export_kernel(fmt);
+  if (kernel != 0) {
+    int ssize = SAMPLE_BUFFER_CONVERT::sample_size(fmt);
+    buf_size_t chunk = priv_convert_chunk_frames(ssize * chcount);
+    for(buf_size_t start = 0; start < buffersize_rep; start += chunk) {
+      buf_size_t count = buffersize_rep - start;
+      if (count > chunk) count = chunk;
+      unsigned char* frames = target + start * ssize * chcount;
+      for(channel_size_t c = 0; c < chcount; c++) {
+	kernel(buffer[c] + start, frames + c * ssize, ssize * chcount, count,
+	       coding != ECA_AUDIO_FORMAT::sc_float);
+      }
+    }
+  }
+  else {
+    buf_size_t osize = 0;
+    for(buf_size_t isize = 0; isize < buffersize_rep; isize++) {
+      for(channel_size_t c = 0; c < chcount; c++) {
+        sample_t stemp = buffer[c][isize];
+        if (coding != ECA_AUDIO_FORMAT::sc_float) {
+          if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
+          else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+        }
+        SAMPLE_BUFFER::export_helper(target, &osize, stemp, fmt);
       }
-      SAMPLE_BUFFER::export_helper(target, &osize, stemp, fmt);
     }
   }
   
@@ -749,15 +907,26 @@ void SAMPLE_BUFFER::export_noninterleaved(unsigned char* target,
 
   if (chcount > channel_count_rep) number_of_channels(chcount);
 
-  buf_size_t osize = 0;
-  for(channel_size_t c = 0; c < chcount; c++) {
-    for(buf_size_t isize = 0; isize < buffersize_rep; isize++) {
-      sample_t stemp = buffer[c][isize];
-      if (coding != ECA_AUDIO_FORMAT::sc_float) {
-        if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
-        else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+  SAMPLE_BUFFER_CONVERT::export_kernel_t kernel = 
+    SAMPLE_BUFFER_CONVERT::export_kernel(fmt);
+  if (kernel != 0) {
+    int ssize = SAMPLE_BUFFER_CONVERT::sample_size(fmt);
+    for(channel_size_t c = 0; c < chcount; c++) {
+      kernel(buffer[c], target + c * ssize * buffersize_rep, ssize, buffersize_rep,
+	     coding != ECA_AUDIO_FORMAT::sc_float);
+    }
+  }
+  else {
+    buf_size_t osize = 0;
+    for(channel_size_t c = 0; c < chcount; c++) {
+      for(buf_size_t isize = 0; isize < buffersize_rep; isize++) {
+        sample_t stemp = buffer[c][isize];
+        if (coding != ECA_AUDIO_FORMAT::sc_float) {
+          if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
+          else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+        }
+        SAMPLE_BUFFER::export_helper(target, &osize, stemp, fmt);
       }
-      SAMPLE_BUFFER::export_helper(target, &osize, stemp, fmt);
     }
   }
 
@@ -961,11 +1130,26 @@ void SAMPLE_BUFFER::import_interleaved(unsigned char* source,
   if (channel_count_rep != chcount) number_of_channels(chcount);
   if (buffersize_rep != samples_read) length_in_samples(samples_read);
 
-  buf_size_t isize = 0;
-
-  for(buf_size_t osize = 0; osize < buffersize_rep; osize++) {
-    for(channel_size_t c = 0; c < chcount; c++) {
-      import_helper(source, &isize, buffer[c], osize, fmt);
+  SAMPLE_BUFFER_CONVERT::import_kernel_t kernel = 
+    SAMPLE_BUFFER_CONVERT::import_kernel(fmt);
+  if (kernel != 0) {
+    int ssize = SAMPLE_BUFFER_CONVERT::sample_size(fmt);
+    buf_size_t chunk = priv_convert_chunk_frames(ssize * chcount);
+    for(buf_size_t start = 0; start < buffersize_rep; start += chunk) {
+      buf_size_t count = buffersize_rep - start;
+      if (count > chunk) count = chunk;
+      const unsigned char* frames = source + start * ssize * chcount;
+      for(channel_size_t c = 0; c < chcount; c++) {
+	kernel(frames + c * ssize, ssize * chcount, buffer[c] + start, count);
+      }
+    }
+  }
+  else {
+    buf_size_t isize = 0;
+    for(buf_size_t osize = 0; osize < buffersize_rep; osize++) {
+      for(channel_size_t c = 0; c < chcount; c++) {
+        import_helper(source, &isize, buffer[c], osize, fmt);
+      }
     }
   }
 }
@@ -990,10 +1174,20 @@ void SAMPLE_BUFFER::import_noninterleaved(unsigned char* source,
   if (channel_count_rep != chcount) number_of_channels(chcount);
   if (buffersize_rep != samples_read) length_in_samples(samples_read);
 
-  buf_size_t isize = 0;
-  for(channel_size_t c = 0; c < chcount; c++) {
-    for(buf_size_t osize = 0; osize < buffersize_rep; osize++) {
-      import_helper(source, &isize, buffer[c], osize, fmt);
+  SAMPLE_BUFFER_CONVERT::import_kernel_t kernel = 
+    SAMPLE_BUFFER_CONVERT::import_kernel(fmt);
+  if (kernel != 0) {
+    int ssize = SAMPLE_BUFFER_CONVERT::sample_size(fmt);
+    for(channel_size_t c = 0; c < chcount; c++) {
+      kernel(source + c * ssize * buffersize_rep, ssize, buffer[c], buffersize_rep);
+    }
+  }
+  else {
+    buf_size_t isize = 0;
+    for(channel_size_t c = 0; c < chcount; c++) {
+      for(buf_size_t osize = 0; osize < buffersize_rep; osize++) {
+        import_helper(source, &isize, buffer[c], osize, fmt);
+      }
     }
   }
 }
@@ -1008,11 +1202,7 @@ void SAMPLE_BUFFER::number_of_channels(channel_size_t len)
   if (len > static_cast<channel_size_t>(buffer.size())) {
     DBC_CHECK(impl_repp->rt_lock_rep != true);
 
-    size_t old_size = buffer.size();
-    buffer.resize(len);
-    for(channel_size_t n = old_size; n < len; n++) {
-      priv_alloc_sample_buf(&buffer[n], sizeof(sample_t) * reserved_samples_rep);
-    }
+    reallocate_channels(len, reserved_samples_rep);
     ECA_LOG_MSG(ECA_LOGGER::functions, "Increasing channel-count (1).");    
   }
 
@@ -1048,14 +1238,7 @@ void SAMPLE_BUFFER::length_in_samples(buf_size_t len)
     DBC_CHECK(impl_repp->rt_lock_rep != true);
     DBC_CHECK(impl_repp->lockref_rep == 0);
 
-    reserved_samples_rep = len * 2;
-    for(size_t n = 0; n < buffer.size(); n++) {
-      sample_t *prev_buffer = buffer[n];
-      priv_alloc_sample_buf(&buffer[n], sizeof(sample_t) * reserved_samples_rep);
-      for (buf_size_t m = 0; m < buffersize_rep; m++)
-	buffer[n][m] = prev_buffer[m];
-      ::free(prev_buffer);
-    }
+    reallocate_channels(buffer.size(), len * 2);
 
     if (impl_repp->old_buffer_repp != 0) {
       ::free(impl_repp->old_buffer_repp);
@@ -1101,17 +1284,12 @@ void SAMPLE_BUFFER::resample_init_memory(SAMPLE_SPECS::sample_rate_t from_srate,
   buf_size_t new_buffer_size = static_cast<buf_size_t>((step * buffersize_rep)) + sizeof(buf_size_t);
 
   if (new_buffer_size > reserved_samples_rep) {
-    reserved_samples_rep = new_buffer_size * 2;
-
 #ifdef ECA_DEBUG_MODE
     DBC_CHECK(impl_repp->rt_lock_rep != true);
     DBC_CHECK(impl_repp->lockref_rep == 0);
 #endif
 
-    for(int c = 0; c < channel_count_rep; c++) {
-      ::free(buffer[c]);
-      priv_alloc_sample_buf(&buffer[c], sizeof(sample_t) * reserved_samples_rep);
-    }
+    reallocate_channels(buffer.size(), new_buffer_size * 2);
   }
 
 #ifdef ECA_COMPILE_SAMPLERATE
@@ -1140,6 +1318,45 @@ void SAMPLE_BUFFER::resample_init_memory(SAMPLE_SPECS::sample_rate_t from_srate,
   }
 }
 
+/**
+ * Reserves room for 'channels' channels of 'samples' 
+ * samples. Existing data is preserved and new space 
+ * is muted. Sets reserved_samples_rep to 'samples'.
+ *
+ * All channels are moved to one new contiguous block,
+ * each channel starting at an aligned address, so
+ * pointers to old channel data become invalid. Allocates
+ * memory, so must not be called from real-time context.
+ */
+void SAMPLE_BUFFER::reallocate_channels(channel_size_t channels, buf_size_t samples)
+{
+  size_t old_channels = buffer.size();
+  buf_size_t stride = priv_channel_stride(samples);
+  void* slab = 0;
+  sample_t* base = 0;
+  if (channels > 0) {
+    size_t bytes = sizeof(sample_t) * stride * channels;
+    base = priv_alloc_aligned_buf(&slab, bytes);
+    DBC_CHECK(base != 0);
+    std::memset(base, 0, bytes);
+  }
+
+  buf_size_t keep = (samples < reserved_samples_rep) ? samples : reserved_samples_rep;
+  buffer.resize(channels);
+  for(channel_size_t n = 0; n < channels; n++) {
+    sample_t* dst = base + n * stride;
+    if (static_cast<size_t>(n) < old_channels && keep > 0)
+      std::memcpy(dst, buffer[n], sizeof(sample_t) * keep);
+    buffer[n] = dst;
+  }
+
+  if (impl_repp->slab_repp != 0)
+    ::free(impl_repp->slab_repp);
+  impl_repp->slab_repp = slab;
+  impl_repp->channel_stride_rep = stride;
+  reserved_samples_rep = samples;
+}
+
 void SAMPLE_BUFFER::reserve_channels(channel_size_t num)
 {
   channel_size_t oldcount = number_of_channels();
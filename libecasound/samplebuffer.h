@@ -30,6 +30,13 @@ class SAMPLE_BUFFER_impl;
  *  - reserving space before-hand
  *  - realtime-safety and pointer locking
  *  - access to event tags
+ *
+ * Audio data of all channels is stored in one contiguous 
+ * block of memory. Each channel starts at a boundary of 
+ * 'channel_alignment' bytes. Growing the channel count
+ * or length beyond the reserved space moves all channels
+ * to a new block, so users that store pointers to channel
+ * data should reserve space before taking the pointers.
  */
 class SAMPLE_BUFFER {
 
@@ -48,6 +55,9 @@ class SAMPLE_BUFFER {
   typedef long int buf_size_t;
   typedef SAMPLE_SPECS::sample_t sample_t;
 
+  /* alignment of channel data in bytes (one cache line) */
+  static const int channel_alignment = 64;
+
   enum Tag_name {
     /* buffer contains last samples of a stream */
     tag_end_of_stream = 1,
@@ -81,6 +91,7 @@ class SAMPLE_BUFFER {
   void add_matching_channels(const SAMPLE_BUFFER& x);
   void add_matching_channels_ref(const SAMPLE_BUFFER& x);
   void add_with_weight(const SAMPLE_BUFFER& x, int weight);
+  void mix_matching_channels(SAMPLE_BUFFER* const* sources, int count, sample_t weight);
   void copy_matching_channels(const SAMPLE_BUFFER& x);
   void copy_all_content(const SAMPLE_BUFFER& x);
   void copy_range(const SAMPLE_BUFFER& x, buf_size_t start_pos, buf_size_t end_pos, buf_size_t to_pos);
@@ -171,6 +182,7 @@ class SAMPLE_BUFFER {
   void resample_simplefilter(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
   void resample_nofilter(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
   void resample_with_memory(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
+  void reallocate_channels(channel_size_t channels, buf_size_t samples);
 
   static void import_helper(const unsigned char *ibuffer,
 			    buf_size_t* iptr,
@@ -196,9 +208,24 @@ class SAMPLE_BUFFER {
    * If you do use direct access, then you must also 
    * use the get_pointer_reflock() and release_pointer_reflock()
    * calls so that reference counting is possible.
+   *
+   * Pointers in 'buffer' point to the shared storage
+   * of all channels, and must not be modified or freed.
    */
   std::vector<sample_t*> buffer;
 
+  /**
+   * Returns data of channel 'channel', marked as aligned
+   * to 'channel_alignment' bytes for the compiler.
+   */
+  inline sample_t* channel_data(channel_size_t channel) const {
+#if defined(__clang__) || __GNUC__ >= 5
+    return static_cast<sample_t*>(__builtin_assume_aligned(buffer[channel], channel_alignment));
+#else
+    return buffer[channel];
+#endif
+  }
+
   /*@}*/
 
  private:
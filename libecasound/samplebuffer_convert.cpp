@@ -0,0 +1,987 @@
+// ------------------------------------------------------------------------
+// samplebuffer_convert.cpp: Block conversion kernels for SAMPLE_BUFFER
+// Copyright (C) 2026 Kai Vehmanen
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstring> /* memcpy */
+
+#include <kvu_inttypes.h>
+
+#include "eca-sample-conversion.h"
+#include "samplebuffer_convert.h"
+
+/**
+ * x86 kernels are compiled with per-function target
+ * attributes, so no special compiler flags are needed,
+ * and they are only called if the CPU supports them.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(WORDS_BIGENDIAN) && (__GNUC__ >= 5 || defined(__clang__))
+#define ECA_CONVERT_X86
+#include <immintrin.h>
+#define ECA_TARGET_SSE2 __attribute__((target("sse2")))
+#define ECA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+typedef SAMPLE_SPECS::sample_t sample_t;
+typedef SAMPLE_BUFFER_CONVERT::Kernel_type Kernel_type;
+
+static Kernel_type priv_detect_kernel_type(void)
+{
+#ifdef ECA_CONVERT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SAMPLE_BUFFER_CONVERT::kernel_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return SAMPLE_BUFFER_CONVERT::kernel_sse2;
+#endif
+  return SAMPLE_BUFFER_CONVERT::kernel_scalar;
+}
+
+static const Kernel_type best_kernel_type_rep = priv_detect_kernel_type();
+static Kernel_type kernel_type_rep = best_kernel_type_rep;
+
+static const int max_mix_sources = SAMPLE_BUFFER_CONVERT::max_mix_sources;
+
+static const float s16_pos_limit = ((float)0x7fff) / 0x8000;
+static const float s32_pos_limit = ((float)0x7fffff) / 0x800000;
+
+static inline sample_t priv_clip(sample_t value)
+{
+  if (value > SAMPLE_SPECS::impl_max_value) return SAMPLE_SPECS::impl_max_value;
+  else if (value < SAMPLE_SPECS::impl_min_value) return SAMPLE_SPECS::impl_min_value;
+  return value;
+}
+
+/**
+ * Raw sample formats
+ *
+ * Integer formats: load() returns the sample left-justified
+ * in 32 bits, convert() returns the value written by
+ * store(), and 'bits' tells whether convert() produces 16
+ * or 32 bit values.
+ *
+ * Floating point formats: load() and store() operate on
+ * the bit pattern of the value.
+ *
+ * The byte-level access is independent of the host byte
+ * order.
+ */
+
+struct FMT_S16_LE {
+  enum { size = 2, big_endian = 0, bits = 16 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[1] << 24) | ((uint32_t)p[0] << 16));
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s16(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    p[0] = (unsigned char)(v & 0xff);
+    p[1] = (unsigned char)((v >> 8) & 0xff);
+  }
+};
+
+struct FMT_S16_BE {
+  enum { size = 2, big_endian = 1, bits = 16 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16));
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s16(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    p[0] = (unsigned char)((v >> 8) & 0xff);
+    p[1] = (unsigned char)(v & 0xff);
+  }
+};
+
+struct FMT_S24_LE {
+  enum { size = 3, big_endian = 0, bits = 32 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8));
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s32(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    /* skip the LSB-byte of v (v & 0xff) */
+    p[0] = (unsigned char)((v >> 8) & 0xff);
+    p[1] = (unsigned char)((v >> 16) & 0xff);
+    p[2] = (unsigned char)((v >> 24) & 0xff);
+  }
+};
+
+struct FMT_S24_BE {
+  enum { size = 3, big_endian = 1, bits = 32 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8));
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s32(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    p[0] = (unsigned char)((v >> 24) & 0xff);
+    p[1] = (unsigned char)((v >> 16) & 0xff);
+    p[2] = (unsigned char)((v >> 8) & 0xff);
+    /* skip the LSB-byte of v (v & 0xff) */
+  }
+};
+
+struct FMT_S32_LE {
+  enum { size = 4, big_endian = 0, bits = 32 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+		     ((uint32_t)p[1] << 8) | (uint32_t)p[0]);
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s32(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    p[0] = (unsigned char)(v & 0xff);
+    p[1] = (unsigned char)((v >> 8) & 0xff);
+    p[2] = (unsigned char)((v >> 16) & 0xff);
+    p[3] = (unsigned char)((v >> 24) & 0xff);
+  }
+};
+
+struct FMT_S32_BE {
+  enum { size = 4, big_endian = 1, bits = 32 };
+  static inline int32_t load(const unsigned char* p) {
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+		     ((uint32_t)p[2] << 8) | (uint32_t)p[3]);
+  }
+  static inline int32_t convert(sample_t v) { return eca_sample_convert_float_to_s32(v); }
+  static inline void store(unsigned char* p, int32_t v) {
+    p[0] = (unsigned char)((v >> 24) & 0xff);
+    p[1] = (unsigned char)((v >> 16) & 0xff);
+    p[2] = (unsigned char)((v >> 8) & 0xff);
+    p[3] = (unsigned char)(v & 0xff);
+  }
+};
+
+struct FMT_F32_LE {
+  enum { size = 4, big_endian = 0 };
+  static inline uint32_t load(const unsigned char* p) { return FMT_S32_LE::load(p); }
+  static inline void store(unsigned char* p, uint32_t v) { FMT_S32_LE::store(p, v); }
+};
+
+struct FMT_F32_BE {
+  enum { size = 4, big_endian = 1 };
+  static inline uint32_t load(const unsigned char* p) { return FMT_S32_BE::load(p); }
+  static inline void store(unsigned char* p, uint32_t v) { FMT_S32_BE::store(p, v); }
+};
+
+struct FMT_F64_LE {
+  enum { size = 8, big_endian = 0 };
+  static inline uint64_t load(const unsigned char* p) {
+    return ((uint64_t)(uint32_t)FMT_S32_LE::load(p + 4) << 32) | (uint32_t)FMT_S32_LE::load(p);
+  }
+  static inline void store(unsigned char* p, uint64_t v) {
+    FMT_S32_LE::store(p, (uint32_t)v);
+    FMT_S32_LE::store(p + 4, (uint32_t)(v >> 32));
+  }
+};
+
+struct FMT_F64_BE {
+  enum { size = 8, big_endian = 1 };
+  static inline uint64_t load(const unsigned char* p) {
+    return ((uint64_t)(uint32_t)FMT_S32_BE::load(p) << 32) | (uint32_t)FMT_S32_BE::load(p + 4);
+  }
+  static inline void store(unsigned char* p, uint64_t v) {
+    FMT_S32_BE::store(p, (uint32_t)(v >> 32));
+    FMT_S32_BE::store(p + 4, (uint32_t)v);
+  }
+};
+
+/* ---------------------------------------------------------------------
+ * Scalar kernels
+ */
+
+template<class FMT>
+static void priv_import_int(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  for(long int n = 0; n < count; n++) {
+    target[n] = eca_sample_convert_s32_to_float(FMT::load(source));
+    source += stride;
+  }
+}
+
+template<class FMT>
+static void priv_export_int(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  for(long int n = 0; n < count; n++) {
+    sample_t value = (clip == true) ? priv_clip(source[n]) : source[n];
+    FMT::store(target, FMT::convert(value));
+    target += stride;
+  }
+}
+
+template<class FMT>
+static void priv_import_f32(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  for(long int n = 0; n < count; n++) {
+    uint32_t bits = FMT::load(source);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    target[n] = value;
+    source += stride;
+  }
+}
+
+template<class FMT>
+static void priv_export_f32(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  for(long int n = 0; n < count; n++) {
+    float value = (clip == true) ? priv_clip(source[n]) : source[n];
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    FMT::store(target, bits);
+    target += stride;
+  }
+}
+
+static void priv_mix(const sample_t* const* sources, int nsources, sample_t* target, long int count, sample_t weight, bool add)
+{
+  for(long int n = 0; n < count; n++) {
+    sample_t acc = (add == true) ? target[n] + sources[0][n] * weight : sources[0][n] * weight;
+    for(int i = 1; i < nsources; i++)
+      acc = acc + sources[i][n] * weight;
+    target[n] = acc;
+  }
+}
+
+template<class FMT>
+static void priv_import_f64(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  for(long int n = 0; n < count; n++) {
+    uint64_t bits = FMT::load(source);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    target[n] = static_cast<sample_t>(value);
+    source += stride;
+  }
+}
+
+template<class FMT>
+static void priv_export_f64(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  for(long int n = 0; n < count; n++) {
+    double value = (clip == true) ? priv_clip(source[n]) : source[n];
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    FMT::store(target, bits);
+    target += stride;
+  }
+}
+
+#ifdef ECA_CONVERT_X86
+
+/* ---------------------------------------------------------------------
+ * SSE2 kernels
+ *
+ * Contiguous data is loaded and stored with vector
+ * instructions, strided data is gathered with scalar loads.
+ * Conversion arithmetic is done four samples at a time.
+ */
+
+static inline ECA_TARGET_SSE2 __m128i priv_bswap16_sse2(__m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static inline ECA_TARGET_SSE2 __m128i priv_bswap32_sse2(__m128i x)
+{
+  x = _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+  return priv_bswap16_sse2(x);
+}
+
+/**
+ * Converts four samples to 16 or 32 bit integers with the
+ * same rounding and limits as eca_sample_convert_float_to_s16()
+ * and eca_sample_convert_float_to_s32().
+ */
+template<int BITS>
+static inline ECA_TARGET_SSE2 __m128i priv_float_to_int_sse2(__m128 v)
+{
+  const __m128 scale = _mm_set1_ps((BITS == 16) ? 32768.0f : 2147483648.0f);
+  const __m128 limit = _mm_set1_ps((BITS == 16) ? s16_pos_limit : s32_pos_limit);
+  const __m128i maxval = _mm_set1_epi32((BITS == 16) ? INT16_MAX : INT32_MAX);
+  __m128i mask = _mm_castps_si128(_mm_cmpge_ps(v, limit));
+  __m128i res = _mm_cvttps_epi32(_mm_mul_ps(v, scale));
+  return _mm_or_si128(_mm_and_si128(mask, maxval), _mm_andnot_si128(mask, res));
+}
+
+static inline ECA_TARGET_SSE2 __m128 priv_clip_sse2(__m128 v)
+{
+  return _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(SAMPLE_SPECS::impl_min_value)),
+		    _mm_set1_ps(SAMPLE_SPECS::impl_max_value));
+}
+
+/**
+ * Stores four 32 bit lanes to 'stride' separated raw samples.
+ * Lanes are moved directly to general purpose registers, as
+ * going through a temporary array stalls on store forwarding.
+ */
+template<class FMT>
+static inline ECA_TARGET_SSE2 void priv_scatter_sse2(unsigned char* target, long int stride, __m128i res)
+{
+  FMT::store(target, _mm_cvtsi128_si32(res));
+  FMT::store(target + stride, _mm_cvtsi128_si32(_mm_srli_si128(res, 4)));
+  FMT::store(target + 2 * stride, _mm_cvtsi128_si32(_mm_srli_si128(res, 8)));
+  FMT::store(target + 3 * stride, _mm_cvtsi128_si32(_mm_srli_si128(res, 12)));
+}
+
+template<class FMT>
+static ECA_TARGET_SSE2 void priv_import_int_sse2(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+  long int n = 0;
+
+  if (FMT::size == 2 && stride == 2) {
+    for(; n + 8 <= count; n += 8) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+      if (FMT::big_endian) raw = priv_bswap16_sse2(raw);
+      __m128i lo = _mm_unpacklo_epi16(_mm_setzero_si128(), raw);
+      __m128i hi = _mm_unpackhi_epi16(_mm_setzero_si128(), raw);
+      _mm_storeu_ps(target + n, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(target + n + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+      source += 16;
+    }
+  }
+  else if (FMT::size == 4 && stride == 4) {
+    for(; n + 4 <= count; n += 4) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+      if (FMT::big_endian) raw = priv_bswap32_sse2(raw);
+      _mm_storeu_ps(target + n, _mm_mul_ps(_mm_cvtepi32_ps(raw), scale));
+      source += 16;
+    }
+  }
+  else {
+    for(; n + 4 <= count; n += 4) {
+      __m128i raw = _mm_set_epi32(FMT::load(source + 3 * stride),
+				  FMT::load(source + 2 * stride),
+				  FMT::load(source + stride),
+				  FMT::load(source));
+      _mm_storeu_ps(target + n, _mm_mul_ps(_mm_cvtepi32_ps(raw), scale));
+      source += 4 * stride;
+    }
+  }
+
+  priv_import_int<FMT>(source, stride, target + n, count - n);
+}
+
+template<class FMT>
+static ECA_TARGET_SSE2 void priv_export_int_sse2(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  long int n = 0;
+
+  if (FMT::size == 2 && stride == 2) {
+    for(; n + 8 <= count; n += 8) {
+      __m128 v1 = _mm_loadu_ps(source + n);
+      __m128 v2 = _mm_loadu_ps(source + n + 4);
+      if (clip == true) {
+	v1 = priv_clip_sse2(v1);
+	v2 = priv_clip_sse2(v2);
+      }
+      /* note: truncate to 16 bits before packing, like
+       *       the scalar conversion does */
+      __m128i s1 = _mm_srai_epi32(_mm_slli_epi32(priv_float_to_int_sse2<FMT::bits>(v1), 16), 16);
+      __m128i s2 = _mm_srai_epi32(_mm_slli_epi32(priv_float_to_int_sse2<FMT::bits>(v2), 16), 16);
+      __m128i res = _mm_packs_epi32(s1, s2);
+      if (FMT::big_endian) res = priv_bswap16_sse2(res);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target), res);
+      target += 16;
+    }
+  }
+  else {
+    for(; n + 4 <= count; n += 4) {
+      __m128 v = _mm_loadu_ps(source + n);
+      if (clip == true) v = priv_clip_sse2(v);
+      __m128i res = priv_float_to_int_sse2<FMT::bits>(v);
+      if (FMT::size == 4 && stride == 4) {
+	if (FMT::big_endian) res = priv_bswap32_sse2(res);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(target), res);
+	target += 16;
+      }
+      else {
+	priv_scatter_sse2<FMT>(target, stride, res);
+	target += 4 * stride;
+      }
+    }
+  }
+
+  priv_export_int<FMT>(source + n, target, stride, count - n, clip);
+}
+
+template<class FMT>
+static ECA_TARGET_SSE2 void priv_import_f32_sse2(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  long int n = 0;
+  for(; n + 4 <= count; n += 4) {
+    __m128i raw;
+    if (stride == 4) {
+      raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+      if (FMT::big_endian) raw = priv_bswap32_sse2(raw);
+    }
+    else {
+      raw = _mm_set_epi32(FMT::load(source + 3 * stride),
+			  FMT::load(source + 2 * stride),
+			  FMT::load(source + stride),
+			  FMT::load(source));
+    }
+    _mm_storeu_ps(target + n, _mm_castsi128_ps(raw));
+    source += 4 * stride;
+  }
+
+  priv_import_f32<FMT>(source, stride, target + n, count - n);
+}
+
+template<class FMT>
+static ECA_TARGET_SSE2 void priv_export_f32_sse2(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  long int n = 0;
+  for(; n + 4 <= count; n += 4) {
+    __m128 v = _mm_loadu_ps(source + n);
+    if (clip == true) v = priv_clip_sse2(v);
+    __m128i res = _mm_castps_si128(v);
+    if (stride == 4) {
+      if (FMT::big_endian) res = priv_bswap32_sse2(res);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target), res);
+      target += 16;
+    }
+    else {
+      priv_scatter_sse2<FMT>(target, stride, res);
+      target += 4 * stride;
+    }
+  }
+
+  priv_export_f32<FMT>(source + n, target, stride, count - n, clip);
+}
+
+static ECA_TARGET_SSE2 void priv_mix_sse2(const sample_t* const* sources, int nsources, sample_t* target, long int count, sample_t weight, bool add)
+{
+  const __m128 w = _mm_set1_ps(weight);
+  long int n = 0;
+  for(; n + 8 <= count; n += 8) {
+    __m128 a = _mm_mul_ps(_mm_loadu_ps(sources[0] + n), w);
+    __m128 b = _mm_mul_ps(_mm_loadu_ps(sources[0] + n + 4), w);
+    if (add == true) {
+      a = _mm_add_ps(_mm_loadu_ps(target + n), a);
+      b = _mm_add_ps(_mm_loadu_ps(target + n + 4), b);
+    }
+    for(int i = 1; i < nsources; i++) {
+      a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(sources[i] + n), w));
+      b = _mm_add_ps(b, _mm_mul_ps(_mm_loadu_ps(sources[i] + n + 4), w));
+    }
+    _mm_storeu_ps(target + n, a);
+    _mm_storeu_ps(target + n + 4, b);
+  }
+
+  if (n < count) {
+    const sample_t* rest[max_mix_sources];
+    for(int i = 0; i < nsources; i++) rest[i] = sources[i] + n;
+    priv_mix(rest, nsources, target + n, count - n, weight, add);
+  }
+}
+
+/* ---------------------------------------------------------------------
+ * AVX2 kernels
+ *
+ * Strided data is loaded with gather instructions, eight
+ * samples at a time. The remaining samples are handled by
+ * the scalar kernels, which are compiled without AVX, so the
+ * upper register halves are cleared before calling them to
+ * avoid the SSE/AVX transition penalty.
+ */
+
+static inline ECA_TARGET_AVX2 __m256i priv_bswap32_avx2(__m256i x)
+{
+  const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+					3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  return _mm256_shuffle_epi8(x, mask);
+}
+
+static inline ECA_TARGET_AVX2 __m256i priv_bswap64_avx2(__m256i x)
+{
+  const __m256i mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+					7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  return _mm256_shuffle_epi8(x, mask);
+}
+
+static inline ECA_TARGET_AVX2 __m128i priv_bswap16_avx2(__m128i x)
+{
+  const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  return _mm_shuffle_epi8(x, mask);
+}
+
+template<int BITS>
+static inline ECA_TARGET_AVX2 __m256i priv_float_to_int_avx2(__m256 v)
+{
+  const __m256 scale = _mm256_set1_ps((BITS == 16) ? 32768.0f : 2147483648.0f);
+  const __m256 limit = _mm256_set1_ps((BITS == 16) ? s16_pos_limit : s32_pos_limit);
+  const __m256i maxval = _mm256_set1_epi32((BITS == 16) ? INT16_MAX : INT32_MAX);
+  __m256i mask = _mm256_castps_si256(_mm256_cmp_ps(v, limit, _CMP_GE_OQ));
+  __m256i res = _mm256_cvttps_epi32(_mm256_mul_ps(v, scale));
+  return _mm256_blendv_epi8(res, maxval, mask);
+}
+
+static inline ECA_TARGET_AVX2 __m256 priv_clip_avx2(__m256 v)
+{
+  return _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(SAMPLE_SPECS::impl_min_value)),
+		       _mm256_set1_ps(SAMPLE_SPECS::impl_max_value));
+}
+
+/**
+ * Stores eight 32 bit lanes to 'stride' separated raw samples.
+ */
+template<class FMT>
+static inline ECA_TARGET_AVX2 void priv_scatter_avx2(unsigned char* target, long int stride, __m256i res)
+{
+  __m128i lo = _mm256_castsi256_si128(res);
+  __m128i hi = _mm256_extracti128_si256(res, 1);
+  FMT::store(target, _mm_cvtsi128_si32(lo));
+  FMT::store(target + stride, _mm_extract_epi32(lo, 1));
+  FMT::store(target + 2 * stride, _mm_extract_epi32(lo, 2));
+  FMT::store(target + 3 * stride, _mm_extract_epi32(lo, 3));
+  target += 4 * stride;
+  FMT::store(target, _mm_cvtsi128_si32(hi));
+  FMT::store(target + stride, _mm_extract_epi32(hi, 1));
+  FMT::store(target + 2 * stride, _mm_extract_epi32(hi, 2));
+  FMT::store(target + 3 * stride, _mm_extract_epi32(hi, 3));
+}
+
+static inline ECA_TARGET_AVX2 __m256i priv_gather_index_avx2(long int stride)
+{
+  return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+			    _mm256_set1_epi32(static_cast<int>(stride)));
+}
+
+/**
+ * Largest stride for which gather indices fit into 32 bits.
+ */
+static const long int max_gather_stride = 0x7fffffff / 8;
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_import_int_avx2(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  const __m256i index = priv_gather_index_avx2(stride);
+  long int n = 0;
+
+  if (FMT::size == 2 && stride == 2) {
+    for(; n + 8 <= count; n += 8) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+      if (FMT::big_endian) raw = priv_bswap16_avx2(raw);
+      __m256i res = _mm256_slli_epi32(_mm256_cvtepi16_epi32(raw), 16);
+      _mm256_storeu_ps(target + n, _mm256_mul_ps(_mm256_cvtepi32_ps(res), scale));
+      source += 16;
+    }
+  }
+  else if (stride <= max_gather_stride) {
+    /* note: gathers read four bytes per sample, so for 16 and
+     *       24 bit samples the last sample is left to the scalar
+     *       code to avoid reading past the end of 'source' */
+    long int last = (FMT::size < 4) ? count - 1 : count;
+    for(; n + 8 <= last; n += 8) {
+      __m256i raw;
+      if (FMT::size == 4 && stride == 4)
+	raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+      else
+	raw = _mm256_i32gather_epi32(reinterpret_cast<const int*>(source), index, 1);
+      if (FMT::big_endian) {
+	raw = priv_bswap32_avx2(raw);
+	if (FMT::size < 4)
+	  raw = _mm256_and_si256(raw, _mm256_set1_epi32(~0u << (32 - 8 * FMT::size)));
+      }
+      else if (FMT::size < 4) {
+	raw = _mm256_slli_epi32(raw, 32 - 8 * FMT::size);
+      }
+      _mm256_storeu_ps(target + n, _mm256_mul_ps(_mm256_cvtepi32_ps(raw), scale));
+      source += 8 * stride;
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_import_int<FMT>(source, stride, target + n, count - n);
+}
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_export_int_avx2(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  long int n = 0;
+  for(; n + 8 <= count; n += 8) {
+    __m256 v = _mm256_loadu_ps(source + n);
+    if (clip == true) v = priv_clip_avx2(v);
+    __m256i res = priv_float_to_int_avx2<FMT::bits>(v);
+    if (FMT::size == 2 && stride == 2) {
+      /* note: truncate to 16 bits before packing, like
+       *       the scalar conversion does */
+      res = _mm256_srai_epi32(_mm256_slli_epi32(res, 16), 16);
+      res = _mm256_permute4x64_epi64(_mm256_packs_epi32(res, res), 0x08);
+      __m128i res16 = _mm256_castsi256_si128(res);
+      if (FMT::big_endian) res16 = priv_bswap16_avx2(res16);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target), res16);
+      target += 16;
+    }
+    else if (FMT::size == 4 && stride == 4) {
+      if (FMT::big_endian) res = priv_bswap32_avx2(res);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), res);
+      target += 32;
+    }
+    else {
+      priv_scatter_avx2<FMT>(target, stride, res);
+      target += 8 * stride;
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_export_int<FMT>(source + n, target, stride, count - n, clip);
+}
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_import_f32_avx2(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  const __m256i index = priv_gather_index_avx2(stride);
+  long int n = 0;
+  if (stride <= max_gather_stride) {
+    for(; n + 8 <= count; n += 8) {
+      __m256i raw;
+      if (stride == 4)
+	raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+      else
+	raw = _mm256_i32gather_epi32(reinterpret_cast<const int*>(source), index, 1);
+      if (FMT::big_endian) raw = priv_bswap32_avx2(raw);
+      _mm256_storeu_ps(target + n, _mm256_castsi256_ps(raw));
+      source += 8 * stride;
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_import_f32<FMT>(source, stride, target + n, count - n);
+}
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_export_f32_avx2(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  long int n = 0;
+  for(; n + 8 <= count; n += 8) {
+    __m256 v = _mm256_loadu_ps(source + n);
+    if (clip == true) v = priv_clip_avx2(v);
+    __m256i res = _mm256_castps_si256(v);
+    if (stride == 4) {
+      if (FMT::big_endian) res = priv_bswap32_avx2(res);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), res);
+      target += 32;
+    }
+    else {
+      priv_scatter_avx2<FMT>(target, stride, res);
+      target += 8 * stride;
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_export_f32<FMT>(source + n, target, stride, count - n, clip);
+}
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_import_f64_avx2(const unsigned char* source, long int stride, sample_t* target, long int count)
+{
+  const __m128i index = _mm256_castsi256_si128(priv_gather_index_avx2(stride));
+  long int n = 0;
+  if (stride <= max_gather_stride) {
+    for(; n + 4 <= count; n += 4) {
+      __m256d raw;
+      if (stride == 8)
+	raw = _mm256_loadu_pd(reinterpret_cast<const double*>(source));
+      else
+	raw = _mm256_i32gather_pd(reinterpret_cast<const double*>(source), index, 1);
+      if (FMT::big_endian)
+	raw = _mm256_castsi256_pd(priv_bswap64_avx2(_mm256_castpd_si256(raw)));
+      _mm_storeu_ps(target + n, _mm256_cvtpd_ps(raw));
+      source += 4 * stride;
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_import_f64<FMT>(source, stride, target + n, count - n);
+}
+
+template<class FMT>
+static ECA_TARGET_AVX2 void priv_export_f64_avx2(const sample_t* source, unsigned char* target, long int stride, long int count, bool clip)
+{
+  long int n = 0;
+  uint64_t tmp[4];
+  for(; n + 4 <= count; n += 4) {
+    __m128 v = _mm_loadu_ps(source + n);
+    if (clip == true)
+      v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(SAMPLE_SPECS::impl_min_value)),
+		     _mm_set1_ps(SAMPLE_SPECS::impl_max_value));
+    __m256i res = _mm256_castpd_si256(_mm256_cvtps_pd(v));
+    if (FMT::big_endian) res = priv_bswap64_avx2(res);
+    if (stride == 8) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), res);
+      target += 32;
+    }
+    else {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), res);
+      for(int k = 0; k < 4; k++) {
+	std::memcpy(target, &tmp[k], sizeof(tmp[k]));
+	target += stride;
+      }
+    }
+  }
+
+  _mm256_zeroupper();
+  priv_export_f64<FMT>(source + n, target, stride, count - n, clip);
+}
+
+/* note: no FMA, so that results match the other kernels */
+static ECA_TARGET_AVX2 void priv_mix_avx2(const sample_t* const* sources, int nsources, sample_t* target, long int count, sample_t weight, bool add)
+{
+  const __m256 w = _mm256_set1_ps(weight);
+  long int n = 0;
+  for(; n + 16 <= count; n += 16) {
+    __m256 a = _mm256_mul_ps(_mm256_loadu_ps(sources[0] + n), w);
+    __m256 b = _mm256_mul_ps(_mm256_loadu_ps(sources[0] + n + 8), w);
+    if (add == true) {
+      a = _mm256_add_ps(_mm256_loadu_ps(target + n), a);
+      b = _mm256_add_ps(_mm256_loadu_ps(target + n + 8), b);
+    }
+    for(int i = 1; i < nsources; i++) {
+      a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(sources[i] + n), w));
+      b = _mm256_add_ps(b, _mm256_mul_ps(_mm256_loadu_ps(sources[i] + n + 8), w));
+    }
+    _mm256_storeu_ps(target + n, a);
+    _mm256_storeu_ps(target + n + 8, b);
+  }
+
+  _mm256_zeroupper();
+  if (n < count) {
+    const sample_t* rest[max_mix_sources];
+    for(int i = 0; i < nsources; i++) rest[i] = sources[i] + n;
+    priv_mix(rest, nsources, target + n, count - n, weight, add);
+  }
+}
+
+#endif /* ECA_CONVERT_X86 */
+
+/* ---------------------------------------------------------------------
+ * Kernel selection
+ */
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::import_kernel_t priv_int_import_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_import_int_avx2<FMT>;
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_sse2)
+    return priv_import_int_sse2<FMT>;
+#endif
+  return priv_import_int<FMT>;
+}
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::export_kernel_t priv_int_export_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_export_int_avx2<FMT>;
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_sse2)
+    return priv_export_int_sse2<FMT>;
+#endif
+  return priv_export_int<FMT>;
+}
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::import_kernel_t priv_f32_import_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_import_f32_avx2<FMT>;
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_sse2)
+    return priv_import_f32_sse2<FMT>;
+#endif
+  return priv_import_f32<FMT>;
+}
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::export_kernel_t priv_f32_export_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_export_f32_avx2<FMT>;
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_sse2)
+    return priv_export_f32_sse2<FMT>;
+#endif
+  return priv_export_f32<FMT>;
+}
+
+/* note: there are no SSE2 versions of the f64 kernels, as
+ *       without gathers they are no faster than scalar code */
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::import_kernel_t priv_f64_import_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_import_f64_avx2<FMT>;
+#endif
+  return priv_import_f64<FMT>;
+}
+
+template<class FMT>
+static SAMPLE_BUFFER_CONVERT::export_kernel_t priv_f64_export_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_export_f64_avx2<FMT>;
+#endif
+  return priv_export_f64<FMT>;
+}
+
+/**
+ * Returns the import kernel for 'fmt', or 0 if
+ * the format is not supported.
+ */
+SAMPLE_BUFFER_CONVERT::import_kernel_t SAMPLE_BUFFER_CONVERT::import_kernel(ECA_AUDIO_FORMAT::Sample_format fmt)
+{
+  switch (fmt) {
+  case ECA_AUDIO_FORMAT::sfmt_s16_le: return priv_int_import_kernel<FMT_S16_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s16_be: return priv_int_import_kernel<FMT_S16_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_s24_le: return priv_int_import_kernel<FMT_S24_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s24_be: return priv_int_import_kernel<FMT_S24_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_s32_le: return priv_int_import_kernel<FMT_S32_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s32_be: return priv_int_import_kernel<FMT_S32_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_f32_le: return priv_f32_import_kernel<FMT_F32_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_f32_be: return priv_f32_import_kernel<FMT_F32_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_f64_le: return priv_f64_import_kernel<FMT_F64_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_f64_be: return priv_f64_import_kernel<FMT_F64_BE>();
+  default: { }
+  }
+  return 0;
+}
+
+/**
+ * Returns the export kernel for 'fmt', or 0 if
+ * the format is not supported.
+ */
+SAMPLE_BUFFER_CONVERT::export_kernel_t SAMPLE_BUFFER_CONVERT::export_kernel(ECA_AUDIO_FORMAT::Sample_format fmt)
+{
+  switch (fmt) {
+  case ECA_AUDIO_FORMAT::sfmt_s16_le: return priv_int_export_kernel<FMT_S16_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s16_be: return priv_int_export_kernel<FMT_S16_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_s24_le: return priv_int_export_kernel<FMT_S24_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s24_be: return priv_int_export_kernel<FMT_S24_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_s32_le: return priv_int_export_kernel<FMT_S32_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_s32_be: return priv_int_export_kernel<FMT_S32_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_f32_le: return priv_f32_export_kernel<FMT_F32_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_f32_be: return priv_f32_export_kernel<FMT_F32_BE>();
+  case ECA_AUDIO_FORMAT::sfmt_f64_le: return priv_f64_export_kernel<FMT_F64_LE>();
+  case ECA_AUDIO_FORMAT::sfmt_f64_be: return priv_f64_export_kernel<FMT_F64_BE>();
+  default: { }
+  }
+  return 0;
+}
+
+/**
+ * Returns the mixing kernel for the current kernel type.
+ */
+SAMPLE_BUFFER_CONVERT::mix_kernel_t SAMPLE_BUFFER_CONVERT::mix_kernel(void)
+{
+#ifdef ECA_CONVERT_X86
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_avx2)
+    return priv_mix_avx2;
+  if (kernel_type_rep == SAMPLE_BUFFER_CONVERT::kernel_sse2)
+    return priv_mix_sse2;
+#endif
+  return priv_mix;
+}
+
+/**
+ * Returns the size of one raw sample in bytes for
+ * formats that have conversion kernels, or 0 otherwise.
+ */
+int SAMPLE_BUFFER_CONVERT::sample_size(ECA_AUDIO_FORMAT::Sample_format fmt)
+{
+  switch (fmt) {
+  case ECA_AUDIO_FORMAT::sfmt_s16_le:
+  case ECA_AUDIO_FORMAT::sfmt_s16_be: return 2;
+  case ECA_AUDIO_FORMAT::sfmt_s24_le:
+  case ECA_AUDIO_FORMAT::sfmt_s24_be: return 3;
+  case ECA_AUDIO_FORMAT::sfmt_s32_le:
+  case ECA_AUDIO_FORMAT::sfmt_s32_be:
+  case ECA_AUDIO_FORMAT::sfmt_f32_le:
+  case ECA_AUDIO_FORMAT::sfmt_f32_be: return 4;
+  case ECA_AUDIO_FORMAT::sfmt_f64_le:
+  case ECA_AUDIO_FORMAT::sfmt_f64_be: return 8;
+  default: { }
+  }
+  return 0;
+}
+
+/**
+ * Whether raw samples of format 'fmt' have the same 
+ * binary representation as sample_t, ie. whether
+ * raw data can be used as is without conversion.
+ */
+bool SAMPLE_BUFFER_CONVERT::is_native_format(ECA_AUDIO_FORMAT::Sample_format fmt)
+{
+  if (sizeof(sample_t) != sizeof(float))
+    return false;
+
+#ifdef WORDS_BIGENDIAN
+  return fmt == ECA_AUDIO_FORMAT::sfmt_f32_be;
+#else
+  return fmt == ECA_AUDIO_FORMAT::sfmt_f32_le;
+#endif
+}
+
+/**
+ * Returns the type of kernels currently in use.
+ */
+SAMPLE_BUFFER_CONVERT::Kernel_type SAMPLE_BUFFER_CONVERT::kernel_type(void)
+{
+  return kernel_type_rep;
+}
+
+/**
+ * Returns the fastest kernel type supported by the CPU.
+ */
+SAMPLE_BUFFER_CONVERT::Kernel_type SAMPLE_BUFFER_CONVERT::best_kernel_type(void)
+{
+  return best_kernel_type_rep;
+}
+
+/**
+ * Selects the type of kernels returned by import_kernel()
+ * and export_kernel(). Types not supported by the CPU are
+ * replaced by best_kernel_type(). Mainly useful for testing
+ * and benchmarking.
+ */
+void SAMPLE_BUFFER_CONVERT::set_kernel_type(Kernel_type type)
+{
+  kernel_type_rep = (type > best_kernel_type_rep) ? best_kernel_type_rep : type;
+}
+
+const char* SAMPLE_BUFFER_CONVERT::kernel_type_name(Kernel_type type)
+{
+  switch (type) {
+  case kernel_avx2: return "avx2";
+  case kernel_sse2: return "sse2";
+  default: { }
+  }
+  return "scalar";
+}
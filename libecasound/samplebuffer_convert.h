@@ -0,0 +1,81 @@
+#ifndef INCLUDED_SAMPLEBUFFER_CONVERT_H
+#define INCLUDED_SAMPLEBUFFER_CONVERT_H
+
+#include "eca-audio-format.h"
+#include "sample-specs.h"
+
+/**
+ * Block conversion kernels between raw sample formats and
+ * the internal sample type. This class really is just an
+ * extension of class SAMPLE_BUFFER.
+ *
+ * Each kernel converts 'count' samples of one channel.
+ * 'stride' is the distance in bytes between consecutive
+ * raw samples, so the same kernel deinterleaves (stride
+ * is the frame size) or reads non-interleaved data
+ * (stride is the sample size) in a single pass.
+ *
+ * Kernels are provided for s16, s24, s32, f32 and f64 in
+ * both byte orders. On x86 CPUs, SSE2 and AVX2 versions
+ * are selected at runtime. Other formats are not handled
+ * and the kernel lookup returns 0.
+ *
+ * Mixing kernels sum 'count' samples of 1 to max_mix_sources
+ * channels in 'sources', each multiplied by 'weight', and 
+ * either store (add == false) or add (add == true) the result
+ * to 'target'. Sums are kept in registers, so 'target' is 
+ * read and written only once. The first source may be the 
+ * same as 'target' for scaling in place. All kernel types 
+ * give bit-exact results.
+ */
+class SAMPLE_BUFFER_CONVERT {
+
+ public:
+
+  /** @name Public type definitions */
+  /*@{*/
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  typedef void (*import_kernel_t)(const unsigned char* source,
+				  long int stride,
+				  sample_t* target,
+				  long int count);
+
+  typedef void (*export_kernel_t)(const sample_t* source,
+				  unsigned char* target,
+				  long int stride,
+				  long int count,
+				  bool clip);
+
+  typedef void (*mix_kernel_t)(const sample_t* const* sources,
+			       int nsources,
+			       sample_t* target,
+			       long int count,
+			       sample_t weight,
+			       bool add);
+
+  static const int max_mix_sources = 8;
+
+  enum Kernel_type { kernel_scalar = 0, kernel_sse2, kernel_avx2 };
+
+  /*@}*/
+
+  /** @name Public functions for kernel selection */
+  /*@{*/
+
+  static import_kernel_t import_kernel(ECA_AUDIO_FORMAT::Sample_format fmt);
+  static export_kernel_t export_kernel(ECA_AUDIO_FORMAT::Sample_format fmt);
+  static mix_kernel_t mix_kernel(void);
+  static int sample_size(ECA_AUDIO_FORMAT::Sample_format fmt);
+  static bool is_native_format(ECA_AUDIO_FORMAT::Sample_format fmt);
+
+  static Kernel_type kernel_type(void);
+  static Kernel_type best_kernel_type(void);
+  static void set_kernel_type(Kernel_type type);
+  static const char* kernel_type_name(Kernel_type type);
+
+  /*@}*/
+};
+
+#endif
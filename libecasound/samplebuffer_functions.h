@@ -38,18 +38,20 @@ class SAMPLE_BUFFER_FUNCTIONS {
 
   static sample_t max_value(const SAMPLE_BUFFER& buf, 
 			       SAMPLE_BUFFER::channel_size_t channel) {
+    const sample_t* data = buf.channel_data(channel);
     sample_t t = SAMPLE_SPECS::impl_min_value;
     for(SAMPLE_BUFFER::buf_size_t m = 0; m < buf.buffersize_rep; m++) {
-      if (buf.buffer[channel][m] > t) t = buf.buffer[channel][m];
+      if (data[m] > t) t = data[m];
     }
     return(t);
   }
 
   static sample_t min_value(const SAMPLE_BUFFER& buf, 
 			SAMPLE_BUFFER::channel_size_t channel) {
+    const sample_t* data = buf.channel_data(channel);
     sample_t t = SAMPLE_SPECS::impl_max_value;
     for(SAMPLE_BUFFER::buf_size_t m = 0; m < buf.buffersize_rep; m++) {
-      if (buf.buffer[channel][m] < t) t = buf.buffer[channel][m];
+      if (data[m] < t) t = data[m];
     }
     return(t);
   }
@@ -57,8 +59,9 @@ class SAMPLE_BUFFER_FUNCTIONS {
   static sample_t average_amplitude(const SAMPLE_BUFFER& buf) {
     sample_t temp_avg = 0.0;
     for(int n = 0; n < buf.channel_count_rep; n++) {
+      const sample_t* data = buf.channel_data(n);
       for(SAMPLE_BUFFER::buf_size_t m = 0; m < buf.buffersize_rep; m++) {
-	temp_avg += fabs(buf.buffer[n][m] - SAMPLE_SPECS::silent_value);
+	temp_avg += fabs(data[m] - SAMPLE_SPECS::silent_value);
       }
     }
     return(temp_avg / buf.channel_count_rep / buf.buffersize_rep);
@@ -67,8 +70,9 @@ class SAMPLE_BUFFER_FUNCTIONS {
   static sample_t RMS_volume(const SAMPLE_BUFFER& buf) {
     sample_t temp_avg = 0.0;
     for(int n = 0; n < buf.channel_count_rep; n++) {
+      const sample_t* data = buf.channel_data(n);
       for(SAMPLE_BUFFER::buf_size_t m = 0; m < buf.buffersize_rep; m++) {
-	temp_avg += buf.buffer[n][m] * buf.buffer[n][m];
+	temp_avg += data[m] * data[m];
       }
     }
     return(sqrt(temp_avg / buf.channel_count_rep / buf.buffersize_rep));
@@ -80,8 +84,9 @@ class SAMPLE_BUFFER_FUNCTIONS {
       sample_t temp_avg = 0.0;
       if (count_samples == 0) count_samples = static_cast<int>(buf.channel_count_rep);
       
+      const sample_t* data = buf.channel_data(channel);
       for(SAMPLE_BUFFER::buf_size_t n = 0; n < buf.buffersize_rep; n++) {
-	temp_avg += fabs(buf.buffer[channel][n] - SAMPLE_SPECS::silent_value);
+	temp_avg += fabs(data[n] - SAMPLE_SPECS::silent_value);
       }
       
       return(temp_avg / count_samples);
@@ -92,8 +97,9 @@ class SAMPLE_BUFFER_FUNCTIONS {
 				SAMPLE_BUFFER::buf_size_t count_samples) {
     sample_t temp_avg = 0.0;
     if (count_samples == 0) count_samples = static_cast<int>(buf.channel_count_rep);
+    const sample_t* data = buf.channel_data(channel);
     for(SAMPLE_BUFFER::buf_size_t n = 0; n < buf.buffersize_rep; n++) {
-      temp_avg += buf.buffer[channel][n] * buf.buffer[channel][n];
+      temp_avg += data[n] * data[n];
     }
     return(sqrt(temp_avg / count_samples));
   }
@@ -28,6 +28,8 @@ class SAMPLE_BUFFER_impl {
   int quality_rep;
   int event_tags_rep;
 
+  void* slab_repp;                           // storage for all channels
+  SAMPLE_BUFFER::buf_size_t channel_stride_rep;
   SAMPLE_BUFFER::sample_t* old_buffer_repp; // for resampling
   std::vector<SAMPLE_BUFFER::sample_t> resample_memory_rep;
 #ifdef ECA_COMPILE_SAMPLERATE
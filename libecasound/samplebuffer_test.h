@@ -24,6 +24,7 @@
 #include "kvu_inttypes.h"
 
 #include "samplebuffer.h"
+#include "samplebuffer_convert.h"
 #include "samplebuffer_functions.h"
 #include "eca-test-case.h"
 
@@ -122,4 +123,134 @@ void SAMPLE_BUFFER_TEST::do_run(void)
       ECA_TEST_FAILURE("optimized add_matching_channels");
     }
   }
+
+  /* case: mix_matching_channels */
+  {
+    std::fprintf(stdout, "%s: mix_matching_channels\n",
+		 __FILE__);
+    SAMPLE_BUFFER src1 (bufsize, channels);
+    SAMPLE_BUFFER src2 (bufsize / 2 + 3, channels / 2);
+    SAMPLE_BUFFER src3 (bufsize - 1, channels);
+    SAMPLE_BUFFER* sources[] = { &src2, &src1, &src3 };
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&src1);
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&src2);
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&src3);
+
+    /* reference: copy first, add the rest, then scale */
+    SAMPLE_BUFFER sbuf_ref (bufsize, channels);
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&sbuf_ref);
+    sbuf_ref.make_silent();
+    sbuf_ref.copy_matching_channels(src2);
+    sbuf_ref.add_matching_channels_ref(src1);
+    sbuf_ref.add_matching_channels_ref(src3);
+    sbuf_ref.multiply_by_ref(0.25f);
+
+    SAMPLE_BUFFER sbuf_scalar (16, channels);
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&sbuf_scalar);
+    SAMPLE_BUFFER_CONVERT::set_kernel_type(SAMPLE_BUFFER_CONVERT::kernel_scalar);
+    sbuf_scalar.mix_matching_channels(sources, 3, 0.25f);
+    if (SAMPLE_BUFFER_FUNCTIONS::is_almost_equal(sbuf_ref, sbuf_scalar) != true) { 
+      ECA_TEST_FAILURE("mix_matching_channels");
+    }
+
+    /* all kernel types must give identical results */
+    for(int t = SAMPLE_BUFFER_CONVERT::kernel_sse2; 
+	t <= SAMPLE_BUFFER_CONVERT::best_kernel_type(); t++) {
+      SAMPLE_BUFFER_CONVERT::set_kernel_type(static_cast<SAMPLE_BUFFER_CONVERT::Kernel_type>(t));
+      SAMPLE_BUFFER sbuf_test (bufsize, channels);
+      sbuf_test.mix_matching_channels(sources, 3, 0.25f);
+      bool match = true;
+      for(int c = 0; c < channels; c++) {
+	for(int n = 0; n < bufsize; n++) {
+	  if (sbuf_test.buffer[c][n] != sbuf_scalar.buffer[c][n]) 
+	    match = false;
+	}
+      }
+      if (match != true) {
+	ECA_TEST_FAILURE(string("mix kernel mismatch: ") +
+			 SAMPLE_BUFFER_CONVERT::kernel_type_name(static_cast<SAMPLE_BUFFER_CONVERT::Kernel_type>(t)));
+      }
+    }
+    SAMPLE_BUFFER_CONVERT::set_kernel_type(SAMPLE_BUFFER_CONVERT::best_kernel_type());
+  }
+
+  /* case: channel storage layout */
+  {
+    std::fprintf(stdout, "%s: channel storage\n",
+		 __FILE__);
+    SAMPLE_BUFFER sbuf_orig (bufsize, channels);
+    SAMPLE_BUFFER sbuf_test (100, 3);
+
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&sbuf_orig);
+    sbuf_orig.length_in_samples(100);
+    sbuf_orig.number_of_channels(3);
+    sbuf_test.copy_all_content(sbuf_orig);
+
+    /* grow channel count, then length */
+    sbuf_test.number_of_channels(channels);
+    sbuf_test.reserve_length_in_samples(bufsize * 4);
+    sbuf_test.number_of_channels(3);
+
+    if (SAMPLE_BUFFER_FUNCTIONS::is_almost_equal(sbuf_orig, sbuf_test) != true) { 
+      ECA_TEST_FAILURE("data lost when growing storage");
+    }
+
+    for(int c = 0; c < channels; c++) {
+      if (reinterpret_cast<uintptr_t>(sbuf_test.buffer[c]) % 
+	  SAMPLE_BUFFER::channel_alignment != 0) {
+	ECA_TEST_FAILURE("channel alignment");
+      }
+      if (c > 0 &&
+	  sbuf_test.buffer[c] - sbuf_test.buffer[c - 1] != 
+	  sbuf_test.buffer[1] - sbuf_test.buffer[0]) {
+	ECA_TEST_FAILURE("channels not evenly spaced");
+      }
+    }
+    if (sbuf_test.buffer[1] - sbuf_test.buffer[0] < bufsize * 4) {
+      ECA_TEST_FAILURE("channels overlap");
+    }
+
+    /* new channels are silent */
+    sbuf_test.number_of_channels(channels);
+    if (SAMPLE_BUFFER_FUNCTIONS::max_value(sbuf_test, channels - 1) != SAMPLE_SPECS::silent_value ||
+	SAMPLE_BUFFER_FUNCTIONS::min_value(sbuf_test, channels - 1) != SAMPLE_SPECS::silent_value) {
+      ECA_TEST_FAILURE("new channel not silent");
+    }
+  }
+
+  /* case: adding channels keeps existing channels in place */
+  {
+    std::fprintf(stdout, "%s: channel growth\n",
+		 __FILE__);
+    SAMPLE_BUFFER sbuf (bufsize, 1);
+    SAMPLE_BUFFER_FUNCTIONS::fill_with_random_samples(&sbuf);
+    SAMPLE_BUFFER sbuf_copy (bufsize, 1);
+    sbuf_copy.copy_all_content(sbuf);
+
+    /* note: added channels are stored in the same block
+     *       as existing ones */
+    sbuf.number_of_channels(channels);
+    for(int c = 1; c < channels; c++) {
+      if (sbuf.buffer[c] - sbuf.buffer[c - 1] !=
+	  sbuf.buffer[1] - sbuf.buffer[0]) {
+	ECA_TEST_FAILURE("added channel not contiguous");
+      }
+    }
+    if (reinterpret_cast<uintptr_t>(sbuf.buffer[channels - 1]) % 
+	SAMPLE_BUFFER::channel_alignment != 0) {
+      ECA_TEST_FAILURE("added channel alignment");
+    }
+    sbuf.number_of_channels(1);
+    if (SAMPLE_BUFFER_FUNCTIONS::is_almost_equal(sbuf, sbuf_copy) != true) { 
+      ECA_TEST_FAILURE("data lost when adding channels");
+    }
+
+    /* note: plugins keep pointers to channel data, so
+     *       channels within the reserved space stay put */
+    SAMPLE_SPECS::sample_t* first = sbuf.buffer[0];
+    sbuf.number_of_channels(channels);
+    if (sbuf.buffer[0] != first) {
+      ECA_TEST_FAILURE("channel moved within reserved space");
+    }
+  }
 }
@@ -19,10 +19,13 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <vector>
 
 #include "eca-version.h"
 #include "samplebuffer.h"
+#include "samplebuffer_convert.h"
 #include "audiofx_amplitude.h"
+#include "audiofx_filter.h"
 
 #include "kvu_procedure_timer.h"
 #include "ecatestsuite.h"
@@ -31,7 +34,10 @@ int test_sbuf_make_silent(void);
 int test_sbuf_copy_ops(void);
 int test_sbuf_constructor(void);
 int test_sbuf_mix(void);
+int test_sbuf_mix_chains(void);
 int test_sbuf_iter(void);
+int test_sbuf_convert(void);
+int test_effect_filter(void);
 
 #ifndef LIBECASOUND_VERSION
 #define LIBECASOUND_VERSION 22
@@ -49,7 +55,10 @@ int main(int argc, char *argv[])
   res += test_sbuf_constructor();
   res += test_sbuf_make_silent();
   res += test_sbuf_mix();
+  res += test_sbuf_mix_chains();
   res += test_sbuf_iter();
+  res += test_sbuf_convert();
+  res += test_effect_filter();
 
   return res;
 }
@@ -99,7 +108,9 @@ int test_sbuf_make_silent(void)
   t1.stop();
   
   helper_print_one_result("make_silent", t1, loops, bufsize);
-}  
+
+  return 0;
+}
 
 int test_sbuf_copy_ops(void)
 {
@@ -169,7 +180,9 @@ int test_sbuf_copy_ops(void)
    std::free(rawbuf1);
    std::free(rawbuf2);
  }
-}  
+
+  return 0;
+}
 
 int test_sbuf_constructor(void)
 {
@@ -192,7 +205,9 @@ int test_sbuf_constructor(void)
   t1.stop();
 
   helper_print_one_result("constructor", t1, loops, bufsize);
-}  
+
+  return 0;
+}
 
 int test_sbuf_mix(void)
 {
@@ -318,6 +333,75 @@ int test_sbuf_mix(void)
     helper_print_one_result("limit_values_ref", t1, loops, bufsize);
 #endif
   }
+
+  return 0;
+}
+
+/**
+ * Mixing of many chains to one output, as done in
+ * ECA_ENGINE::mix_to_outputs() in averaging mode.
+ */
+int test_sbuf_mix_chains(void)
+{
+  const int loops = 1000;
+  const int bufsize = 1024;
+  const int channels = 2;
+  const int chains = 128;
+
+  std::printf("sbuf_mix_chains with %d loops (bufsize=%d, ch=%d, chains=%d):\n", 
+	      loops, bufsize, channels, chains);
+
+  PROCEDURE_TIMER t1;
+  SAMPLE_BUFFER mix (bufsize, channels);
+  std::vector<SAMPLE_BUFFER*> sources (chains);
+  for(int c = 0; c < chains; c++) {
+    sources[c] = new SAMPLE_BUFFER(bufsize, channels);
+  }
+
+  /* case 1: copy, divide and add_with_weight per chain */
+  {
+    t1.reset();
+    t1.start();
+    for(int n = 0; n < loops; n++) {
+      mix.copy_matching_channels(*sources[0]);
+      mix.divide_by(chains);
+      for(int c = 1; c < chains; c++) {
+	mix.add_with_weight(*sources[c], chains);
+      }
+    }
+    t1.stop();
+
+    helper_print_one_result("add_with_weight", t1, loops, bufsize);
+  }
+
+#if LIBECASOUND_VERSION >= 22
+  /* case 2: fused and tiled, all chains in one pass */
+  for(int k = 0; k < 2; k++) {
+    SAMPLE_BUFFER_CONVERT::Kernel_type type = 
+      (k == 0) ? SAMPLE_BUFFER_CONVERT::kernel_scalar : 
+      SAMPLE_BUFFER_CONVERT::best_kernel_type();
+    SAMPLE_BUFFER_CONVERT::set_kernel_type(type);
+
+    mix.mix_matching_channels(&sources[0], chains, 1.0f / chains);
+    t1.reset();
+    t1.start();
+    for(int n = 0; n < loops; n++) {
+      mix.mix_matching_channels(&sources[0], chains, 1.0f / chains);
+    }
+    t1.stop();
+
+    char casename[64];
+    std::snprintf(casename, sizeof(casename), "mix_matching_ch (%s)",
+		  SAMPLE_BUFFER_CONVERT::kernel_type_name(type));
+    helper_print_one_result(casename, t1, loops, bufsize);
+  }
+#endif
+
+  for(int c = 0; c < chains; c++) {
+    delete sources[c];
+  }
+
+  return 0;
 }
 
 int test_sbuf_iter(void)
@@ -407,4 +491,102 @@ int test_sbuf_iter(void)
 #endif
   }
 
+  return 0;
+}
+
+int test_sbuf_convert(void)
+{
+  const int loops = 10000;
+  const int bufsize = 1024;
+  const int channels = 24;
+  const ECA_AUDIO_FORMAT::Sample_format fmts[] = {
+    ECA_AUDIO_FORMAT::sfmt_s16_le, ECA_AUDIO_FORMAT::sfmt_s24_le,
+    ECA_AUDIO_FORMAT::sfmt_s32_le, ECA_AUDIO_FORMAT::sfmt_f32_le };
+  const char* fmtnames[] = { "s16_le", "s24_le", "s32_le", "f32_le" };
+  const SAMPLE_BUFFER_CONVERT::Kernel_type best = 
+    SAMPLE_BUFFER_CONVERT::best_kernel_type();
+
+  std::printf("sbuf_convert with %d loops (bufsize=%d, ch=%d, kernels=%s):\n", 
+	      loops, bufsize, channels, 
+	      SAMPLE_BUFFER_CONVERT::kernel_type_name(best));
+
+  PROCEDURE_TIMER t1;
+  SAMPLE_BUFFER sbuf (bufsize, channels);
+  unsigned char* raw = new unsigned char [bufsize * channels * 4];
+  std::memset(raw, 0, bufsize * channels * 4);
+  sbuf.make_silent();
+
+  for(int f = 0; f < 4; f++) {
+    ECA_AUDIO_FORMAT::Sample_coding coding = (f < 3) ? 
+      ECA_AUDIO_FORMAT::sc_signed : ECA_AUDIO_FORMAT::sc_float;
+
+    for(int k = 0; k < 2; k++) {
+      SAMPLE_BUFFER_CONVERT::Kernel_type type = 
+	(k == 0) ? SAMPLE_BUFFER_CONVERT::kernel_scalar : best;
+      char casename[64];
+      SAMPLE_BUFFER_CONVERT::set_kernel_type(type);
+
+      /* note: make sure code is paged in */
+      sbuf.import_interleaved(raw, bufsize, fmts[f], channels);
+
+      t1.reset();
+      t1.start();
+      for(int n = 0; n < loops; n++) {
+	sbuf.import_interleaved(raw, bufsize, fmts[f], channels);
+      }
+      t1.stop();
+      std::snprintf(casename, sizeof(casename), "import %s %s", 
+		    fmtnames[f], SAMPLE_BUFFER_CONVERT::kernel_type_name(type));
+      helper_print_one_result(casename, t1, loops, bufsize);
+
+      t1.reset();
+      t1.start();
+      for(int n = 0; n < loops; n++) {
+	sbuf.export_interleaved(raw, fmts[f], coding, channels);
+      }
+      t1.stop();
+      std::snprintf(casename, sizeof(casename), "export %s %s", 
+		    fmtnames[f], SAMPLE_BUFFER_CONVERT::kernel_type_name(type));
+      helper_print_one_result(casename, t1, loops, bufsize);
+    }
+  }
+
+  SAMPLE_BUFFER_CONVERT::set_kernel_type(best);
+  delete[] raw;
+
+  return 0;
+}
+
+int test_effect_filter(void)
+{
+  const int loops = 2000;
+  const int bufsize = 1024;
+  const int channels[] = { 2, 24 };
+
+  for(int c = 0; c < 2; c++) {
+    std::printf("effect_filter with %d loops (bufsize=%d, ch=%d):\n", 
+		loops, bufsize, channels[c]);
+
+    PROCEDURE_TIMER t1;
+    SAMPLE_BUFFER sbuf (bufsize, channels[c]);
+    EFFECT_LOWPASS lowpass (1000.0);
+
+    for(int ch = 0; ch < channels[c]; ch++)
+      for(int n = 0; n < bufsize; n++)
+	sbuf.buffer[ch][n] = (std::rand() / (SAMPLE_BUFFER::sample_t)RAND_MAX) - 0.5f;
+
+    lowpass.init(&sbuf);
+    lowpass.process();
+
+    t1.reset();
+    t1.start();
+    for(int n = 0; n < loops; n++) {
+      lowpass.process();
+    }
+    t1.stop();
+
+    helper_print_one_result("effect_lowpass", t1, loops, bufsize);
+  }
+
+  return 0;
 }